@@ -0,0 +1,121 @@
+//
+//  ClientPoolBench.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IAgoraRtmClient.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Session/RtmClientPool.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+
+namespace {
+
+class CountingEventHandler : public IRtmEventHandler {
+ public:
+  void onMessageEvent(const MessageEvent&) override { messages.fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<uint64_t> messages{0};
+};
+
+}  // namespace
+
+/// Usage: ClientPoolBench [sessions] [shards] [rooms] [messages per room] [service logins per second]
+int main(int argc, char** argv) {
+  const int sessionCount = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const size_t shardCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+  const int roomCount = argc > 3 ? std::atoi(argv[3]) : 20;
+  const int messageCount = argc > 4 ? std::atoi(argv[4]) : 2000;
+  const size_t serviceLogins = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 4000;
+
+  LoopbackBroker::Options brokerOptions;
+  brokerOptions.loginsPerSecond = serviceLogins;
+  LoopbackBroker broker(brokerOptions);
+  RtmClientPool::Options options;
+  options.shards = shardCount;
+  options.overflow = QueuedRtmEventHandler::OverflowPolicy::block;
+  options.loginsPerSecond = static_cast<double>(serviceLogins);
+  options.loginBurst = serviceLogins / 10 + 1;
+  options.retryBackoff = std::chrono::milliseconds(50);
+  options.create = [&broker](const RtmConfig& config, int& errorCode) -> IRtmClient* {
+    LoopbackRtmClient* client = createLoopbackRtmClient(broker, config, errorCode);
+    if (client) client->setResultsOnDispatcher(true);
+    return client;
+  };
+  RtmClientPool pool(RtmClock::now(), options);
+  std::vector<CountingEventHandler> handlers(sessionCount);
+  std::vector<RtmClientPool::SessionId> ids;
+  for (int i = 0; i < sessionCount; ++i) {
+    std::string userId = "bot" + std::to_string(i);
+    RtmConfig config;
+    config.appId = "bench";
+    config.userId = userId.c_str();
+    int errorCode = 0;
+    ids.push_back(pool.add(config, "token", handlers[i], errorCode));
+  }
+
+  pool.start();
+  auto start = std::chrono::steady_clock::now();
+  while (pool.stats().online < static_cast<size_t>(sessionCount)) {
+    pool.poll(RtmClock::now());
+    RtmClock::time_point next = std::min(pool.nextDeadline(), RtmClock::now() + std::chrono::milliseconds(5));
+    std::this_thread::sleep_until(next);
+  }
+  double loginSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  SubscribeOptions subscribeOptions;
+  subscribeOptions.withPresence = false;
+  for (int i = 0; i < sessionCount; ++i) {
+    std::string room = "room" + std::to_string(i % roomCount);
+    uint64_t requestId = 0;
+    pool.client(ids[i])->subscribe(room.c_str(), subscribeOptions, requestId);
+  }
+  RtmConfig config;
+  config.appId = "bench";
+  config.userId = "teacher";
+  int errorCode = 0;
+  CountingEventHandler teacherHandler;
+  config.eventHandler = &teacherHandler;
+  LoopbackRtmClient* teacher = createLoopbackRtmClient(broker, config, errorCode);
+  teacher->setResultsOnDispatcher(true);
+  uint64_t requestId = 0;
+  teacher->login("token", requestId);
+
+  PublishOptions publishOptions;
+  const std::string payload(64, 'x');
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < messageCount; ++i) {
+    for (int room = 0; room < roomCount; ++room) {
+      std::string channel = "room" + std::to_string(room);
+      teacher->publish(channel.c_str(), payload.data(), payload.size(), publishOptions, requestId);
+    }
+  }
+  pool.stop();
+  double deliverSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  uint64_t delivered = 0;
+  for (const CountingEventHandler& handler : handlers) delivered += handler.messages.load();
+  RtmClientPool::Stats stats = pool.stats();
+  std::printf("sessions=%d shards=%zu rooms=%d publishes=%d service logins/s=%zu\n", sessionCount, shardCount,
+              roomCount, messageCount * roomCount, serviceLogins);
+  std::printf("login: %.2f s (%.0f sessions/s, %llu retries, %llu failures)\n", loginSeconds,
+              sessionCount / loginSeconds, static_cast<unsigned long long>(stats.loginRetries),
+              static_cast<unsigned long long>(stats.loginFailures));
+  std::printf("deliver: %.0f msg/s (%.1f ns/delivery)\n", delivered / deliverSeconds,
+              deliverSeconds * 1e9 / static_cast<double>(delivered ? delivered : 1));
+
+  teacher->release();
+  return delivered == static_cast<uint64_t>(messageCount) * sessionCount ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+//
+//  CommandCodecBench.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Command/RtmCommandCodec.h"
+#include "Common/JsonScan.h"
+
+using namespace flat::rtm;
+
+namespace {
+
+using Format = RtmCommandCodec::Format;
+
+/// A classroom's traffic: mostly hand raises and device requests, some notices and arrivals.
+std::vector<RtmCommand> classroomMix() {
+  std::vector<RtmCommand> commands;
+  RtmCommand command;
+  command.roomUUID = "5f1c8a3e-2b7d-4c9a-9e0f-61d2b3a4c5e6";
+  command.type = RtmCommandType::raiseHand;
+  command.on = true;
+  commands.push_back(command);
+  command.on = false;
+  commands.push_back(command);
+  command.type = RtmCommandType::requestDeviceResponse;
+  command.device = RtmDeviceType::mic;
+  command.on = true;
+  commands.push_back(command);
+  command.type = RtmCommandType::ban;
+  commands.push_back(command);
+  command.type = RtmCommandType::notice;
+  command.text = "Please open the worksheet on page 12 and finish the first three exercises.";
+  commands.push_back(command);
+  command.type = RtmCommandType::updateRoomStatus;
+  command.status = "Started";
+  commands.push_back(command);
+  command.type = RtmCommandType::newUserEnter;
+  command.userUUID = "0b9d7e4f-8a21-4f3c-b6d5-2e1f0a9c8b7d";
+  command.userName = "Student 17";
+  command.rtcUID = 2314897;
+  command.avatarURL = "https://flat-storage.example.com/avatars/0b9d7e4f.png";
+  commands.push_back(command);
+  command.type = RtmCommandType::reward;
+  commands.push_back(command);
+  return commands;
+}
+
+/// Notices as the apps send them during a lesson: mostly a sentence or two, sometimes a pasted paragraph.
+std::vector<std::string> noticeJson() {
+  const std::string sentence = "Please open the worksheet on page 12 and finish the first three exercises, "
+                               "then share your answers in the chat — we will review them together. ";
+  std::vector<std::string> payloads;
+  for (int sentences : {1, 2, 4, 8, 16}) {
+    RtmCommand command;
+    command.type = RtmCommandType::notice;
+    command.roomUUID = "5f1c8a3e-2b7d-4c9a-9e0f-61d2b3a4c5e6";
+    std::string text;
+    for (int i = 0; i < sentences; ++i) text += sentence;
+    command.text = text;
+    payloads.emplace_back();
+    RtmCommandCodec::encode(command, Format::json, payloads.back());
+  }
+  return payloads;
+}
+
+/// One JSON payload per line, as dumped from a capture; lines that are not commands are left out.
+std::vector<std::string> capturedJson(const char* path) {
+  std::vector<std::string> payloads;
+  std::ifstream file(path);
+  RtmCommandCodec codec;
+  RtmCommand command;
+  for (std::string line; std::getline(file, line);) {
+    if (codec.decode(line, Format::json, command)) payloads.push_back(line);
+  }
+  return payloads;
+}
+
+double decodeSeconds(RtmCommandCodec& codec, const std::vector<std::string>& payloads, Format format,
+                     int rounds) {
+  RtmCommand command;
+  size_t decoded = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    for (const std::string& payload : payloads) decoded += codec.decode(payload, format, command) ? 1 : 0;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (decoded != payloads.size() * rounds) std::exit(1);
+  return seconds;
+}
+
+}  // namespace
+
+/// Usage: CommandCodecBench [rounds] [capture]
+///
+/// `capture` holds one JSON command per line; without it, the JSON throughput runs over generated notices.
+int main(int argc, char** argv) {
+  const int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  std::vector<RtmCommand> commands = classroomMix();
+  RtmCommandCodec codec;
+  for (Format format : {Format::binary, Format::json}) {
+    std::vector<std::string> payloads;
+    size_t bytes = 0;
+    for (const RtmCommand& command : commands) {
+      payloads.emplace_back();
+      RtmCommandCodec::encode(command, format, payloads.back());
+      bytes += payloads.back().size();
+    }
+    double seconds = decodeSeconds(codec, payloads, format, rounds);
+    double count = static_cast<double>(payloads.size()) * rounds;
+    std::printf("%-6s %5.1f B/command, decode %6.1f ns/command (%.0f commands/s)\n",
+                format == Format::binary ? "binary" : "json", static_cast<double>(bytes) / payloads.size(),
+                seconds * 1e9 / count, count / seconds);
+  }
+
+  std::vector<std::string> payloads = argc > 2 ? capturedJson(argv[2]) : noticeJson();
+  size_t bytes = 0;
+  for (const std::string& payload : payloads) bytes += payload.size();
+  if (bytes == 0) return 1;
+  const int jsonRounds = std::max(1, static_cast<int>(static_cast<double>(rounds) * 2000 / bytes));
+  std::vector<const JsonScanKernels*> kernels = availableJsonScanKernels();
+  for (const JsonScanKernels* kernel : kernels) {
+    RtmCommandCodec scanning(*kernel);
+    double seconds = decodeSeconds(scanning, payloads, Format::json, jsonRounds);
+    std::printf("json %-6s %6.1f B/command, decode %5.2f GB/s\n", kernel->name,
+                static_cast<double>(bytes) / payloads.size(), static_cast<double>(bytes) * jsonRounds / seconds / 1e9);
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+//
+//  EventArenaBench.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventArena.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+
+namespace {
+
+using PresenceEvent = IRtmEventHandler::PresenceEvent;
+
+/// The per-string baseline: what a deferred handler does without an arena.
+struct OwnedSnapshot {
+  struct User {
+    std::string userId;
+    std::vector<std::pair<std::string, std::string>> states;
+  };
+
+  explicit OwnedSnapshot(const PresenceEvent& event) : channelName(event.channelName) {
+    users.reserve(event.snapshot.userCount);
+    for (size_t i = 0; i < event.snapshot.userCount; ++i) {
+      const UserState& state = event.snapshot.userStateList[i];
+      User user{state.userId, {}};
+      for (size_t j = 0; j < state.statesCount; ++j) {
+        user.states.emplace_back(state.states[j].key, state.states[j].value);
+      }
+      users.push_back(std::move(user));
+    }
+  }
+
+  std::string channelName;
+  std::vector<User> users;
+};
+
+template <typename Body>
+double nanosPerIteration(int iterations, Body&& body) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) body();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}  // namespace
+
+/// Usage: EventArenaBench [users] [iterations]
+int main(int argc, char** argv) {
+  const size_t userCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+  std::vector<std::string> userIds;
+  for (size_t i = 0; i < userCount; ++i) userIds.push_back("user-with-a-long-identifier-" + std::to_string(i));
+  std::vector<StateItem> items(userCount);
+  std::vector<UserState> states(userCount);
+  for (size_t i = 0; i < userCount; ++i) {
+    items[i].key = "camera";
+    items[i].value = "on";
+    states[i].userId = userIds[i].c_str();
+    states[i].states = &items[i];
+    states[i].statesCount = 1;
+  }
+  PresenceEvent event;
+  event.type = RTM_PRESENCE_EVENT_TYPE_SNAPSHOT;
+  event.channelName = "lecture";
+  event.snapshot.userStateList = states.data();
+  event.snapshot.userCount = states.size();
+
+  size_t checksum = 0;
+  double owned = nanosPerIteration(iterations, [&] {
+    OwnedSnapshot copy(event);
+    checksum += copy.users.size();
+  });
+
+  RtmEventBlockPool pool;
+  double arena = nanosPerIteration(iterations, [&] {
+    RtmEventArena copyArena(pool);
+    PresenceEvent copy = copyArena.copy(event);
+    checksum += copy.snapshot.userCount;
+  });
+
+  RtmEventBlockPool::Stats stats = pool.stats();
+  std::printf("snapshot users=%zu iterations=%d\n", userCount, iterations);
+  std::printf("per-string copy: %.0f ns/event\n", owned);
+  std::printf("arena copy:      %.0f ns/event (%llu block allocations, %llu reuses)\n", arena,
+              static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.reuses));
+  return checksum == 0 ? 1 : 0;
+}
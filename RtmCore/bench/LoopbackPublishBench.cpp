@@ -0,0 +1,80 @@
+//
+//  LoopbackPublishBench.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "IAgoraRtmClient.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+
+namespace {
+
+class CountingEventHandler : public IRtmEventHandler {
+ public:
+  void onMessageEvent(const MessageEvent& event) override {
+    ++messages;
+    bytes += event.messageLength;
+  }
+
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+};
+
+}  // namespace
+
+/// Usage: LoopbackPublishBench [subscribers] [messages] [payload bytes]
+int main(int argc, char** argv) {
+  const int subscriberCount = argc > 1 ? std::atoi(argv[1]) : 4;
+  const int messageCount = argc > 2 ? std::atoi(argv[2]) : 500000;
+  const size_t payloadSize = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+
+  LoopbackBroker broker;
+  std::vector<CountingEventHandler> handlers(subscriberCount + 1);
+  std::vector<LoopbackRtmClient*> clients;
+  for (int i = 0; i <= subscriberCount; ++i) {
+    std::string userId = "user" + std::to_string(i);
+    RtmConfig config;
+    config.appId = "bench";
+    config.userId = userId.c_str();
+    config.eventHandler = &handlers[i];
+    int errorCode = 0;
+    LoopbackRtmClient* client = createLoopbackRtmClient(broker, config, errorCode);
+    uint64_t requestId = 0;
+    client->login("token", requestId);
+    SubscribeOptions options;
+    options.withPresence = false;
+    client->subscribe("room", options, requestId);
+    client->pump();
+    clients.push_back(client);
+  }
+
+  const std::string payload(payloadSize, 'x');
+  PublishOptions options;
+  uint64_t requestId = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < messageCount; ++i) {
+    clients[0]->publish("room", payload.data(), payload.size(), options, requestId);
+    clients[0]->pump();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  uint64_t delivered = 0;
+  for (const CountingEventHandler& handler : handlers) delivered += handler.messages;
+  std::printf("subscribers=%d publishes=%d payload=%zuB\n", subscriberCount, messageCount, payloadSize);
+  std::printf("publish: %.0f msg/s, deliver: %.0f msg/s (%.1f ns/delivery)\n", messageCount / seconds,
+              delivered / seconds, seconds * 1e9 / static_cast<double>(delivered ? delivered : 1));
+
+  for (LoopbackRtmClient* client : clients) client->release();
+  return delivered == static_cast<uint64_t>(messageCount) * subscriberCount ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+//
+//  MetadataWriteBench.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Storage/ChannelMetadataReplica.h"
+#include "Storage/MetadataWriteCoalescer.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+
+namespace {
+
+class CountingEventHandler : public IRtmEventHandler {
+ public:
+  void onStorageEvent(const StorageEvent&) override { ++events; }
+  void onSetChannelMetadataResult(const uint64_t, const char*, RTM_CHANNEL_TYPE, RTM_ERROR_CODE errorCode) override {
+    ++results;
+    failures += errorCode != RTM_ERROR_OK;
+  }
+
+  uint64_t events = 0;
+  uint64_t results = 0;
+  uint64_t failures = 0;
+};
+
+/// A writer with its replica and coalescer, and `watcherCount` clients watching the room's metadata.
+struct Room {
+  Room(int watcherCount, MetadataWriteCoalescer::Options options) : watchers(watcherCount) {
+    writer = client("writer", mux);
+    replica = std::make_unique<ChannelMetadataReplica>(*writer->getStorage(), "room", RTM_CHANNEL_TYPE_MESSAGE);
+    coalescer = std::make_unique<MetadataWriteCoalescer>(*writer->getStorage(), *replica, options);
+    mux.add(*replica);
+    mux.add(*coalescer);
+    mux.add(writerEvents);
+    subscribe(writer);
+    for (int i = 0; i < watcherCount; ++i) subscribe(client("watcher" + std::to_string(i), watchers[i]));
+    for (LoopbackRtmClient* client : clients) client->pump();
+  }
+
+  ~Room() {
+    for (LoopbackRtmClient* client : clients) client->release();
+  }
+
+  LoopbackRtmClient* client(const std::string& userId, IRtmEventHandler& handler) {
+    RtmConfig config;
+    config.appId = "bench";
+    config.userId = userId.c_str();
+    config.eventHandler = &handler;
+    int errorCode = 0;
+    LoopbackRtmClient* client = createLoopbackRtmClient(broker, config, errorCode);
+    uint64_t requestId = 0;
+    client->login("token", requestId);
+    clients.push_back(client);
+    return client;
+  }
+
+  static void subscribe(LoopbackRtmClient* client) {
+    SubscribeOptions options;
+    options.withMetadata = true;
+    options.withPresence = false;
+    uint64_t requestId = 0;
+    client->subscribe("room", options, requestId);
+  }
+
+  uint64_t watcherEvents() const {
+    uint64_t events = 0;
+    for (const CountingEventHandler& watcher : watchers) events += watcher.events;
+    return events;
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  CountingEventHandler writerEvents;
+  std::vector<CountingEventHandler> watchers;
+  std::vector<LoopbackRtmClient*> clients;
+  LoopbackRtmClient* writer = nullptr;
+  std::unique_ptr<ChannelMetadataReplica> replica;
+  std::unique_ptr<MetadataWriteCoalescer> coalescer;
+};
+
+void report(const char* name, int writeCount, double seconds, uint64_t calls, uint64_t events, double rttMs) {
+  std::printf("%-10s %9.0f writes/s  %7llu calls  %8llu watcher events  %8.1f s of round trips at %.0f ms\n", name,
+              writeCount / seconds, static_cast<unsigned long long>(calls), static_cast<unsigned long long>(events),
+              calls * rttMs / 1000, rttMs);
+}
+
+}  // namespace
+
+/// Usage: MetadataWriteBench [writes] [keys] [watchers] [write interval us] [window ms] [rtt ms]
+///
+/// Writes arrive every `write interval` of simulated time, spread over `keys` keys. The baseline issues one
+/// revision-checked `setChannelMetadata` per write; the coalescer merges them per window. Each result is
+/// delivered right after its call, so the round-trip column shows what each approach costs against a real
+/// service, where every call of one writer waits for the previous result to learn the next revision.
+int main(int argc, char** argv) {
+  const int writeCount = argc > 1 ? std::atoi(argv[1]) : 200000;
+  const int keyCount = argc > 2 ? std::atoi(argv[2]) : 32;
+  const int watcherCount = argc > 3 ? std::atoi(argv[3]) : 8;
+  const auto interval = std::chrono::microseconds(argc > 4 ? std::atoi(argv[4]) : 500);
+  const auto window = std::chrono::milliseconds(argc > 5 ? std::atoi(argv[5]) : 20);
+  const double rttMs = argc > 6 ? std::atof(argv[6]) : 80;
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < keyCount; ++i) keys.push_back("device/user" + std::to_string(i));
+  std::vector<std::string> values;
+  for (int i = 0; i < 64; ++i) values.push_back("{\"camera\":" + std::to_string(i % 2) + ",\"mic\":1}");
+
+  MetadataWriteCoalescer::Options options;
+  options.window = window;
+  std::printf("writes=%d keys=%d watchers=%d interval=%lldus window=%lldms\n", writeCount, keyCount, watcherCount,
+              static_cast<long long>(interval.count()), static_cast<long long>(window.count()));
+
+  int failures = 0;
+  {
+    Room room(watcherCount, options);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < writeCount; ++i) {
+      const std::string& key = keys[i % keyCount];
+      MetadataItem item(key.c_str(), values[i % values.size()].c_str(), room.replica->revision(key));
+      Metadata data;
+      data.items = &item;
+      data.itemCount = 1;
+      uint64_t requestId = 0;
+      room.writer->setChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, MetadataOptions(), nullptr, requestId);
+      room.writer->pump();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("per-write", writeCount, seconds, room.writerEvents.results, room.watcherEvents(), rttMs);
+    failures += static_cast<int>(room.writerEvents.failures);
+  }
+  {
+    Room room(watcherCount, options);
+    RtmClock::time_point now = RtmClock::now();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < writeCount; ++i) {
+      now += interval;
+      room.coalescer->set(keys[i % keyCount], values[i % values.size()], now);
+      room.writer->pump();
+    }
+    room.coalescer->flush();
+    room.writer->pump();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    MetadataWriteCoalescer::Stats stats = room.coalescer->stats();
+    report("coalesced", writeCount, seconds, stats.flushes + stats.conflicts, room.watcherEvents(), rttMs);
+    failures += static_cast<int>(stats.failed);
+  }
+  return failures == 0 ? 0 : 1;
+}
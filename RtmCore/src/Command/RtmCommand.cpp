@@ -0,0 +1,47 @@
+//
+//  RtmCommand.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Command/RtmCommand.h"
+
+#include "Common/PerfectHash.h"
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+/// The app's `RtmCommandType` raw values, indexed by `RtmCommandType`.
+constexpr std::string_view kTypeNames[kRtmCommandTypeCount] = {
+    "undefined",
+    "raise-hand",
+    "ban",
+    "notice",
+    "update-room-status",
+    "request-device",
+    "request-device-response",
+    "notify-device-off",
+    "reward",
+    "enter",
+    "room-expire",
+};
+
+constexpr PerfectHashIndex kTypeIndex(kTypeNames);
+
+}  // namespace
+
+std::string_view rtmCommandTypeName(RtmCommandType type) {
+  size_t index = static_cast<size_t>(type);
+  return index < kRtmCommandTypeCount ? kTypeNames[index] : kTypeNames[0];
+}
+
+RtmCommandType rtmCommandTypeNamed(std::string_view name) {
+  size_t index = kTypeIndex.find(name);
+  return index < kRtmCommandTypeCount ? static_cast<RtmCommandType>(index) : RtmCommandType::undefined;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,65 @@
+//
+//  RtmCommand.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace flat {
+namespace rtm {
+
+/// The classroom commands of the app's `RtmCommand` enum, in wire order; the values are part of the binary format.
+enum class RtmCommandType : uint8_t {
+  undefined = 0,
+  raiseHand,
+  ban,
+  notice,
+  updateRoomStatus,
+  requestDevice,
+  requestDeviceResponse,
+  notifyDeviceOff,
+  reward,
+  newUserEnter,
+  roomExpire,
+};
+
+constexpr size_t kRtmCommandTypeCount = static_cast<size_t>(RtmCommandType::roomExpire) + 1;
+
+enum class RtmDeviceType : uint8_t { camera = 0, mic };
+
+/// One decoded command. Only the fields of its type are set; the views point into the message or into the
+/// decoder that produced it, and stay valid until either changes.
+struct RtmCommand {
+  RtmCommandType type = RtmCommandType::undefined;
+  std::string_view roomUUID;
+  /// `raiseHand`'s raiseHand, `ban`'s status and `requestDeviceResponse`'s answer.
+  bool on = false;
+  /// `notice`'s text, and the reason of an `undefined` command.
+  std::string_view text;
+  /// `updateRoomStatus`'s status: Idle, Started, Paused or Stopped.
+  std::string_view status;
+  RtmDeviceType device = RtmDeviceType::camera;
+  /// `reward`'s and `newUserEnter`'s user.
+  std::string_view userUUID;
+  /// `newUserEnter`'s user info.
+  std::string_view userName;
+  uint64_t rtcUID = 0;
+  std::string_view avatarURL;
+  /// `roomExpire`'s expire info; `expireAt` in milliseconds since 1970.
+  int64_t roomLevel = 0;
+  int64_t expireAt = 0;
+};
+
+/// The command's `t` in the JSON format, e.g. "raise-hand".
+std::string_view rtmCommandTypeName(RtmCommandType type);
+/// `RtmCommandType::undefined` for an unknown name.
+RtmCommandType rtmCommandTypeNamed(std::string_view name);
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,673 @@
+//
+//  RtmCommandCodec.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Command/RtmCommandCodec.h"
+
+#include <charconv>
+#include <cmath>
+
+#include "Common/StringMap.h"
+#include "Common/Varint.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+/// Field numbers of the binary format. Never renumber; retire numbers instead.
+enum Field : uint32_t {
+  kRoomUUID = 1,
+  kOn = 2,
+  kText = 3,
+  kStatus = 4,
+  kDevice = 5,
+  kUserUUID = 6,
+  kUserName = 7,
+  kRtcUID = 8,
+  kAvatarURL = 9,
+  kRoomLevel = 10,
+  kExpireAt = 11,
+};
+
+constexpr uint32_t kVarintWire = 0;
+constexpr uint32_t kLengthWire = 2;
+
+constexpr uint32_t bit(Field field) { return 1u << field; }
+
+/// The fields each command type carries, indexed by `RtmCommandType`; a command missing one is not decoded.
+constexpr uint32_t kFieldsOf[kRtmCommandTypeCount] = {
+    bit(kText),
+    bit(kRoomUUID) | bit(kOn),
+    bit(kRoomUUID) | bit(kOn),
+    bit(kRoomUUID) | bit(kText),
+    bit(kRoomUUID) | bit(kStatus),
+    bit(kRoomUUID) | bit(kDevice),
+    bit(kRoomUUID) | bit(kDevice) | bit(kOn),
+    bit(kRoomUUID) | bit(kDevice),
+    bit(kRoomUUID) | bit(kUserUUID),
+    bit(kRoomUUID) | bit(kUserUUID) | bit(kUserName) | bit(kRtcUID) | bit(kAvatarURL),
+    bit(kRoomUUID) | bit(kRoomLevel) | bit(kExpireAt),
+};
+
+constexpr uint32_t fieldsOf(RtmCommandType type) { return kFieldsOf[static_cast<size_t>(type)]; }
+
+/// Resets the fields the command's type does not carry, such as the `true` of a JSON device request.
+void keepOnlyFieldsOfType(RtmCommand& command) {
+  RtmCommand kept;
+  kept.type = command.type;
+  uint32_t fields = fieldsOf(command.type);
+  if (fields & bit(kRoomUUID)) kept.roomUUID = command.roomUUID;
+  if (fields & bit(kOn)) kept.on = command.on;
+  if (fields & bit(kText)) kept.text = command.text;
+  if (fields & bit(kStatus)) kept.status = command.status;
+  if (fields & bit(kDevice)) kept.device = command.device;
+  if (fields & bit(kUserUUID)) kept.userUUID = command.userUUID;
+  if (fields & bit(kUserName)) kept.userName = command.userName;
+  if (fields & bit(kRtcUID)) kept.rtcUID = command.rtcUID;
+  if (fields & bit(kAvatarURL)) kept.avatarURL = command.avatarURL;
+  if (fields & bit(kRoomLevel)) kept.roomLevel = command.roomLevel;
+  if (fields & bit(kExpireAt)) kept.expireAt = command.expireAt;
+  command = kept;
+}
+
+// MARK: - Binary
+
+void appendVarintField(std::string& out, Field field, uint64_t value) {
+  appendVarint(out, field << 3 | kVarintWire);
+  appendVarint(out, value);
+}
+
+void appendBytesField(std::string& out, Field field, std::string_view value) {
+  appendVarint(out, field << 3 | kLengthWire);
+  appendVarint(out, value.size());
+  out.append(value);
+}
+
+/// Sets the command's field from a varint, or from bytes. False when the field is unknown or of another wire type.
+bool setVarintField(RtmCommand& command, uint32_t field, uint64_t value) {
+  switch (field) {
+    case kOn:
+      command.on = value != 0;
+      return true;
+    case kDevice:
+      command.device = value == 0 ? RtmDeviceType::camera : RtmDeviceType::mic;
+      return true;
+    case kRtcUID:
+      command.rtcUID = value;
+      return true;
+    case kRoomLevel:
+      command.roomLevel = static_cast<int64_t>(value);
+      return true;
+    case kExpireAt:
+      command.expireAt = static_cast<int64_t>(value);
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool setBytesField(RtmCommand& command, uint32_t field, std::string_view value) {
+  switch (field) {
+    case kRoomUUID:
+      command.roomUUID = value;
+      return true;
+    case kText:
+      command.text = value;
+      return true;
+    case kStatus:
+      command.status = value;
+      return true;
+    case kUserUUID:
+      command.userUUID = value;
+      return true;
+    case kUserName:
+      command.userName = value;
+      return true;
+    case kAvatarURL:
+      command.avatarURL = value;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// MARK: - JSON
+
+void appendJsonString(std::string& out, std::string_view value) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out.push_back('"');
+  for (char c : value) {
+    auto byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (byte < 0x20) {
+      out.append("\\u00");
+      out.push_back(kHex[byte >> 4]);
+      out.push_back(kHex[byte & 0xF]);
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+}
+
+void appendJsonKey(std::string& out, std::string_view key) {
+  if (out.back() != '{') out.push_back(',');
+  appendJsonString(out, key);
+  out.push_back(':');
+}
+
+void appendJsonInteger(std::string& out, int64_t value) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, result.ptr);
+}
+
+void appendJsonUnsigned(std::string& out, uint64_t value) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, result.ptr);
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    out.push_back(static_cast<char>(codePoint));
+  } else if (codePoint < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | codePoint >> 6));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | codePoint >> 12));
+    out.push_back(static_cast<char>(0x80 | (codePoint >> 6 & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | codePoint >> 18));
+    out.push_back(static_cast<char>(0x80 | (codePoint >> 12 & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codePoint >> 6 & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+/// On-demand JSON reader for command envelopes: it walks the input once, hands each member to the caller and
+/// builds no tree. String contents and skipped values are stepped over with the vectorized `JsonScanKernels`.
+/// Strings without escapes are views into the input; the others are unescaped into `scratch`, whose capacity must
+/// already cover the input so the views never move.
+class JsonReader {
+ public:
+  JsonReader(std::string_view input, std::string& scratch, const JsonScanKernels& kernels)
+      : cursor_(input.data()), end_(input.data() + input.size()), scratch_(scratch), kernels_(kernels) {}
+
+  /// Calls `onMember(key)` with the reader at each member's value; `onMember` reads or skips it.
+  template <typename OnMember>
+  bool object(OnMember&& onMember) {
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+      std::string_view key;
+      if (!string(key) || !consume(':') || !onMember(key)) return false;
+    } while (consume(','));
+    return consume('}');
+  }
+
+  bool string(std::string_view& value) {
+    if (!consume('"')) return false;
+    const char* begin = cursor_;
+    cursor_ = kernels_.stringStop(cursor_, end_);
+    if (cursor_ == end_) return false;
+    if (*cursor_ == '"') {
+      value = std::string_view(begin, cursor_ - begin);
+      ++cursor_;
+      return true;
+    }
+    size_t start = scratch_.size();
+    for (;;) {
+      scratch_.append(begin, cursor_);
+      if (cursor_ == end_ || *cursor_ != '\\') break;
+      ++cursor_;
+      if (!escape()) return false;
+      begin = cursor_;
+      cursor_ = kernels_.stringStop(cursor_, end_);
+    }
+    if (cursor_ == end_ || *cursor_ != '"') return false;
+    ++cursor_;
+    value = std::string_view(scratch_.data() + start, scratch_.size() - start);
+    return true;
+  }
+
+  bool boolean(bool& value) {
+    skipSpace();
+    if (literal("true")) {
+      value = true;
+      return true;
+    }
+    value = false;
+    return literal("false");
+  }
+
+  bool number(double& value) {
+    skipSpace();
+    auto result = std::from_chars(cursor_, end_, value);
+    if (result.ec != std::errc() || !std::isfinite(value)) return false;
+    cursor_ = result.ptr;
+    return true;
+  }
+
+  bool integer(int64_t& value) {
+    skipSpace();
+    // Plain integers, which is what the apps send, skip the floating-point parse.
+    auto result = std::from_chars(cursor_, end_, value);
+    if (result.ec == std::errc() && (result.ptr == end_ || !isNumberTail(*result.ptr))) {
+      cursor_ = result.ptr;
+      return true;
+    }
+    double number = 0;
+    if (!this->number(number) || std::fabs(number) > 9.007199254740992e15) return false;
+    value = static_cast<int64_t>(std::llround(number));
+    return true;
+  }
+
+  /// Strings are checked for their end only, containers for balanced nesting only: on demand, a value nobody
+  /// reads is not validated.
+  bool skipValue() {
+    switch (peek()) {
+      case '"':
+        return skipString();
+      case '{':
+      case '[':
+        return skipContainer();
+      case 't':
+      case 'f': {
+        bool ignored;
+        return boolean(ignored);
+      }
+      case 'n':
+        return literal("null");
+      default: {
+        double ignored;
+        return number(ignored);
+      }
+    }
+  }
+
+  char peek() {
+    skipSpace();
+    return cursor_ < end_ ? *cursor_ : '\0';
+  }
+
+  bool atEnd() {
+    skipSpace();
+    return cursor_ == end_;
+  }
+
+ private:
+  static constexpr int kMaxDepth = 32;
+
+  static bool isNumberTail(char c) { return c == '.' || c == 'e' || c == 'E'; }
+
+  bool skipString() {
+    ++cursor_;
+    for (;;) {
+      cursor_ = kernels_.stringStop(cursor_, end_);
+      if (end_ - cursor_ < 2 || *cursor_ != '\\') break;
+      cursor_ += 2;
+    }
+    if (cursor_ == end_ || *cursor_ != '"') return false;
+    ++cursor_;
+    return true;
+  }
+
+  bool skipContainer() {
+    int depth = 0;
+    for (;;) {
+      cursor_ = kernels_.structural(cursor_, end_);
+      if (cursor_ == end_) return false;
+      char c = *cursor_;
+      if (c == '"') {
+        if (!skipString()) return false;
+        continue;
+      }
+      ++cursor_;
+      if (c == '{' || c == '[') {
+        if (++depth > kMaxDepth) return false;
+      } else if (--depth == 0) {
+        return true;
+      }
+    }
+  }
+
+  void skipSpace() {
+    while (cursor_ < end_ && (*cursor_ == ' ' || *cursor_ == '\n' || *cursor_ == '\r' || *cursor_ == '\t')) {
+      ++cursor_;
+    }
+  }
+
+  bool consume(char c) {
+    if (peek() != c) return false;
+    ++cursor_;
+    return true;
+  }
+
+  bool literal(std::string_view word) {
+    if (static_cast<size_t>(end_ - cursor_) < word.size() || std::string_view(cursor_, word.size()) != word) {
+      return false;
+    }
+    cursor_ += word.size();
+    return true;
+  }
+
+  bool hex4(uint32_t& value) {
+    if (end_ - cursor_ < 4) return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = *cursor_++;
+      uint32_t digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        return false;
+      }
+      value = value << 4 | digit;
+    }
+    return true;
+  }
+
+  /// Unescapes the sequence after a backslash into the scratch buffer.
+  bool escape() {
+    if (cursor_ == end_) return false;
+    char c = *cursor_++;
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        scratch_.push_back(c);
+        return true;
+      case 'b':
+        scratch_.push_back('\b');
+        return true;
+      case 'f':
+        scratch_.push_back('\f');
+        return true;
+      case 'n':
+        scratch_.push_back('\n');
+        return true;
+      case 'r':
+        scratch_.push_back('\r');
+        return true;
+      case 't':
+        scratch_.push_back('\t');
+        return true;
+      case 'u':
+        break;
+      default:
+        return false;
+    }
+    uint32_t codePoint = 0;
+    if (!hex4(codePoint)) return false;
+    if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+      uint32_t low = 0;
+      if (!literal("\\u") || !hex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+    } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+      return false;
+    }
+    appendUtf8(scratch_, codePoint);
+    return true;
+  }
+
+  const char* cursor_;
+  const char* end_;
+  std::string& scratch_;
+  const JsonScanKernels& kernels_;
+};
+
+/// Reads a member of the envelope's `v` into the command; the keys are those of the app's `CommandEncoder`.
+bool readValueMember(JsonReader& reader, std::string_view key, RtmCommand& command, uint32_t& fields) {
+  auto text = [&](std::string_view& value, Field field) {
+    fields |= bit(field);
+    return reader.string(value);
+  };
+  auto flag = [&](Field field) {
+    fields |= bit(field);
+    return reader.boolean(command.on);
+  };
+  if (key == "roomUUID") return text(command.roomUUID, kRoomUUID);
+  if (key == "raiseHand") return flag(kOn);
+  // `ban` sends its status as a bool, `update-room-status` as a string.
+  if (key == "status") return reader.peek() == '"' ? text(command.status, kStatus) : flag(kOn);
+  if (key == "text" || key == "reason") return text(command.text, kText);
+  if (key == "userUUID") return text(command.userUUID, kUserUUID);
+  if (key == "camera" || key == "mic") {
+    command.device = key == "camera" ? RtmDeviceType::camera : RtmDeviceType::mic;
+    fields |= bit(kDevice);
+    return reader.peek() == 't' || reader.peek() == 'f' ? flag(kOn) : reader.skipValue();
+  }
+  if (key == "userInfo") {
+    return reader.object([&](std::string_view member) {
+      if (member == "name") return text(command.userName, kUserName);
+      if (member == "avatarURL") return text(command.avatarURL, kAvatarURL);
+      if (member != "rtcUID") return reader.skipValue();
+      int64_t rtcUID = 0;
+      fields |= bit(kRtcUID);
+      if (!reader.integer(rtcUID) || rtcUID < 0) return false;
+      command.rtcUID = static_cast<uint64_t>(rtcUID);
+      return true;
+    });
+  }
+  if (key == "expireInfo") {
+    return reader.object([&](std::string_view member) {
+      if (member == "roomLevel") {
+        fields |= bit(kRoomLevel);
+        return reader.integer(command.roomLevel);
+      }
+      if (member == "expireAt") {
+        fields |= bit(kExpireAt);
+        return reader.integer(command.expireAt);
+      }
+      return reader.skipValue();
+    });
+  }
+  return reader.skipValue();
+}
+
+}  // namespace
+
+RtmCommandCodec::RtmCommandCodec() : RtmCommandCodec(jsonScanKernels()) {}
+
+RtmCommandCodec::RtmCommandCodec(const JsonScanKernels& kernels) : kernels_(kernels) {}
+
+void RtmCommandCodec::encode(const RtmCommand& command, Format format, std::string& out) {
+  if (format == Format::binary) {
+    encodeBinary(command, out);
+  } else {
+    encodeJson(command, out);
+  }
+}
+
+const char* RtmCommandCodec::customTypeOf(Format format) { return format == Format::binary ? kCustomType : nullptr; }
+
+RTM_MESSAGE_TYPE RtmCommandCodec::messageTypeOf(Format format) {
+  return format == Format::binary ? RTM_MESSAGE_TYPE_BINARY : RTM_MESSAGE_TYPE_STRING;
+}
+
+bool RtmCommandCodec::decode(const IRtmEventHandler::MessageEvent& event, RtmCommand& command) {
+  Format format = viewOf(event.customType) == kCustomType ? Format::binary : Format::json;
+  return decode(std::string_view(event.message, event.message ? event.messageLength : 0), format, command);
+}
+
+bool RtmCommandCodec::decode(std::string_view payload, Format format, RtmCommand& command) {
+  command = RtmCommand();
+  uint32_t fields = 0;
+  const char* error =
+      format == Format::binary ? decodeBinary(payload, command, fields) : decodeJson(payload, command, fields);
+  if (!error && (fields & fieldsOf(command.type)) != fieldsOf(command.type)) error = "decode command field error";
+  if (!error) {
+    keepOnlyFieldsOfType(command);
+    return true;
+  }
+  command = RtmCommand();
+  command.text = error;
+  return false;
+}
+
+// MARK: - Private
+
+void RtmCommandCodec::encodeBinary(const RtmCommand& command, std::string& out) {
+  uint32_t fields = fieldsOf(command.type);
+  appendVarint(out, static_cast<uint64_t>(command.type));
+  if (fields & bit(kRoomUUID)) appendBytesField(out, kRoomUUID, command.roomUUID);
+  if (fields & bit(kOn)) appendVarintField(out, kOn, command.on ? 1 : 0);
+  if (fields & bit(kText)) appendBytesField(out, kText, command.text);
+  if (fields & bit(kStatus)) appendBytesField(out, kStatus, command.status);
+  if (fields & bit(kDevice)) appendVarintField(out, kDevice, static_cast<uint64_t>(command.device));
+  if (fields & bit(kUserUUID)) appendBytesField(out, kUserUUID, command.userUUID);
+  if (fields & bit(kUserName)) appendBytesField(out, kUserName, command.userName);
+  if (fields & bit(kRtcUID)) appendVarintField(out, kRtcUID, command.rtcUID);
+  if (fields & bit(kAvatarURL)) appendBytesField(out, kAvatarURL, command.avatarURL);
+  if (fields & bit(kRoomLevel)) appendVarintField(out, kRoomLevel, static_cast<uint64_t>(command.roomLevel));
+  if (fields & bit(kExpireAt)) appendVarintField(out, kExpireAt, static_cast<uint64_t>(command.expireAt));
+}
+
+void RtmCommandCodec::encodeJson(const RtmCommand& command, std::string& out) {
+  out.append("{\"t\":");
+  appendJsonString(out, rtmCommandTypeName(command.type));
+  out.append(",\"v\":{");
+  if (command.type != RtmCommandType::undefined) {
+    appendJsonKey(out, "roomUUID");
+    appendJsonString(out, command.roomUUID);
+  }
+  auto device = [&](bool on) {
+    appendJsonKey(out, command.device == RtmDeviceType::camera ? "camera" : "mic");
+    out.append(on ? "true" : "false");
+  };
+  switch (command.type) {
+    case RtmCommandType::undefined:
+      appendJsonKey(out, "reason");
+      appendJsonString(out, command.text);
+      break;
+    case RtmCommandType::raiseHand:
+      appendJsonKey(out, "raiseHand");
+      out.append(command.on ? "true" : "false");
+      break;
+    case RtmCommandType::ban:
+      appendJsonKey(out, "status");
+      out.append(command.on ? "true" : "false");
+      break;
+    case RtmCommandType::notice:
+      appendJsonKey(out, "text");
+      appendJsonString(out, command.text);
+      break;
+    case RtmCommandType::updateRoomStatus:
+      appendJsonKey(out, "status");
+      appendJsonString(out, command.status);
+      break;
+    case RtmCommandType::requestDevice:
+      device(true);
+      break;
+    case RtmCommandType::requestDeviceResponse:
+      device(command.on);
+      break;
+    case RtmCommandType::notifyDeviceOff:
+      device(false);
+      break;
+    case RtmCommandType::reward:
+      appendJsonKey(out, "userUUID");
+      appendJsonString(out, command.userUUID);
+      break;
+    case RtmCommandType::newUserEnter:
+      appendJsonKey(out, "userUUID");
+      appendJsonString(out, command.userUUID);
+      appendJsonKey(out, "userInfo");
+      out.push_back('{');
+      appendJsonKey(out, "name");
+      appendJsonString(out, command.userName);
+      appendJsonKey(out, "rtcUID");
+      appendJsonUnsigned(out, command.rtcUID);
+      appendJsonKey(out, "avatarURL");
+      appendJsonString(out, command.avatarURL);
+      out.push_back('}');
+      break;
+    case RtmCommandType::roomExpire:
+      appendJsonKey(out, "expireInfo");
+      out.push_back('{');
+      appendJsonKey(out, "roomLevel");
+      appendJsonInteger(out, command.roomLevel);
+      appendJsonKey(out, "expireAt");
+      appendJsonInteger(out, command.expireAt);
+      out.push_back('}');
+      break;
+  }
+  out.append("}}");
+}
+
+const char* RtmCommandCodec::decodeBinary(std::string_view payload, RtmCommand& command, uint32_t& fields) {
+  const char* cursor = payload.data();
+  const char* end = payload.data() + payload.size();
+  uint64_t type = 0;
+  if (!readVarint(cursor, end, type)) return "decode command error";
+  if (type >= kRtmCommandTypeCount) return "decode command title error";
+  command.type = static_cast<RtmCommandType>(type);
+  while (cursor < end) {
+    uint64_t key = 0;
+    uint64_t value = 0;
+    if (!readVarint(cursor, end, key) || !readVarint(cursor, end, value)) return "decode command error";
+    uint64_t field = key >> 3;
+    bool known;
+    switch (key & 7) {
+      case kVarintWire:
+        known = field < 32 && setVarintField(command, static_cast<uint32_t>(field), value);
+        break;
+      case kLengthWire:
+        if (value > static_cast<uint64_t>(end - cursor)) return "decode command error";
+        known = field < 32 && setBytesField(command, static_cast<uint32_t>(field), std::string_view(cursor, value));
+        cursor += value;
+        break;
+      default:
+        return "decode command error";
+    }
+    if (known) fields |= 1u << field;
+  }
+  return nullptr;
+}
+
+const char* RtmCommandCodec::decodeJson(std::string_view payload, RtmCommand& command, uint32_t& fields) {
+  // Unescaped strings are never longer than their JSON, so the buffer does not move while views point into it.
+  scratch_.clear();
+  scratch_.reserve(payload.size());
+  JsonReader reader(payload, scratch_, kernels_);
+  std::string_view title;
+  bool hasTitle = false;
+  bool hasValue = false;
+  bool parsed = reader.object([&](std::string_view key) {
+    if (key == "t") {
+      hasTitle = true;
+      return reader.string(title);
+    }
+    if (key == "v") {
+      hasValue = true;
+      return reader.object(
+          [&](std::string_view member) { return readValueMember(reader, member, command, fields); });
+    }
+    return reader.skipValue();
+  });
+  if (!parsed || !reader.atEnd()) return "decode command error";
+  if (!hasTitle) return "decode command title error";
+  if (!hasValue) return "decode command info error";
+  command.type = rtmCommandTypeNamed(title);
+  if (command.type == RtmCommandType::undefined && title != rtmCommandTypeName(RtmCommandType::undefined)) {
+    return "decode command title error";
+  }
+  return nullptr;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,68 @@
+//
+//  RtmCommandCodec.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Command/RtmCommand.h"
+#include "Common/JsonScan.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Encodes and decodes `RtmCommand`s in a compact binary format, keeping the app's JSON format for web clients.
+///
+/// A binary command is published as a binary message with customType `kCustomType`, which carries the format
+/// version. Its payload is the command type as a varint, then one field per set value:
+/// `[varint fieldNumber << 3 | wireType][value]`, where wire type 0 is a varint and 2 a varint length followed by
+/// the bytes. Decoders skip fields they do not know, so fields can be added without a new version.
+///
+/// A message with any other customType is read as the JSON `{"t": "raise-hand", "v": {"roomUUID": ...}}` the app
+/// and the web client send, in any key order. The reader is on demand: it builds no tree, keeps only the members a
+/// command uses and steps over strings and other members with the vectorized scans of `JsonScanKernels`.
+///
+/// Decoding does not allocate: strings are views into the message. A JSON string with escapes is unescaped into
+/// the decoder's buffer, which only grows when a message is larger than any before it, so views into it last until
+/// the next decode. A command that cannot be decoded comes back as `undefined` with the reason in `text`, as the
+/// app's `CommandDecoder` does.
+class RtmCommandCodec {
+ public:
+  static constexpr const char* kCustomType = "flat.cmd.1";
+
+  enum class Format { binary, json };
+
+  RtmCommandCodec();
+  /// Scans JSON with `kernels` instead of the fastest ones of this CPU.
+  explicit RtmCommandCodec(const JsonScanKernels& kernels);
+
+  /// Appends the command to `out`. Publish it with `customTypeOf(format)` and `messageTypeOf(format)`.
+  static void encode(const RtmCommand& command, Format format, std::string& out);
+  /// `kCustomType` for binary, null for JSON.
+  static const char* customTypeOf(Format format);
+  static agora::rtm::RTM_MESSAGE_TYPE messageTypeOf(Format format);
+
+  /// Picks the format from the event's customType. False when the message is not a valid command.
+  bool decode(const agora::rtm::IRtmEventHandler::MessageEvent& event, RtmCommand& command);
+  bool decode(std::string_view payload, Format format, RtmCommand& command);
+
+ private:
+  static void encodeBinary(const RtmCommand& command, std::string& out);
+  static void encodeJson(const RtmCommand& command, std::string& out);
+  /// Both return why the payload is not a command, or null; `fields` collects the field numbers set.
+  static const char* decodeBinary(std::string_view payload, RtmCommand& command, uint32_t& fields);
+  const char* decodeJson(std::string_view payload, RtmCommand& command, uint32_t& fields);
+
+  const JsonScanKernels& kernels_;
+  std::string scratch_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,175 @@
+//
+//  JsonScan.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Common/JsonScan.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define RTM_JSON_SCAN_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define RTM_JSON_SCAN_NEON 1
+#endif
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+inline bool isStringStop(char c) { return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20; }
+
+inline bool isStructural(char c) { return c == '"' || (c | 0x20) == '{' || (c | 0x20) == '}'; }
+
+const char* stringStopScalar(const char* begin, const char* end) {
+  while (begin < end && !isStringStop(*begin)) ++begin;
+  return begin;
+}
+
+const char* structuralScalar(const char* begin, const char* end) {
+  while (begin < end && !isStructural(*begin)) ++begin;
+  return begin;
+}
+
+constexpr JsonScanKernels kScalar{"scalar", stringStopScalar, structuralScalar};
+
+#if RTM_JSON_SCAN_X86
+
+// '[' and ']' differ from '{' and '}' only in bit 5, so one OR folds both brackets onto the braces.
+
+const char* stringStopSse2(const char* begin, const char* end) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i lastControl = _mm_set1_epi8(0x1F);
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk);
+    __m128i stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), control);
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(stop));
+    if (mask != 0) return begin + __builtin_ctz(mask);
+  }
+  return stringStopScalar(begin, end);
+}
+
+const char* structuralSse2(const char* begin, const char* end) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i bit5 = _mm_set1_epi8(0x20);
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i folded = _mm_or_si128(chunk, bit5);
+    __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                 _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+    if (mask != 0) return begin + __builtin_ctz(mask);
+  }
+  return structuralScalar(begin, end);
+}
+
+__attribute__((target("avx2"))) const char* stringStopAvx2(const char* begin, const char* end) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i lastControl = _mm256_set1_epi8(0x1F);
+  for (; end - begin >= 32; begin += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, lastControl), chunk);
+    __m256i stop =
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), control);
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+    if (mask != 0) return begin + __builtin_ctz(mask);
+  }
+  return stringStopSse2(begin, end);
+}
+
+__attribute__((target("avx2"))) const char* structuralAvx2(const char* begin, const char* end) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i bit5 = _mm256_set1_epi8(0x20);
+  const __m256i open = _mm256_set1_epi8('{');
+  const __m256i close = _mm256_set1_epi8('}');
+  for (; end - begin >= 32; begin += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i folded = _mm256_or_si256(chunk, bit5);
+    __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_or_si256(_mm256_cmpeq_epi8(folded, open),
+                                                                                     _mm256_cmpeq_epi8(folded, close)));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+    if (mask != 0) return begin + __builtin_ctz(mask);
+  }
+  return structuralSse2(begin, end);
+}
+
+constexpr JsonScanKernels kSse2{"sse2", stringStopSse2, structuralSse2};
+constexpr JsonScanKernels kAvx2{"avx2", stringStopAvx2, structuralAvx2};
+
+bool hasAvx2() { return __builtin_cpu_supports("avx2"); }
+
+#elif RTM_JSON_SCAN_NEON
+
+/// Narrows a byte mask of 0x00/0xFF lanes to four bits per lane, so the first set lane is a count of zeros away.
+inline uint64_t nibbleMask(uint8x16_t lanes) {
+  return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4)), 0);
+}
+
+const char* stringStopNeon(const char* begin, const char* end) {
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(0x20);
+  for (; end - begin >= 16; begin += 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+    uint8x16_t stop = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)), vcltq_u8(chunk, space));
+    uint64_t mask = nibbleMask(stop);
+    if (mask != 0) return begin + (__builtin_ctzll(mask) >> 2);
+  }
+  return stringStopScalar(begin, end);
+}
+
+const char* structuralNeon(const char* begin, const char* end) {
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t bit5 = vdupq_n_u8(0x20);
+  const uint8x16_t open = vdupq_n_u8('{');
+  const uint8x16_t close = vdupq_n_u8('}');
+  for (; end - begin >= 16; begin += 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+    uint8x16_t folded = vorrq_u8(chunk, bit5);
+    uint8x16_t found = vorrq_u8(vceqq_u8(chunk, quote), vorrq_u8(vceqq_u8(folded, open), vceqq_u8(folded, close)));
+    uint64_t mask = nibbleMask(found);
+    if (mask != 0) return begin + (__builtin_ctzll(mask) >> 2);
+  }
+  return structuralScalar(begin, end);
+}
+
+constexpr JsonScanKernels kNeon{"neon", stringStopNeon, structuralNeon};
+
+#endif
+
+}  // namespace
+
+const JsonScanKernels& jsonScanKernels() {
+#if RTM_JSON_SCAN_X86
+  static const JsonScanKernels& best = hasAvx2() ? kAvx2 : kSse2;
+  return best;
+#elif RTM_JSON_SCAN_NEON
+  return kNeon;
+#else
+  return kScalar;
+#endif
+}
+
+std::vector<const JsonScanKernels*> availableJsonScanKernels() {
+  std::vector<const JsonScanKernels*> kernels{&kScalar};
+#if RTM_JSON_SCAN_X86
+  kernels.push_back(&kSse2);
+  if (hasAvx2()) kernels.push_back(&kAvx2);
+#elif RTM_JSON_SCAN_NEON
+  kernels.push_back(&kNeon);
+#endif
+  return kernels;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,34 @@
+//
+//  JsonScan.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+namespace flat {
+namespace rtm {
+
+/// Vectorized searches for the bytes a JSON reader stops at, so it can step over string contents and skipped
+/// values a register at a time instead of a byte at a time.
+///
+/// `jsonScanKernels()` picks the widest set the CPU runs: AVX2 where the CPU reports it, SSE2 on any other x86-64,
+/// NEON on arm64, bytewise otherwise. Every set finds the same bytes.
+struct JsonScanKernels {
+  const char* name;
+  /// The first `"`, `\` or control character in `[begin, end)`, or `end`: where a string's plain run stops.
+  const char* (*stringStop)(const char* begin, const char* end);
+  /// The first `"`, `{`, `}`, `[` or `]` in `[begin, end)`, or `end`: what a skipped value's nesting depends on.
+  const char* (*structural)(const char* begin, const char* end);
+};
+
+/// The fastest kernels of this CPU, chosen once.
+const JsonScanKernels& jsonScanKernels();
+/// Every set this CPU runs, bytewise first, for tests and benchmarks.
+std::vector<const JsonScanKernels*> availableJsonScanKernels();
+
+}  // namespace rtm
+}  // namespace flat
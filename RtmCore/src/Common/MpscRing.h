@@ -0,0 +1,92 @@
+//
+//  MpscRing.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace flat {
+namespace rtm {
+
+/// Bounded lock-free ring for many producers and one consumer.
+///
+/// Each slot carries a sequence number (Vyukov's bounded queue), so producers only contend on the tail
+/// index and the consumer never takes a lock. Capacity is rounded up to a power of two.
+template <typename T>
+class MpscRing {
+ public:
+  explicit MpscRing(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) rounded <<= 1;
+    mask_ = rounded - 1;
+    slots_ = std::make_unique<Slot[]>(rounded);
+    for (size_t i = 0; i < rounded; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MpscRing(const MpscRing&) = delete;
+  MpscRing& operator=(const MpscRing&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  /// Approximate number of queued items; exact when no producer is mid-push.
+  size_t size() const {
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  /// Any thread. Returns false and leaves `value` untouched when the ring is full.
+  bool tryPush(T& value) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[position & mask_];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (difference == 0) {
+        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(value);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer thread only.
+  bool tryPop(T& value) {
+    size_t position = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[position & mask_];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1) < 0) return false;
+    value = std::move(slot.value);
+    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+    head_.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence{0};
+    T value{};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<size_t> head_{0};
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,143 @@
+//
+//  PerfectHash.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace flat {
+namespace rtm {
+
+/// A string and a small integer it is qualified by, such as a channel type.
+struct PerfectHashKey {
+  std::string_view name;
+  uint32_t tag = 0;
+};
+
+/// Seeded FNV-1a over the tag and the name, finished with a shift so the low bits depend on every byte.
+constexpr uint32_t perfectHashOf(uint32_t seed, std::string_view name, uint32_t tag) {
+  uint32_t hash = (2166136261u ^ seed) * 16777619u;
+  hash = (hash ^ tag) * 16777619u;
+  for (char c : name) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  return hash ^ (hash >> 15);
+}
+
+/// Rehashes a `perfectHashOf` value under another seed: the murmur3 finalizer over the hash and the seed.
+constexpr uint32_t perfectHashMix(uint32_t hash, uint32_t seed) {
+  hash ^= seed * 0x9e3779b9u;
+  hash = (hash ^ (hash >> 16)) * 0x85ebca6bu;
+  hash = (hash ^ (hash >> 13)) * 0xc2b2ae35u;
+  return hash ^ (hash >> 16);
+}
+
+/// Fixed key set laid out at compile time so that every key hashes to its own slot: a lookup is one hash over
+/// the key, one mix and one compare with the only key that can match, however many keys there are.
+///
+/// Hash and displace: the key's hash picks a bucket of about four keys, and the bucket's own seed mixes the hash
+/// into a slot of a table twice the key count. The constructor is `consteval`, so it only runs in a constant
+/// expression: it seeds the largest buckets first, trying seeds until the bucket's keys land in free slots, which
+/// takes a few tries per bucket at this load. Duplicate keys fail the build.
+template <size_t N>
+class PerfectHashIndex {
+ public:
+  static_assert(N > 0 && N < UINT16_MAX, "PerfectHashIndex needs 1 to 65534 keys");
+
+  static constexpr size_t kBuckets = std::bit_ceil((N + 3) / 4);
+  static constexpr size_t kSlots = std::bit_ceil(2 * N);
+  static constexpr uint16_t kEmpty = UINT16_MAX;
+
+  consteval explicit PerfectHashIndex(const PerfectHashKey (&keys)[N]) {
+    for (size_t i = 0; i < N; ++i) keys_[i] = keys[i];
+    build();
+  }
+
+  consteval explicit PerfectHashIndex(const std::string_view (&names)[N]) {
+    for (size_t i = 0; i < N; ++i) keys_[i] = PerfectHashKey{names[i], 0};
+    build();
+  }
+
+  /// The key's position in the constructor's list, or `N` when it is not in the set.
+  constexpr size_t find(std::string_view name, uint32_t tag = 0) const {
+    uint32_t hash = perfectHashOf(0, name, tag);
+    uint16_t index = slots_[perfectHashMix(hash, seeds_[hash & (kBuckets - 1)]) & (kSlots - 1)];
+    if (index == kEmpty || keys_[index].tag != tag || keys_[index].name != name) return N;
+    return index;
+  }
+
+  constexpr const PerfectHashKey& key(size_t index) const { return keys_[index]; }
+  static constexpr size_t size() { return N; }
+
+ private:
+  /// Seeds tried per bucket before giving up; only keys whose 32-bit hashes are equal get that far.
+  static constexpr uint32_t kMaxSeed = 1u << 16;
+
+  consteval void build() {
+    std::array<uint32_t, N> hashes{};
+    std::array<size_t, kBuckets + 1> start{};
+    for (size_t i = 0; i < N; ++i) {
+      hashes[i] = perfectHashOf(0, keys_[i].name, keys_[i].tag);
+      ++start[(hashes[i] & (kBuckets - 1)) + 1];
+    }
+    // Keys grouped by bucket: bucket `b` holds `members[start[b]]` up to `members[start[b + 1]]`.
+    size_t largest = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+      if (start[b + 1] > largest) largest = start[b + 1];
+      start[b + 1] += start[b];
+    }
+    std::array<uint16_t, N> members{};
+    std::array<size_t, kBuckets> filled{};
+    for (size_t i = 0; i < N; ++i) {
+      size_t b = hashes[i] & (kBuckets - 1);
+      members[start[b] + filled[b]++] = static_cast<uint16_t>(i);
+    }
+    for (size_t b = 0; b < kBuckets; ++b) {
+      for (size_t i = start[b]; i < start[b + 1]; ++i) {
+        for (size_t j = start[b]; j < i; ++j) {
+          const PerfectHashKey& key = keys_[members[i]];
+          const PerfectHashKey& other = keys_[members[j]];
+          if (key.tag == other.tag && key.name == other.name) throw "duplicate PerfectHashIndex key";
+        }
+      }
+    }
+
+    slots_.fill(kEmpty);
+    for (size_t count = largest; count > 0; --count) {
+      for (size_t b = 0; b < kBuckets; ++b) {
+        if (start[b + 1] - start[b] == count) seeds_[b] = place(hashes, &members[start[b]], count);
+      }
+    }
+  }
+
+  /// Finds a seed under which the bucket's keys take free slots, and takes them.
+  consteval uint32_t place(const std::array<uint32_t, N>& hashes, const uint16_t* bucket, size_t count) {
+    for (uint32_t seed = 0; seed < kMaxSeed; ++seed) {
+      size_t placed = 0;
+      for (; placed < count; ++placed) {
+        uint16_t& slot = slots_[perfectHashMix(hashes[bucket[placed]], seed) & (kSlots - 1)];
+        if (slot != kEmpty) break;
+        slot = bucket[placed];
+      }
+      if (placed == count) return seed;
+      while (placed > 0) {
+        --placed;
+        slots_[perfectHashMix(hashes[bucket[placed]], seed) & (kSlots - 1)] = kEmpty;
+      }
+    }
+    throw "PerfectHashIndex keys share a hash";
+  }
+
+  std::array<PerfectHashKey, N> keys_{};
+  std::array<uint32_t, kBuckets> seeds_{};
+  std::array<uint16_t, kSlots> slots_{};
+};
+
+}  // namespace rtm
+}  // namespace flat
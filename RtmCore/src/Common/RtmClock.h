@@ -0,0 +1,27 @@
+//
+//  RtmClock.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace flat {
+namespace rtm {
+
+/// Monotonic clock used by every time-driven component in RtmCore.
+/// Components never read it themselves; callers pass `now` into `poll`, so tests can drive time.
+using RtmClock = std::chrono::steady_clock;
+
+/// Milliseconds since the unix epoch, the unit of the `timestamp` fields in the RTM event structs.
+inline uint64_t rtmServerTimestamp() {
+  using namespace std::chrono;
+  return static_cast<uint64_t>(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace rtm
+}  // namespace flat
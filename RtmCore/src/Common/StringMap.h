@@ -0,0 +1,35 @@
+//
+//  StringMap.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace flat {
+namespace rtm {
+
+/// Hash that accepts `const char*`, `std::string_view` and `std::string` alike,
+/// so lookups with the SDK's borrowed strings do not allocate a temporary key.
+struct TransparentStringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+};
+
+template <typename Value>
+using StringMap = std::unordered_map<std::string, Value, TransparentStringHash, std::equal_to<>>;
+
+using StringSet = std::unordered_set<std::string, TransparentStringHash, std::equal_to<>>;
+
+/// Null-safe view of an SDK string field.
+inline std::string_view viewOf(const char* value) { return value ? std::string_view(value) : std::string_view(); }
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,139 @@
+//
+//  TimingWheel.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Common/TimingWheel.h"
+
+namespace flat {
+namespace rtm {
+
+TimingWheel::TimingWheel(RtmClock::time_point start) : TimingWheel(start, Options()) {}
+
+TimingWheel::TimingWheel(RtmClock::time_point start, Options options) : start_(start), options_(options) {
+  if (options_.tick.count() <= 0) options_.tick = std::chrono::milliseconds(1);
+  slots_.fill(kNone);
+}
+
+TimingWheel::TimerId TimingWheel::schedule(RtmClock::time_point deadline, uint64_t payload) {
+  uint32_t index;
+  if (!freeNodes_.empty()) {
+    index = freeNodes_.back();
+    freeNodes_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  Node& node = nodes_[index];
+  // Round up so a timer never fires before its deadline.
+  auto offset = deadline - start_;
+  uint64_t tick = offset.count() <= 0
+                      ? 0
+                      : static_cast<uint64_t>((offset + options_.tick - RtmClock::duration(1)) / options_.tick);
+  node.deadlineTick = tick > currentTick_ ? tick : currentTick_ + 1;
+  node.payload = payload;
+  place(index);
+  ++size_;
+  return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimingWheel::cancel(TimerId id) {
+  uint64_t position = id & UINT32_MAX;
+  if (position == 0 || position > nodes_.size()) return false;
+  uint32_t index = static_cast<uint32_t>(position - 1);
+  Node& node = nodes_[index];
+  if (node.slot == kNone || node.generation != static_cast<uint32_t>(id >> 32)) return false;
+  unlink(index);
+  release(index);
+  return true;
+}
+
+size_t TimingWheel::advance(RtmClock::time_point now, std::vector<uint64_t>& expired) {
+  auto offset = now - start_;
+  uint64_t target = offset.count() <= 0 ? 0 : static_cast<uint64_t>(offset / options_.tick);
+  size_t fired = 0;
+  while (currentTick_ < target) {
+    if (size_ == 0) {
+      currentTick_ = target;
+      break;
+    }
+    ++currentTick_;
+    // Coarse levels first, so a timer due on this very tick reaches level 0 before it is swept.
+    for (int level = kLevels - 1; level > 0; --level) {
+      uint64_t span = uint64_t(1) << (kSlotBits * level);
+      if ((currentTick_ & (span - 1)) == 0) cascade(level);
+    }
+    uint32_t slot = static_cast<uint32_t>(currentTick_ & (kSlots - 1));
+    uint32_t index = slots_[slot];
+    slots_[slot] = kNone;
+    while (index != kNone) {
+      uint32_t next = nodes_[index].next;
+      expired.push_back(nodes_[index].payload);
+      release(index);
+      ++fired;
+      index = next;
+    }
+  }
+  return fired;
+}
+
+// MARK: - Slots
+
+void TimingWheel::place(uint32_t index) {
+  uint64_t deadline = nodes_[index].deadlineTick;
+  uint64_t delta = deadline > currentTick_ ? deadline - currentTick_ : 0;
+  for (int level = 0; level < kLevels; ++level) {
+    if (delta < (uint64_t(1) << (kSlotBits * (level + 1)))) {
+      link(index, level * kSlots + static_cast<uint32_t>((deadline >> (kSlotBits * level)) & (kSlots - 1)));
+      return;
+    }
+  }
+  // Past the top level's span: park on the furthest top slot and re-place when it cascades.
+  int top = kLevels - 1;
+  uint64_t parked = currentTick_ + (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+  link(index, top * kSlots + static_cast<uint32_t>((parked >> (kSlotBits * top)) & (kSlots - 1)));
+}
+
+void TimingWheel::link(uint32_t index, uint32_t slot) {
+  Node& node = nodes_[index];
+  node.slot = slot;
+  node.prev = kNone;
+  node.next = slots_[slot];
+  if (node.next != kNone) nodes_[node.next].prev = index;
+  slots_[slot] = index;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+  Node& node = nodes_[index];
+  if (node.prev != kNone) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    slots_[node.slot] = node.next;
+  }
+  if (node.next != kNone) nodes_[node.next].prev = node.prev;
+  node.prev = node.next = kNone;
+}
+
+void TimingWheel::release(uint32_t index) {
+  Node& node = nodes_[index];
+  node.slot = kNone;
+  ++node.generation;
+  freeNodes_.push_back(index);
+  --size_;
+}
+
+void TimingWheel::cascade(int level) {
+  uint32_t slot = level * kSlots + static_cast<uint32_t>((currentTick_ >> (kSlotBits * level)) & (kSlots - 1));
+  uint32_t index = slots_[slot];
+  slots_[slot] = kNone;
+  while (index != kNone) {
+    uint32_t next = nodes_[index].next;
+    place(index);
+    index = next;
+  }
+}
+
+}  // namespace rtm
+}  // namespace flat
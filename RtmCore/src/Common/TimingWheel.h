@@ -0,0 +1,85 @@
+//
+//  TimingWheel.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Common/RtmClock.h"
+
+namespace flat {
+namespace rtm {
+
+/// Hierarchical hashed timing wheel: four levels of 64 slots, O(1) `schedule` and `cancel`.
+///
+/// A timer lands on the coarsest level whose span covers its deadline and cascades one level down each time
+/// the wheel reaches its slot, so it is touched at most four times before it fires. Deadlines round up to the
+/// next tick and never fire early. Deadlines beyond the top level's span (about 4.6 hours at 1 ms) are parked
+/// on the top level and re-placed on every cascade.
+///
+/// Not thread-safe; owners serialize access with their own lock.
+class TimingWheel {
+ public:
+  /// 0 is never a valid id.
+  using TimerId = uint64_t;
+
+  struct Options {
+    std::chrono::milliseconds tick{1};
+  };
+
+  explicit TimingWheel(RtmClock::time_point start);
+  TimingWheel(RtmClock::time_point start, Options options);
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  TimerId schedule(RtmClock::time_point deadline, uint64_t payload);
+  /// False if the timer already fired or was cancelled.
+  bool cancel(TimerId id);
+  /// Moves the wheel to `now` and appends the payloads of every timer that expired, earliest tick first.
+  /// Returns how many fired. A deadline already in the past when scheduled fires on the next tick.
+  size_t advance(RtmClock::time_point now, std::vector<uint64_t>& expired);
+
+  size_t size() const { return size_; }
+  RtmClock::time_point now() const { return start_ + options_.tick * static_cast<int64_t>(currentTick_); }
+
+ private:
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 6;
+  static constexpr uint32_t kSlots = 1u << kSlotBits;
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Node {
+    uint64_t deadlineTick = 0;
+    uint64_t payload = 0;
+    uint32_t generation = 0;
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+    /// Index into `slots_`, or `kNone` when the node is free.
+    uint32_t slot = kNone;
+  };
+
+  void place(uint32_t index);
+  void link(uint32_t index, uint32_t slot);
+  void unlink(uint32_t index);
+  void release(uint32_t index);
+  void cascade(int level);
+
+  RtmClock::time_point start_;
+  Options options_;
+  uint64_t currentTick_ = 0;
+  size_t size_ = 0;
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> freeNodes_;
+  std::array<uint32_t, kLevels * kSlots> slots_;
+};
+
+}  // namespace rtm
+}  // namespace flat
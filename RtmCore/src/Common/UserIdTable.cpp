@@ -0,0 +1,162 @@
+//
+//  UserIdTable.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Common/UserIdTable.h"
+
+#include <bit>
+#include <cstring>
+#include <functional>
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+constexpr size_t kBlockBytes = 64 * 1024;
+
+/// Segment of a handle and its offset there; segment `s` holds `kFirst << s` entries.
+template <uint32_t kFirst>
+std::pair<int, uint32_t> locate(uint32_t handle) {
+  uint32_t blocks = handle / kFirst + 1;
+  int segment = std::bit_width(blocks) - 1;
+  return {segment, handle - kFirst * ((1u << segment) - 1)};
+}
+
+}  // namespace
+
+UserIdTable::Index::Index(size_t capacity)
+    : mask(capacity - 1), slots(std::make_unique<std::atomic<uint32_t>[]>(capacity)) {
+  for (size_t i = 0; i < capacity; ++i) slots[i].store(0, std::memory_order_relaxed);
+}
+
+UserIdTable::UserIdTable() {
+  indexes_.push_back(std::make_unique<Index>(1024));
+  index_.store(indexes_.back().get(), std::memory_order_release);
+}
+
+UserIdTable::~UserIdTable() {
+  for (std::atomic<Entry*>& segment : segments_) delete[] segment.load(std::memory_order_relaxed);
+}
+
+UserIdTable& UserIdTable::shared() {
+  static UserIdTable table;
+  return table;
+}
+
+UserIdTable::UserHandle UserIdTable::find(std::string_view userId) const {
+  if (userId.empty()) return kNoUser;
+  return lookup(*index_.load(std::memory_order_acquire), userId, hashOf(userId));
+}
+
+UserIdTable::UserHandle UserIdTable::intern(std::string_view userId) {
+  if (userId.empty() || userId.size() > UINT32_MAX) return kNoUser;
+  uint32_t hash = hashOf(userId);
+  UserHandle handle = lookup(*index_.load(std::memory_order_acquire), userId, hash);
+  if (handle != kNoUser) return handle;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  Index* index = index_.load(std::memory_order_relaxed);
+  handle = lookup(*index, userId, hash);
+  if (handle != kNoUser) return handle;
+  handle = size_.load(std::memory_order_relaxed);
+  auto [segment, offset] = locate<kFirstSegment>(handle);
+  if (segment >= kSegments) return kNoUser;
+  Entry* entries = segments_[segment].load(std::memory_order_relaxed);
+  if (!entries) {
+    entries = new Entry[static_cast<size_t>(kFirstSegment) << segment];
+    segments_[segment].store(entries, std::memory_order_release);
+  }
+  entries[offset] = Entry{store(userId), static_cast<uint32_t>(userId.size()), hash};
+
+  if ((static_cast<size_t>(handle) + 1) * 2 > index->mask + 1) {
+    // The grown index is complete before readers can see it, so a lookup finds every id that was interned
+    // before it started, in whichever index it loads.
+    auto grown = std::make_unique<Index>((index->mask + 1) * 2);
+    for (UserHandle existing = 0; existing <= handle; ++existing) {
+      place(*grown, entry(existing)->hash, existing, std::memory_order_relaxed);
+    }
+    index_.store(grown.get(), std::memory_order_release);
+    indexes_.push_back(std::move(grown));
+  } else {
+    place(*index, hash, handle, std::memory_order_release);
+  }
+  size_.store(handle + 1, std::memory_order_release);
+  return handle;
+}
+
+std::string_view UserIdTable::name(UserHandle handle) const {
+  if (handle >= size_.load(std::memory_order_acquire)) return {};
+  const Entry* found = entry(handle);
+  return std::string_view(found->data, found->length);
+}
+
+size_t UserIdTable::bytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t total = blockBytes_;
+  for (const std::unique_ptr<Index>& index : indexes_) total += (index->mask + 1) * sizeof(uint32_t);
+  for (int segment = 0; segment < kSegments; ++segment) {
+    if (segments_[segment].load(std::memory_order_relaxed)) {
+      total += (static_cast<size_t>(kFirstSegment) << segment) * sizeof(Entry);
+    }
+  }
+  return total;
+}
+
+// MARK: - Private
+
+uint32_t UserIdTable::hashOf(std::string_view userId) {
+  size_t hash = std::hash<std::string_view>{}(userId);
+  return static_cast<uint32_t>(hash ^ (static_cast<uint64_t>(hash) >> 32));
+}
+
+const UserIdTable::Entry* UserIdTable::entry(UserHandle handle) const {
+  auto [segment, offset] = locate<kFirstSegment>(handle);
+  return &segments_[segment].load(std::memory_order_acquire)[offset];
+}
+
+UserIdTable::UserHandle UserIdTable::lookup(const Index& index, std::string_view userId, uint32_t hash) const {
+  for (size_t i = hash & index.mask;; i = (i + 1) & index.mask) {
+    uint32_t slot = index.slots[i].load(std::memory_order_acquire);
+    if (slot == 0) return kNoUser;
+    const Entry* candidate = entry(slot - 1);
+    if (candidate->hash == hash && candidate->length == userId.size() &&
+        std::memcmp(candidate->data, userId.data(), userId.size()) == 0) {
+      return slot - 1;
+    }
+  }
+}
+
+void UserIdTable::place(Index& index, uint32_t hash, UserHandle handle, std::memory_order order) {
+  size_t i = hash & index.mask;
+  while (index.slots[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & index.mask;
+  // Slots hold handle + 1 so that 0 marks an empty slot.
+  index.slots[i].store(handle + 1, order);
+}
+
+const char* UserIdTable::store(std::string_view userId) {
+  if (userId.size() > kBlockBytes / 4) {
+    // Long ids get a block of their own rather than wasting the tail of a shared one.
+    blocks_.push_back(std::make_unique<char[]>(userId.size()));
+    blockBytes_ += userId.size();
+    std::memcpy(blocks_.back().get(), userId.data(), userId.size());
+    return blocks_.back().get();
+  }
+  if (blockRemaining_ < userId.size()) {
+    blocks_.push_back(std::make_unique<char[]>(kBlockBytes));
+    blockBytes_ += kBlockBytes;
+    blockCursor_ = blocks_.back().get();
+    blockRemaining_ = kBlockBytes;
+  }
+  char* data = blockCursor_;
+  std::memcpy(data, userId.data(), userId.size());
+  blockCursor_ += userId.size();
+  blockRemaining_ -= userId.size();
+  return data;
+}
+
+}  // namespace rtm
+}  // namespace flat
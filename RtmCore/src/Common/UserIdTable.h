@@ -0,0 +1,94 @@
+//
+//  UserIdTable.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "Common/StringMap.h"
+
+namespace flat {
+namespace rtm {
+
+/// Interns user ids into dense 32-bit handles, so rosters, chat, locks and metadata can key on integers instead
+/// of copying and comparing the SDK's `publisher`, `users`, `userId`, `owner` and `authorUserId` strings.
+///
+/// Handles count up from 0 in first-seen order and are never reused; each id is stored once. `find` and `name`
+/// never lock: the open-addressing index holds handles in atomic slots published after their entry, and
+/// entries live in segments that double in size and never move. `intern` only takes the lock for ids it has
+/// not seen, so once a room has warmed up every callback resolves its ids lock-free. Outgrown index arrays are
+/// kept until destruction, together smaller than the current one, so readers need no reclamation scheme.
+class UserIdTable {
+ public:
+  using UserHandle = uint32_t;
+  static constexpr UserHandle kNoUser = UINT32_MAX;
+
+  UserIdTable();
+  ~UserIdTable();
+
+  UserIdTable(const UserIdTable&) = delete;
+  UserIdTable& operator=(const UserIdTable&) = delete;
+
+  /// The table shared by every component that does not bring its own.
+  static UserIdTable& shared();
+
+  /// The id's handle, adding it when unseen; `kNoUser` for an empty or null id.
+  UserHandle intern(std::string_view userId);
+  UserHandle intern(const char* userId) { return intern(viewOf(userId)); }
+  /// Lock-free. `kNoUser` when the id was never interned.
+  UserHandle find(std::string_view userId) const;
+  UserHandle find(const char* userId) const { return find(viewOf(userId)); }
+  /// Lock-free. The view stays valid for the table's lifetime; empty for an unknown handle.
+  std::string_view name(UserHandle handle) const;
+
+  /// Handles issued so far; every handle below it is valid.
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+  /// Bytes held by entries, names and the index.
+  size_t bytes() const;
+
+ private:
+  struct Entry {
+    const char* data;
+    uint32_t length;
+    uint32_t hash;
+  };
+
+  struct Index {
+    explicit Index(size_t capacity);
+    size_t mask;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots;
+  };
+
+  static constexpr uint32_t kFirstSegment = 1024;
+  static constexpr int kSegments = 22;
+
+  static uint32_t hashOf(std::string_view userId);
+  const Entry* entry(UserHandle handle) const;
+  UserHandle lookup(const Index& index, std::string_view userId, uint32_t hash) const;
+  static void place(Index& index, uint32_t hash, UserHandle handle, std::memory_order order);
+  const char* store(std::string_view userId);
+
+  std::atomic<Index*> index_;
+  std::atomic<Entry*> segments_[kSegments] = {};
+  std::atomic<uint32_t> size_{0};
+
+  /// Taken by writers and `bytes`.
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Index>> indexes_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* blockCursor_ = nullptr;
+  size_t blockRemaining_ = 0;
+  size_t blockBytes_ = 0;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,49 @@
+//
+//  Varint.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flat {
+namespace rtm {
+
+/// LEB128 unsigned varints, the length prefix of RtmCore's binary wire formats.
+constexpr size_t kMaxVarintLength = 10;
+
+inline size_t varintLength(uint64_t value) {
+  size_t length = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++length;
+  }
+  return length;
+}
+
+inline void appendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+/// Reads one varint from `[cursor, end)` and advances `cursor`. False on truncated or overlong input.
+inline bool readVarint(const char*& cursor, const char* end, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(*cursor++);
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,46 @@
+//
+//  DebatchingEventHandler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/DebatchingEventHandler.h"
+
+#include "Publishing/MessageBatch.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+DebatchingEventHandler::Stats DebatchingEventHandler::stats() const {
+  Stats stats;
+  stats.envelopes = envelopes_.load(std::memory_order_relaxed);
+  stats.messages = messages_.load(std::memory_order_relaxed);
+  stats.malformed = malformed_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void DebatchingEventHandler::onMessageEvent(const MessageEvent& event) {
+  if (!MessageBatch::isEnvelope(event)) {
+    next().onMessageEvent(event);
+    return;
+  }
+  // Validate every frame before delivering any of them.
+  MessageBatchReader check(event);
+  MessageEvent message;
+  uint64_t count = 0;
+  while (check.next(message)) ++count;
+  if (check.malformed()) {
+    malformed_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  envelopes_.fetch_add(1, std::memory_order_relaxed);
+  messages_.fetch_add(count, std::memory_order_relaxed);
+  MessageBatchReader reader(event);
+  while (reader.next(message)) next().onMessageEvent(message);
+}
+
+}  // namespace rtm
+}  // namespace flat
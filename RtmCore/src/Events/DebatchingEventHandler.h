@@ -0,0 +1,44 @@
+//
+//  DebatchingEventHandler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Events/ForwardingRtmEventHandler.h"
+
+namespace flat {
+namespace rtm {
+
+/// Receiving side of `BatchingPublisher`: splits `MessageBatch` envelopes back into one `onMessageEvent` per
+/// message, in publish order, each with the envelope's channel, topic, publisher and timestamp. Every other
+/// callback, and every message that is not an envelope, passes through unchanged.
+///
+/// An envelope with a malformed frame is dropped whole and counted, so a receiver never sees half a batch.
+class DebatchingEventHandler : public ForwardingRtmEventHandler {
+ public:
+  struct Stats {
+    uint64_t envelopes = 0;
+    uint64_t messages = 0;
+    uint64_t malformed = 0;
+  };
+
+  explicit DebatchingEventHandler(agora::rtm::IRtmEventHandler& next) : ForwardingRtmEventHandler(next) {}
+
+  Stats stats() const;
+
+  void onMessageEvent(const MessageEvent& event) override;
+
+ private:
+  std::atomic<uint64_t> envelopes_{0};
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> malformed_{0};
+};
+
+}  // namespace rtm
+}  // namespace flat
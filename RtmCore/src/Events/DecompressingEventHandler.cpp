@@ -0,0 +1,41 @@
+//
+//  DecompressingEventHandler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/DecompressingEventHandler.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+DecompressingEventHandler::Stats DecompressingEventHandler::stats() const {
+  Stats stats;
+  stats.inflated = inflated_.load(std::memory_order_relaxed);
+  stats.malformed = malformed_.load(std::memory_order_relaxed);
+  stats.bytesIn = bytesIn_.load(std::memory_order_relaxed);
+  stats.bytesOut = bytesOut_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void DecompressingEventHandler::onMessageEvent(const MessageEvent& event) {
+  if (!PayloadCompression::isCompressed(event)) {
+    next().onMessageEvent(event);
+    return;
+  }
+  MessageEvent message;
+  if (!inflater_.inflate(event, message)) {
+    malformed_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  inflated_.fetch_add(1, std::memory_order_relaxed);
+  bytesIn_.fetch_add(event.messageLength, std::memory_order_relaxed);
+  bytesOut_.fetch_add(message.messageLength, std::memory_order_relaxed);
+  next().onMessageEvent(message);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,50 @@
+//
+//  DecompressingEventHandler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Events/ForwardingRtmEventHandler.h"
+#include "Publishing/PayloadCompression.h"
+
+namespace flat {
+namespace rtm {
+
+/// Receiving side of `CompressingPublisher`: restores each compressed message to the message that was published,
+/// with its own customType and message type. Every other callback, and every message that is not compressed,
+/// passes through unchanged.
+///
+/// A compressed message that does not inflate is dropped and counted. Messages are inflated on the calling
+/// thread into one buffer, so the restored message is only valid during `next`'s callback.
+class DecompressingEventHandler : public ForwardingRtmEventHandler {
+ public:
+  struct Stats {
+    uint64_t inflated = 0;
+    uint64_t malformed = 0;
+    /// Payload bytes received compressed, and the bytes they inflated to.
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+  };
+
+  explicit DecompressingEventHandler(agora::rtm::IRtmEventHandler& next) : ForwardingRtmEventHandler(next) {}
+
+  Stats stats() const;
+
+  void onMessageEvent(const MessageEvent& event) override;
+
+ private:
+  PayloadInflater inflater_;
+  std::atomic<uint64_t> inflated_{0};
+  std::atomic<uint64_t> malformed_{0};
+  std::atomic<uint64_t> bytesIn_{0};
+  std::atomic<uint64_t> bytesOut_{0};
+};
+
+}  // namespace rtm
+}  // namespace flat
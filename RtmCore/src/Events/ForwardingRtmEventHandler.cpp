@@ -0,0 +1,240 @@
+//
+//  ForwardingRtmEventHandler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/ForwardingRtmEventHandler.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+void ForwardingRtmEventHandler::onLinkStateEvent(const LinkStateEvent& event) {
+  next_.onLinkStateEvent(event);
+}
+
+void ForwardingRtmEventHandler::onMessageEvent(const MessageEvent& event) {
+  next_.onMessageEvent(event);
+}
+
+void ForwardingRtmEventHandler::onPresenceEvent(const PresenceEvent& event) {
+  next_.onPresenceEvent(event);
+}
+
+void ForwardingRtmEventHandler::onTopicEvent(const TopicEvent& event) {
+  next_.onTopicEvent(event);
+}
+
+void ForwardingRtmEventHandler::onLockEvent(const LockEvent& event) {
+  next_.onLockEvent(event);
+}
+
+void ForwardingRtmEventHandler::onStorageEvent(const StorageEvent& event) {
+  next_.onStorageEvent(event);
+}
+
+void ForwardingRtmEventHandler::onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                             RTM_ERROR_CODE errorCode) {
+  next_.onJoinResult(requestId, channelName, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                              RTM_ERROR_CODE errorCode) {
+  next_.onLeaveResult(requestId, channelName, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onPublishTopicMessageResult(const uint64_t requestId, const char* channelName,
+                                                            const char* topic, RTM_ERROR_CODE errorCode) {
+  next_.onPublishTopicMessageResult(requestId, channelName, topic, errorCode);
+}
+
+void ForwardingRtmEventHandler::onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                                  const char* topic, const char* meta, RTM_ERROR_CODE errorCode) {
+  next_.onJoinTopicResult(requestId, channelName, userId, topic, meta, errorCode);
+}
+
+void ForwardingRtmEventHandler::onLeaveTopicResult(const uint64_t requestId, const char* channelName,
+                                                   const char* userId, const char* topic, const char* meta,
+                                                   RTM_ERROR_CODE errorCode) {
+  next_.onLeaveTopicResult(requestId, channelName, userId, topic, meta, errorCode);
+}
+
+void ForwardingRtmEventHandler::onSubscribeTopicResult(const uint64_t requestId, const char* channelName,
+                                                       const char* userId, const char* topic, UserList succeedUsers,
+                                                       UserList failedUsers, RTM_ERROR_CODE errorCode) {
+  next_.onSubscribeTopicResult(requestId, channelName, userId, topic, succeedUsers, failedUsers, errorCode);
+}
+
+void ForwardingRtmEventHandler::onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName,
+                                                         const char* topic, RTM_ERROR_CODE errorCode) {
+  next_.onUnsubscribeTopicResult(requestId, channelName, topic, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName,
+                                                              const char* topic, UserList users,
+                                                              RTM_ERROR_CODE errorCode) {
+  next_.onGetSubscribedUserListResult(requestId, channelName, topic, users, errorCode);
+}
+
+void ForwardingRtmEventHandler::onConnectionStateChanged(const char* channelName, RTM_CONNECTION_STATE state,
+                                                         RTM_CONNECTION_CHANGE_REASON reason) {
+  next_.onConnectionStateChanged(channelName, state, reason);
+}
+
+void ForwardingRtmEventHandler::onTokenPrivilegeWillExpire(const char* channelName) {
+  next_.onTokenPrivilegeWillExpire(channelName);
+}
+
+void ForwardingRtmEventHandler::onSubscribeResult(const uint64_t requestId, const char* channelName,
+                                                  RTM_ERROR_CODE errorCode) {
+  next_.onSubscribeResult(requestId, channelName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                                                    RTM_ERROR_CODE errorCode) {
+  next_.onUnsubscribeResult(requestId, channelName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  next_.onPublishResult(requestId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  next_.onLoginResult(requestId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onLogoutResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  next_.onLogoutResult(requestId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onRenewTokenResult(const uint64_t requestId, RTM_SERVICE_TYPE serverType,
+                                                   const char* channelName, RTM_ERROR_CODE errorCode) {
+  next_.onRenewTokenResult(requestId, serverType, channelName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                           RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  next_.onSetChannelMetadataResult(requestId, channelName, channelType, errorCode);
+}
+
+void ForwardingRtmEventHandler::onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                              RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  next_.onUpdateChannelMetadataResult(requestId, channelName, channelType, errorCode);
+}
+
+void ForwardingRtmEventHandler::onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                              RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  next_.onRemoveChannelMetadataResult(requestId, channelName, channelType, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                           RTM_CHANNEL_TYPE channelType, const Metadata& data,
+                                                           RTM_ERROR_CODE errorCode) {
+  next_.onGetChannelMetadataResult(requestId, channelName, channelType, data, errorCode);
+}
+
+void ForwardingRtmEventHandler::onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                        RTM_ERROR_CODE errorCode) {
+  next_.onSetUserMetadataResult(requestId, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                           RTM_ERROR_CODE errorCode) {
+  next_.onUpdateUserMetadataResult(requestId, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                           RTM_ERROR_CODE errorCode) {
+  next_.onRemoveUserMetadataResult(requestId, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                        const Metadata& data, RTM_ERROR_CODE errorCode) {
+  next_.onGetUserMetadataResult(requestId, userId, data, errorCode);
+}
+
+void ForwardingRtmEventHandler::onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                              RTM_ERROR_CODE errorCode) {
+  next_.onSubscribeUserMetadataResult(requestId, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                                RTM_ERROR_CODE errorCode) {
+  next_.onUnsubscribeUserMetadataResult(requestId, userId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onSetLockResult(const uint64_t requestId, const char* channelName,
+                                                RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                RTM_ERROR_CODE errorCode) {
+  next_.onSetLockResult(requestId, channelName, channelType, lockName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onRemoveLockResult(const uint64_t requestId, const char* channelName,
+                                                   RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                   RTM_ERROR_CODE errorCode) {
+  next_.onRemoveLockResult(requestId, channelName, channelType, lockName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onReleaseLockResult(const uint64_t requestId, const char* channelName,
+                                                    RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                    RTM_ERROR_CODE errorCode) {
+  next_.onReleaseLockResult(requestId, channelName, channelType, lockName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onAcquireLockResult(const uint64_t requestId, const char* channelName,
+                                                    RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                    RTM_ERROR_CODE errorCode, const char* errorDetails) {
+  next_.onAcquireLockResult(requestId, channelName, channelType, lockName, errorCode, errorDetails);
+}
+
+void ForwardingRtmEventHandler::onRevokeLockResult(const uint64_t requestId, const char* channelName,
+                                                   RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                   RTM_ERROR_CODE errorCode) {
+  next_.onRevokeLockResult(requestId, channelName, channelType, lockName, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetLocksResult(const uint64_t requestId, const char* channelName,
+                                                 RTM_CHANNEL_TYPE channelType, const LockDetail* lockDetailList,
+                                                 const size_t count, RTM_ERROR_CODE errorCode) {
+  next_.onGetLocksResult(requestId, channelName, channelType, lockDetailList, count, errorCode);
+}
+
+void ForwardingRtmEventHandler::onWhoNowResult(const uint64_t requestId, const UserState* userStateList,
+                                               const size_t count, const char* nextPage, RTM_ERROR_CODE errorCode) {
+  next_.onWhoNowResult(requestId, userStateList, count, nextPage, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetOnlineUsersResult(const uint64_t requestId, const UserState* userStateList,
+                                                       const size_t count, const char* nextPage,
+                                                       RTM_ERROR_CODE errorCode) {
+  next_.onGetOnlineUsersResult(requestId, userStateList, count, nextPage, errorCode);
+}
+
+void ForwardingRtmEventHandler::onWhereNowResult(const uint64_t requestId, const ChannelInfo* channels,
+                                                 const size_t count, RTM_ERROR_CODE errorCode) {
+  next_.onWhereNowResult(requestId, channels, count, errorCode);
+}
+
+void ForwardingRtmEventHandler::onGetUserChannelsResult(const uint64_t requestId, const ChannelInfo* channels,
+                                                        const size_t count, RTM_ERROR_CODE errorCode) {
+  next_.onGetUserChannelsResult(requestId, channels, count, errorCode);
+}
+
+void ForwardingRtmEventHandler::onPresenceSetStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  next_.onPresenceSetStateResult(requestId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onPresenceRemoveStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  next_.onPresenceRemoveStateResult(requestId, errorCode);
+}
+
+void ForwardingRtmEventHandler::onPresenceGetStateResult(const uint64_t requestId, const UserState& state,
+                                                         RTM_ERROR_CODE errorCode) {
+  next_.onPresenceGetStateResult(requestId, state, errorCode);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,115 @@
+//
+//  ForwardingRtmEventHandler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Passes every callback through to `next`. Base for adapters that rewrite a few callbacks and leave the rest
+/// untouched, so a new SDK callback only has to be added here.
+class ForwardingRtmEventHandler : public agora::rtm::IRtmEventHandler {
+ public:
+  explicit ForwardingRtmEventHandler(agora::rtm::IRtmEventHandler& next) : next_(next) {}
+
+  agora::rtm::IRtmEventHandler& next() const { return next_; }
+
+  void onLinkStateEvent(const LinkStateEvent& event) override;
+  void onMessageEvent(const MessageEvent& event) override;
+  void onPresenceEvent(const PresenceEvent& event) override;
+  void onTopicEvent(const TopicEvent& event) override;
+  void onLockEvent(const LockEvent& event) override;
+  void onStorageEvent(const StorageEvent& event) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                         const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                          const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                              const char* topic, agora::rtm::UserList succeedUsers, agora::rtm::UserList failedUsers,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                     agora::rtm::UserList users, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onConnectionStateChanged(const char* channelName, agora::rtm::RTM_CONNECTION_STATE state,
+                                agora::rtm::RTM_CONNECTION_CHANGE_REASON reason) override;
+  void onTokenPrivilegeWillExpire(const char* channelName) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLoginResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLogoutResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRenewTokenResult(const uint64_t requestId, agora::rtm::RTM_SERVICE_TYPE serverType, const char* channelName,
+                          agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserMetadataResult(const uint64_t requestId, const char* userId, const agora::rtm::Metadata& data,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                       agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                       const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onReleaseLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onAcquireLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode,
+                           const char* errorDetails) override;
+  void onRevokeLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetLocksResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                        const agora::rtm::LockDetail* lockDetailList, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhereNowResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserChannelsResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceRemoveStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceGetStateResult(const uint64_t requestId, const agora::rtm::UserState& state,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  agora::rtm::IRtmEventHandler& next_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,555 @@
+//
+//  QueuedRtmEventHandler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/QueuedRtmEventHandler.h"
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+class QueuedRtmEventHandler::Callback {
+ public:
+  virtual void deliver(IRtmEventHandler& target) = 0;
+  /// Runs the destructor, then releases the arena the callback was built in.
+  virtual void destroy() = 0;
+
+ protected:
+  ~Callback() = default;
+};
+
+/// A call and the arena holding both its copied arguments and the callback itself.
+template <typename Call>
+class QueuedRtmEventHandler::StoredCallback final : public Callback {
+ public:
+  StoredCallback(RtmEventArena&& storage, Call&& call) : storage_(std::move(storage)), call_(std::move(call)) {}
+  void deliver(IRtmEventHandler& target) override { call_(target); }
+
+  void destroy() override {
+    RtmEventArena storage = std::move(storage_);
+    this->~StoredCallback();
+    // `storage` goes out of scope here and hands this callback's block back to the pool.
+  }
+
+ private:
+  ~StoredCallback() = default;
+
+  RtmEventArena storage_;
+  Call call_;
+};
+
+void QueuedRtmEventHandler::CallbackDeleter::operator()(Callback* callback) const { callback->destroy(); }
+
+QueuedRtmEventHandler::QueuedRtmEventHandler(IRtmEventHandler& target)
+    : QueuedRtmEventHandler(target, Options()) {}
+
+QueuedRtmEventHandler::QueuedRtmEventHandler(IRtmEventHandler& target, const Options& options)
+    : target_(target),
+      options_(options),
+      pool_(options.pool ? *options.pool : RtmEventBlockPool::shared()),
+      ring_(options.capacity) {}
+
+QueuedRtmEventHandler::~QueuedRtmEventHandler() { stop(); }
+
+void QueuedRtmEventHandler::start() {
+  if (running_.exchange(true)) return;
+  consumer_ = std::thread([this] { run(); });
+}
+
+void QueuedRtmEventHandler::stop() {
+  if (!running_.exchange(false)) return;
+  wakeups_.fetch_add(1, std::memory_order_seq_cst);
+  wakeups_.notify_one();
+  consumer_.join();
+}
+
+size_t QueuedRtmEventHandler::drain(size_t maxEvents) {
+  std::vector<CallbackPtr> batch;
+  size_t delivered = 0;
+  while (delivered < maxEvents) {
+    size_t count = deliverBatch(batch, maxEvents - delivered);
+    if (count == 0) break;
+    delivered += count;
+  }
+  return delivered;
+}
+
+QueuedRtmEventHandler::Stats QueuedRtmEventHandler::stats() const {
+  Stats stats;
+  stats.depth = ring_.size();
+  stats.highWatermark = highWatermark_.load(std::memory_order_relaxed);
+  stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+  stats.delivered = delivered_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.batches = batches_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+template <typename Call>
+void QueuedRtmEventHandler::post(RtmEventArena&& storage, Call&& call) {
+  using Stored = StoredCallback<std::decay_t<Call>>;
+  void* memory = storage.allocate(sizeof(Stored), alignof(Stored));
+  enqueue(CallbackPtr(new (memory) Stored(std::move(storage), std::move(call))));
+}
+
+template <typename Call>
+void QueuedRtmEventHandler::post(Call&& call) {
+  post(RtmEventArena(pool_), std::move(call));
+}
+
+void QueuedRtmEventHandler::enqueue(CallbackPtr callback) {
+  while (!ring_.tryPush(callback)) {
+    if (options_.overflow == OverflowPolicy::dropNewest) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::this_thread::yield();
+  }
+  enqueued_.fetch_add(1, std::memory_order_relaxed);
+  // Pairs with the seq_cst sleep flag in run(): either the consumer sees the pushed item or we see it asleep.
+  wakeups_.fetch_add(1, std::memory_order_seq_cst);
+  if (consumerSleeping_.load(std::memory_order_seq_cst)) wakeups_.notify_one();
+  if (options_.notify) options_.notify();
+}
+
+size_t QueuedRtmEventHandler::deliverBatch(std::vector<CallbackPtr>& batch, size_t maxEvents) {
+  size_t depth = ring_.size();
+  if (depth > highWatermark_.load(std::memory_order_relaxed)) highWatermark_.store(depth, std::memory_order_relaxed);
+
+  size_t limit = std::min(options_.maxBatch, maxEvents);
+  batch.clear();
+  CallbackPtr callback;
+  while (batch.size() < limit && ring_.tryPop(callback)) batch.push_back(std::move(callback));
+  if (batch.empty()) return 0;
+
+  for (auto& queued : batch) queued->deliver(target_);
+  size_t count = batch.size();
+  batch.clear();
+  delivered_.fetch_add(count, std::memory_order_relaxed);
+  batches_.fetch_add(1, std::memory_order_relaxed);
+  return count;
+}
+
+void QueuedRtmEventHandler::run() {
+  std::vector<CallbackPtr> batch;
+  batch.reserve(options_.maxBatch);
+  for (;;) {
+    if (deliverBatch(batch, SIZE_MAX) > 0) continue;
+    if (!running_.load(std::memory_order_acquire)) {
+      // A final pass for anything pushed between the empty check and stop().
+      while (deliverBatch(batch, SIZE_MAX) > 0) {
+      }
+      return;
+    }
+    uint32_t observed = wakeups_.load(std::memory_order_seq_cst);
+    consumerSleeping_.store(true, std::memory_order_seq_cst);
+    if (ring_.size() == 0 && running_.load(std::memory_order_acquire)) wakeups_.wait(observed);
+    consumerSleeping_.store(false, std::memory_order_relaxed);
+  }
+}
+
+// MARK: - Events
+
+void QueuedRtmEventHandler::onLinkStateEvent(const LinkStateEvent& event) {
+  RtmEventArena storage(pool_);
+  LinkStateEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onLinkStateEvent(copy); });
+}
+
+void QueuedRtmEventHandler::onMessageEvent(const MessageEvent& event) {
+  RtmEventArena storage(pool_);
+  MessageEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onMessageEvent(copy); });
+}
+
+void QueuedRtmEventHandler::onPresenceEvent(const PresenceEvent& event) {
+  RtmEventArena storage(pool_);
+  PresenceEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onPresenceEvent(copy); });
+}
+
+void QueuedRtmEventHandler::onTopicEvent(const TopicEvent& event) {
+  RtmEventArena storage(pool_);
+  TopicEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onTopicEvent(copy); });
+}
+
+void QueuedRtmEventHandler::onLockEvent(const LockEvent& event) {
+  RtmEventArena storage(pool_);
+  LockEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onLockEvent(copy); });
+}
+
+void QueuedRtmEventHandler::onStorageEvent(const StorageEvent& event) {
+  RtmEventArena storage(pool_);
+  StorageEvent copy = storage.copy(event);
+  post(std::move(storage), [copy](IRtmEventHandler& target) { target.onStorageEvent(copy); });
+}
+
+// MARK: - Stream channel results
+
+void QueuedRtmEventHandler::onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                         RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* user = storage.copy(userId);
+  post(std::move(storage), [=](IRtmEventHandler& target) { target.onJoinResult(requestId, channel, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                          RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onLeaveResult(requestId, channel, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onPublishTopicMessageResult(const uint64_t requestId, const char* channelName,
+                                                        const char* topic, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* topicCopy = storage.copy(topic);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onPublishTopicMessageResult(requestId, channel, topicCopy, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                              const char* topic, const char* meta, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* user = storage.copy(userId);
+  const char* topicCopy = storage.copy(topic);
+  const char* metaCopy = storage.copy(meta);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onJoinTopicResult(requestId, channel, user, topicCopy, metaCopy, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                               const char* topic, const char* meta, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* user = storage.copy(userId);
+  const char* topicCopy = storage.copy(topic);
+  const char* metaCopy = storage.copy(meta);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onLeaveTopicResult(requestId, channel, user, topicCopy, metaCopy, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onSubscribeTopicResult(const uint64_t requestId, const char* channelName,
+                                                   const char* userId, const char* topic, UserList succeedUsers,
+                                                   UserList failedUsers, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* user = storage.copy(userId);
+  const char* topicCopy = storage.copy(topic);
+  UserList succeed = storage.copy(succeedUsers);
+  UserList failed = storage.copy(failedUsers);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onSubscribeTopicResult(requestId, channel, user, topicCopy, succeed, failed, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName,
+                                                     const char* topic, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* topicCopy = storage.copy(topic);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onUnsubscribeTopicResult(requestId, channel, topicCopy, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName,
+                                                          const char* topic, UserList users,
+                                                          RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* topicCopy = storage.copy(topic);
+  UserList usersCopy = storage.copy(users);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onGetSubscribedUserListResult(requestId, channel, topicCopy, usersCopy, errorCode);
+  });
+}
+
+// MARK: - Client results
+
+void QueuedRtmEventHandler::onConnectionStateChanged(const char* channelName, RTM_CONNECTION_STATE state,
+                                                     RTM_CONNECTION_CHANGE_REASON reason) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onConnectionStateChanged(channel, state, reason); });
+}
+
+void QueuedRtmEventHandler::onTokenPrivilegeWillExpire(const char* channelName) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) { target.onTokenPrivilegeWillExpire(channel); });
+}
+
+void QueuedRtmEventHandler::onSubscribeResult(const uint64_t requestId, const char* channelName,
+                                              RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) { target.onSubscribeResult(requestId, channel, errorCode); });
+}
+
+void QueuedRtmEventHandler::onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                                                RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onUnsubscribeResult(requestId, channel, errorCode); });
+}
+
+void QueuedRtmEventHandler::onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  post([=](IRtmEventHandler& target) { target.onPublishResult(requestId, errorCode); });
+}
+
+void QueuedRtmEventHandler::onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  post([=](IRtmEventHandler& target) { target.onLoginResult(requestId, errorCode); });
+}
+
+void QueuedRtmEventHandler::onLogoutResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  post([=](IRtmEventHandler& target) { target.onLogoutResult(requestId, errorCode); });
+}
+
+void QueuedRtmEventHandler::onRenewTokenResult(const uint64_t requestId, RTM_SERVICE_TYPE serverType,
+                                               const char* channelName, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onRenewTokenResult(requestId, serverType, channel, errorCode);
+  });
+}
+
+// MARK: - Storage results
+
+void QueuedRtmEventHandler::onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                       RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onSetChannelMetadataResult(requestId, channel, channelType, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                          RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onUpdateChannelMetadataResult(requestId, channel, channelType, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                          RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onRemoveChannelMetadataResult(requestId, channel, channelType, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                       RTM_CHANNEL_TYPE channelType, const Metadata& data,
+                                                       RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  Metadata dataCopy = storage.copy(data);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onGetChannelMetadataResult(requestId, channel, channelType, dataCopy, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                    RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onSetUserMetadataResult(requestId, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                       RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onUpdateUserMetadataResult(requestId, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                       RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onRemoveUserMetadataResult(requestId, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onGetUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                    const Metadata& data, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  Metadata dataCopy = storage.copy(data);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onGetUserMetadataResult(requestId, user, dataCopy, errorCode); });
+}
+
+void QueuedRtmEventHandler::onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                          RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onSubscribeUserMetadataResult(requestId, user, errorCode); });
+}
+
+void QueuedRtmEventHandler::onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                            RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* user = storage.copy(userId);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onUnsubscribeUserMetadataResult(requestId, user, errorCode); });
+}
+
+// MARK: - Lock results
+
+void QueuedRtmEventHandler::onSetLockResult(const uint64_t requestId, const char* channelName,
+                                            RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                            RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* lock = storage.copy(lockName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onSetLockResult(requestId, channel, channelType, lock, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onRemoveLockResult(const uint64_t requestId, const char* channelName,
+                                               RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                               RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* lock = storage.copy(lockName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onRemoveLockResult(requestId, channel, channelType, lock, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onReleaseLockResult(const uint64_t requestId, const char* channelName,
+                                                RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* lock = storage.copy(lockName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onReleaseLockResult(requestId, channel, channelType, lock, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onAcquireLockResult(const uint64_t requestId, const char* channelName,
+                                                RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                                RTM_ERROR_CODE errorCode, const char* errorDetails) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* lock = storage.copy(lockName);
+  const char* details = storage.copy(errorDetails);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onAcquireLockResult(requestId, channel, channelType, lock, errorCode, details);
+  });
+}
+
+void QueuedRtmEventHandler::onRevokeLockResult(const uint64_t requestId, const char* channelName,
+                                               RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                               RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const char* lock = storage.copy(lockName);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onRevokeLockResult(requestId, channel, channelType, lock, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onGetLocksResult(const uint64_t requestId, const char* channelName,
+                                             RTM_CHANNEL_TYPE channelType, const LockDetail* lockDetailList,
+                                             const size_t count, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const char* channel = storage.copy(channelName);
+  const LockDetail* details = storage.copy(lockDetailList, count);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onGetLocksResult(requestId, channel, channelType, details, details ? count : 0, errorCode);
+  });
+}
+
+// MARK: - Presence results
+
+void QueuedRtmEventHandler::onWhoNowResult(const uint64_t requestId, const UserState* userStateList,
+                                           const size_t count, const char* nextPage, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const UserState* states = storage.copy(userStateList, count);
+  const char* page = storage.copy(nextPage);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onWhoNowResult(requestId, states, states ? count : 0, page, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onGetOnlineUsersResult(const uint64_t requestId, const UserState* userStateList,
+                                                   const size_t count, const char* nextPage,
+                                                   RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const UserState* states = storage.copy(userStateList, count);
+  const char* page = storage.copy(nextPage);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onGetOnlineUsersResult(requestId, states, states ? count : 0, page, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onWhereNowResult(const uint64_t requestId, const ChannelInfo* channels,
+                                             const size_t count, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const ChannelInfo* copies = storage.copy(channels, count);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onWhereNowResult(requestId, copies, copies ? count : 0, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onGetUserChannelsResult(const uint64_t requestId, const ChannelInfo* channels,
+                                                    const size_t count, RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  const ChannelInfo* copies = storage.copy(channels, count);
+  post(std::move(storage), [=](IRtmEventHandler& target) {
+    target.onGetUserChannelsResult(requestId, copies, copies ? count : 0, errorCode);
+  });
+}
+
+void QueuedRtmEventHandler::onPresenceSetStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  post([=](IRtmEventHandler& target) { target.onPresenceSetStateResult(requestId, errorCode); });
+}
+
+void QueuedRtmEventHandler::onPresenceRemoveStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  post([=](IRtmEventHandler& target) { target.onPresenceRemoveStateResult(requestId, errorCode); });
+}
+
+void QueuedRtmEventHandler::onPresenceGetStateResult(const uint64_t requestId, const UserState& state,
+                                                     RTM_ERROR_CODE errorCode) {
+  RtmEventArena storage(pool_);
+  UserState copy = storage.copy(state);
+  post(std::move(storage),
+       [=](IRtmEventHandler& target) { target.onPresenceGetStateResult(requestId, copy, errorCode); });
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,203 @@
+//
+//  QueuedRtmEventHandler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Common/MpscRing.h"
+#include "Events/RtmEventArena.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// `IRtmEventHandler` adapter that takes work off the SDK callback thread.
+///
+/// Every callback deep-copies its arguments into an `RtmEventArena`, builds the queued call in the same arena,
+/// pushes it onto a bounded MPSC ring and returns. Once the block pool is warm, that takes no lock and no
+/// allocation. The wrapped handler is called on the consumer thread started by `start()`, or on whichever thread
+/// calls `drain()`, in the order the callbacks were queued by each producer thread.
+class QueuedRtmEventHandler : public agora::rtm::IRtmEventHandler {
+ public:
+  enum class OverflowPolicy {
+    /// Drop the incoming callback and count it in `Stats::dropped`.
+    dropNewest,
+    /// Spin on the SDK thread until the consumer frees a slot.
+    block,
+  };
+
+  struct Options {
+    size_t capacity = 8192;
+    /// Callbacks delivered per consumer wake-up before re-checking for stop.
+    size_t maxBatch = 256;
+    OverflowPolicy overflow = OverflowPolicy::dropNewest;
+    /// Where callback copies get their arena blocks; null means `RtmEventBlockPool::shared()`.
+    RtmEventBlockPool* pool = nullptr;
+    /// Runs on the producer thread after each queued callback, for queues drained by an outside event loop
+    /// rather than by `start()`.
+    std::function<void()> notify;
+  };
+
+  struct Stats {
+    size_t depth = 0;
+    size_t highWatermark = 0;
+    uint64_t enqueued = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t batches = 0;
+  };
+
+  explicit QueuedRtmEventHandler(agora::rtm::IRtmEventHandler& target);
+  QueuedRtmEventHandler(agora::rtm::IRtmEventHandler& target, const Options& options);
+  ~QueuedRtmEventHandler() override;
+
+  QueuedRtmEventHandler(const QueuedRtmEventHandler&) = delete;
+  QueuedRtmEventHandler& operator=(const QueuedRtmEventHandler&) = delete;
+
+  /// Starts the consumer thread. Idempotent.
+  void start();
+  /// Delivers everything already queued, then joins the consumer thread.
+  void stop();
+  /// Delivers up to `maxEvents` queued callbacks on the calling thread. Only valid while the consumer
+  /// thread is not running. Returns the number delivered.
+  size_t drain(size_t maxEvents = SIZE_MAX);
+
+  size_t depth() const { return ring_.size(); }
+  Stats stats() const;
+
+  void onLinkStateEvent(const LinkStateEvent& event) override;
+  void onMessageEvent(const MessageEvent& event) override;
+  void onPresenceEvent(const PresenceEvent& event) override;
+  void onTopicEvent(const TopicEvent& event) override;
+  void onLockEvent(const LockEvent& event) override;
+  void onStorageEvent(const StorageEvent& event) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                         const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                          const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                              const char* topic, agora::rtm::UserList succeedUsers, agora::rtm::UserList failedUsers,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                     agora::rtm::UserList users, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onConnectionStateChanged(const char* channelName, agora::rtm::RTM_CONNECTION_STATE state,
+                                agora::rtm::RTM_CONNECTION_CHANGE_REASON reason) override;
+  void onTokenPrivilegeWillExpire(const char* channelName) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLoginResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLogoutResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRenewTokenResult(const uint64_t requestId, agora::rtm::RTM_SERVICE_TYPE serverType, const char* channelName,
+                          agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserMetadataResult(const uint64_t requestId, const char* userId, const agora::rtm::Metadata& data,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                       agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                       const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onReleaseLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onAcquireLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode,
+                           const char* errorDetails) override;
+  void onRevokeLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetLocksResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                        const agora::rtm::LockDetail* lockDetailList, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhereNowResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserChannelsResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceRemoveStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceGetStateResult(const uint64_t requestId, const agora::rtm::UserState& state,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  class Callback;
+  template <typename Call>
+  class StoredCallback;
+  /// Destroys a callback, which gives back the arena blocks it lives in.
+  struct CallbackDeleter {
+    void operator()(Callback* callback) const;
+  };
+  using CallbackPtr = std::unique_ptr<Callback, CallbackDeleter>;
+
+  /// Queues `call` with the arena that holds its copies.
+  template <typename Call>
+  void post(RtmEventArena&& storage, Call&& call);
+  /// Queues a `call` whose arguments are all values.
+  template <typename Call>
+  void post(Call&& call);
+  void enqueue(CallbackPtr callback);
+  size_t deliverBatch(std::vector<CallbackPtr>& batch, size_t maxEvents);
+  void run();
+
+  agora::rtm::IRtmEventHandler& target_;
+  const Options options_;
+  RtmEventBlockPool& pool_;
+  MpscRing<CallbackPtr> ring_;
+  std::thread consumer_;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> consumerSleeping_{false};
+  std::atomic<uint32_t> wakeups_{0};
+
+  std::atomic<uint64_t> enqueued_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> delivered_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<size_t> highWatermark_{0};
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,136 @@
+//
+//  ReassemblingEventHandler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/ReassemblingEventHandler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Common/Varint.h"
+#include "Publishing/MessageChunk.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+ReassemblingEventHandler::ReassemblingEventHandler(IRtmEventHandler& next, RtmClock::time_point now)
+    : ReassemblingEventHandler(next, now, Options()) {}
+
+ReassemblingEventHandler::ReassemblingEventHandler(IRtmEventHandler& next, RtmClock::time_point now,
+                                                   Options options)
+    : ForwardingRtmEventHandler(next), options_(options), now_(now) {}
+
+size_t ReassemblingEventHandler::poll(RtmClock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (now > now_) now_ = now;
+  size_t expired = 0;
+  for (auto it = transfers_.begin(); it != transfers_.end();) {
+    if (it->second.touched + options_.timeout > now_) {
+      ++it;
+      continue;
+    }
+    stats_.bufferedBytes -= it->second.payload.size();
+    it = transfers_.erase(it);
+    ++expired;
+  }
+  stats_.expired += expired;
+  stats_.pendingTransfers = transfers_.size();
+  return expired;
+}
+
+RtmClock::time_point ReassemblingEventHandler::nextDeadline() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RtmClock::time_point deadline = RtmClock::time_point::max();
+  for (const auto& [key, transfer] : transfers_) deadline = std::min(deadline, transfer.touched + options_.timeout);
+  return deadline;
+}
+
+ReassemblingEventHandler::Stats ReassemblingEventHandler::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ReassemblingEventHandler::onMessageEvent(const MessageEvent& event) {
+  if (!MessageChunk::isChunk(event)) {
+    next().onMessageEvent(event);
+    return;
+  }
+  MessageChunk::Header header;
+  std::string_view slice;
+  std::string payload;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.fragments;
+    if (!MessageChunk::read(event, header, slice)) {
+      ++stats_.malformed;
+      return;
+    }
+    key_.assign(viewOf(event.publisher));
+    key_.push_back('\0');
+    key_.push_back(static_cast<char>(event.channelType));
+    key_.append(viewOf(event.channelName));
+    key_.push_back('\0');
+    key_.append(viewOf(event.channelTopic));
+    key_.push_back('\0');
+    appendVarint(key_, header.transferId);
+
+    auto found = transfers_.find(key_);
+    if (found == transfers_.end()) {
+      if (!fits(header.length)) {
+        ++stats_.rejected;
+        return;
+      }
+      found = transfers_.emplace(key_, Transfer()).first;
+      Transfer& created = found->second;
+      created.payload.resize(header.length);
+      created.received.assign(header.count, false);
+      created.remaining = header.count;
+      stats_.bufferedBytes += header.length;
+      stats_.pendingTransfers = transfers_.size();
+    }
+    Transfer& transfer = found->second;
+    transfer.touched = now_;
+    // Fragments of one transfer must agree on its shape.
+    if (transfer.payload.size() != header.length || transfer.received.size() != header.count) {
+      ++stats_.malformed;
+      return;
+    }
+    if (transfer.received[header.index]) {
+      ++stats_.duplicates;
+      return;
+    }
+    transfer.received[header.index] = true;
+    uint64_t offset = header.index * MessageChunk::sliceLength(header.length, header.count);
+    transfer.payload.replace(offset, slice.size(), slice);
+    if (--transfer.remaining > 0) return;
+
+    payload = std::move(transfer.payload);
+    stats_.bufferedBytes -= payload.size();
+    transfers_.erase(found);
+    stats_.pendingTransfers = transfers_.size();
+    ++stats_.messages;
+  }
+  // Delivered outside the lock; `header.customType` still points into the fragment, which outlives the call.
+  std::string customType(header.customType);
+  MessageEvent message = event;
+  message.messageType = header.messageType;
+  message.message = payload.data();
+  message.messageLength = payload.size();
+  message.customType = customType.empty() ? nullptr : customType.c_str();
+  next().onMessageEvent(message);
+}
+
+// MARK: - Private
+
+bool ReassemblingEventHandler::fits(uint64_t length) const {
+  return length <= options_.maxMessageLength && transfers_.size() < options_.maxTransfers &&
+         stats_.bufferedBytes + length <= options_.maxBufferedBytes;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,86 @@
+//
+//  ReassemblingEventHandler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "Events/ForwardingRtmEventHandler.h"
+
+namespace flat {
+namespace rtm {
+
+/// Receiving side of `ChunkingPublisher`: collects `MessageChunk` fragments per publisher, channel and transfer,
+/// and delivers one `onMessageEvent` with the whole message, its own type and customType, once the last fragment
+/// is in. It carries the channel, topic, publisher and timestamp of the fragment that completed it. Every other
+/// callback, and every message that is not a fragment, passes through unchanged.
+///
+/// Buffering is bounded: a transfer larger than `maxMessageLength`, or one that would push the partial transfers
+/// past `maxTransfers` or `maxBufferedBytes`, is dropped and counted. A transfer that receives no fragment for
+/// `timeout` is dropped by `poll(now)`. Arrivals are stamped with the `now` of the latest `poll`, so timeouts
+/// are as precise as the polling.
+class ReassemblingEventHandler : public ForwardingRtmEventHandler {
+ public:
+  struct Options {
+    size_t maxMessageLength = 4 * 1024 * 1024;
+    size_t maxBufferedBytes = 16 * 1024 * 1024;
+    size_t maxTransfers = 64;
+    std::chrono::milliseconds timeout{10000};
+  };
+
+  struct Stats {
+    uint64_t fragments = 0;
+    uint64_t messages = 0;
+    uint64_t duplicates = 0;
+    uint64_t malformed = 0;
+    /// Fragments dropped because their transfer would exceed a bound; each later fragment of it counts again.
+    uint64_t rejected = 0;
+    uint64_t expired = 0;
+    size_t pendingTransfers = 0;
+    size_t bufferedBytes = 0;
+  };
+
+  ReassemblingEventHandler(agora::rtm::IRtmEventHandler& next, RtmClock::time_point now);
+  ReassemblingEventHandler(agora::rtm::IRtmEventHandler& next, RtmClock::time_point now, Options options);
+
+  /// Drops the transfers that timed out. Returns the number dropped.
+  size_t poll(RtmClock::time_point now);
+  /// When the oldest partial transfer times out, or `time_point::max()` when none is pending.
+  RtmClock::time_point nextDeadline() const;
+
+  Stats stats() const;
+
+  void onMessageEvent(const MessageEvent& event) override;
+
+ private:
+  struct Transfer {
+    std::string payload;
+    std::vector<bool> received;
+    uint64_t remaining = 0;
+    RtmClock::time_point touched;
+  };
+
+  /// Whether a new transfer of `length` bytes stays within the bounds.
+  bool fits(uint64_t length) const;
+
+  Options options_;
+  mutable std::mutex mutex_;
+  /// Keyed by publisher, channel type, channel name, topic and transfer id.
+  StringMap<Transfer> transfers_;
+  std::string key_;
+  RtmClock::time_point now_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,419 @@
+//
+//  RtmEventArena.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/RtmEventArena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+namespace {
+
+using LinkStateEvent = IRtmEventHandler::LinkStateEvent;
+using MessageEvent = IRtmEventHandler::MessageEvent;
+using PresenceEvent = IRtmEventHandler::PresenceEvent;
+using TopicEvent = IRtmEventHandler::TopicEvent;
+using LockEvent = IRtmEventHandler::LockEvent;
+using StorageEvent = IRtmEventHandler::StorageEvent;
+
+// Footprints are upper bounds: every array pays its worst-case alignment padding.
+
+size_t stringSize(const char* value) { return value ? std::strlen(value) + 1 : 0; }
+
+template <typename T>
+size_t arraySize(size_t count) {
+  return count ? sizeof(T) * count + alignof(T) - 1 : 0;
+}
+
+size_t stringsSize(const char* const* values, size_t count) {
+  if (!values) return 0;
+  size_t size = arraySize<const char*>(count);
+  for (size_t i = 0; i < count; ++i) size += stringSize(values[i]);
+  return size;
+}
+
+size_t stateItemsSize(const StateItem* items, size_t count) {
+  if (!items) return 0;
+  size_t size = arraySize<StateItem>(count);
+  for (size_t i = 0; i < count; ++i) size += stringSize(items[i].key) + stringSize(items[i].value);
+  return size;
+}
+
+size_t userStatesSize(const UserState* states, size_t count) {
+  if (!states) return 0;
+  size_t size = arraySize<UserState>(count);
+  for (size_t i = 0; i < count; ++i) {
+    size += stringSize(states[i].userId) + stateItemsSize(states[i].states, states[i].statesCount);
+  }
+  return size;
+}
+
+size_t metadataSize(const Metadata& data) {
+  if (!data.items) return 0;
+  size_t size = arraySize<MetadataItem>(data.itemCount);
+  for (size_t i = 0; i < data.itemCount; ++i) {
+    const MetadataItem& item = data.items[i];
+    size += stringSize(item.key) + stringSize(item.value) + stringSize(item.authorUserId);
+  }
+  return size;
+}
+
+}  // namespace
+
+// MARK: - RtmEventBlockPool
+
+RtmEventBlockPool::RtmEventBlockPool() : RtmEventBlockPool(Options()) {}
+
+RtmEventBlockPool::RtmEventBlockPool(const Options& options) : options_(options) {
+  if (options_.maxCachedPerClass == 0) return;
+  size_t smallest = std::bit_ceil(options_.minBlockSize);
+  for (size_t capacity = smallest; capacity <= options_.maxCachedBlockSize; capacity <<= 1) {
+    size_t sizeClass = static_cast<size_t>(std::countr_zero(capacity));
+    if (sizeClass >= kClassCount) break;
+    classes_[sizeClass] = std::make_unique<MpmcRing<void*>>(options_.maxCachedPerClass);
+  }
+}
+
+RtmEventBlockPool::~RtmEventBlockPool() {
+  void* block = nullptr;
+  for (auto& blocks : classes_) {
+    while (blocks && blocks->tryPop(block)) ::operator delete(block);
+  }
+}
+
+RtmEventBlockPool& RtmEventBlockPool::shared() {
+  static RtmEventBlockPool pool;
+  return pool;
+}
+
+MpmcRing<void*>* RtmEventBlockPool::blocksOf(size_t capacity) const {
+  size_t sizeClass = static_cast<size_t>(std::countr_zero(capacity));
+  return capacity <= options_.maxCachedBlockSize && sizeClass < kClassCount ? classes_[sizeClass].get() : nullptr;
+}
+
+void* RtmEventBlockPool::acquire(size_t size, size_t& capacity) {
+  capacity = std::bit_ceil(std::max(size, options_.minBlockSize));
+  MpmcRing<void*>* blocks = blocksOf(capacity);
+  void* block = nullptr;
+  if (blocks && blocks->tryPop(block)) {
+    reuses_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(capacity);
+}
+
+void RtmEventBlockPool::release(void* block, size_t capacity) {
+  MpmcRing<void*>* blocks = blocksOf(capacity);
+  if (blocks && blocks->tryPush(block)) return;
+  ::operator delete(block);
+}
+
+RtmEventBlockPool::Stats RtmEventBlockPool::stats() const {
+  Stats stats;
+  stats.allocations = allocations_.load(std::memory_order_relaxed);
+  stats.reuses = reuses_.load(std::memory_order_relaxed);
+  for (const auto& blocks : classes_) {
+    if (blocks) stats.cachedBlocks += blocks->size();
+  }
+  return stats;
+}
+
+// MARK: - RtmEventArena
+
+RtmEventArena::RtmEventArena(RtmEventBlockPool& pool) : pool_(&pool) {}
+
+RtmEventArena::~RtmEventArena() { reset(); }
+
+RtmEventArena::RtmEventArena(RtmEventArena&& other) noexcept
+    : pool_(other.pool_),
+      head_(std::exchange(other.head_, nullptr)),
+      cursor_(std::exchange(other.cursor_, nullptr)),
+      end_(std::exchange(other.end_, nullptr)),
+      blockCount_(std::exchange(other.blockCount_, 0)),
+      bytesUsed_(std::exchange(other.bytesUsed_, 0)) {}
+
+RtmEventArena& RtmEventArena::operator=(RtmEventArena&& other) noexcept {
+  if (this != &other) {
+    reset();
+    pool_ = other.pool_;
+    head_ = std::exchange(other.head_, nullptr);
+    cursor_ = std::exchange(other.cursor_, nullptr);
+    end_ = std::exchange(other.end_, nullptr);
+    blockCount_ = std::exchange(other.blockCount_, 0);
+    bytesUsed_ = std::exchange(other.bytesUsed_, 0);
+  }
+  return *this;
+}
+
+void RtmEventArena::reset() {
+  while (head_) {
+    Block* next = head_->next;
+    pool_->release(head_, head_->capacity);
+    head_ = next;
+  }
+  cursor_ = end_ = nullptr;
+  blockCount_ = 0;
+  bytesUsed_ = 0;
+}
+
+void RtmEventArena::addBlock(size_t bytes) {
+  size_t capacity = 0;
+  void* memory = pool_->acquire(bytes + sizeof(Block), capacity);
+  head_ = new (memory) Block{head_, capacity};
+  cursor_ = static_cast<char*>(memory) + sizeof(Block);
+  end_ = static_cast<char*>(memory) + capacity;
+  ++blockCount_;
+}
+
+void RtmEventArena::reserve(size_t bytes) {
+  if (bytes == 0 || static_cast<size_t>(end_ - cursor_) >= bytes) return;
+  addBlock(bytes);
+}
+
+void* RtmEventArena::allocate(size_t size, size_t alignment) {
+  auto alignUp = [alignment](char* pointer) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return reinterpret_cast<char*>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+  };
+  char* result = alignUp(cursor_);
+  if (!head_ || result + size > end_) {
+    addBlock(size + alignment - 1);
+    result = alignUp(cursor_);
+  }
+  cursor_ = result + size;
+  bytesUsed_ += size;
+  return result;
+}
+
+// MARK: - Copies
+
+const char* RtmEventArena::copy(const char* value) {
+  if (!value) return nullptr;
+  return copy(value, std::strlen(value));
+}
+
+const char* RtmEventArena::copy(const char* data, size_t length) {
+  if (!data) return nullptr;
+  char* copy = static_cast<char*>(allocate(length + 1, 1));
+  std::memcpy(copy, data, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+const char** RtmEventArena::copyStrings(const char* const* values, size_t count) {
+  if (!values) return nullptr;
+  const char** copies = allocateArray<const char*>(count);
+  for (size_t i = 0; i < count; ++i) copies[i] = copy(values[i]);
+  return copies;
+}
+
+UserList RtmEventArena::copy(const UserList& list) {
+  UserList copy;
+  copy.users = copyStrings(list.users, list.userCount);
+  copy.userCount = copy.users ? list.userCount : 0;
+  return copy;
+}
+
+const StateItem* RtmEventArena::copy(const StateItem* items, size_t count) {
+  if (!items) return nullptr;
+  StateItem* copies = allocateArray<StateItem>(count);
+  for (size_t i = 0; i < count; ++i) {
+    copies[i].key = copy(items[i].key);
+    copies[i].value = copy(items[i].value);
+  }
+  return copies;
+}
+
+UserState* RtmEventArena::copy(const UserState* states, size_t count) {
+  if (!states) return nullptr;
+  UserState* copies = allocateArray<UserState>(count);
+  for (size_t i = 0; i < count; ++i) copies[i] = copy(states[i]);
+  return copies;
+}
+
+UserState RtmEventArena::copy(const UserState& state) {
+  UserState copy;
+  copy.userId = this->copy(state.userId);
+  copy.states = this->copy(state.states, state.statesCount);
+  copy.statesCount = copy.states ? state.statesCount : 0;
+  return copy;
+}
+
+Metadata RtmEventArena::copy(const Metadata& data) {
+  Metadata copy;
+  copy.majorRevision = data.majorRevision;
+  if (!data.items) return copy;
+  copy.items = allocateArray<MetadataItem>(data.itemCount);
+  copy.itemCount = copy.items ? data.itemCount : 0;
+  for (size_t i = 0; i < copy.itemCount; ++i) {
+    const MetadataItem& item = data.items[i];
+    copy.items[i] = MetadataItem(this->copy(item.key), this->copy(item.value), item.revision);
+    copy.items[i].authorUserId = this->copy(item.authorUserId);
+    copy.items[i].updateTs = item.updateTs;
+  }
+  return copy;
+}
+
+const LockDetail* RtmEventArena::copy(const LockDetail* details, size_t count) {
+  if (!details) return nullptr;
+  LockDetail* copies = allocateArray<LockDetail>(count);
+  for (size_t i = 0; i < count; ++i) {
+    copies[i] = details[i];
+    copies[i].lockName = copy(details[i].lockName);
+    copies[i].owner = copy(details[i].owner);
+  }
+  return copies;
+}
+
+const TopicInfo* RtmEventArena::copy(const TopicInfo* topics, size_t count) {
+  if (!topics) return nullptr;
+  TopicInfo* copies = allocateArray<TopicInfo>(count);
+  for (size_t i = 0; i < count; ++i) {
+    copies[i].topic = copy(topics[i].topic);
+    copies[i].publisherCount = topics[i].publishers ? topics[i].publisherCount : 0;
+    copies[i].publishers = allocateArray<PublisherInfo>(copies[i].publisherCount);
+    for (size_t j = 0; j < copies[i].publisherCount; ++j) {
+      copies[i].publishers[j].publisherUserId = copy(topics[i].publishers[j].publisherUserId);
+      copies[i].publishers[j].publisherMeta = copy(topics[i].publishers[j].publisherMeta);
+    }
+  }
+  return copies;
+}
+
+const ChannelInfo* RtmEventArena::copy(const ChannelInfo* channels, size_t count) {
+  if (!channels) return nullptr;
+  ChannelInfo* copies = allocateArray<ChannelInfo>(count);
+  for (size_t i = 0; i < count; ++i) {
+    copies[i].channelName = copy(channels[i].channelName);
+    copies[i].channelType = channels[i].channelType;
+  }
+  return copies;
+}
+
+// MARK: - Events
+
+LinkStateEvent RtmEventArena::copy(const LinkStateEvent& event) {
+  reserve(footprint(event));
+  LinkStateEvent copy = event;
+  copy.reason = this->copy(event.reason);
+  copy.affectedChannels = copyStrings(event.affectedChannels, event.affectedChannelCount);
+  copy.unrestoredChannels = copyStrings(event.unrestoredChannels, event.unrestoredChannelCount);
+  return copy;
+}
+
+MessageEvent RtmEventArena::copy(const MessageEvent& event) {
+  reserve(footprint(event));
+  MessageEvent copy = event;
+  copy.channelName = this->copy(event.channelName);
+  copy.channelTopic = this->copy(event.channelTopic);
+  copy.message = this->copy(event.message, event.messageLength);
+  copy.publisher = this->copy(event.publisher);
+  copy.customType = this->copy(event.customType);
+  return copy;
+}
+
+PresenceEvent RtmEventArena::copy(const PresenceEvent& event) {
+  reserve(footprint(event));
+  PresenceEvent copy = event;
+  copy.channelName = this->copy(event.channelName);
+  copy.publisher = this->copy(event.publisher);
+  copy.stateItems = this->copy(event.stateItems, event.stateItemCount);
+  copy.interval.joinUserList = this->copy(event.interval.joinUserList);
+  copy.interval.leaveUserList = this->copy(event.interval.leaveUserList);
+  copy.interval.timeoutUserList = this->copy(event.interval.timeoutUserList);
+  copy.interval.userStateList = this->copy(event.interval.userStateList, event.interval.userStateCount);
+  copy.snapshot.userStateList = this->copy(event.snapshot.userStateList, event.snapshot.userCount);
+  return copy;
+}
+
+TopicEvent RtmEventArena::copy(const TopicEvent& event) {
+  reserve(footprint(event));
+  TopicEvent copy = event;
+  copy.channelName = this->copy(event.channelName);
+  copy.publisher = this->copy(event.publisher);
+  copy.topicInfos = this->copy(event.topicInfos, event.topicInfoCount);
+  return copy;
+}
+
+LockEvent RtmEventArena::copy(const LockEvent& event) {
+  reserve(footprint(event));
+  LockEvent copy = event;
+  copy.channelName = this->copy(event.channelName);
+  copy.lockDetailList = this->copy(event.lockDetailList, event.count);
+  return copy;
+}
+
+StorageEvent RtmEventArena::copy(const StorageEvent& event) {
+  reserve(footprint(event));
+  StorageEvent copy = event;
+  copy.target = this->copy(event.target);
+  copy.data = this->copy(event.data);
+  return copy;
+}
+
+// MARK: - Footprints
+
+size_t RtmEventArena::footprint(const LinkStateEvent& event) {
+  return stringSize(event.reason) + stringsSize(event.affectedChannels, event.affectedChannelCount) +
+         stringsSize(event.unrestoredChannels, event.unrestoredChannelCount);
+}
+
+size_t RtmEventArena::footprint(const MessageEvent& event) {
+  return stringSize(event.channelName) + stringSize(event.channelTopic) +
+         (event.message ? event.messageLength + 1 : 0) + stringSize(event.publisher) + stringSize(event.customType);
+}
+
+size_t RtmEventArena::footprint(const PresenceEvent& event) {
+  const PresenceEvent::IntervalInfo& interval = event.interval;
+  return stringSize(event.channelName) + stringSize(event.publisher) +
+         stateItemsSize(event.stateItems, event.stateItemCount) +
+         stringsSize(interval.joinUserList.users, interval.joinUserList.userCount) +
+         stringsSize(interval.leaveUserList.users, interval.leaveUserList.userCount) +
+         stringsSize(interval.timeoutUserList.users, interval.timeoutUserList.userCount) +
+         userStatesSize(interval.userStateList, interval.userStateCount) +
+         userStatesSize(event.snapshot.userStateList, event.snapshot.userCount);
+}
+
+size_t RtmEventArena::footprint(const TopicEvent& event) {
+  size_t size = stringSize(event.channelName) + stringSize(event.publisher);
+  if (!event.topicInfos) return size;
+  size += arraySize<TopicInfo>(event.topicInfoCount);
+  for (size_t i = 0; i < event.topicInfoCount; ++i) {
+    const TopicInfo& topic = event.topicInfos[i];
+    size += stringSize(topic.topic);
+    if (!topic.publishers) continue;
+    size += arraySize<PublisherInfo>(topic.publisherCount);
+    for (size_t j = 0; j < topic.publisherCount; ++j) {
+      size += stringSize(topic.publishers[j].publisherUserId) + stringSize(topic.publishers[j].publisherMeta);
+    }
+  }
+  return size;
+}
+
+size_t RtmEventArena::footprint(const LockEvent& event) {
+  size_t size = stringSize(event.channelName);
+  if (!event.lockDetailList) return size;
+  size += arraySize<LockDetail>(event.count);
+  for (size_t i = 0; i < event.count; ++i) {
+    size += stringSize(event.lockDetailList[i].lockName) + stringSize(event.lockDetailList[i].owner);
+  }
+  return size;
+}
+
+size_t RtmEventArena::footprint(const StorageEvent& event) {
+  return stringSize(event.target) + metadataSize(event.data);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,155 @@
+//
+//  RtmEventArena.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "Common/MpmcRing.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Thread-safe free list of arena blocks, bucketed by power-of-two size.
+///
+/// Blocks released on one thread (a consumer) are reused by another (the SDK callback thread), so a
+/// steady event stream stops touching the allocator once the pool is warm. Each size class is a lock-free
+/// ring, so neither side ever waits on the other.
+class RtmEventBlockPool {
+ public:
+  struct Options {
+    /// Smallest block handed out; small events share one size class.
+    size_t minBlockSize = 512;
+    /// Blocks above this size are freed instead of cached.
+    size_t maxCachedBlockSize = 1 << 20;
+    /// Cached blocks kept per size class, rounded up to a power of two.
+    size_t maxCachedPerClass = 256;
+  };
+
+  struct Stats {
+    uint64_t allocations = 0;
+    uint64_t reuses = 0;
+    size_t cachedBlocks = 0;
+  };
+
+  RtmEventBlockPool();
+  explicit RtmEventBlockPool(const Options& options);
+  ~RtmEventBlockPool();
+
+  RtmEventBlockPool(const RtmEventBlockPool&) = delete;
+  RtmEventBlockPool& operator=(const RtmEventBlockPool&) = delete;
+
+  static RtmEventBlockPool& shared();
+
+  /// Returns a block of at least `size` bytes and sets `capacity` to its real size.
+  void* acquire(size_t size, size_t& capacity);
+  /// `capacity` must be the value `acquire` reported for this block.
+  void release(void* block, size_t capacity);
+
+  Stats stats() const;
+
+ private:
+  static constexpr size_t kClassCount = 32;
+
+  /// The free blocks of `capacity`, a power of two; null when blocks of that size are not cached.
+  MpmcRing<void*>* blocksOf(size_t capacity) const;
+
+  const Options options_;
+  /// Free blocks per size class; null for the classes that are never cached.
+  std::array<std::unique_ptr<MpmcRing<void*>>, kClassCount> classes_;
+  std::atomic<uint64_t> allocations_{0};
+  std::atomic<uint64_t> reuses_{0};
+};
+
+/// Owning deep copy of RTM event payloads.
+///
+/// The SDK's event structs are graphs of borrowed `const char*` and arrays that die when the callback
+/// returns. The `copy` overloads rebuild them inside bump-allocated blocks with every pointer fixed up to
+/// the copy. Event copies reserve their exact footprint first, so a whole event tree, including a
+/// 500-user `SnapshotInfo`, lands in one block. Blocks go back to the pool on `reset()` or destruction.
+/// Moving an arena keeps every copied pointer valid.
+class RtmEventArena {
+ public:
+  explicit RtmEventArena(RtmEventBlockPool& pool = RtmEventBlockPool::shared());
+  ~RtmEventArena();
+
+  RtmEventArena(RtmEventArena&& other) noexcept;
+  RtmEventArena& operator=(RtmEventArena&& other) noexcept;
+  RtmEventArena(const RtmEventArena&) = delete;
+  RtmEventArena& operator=(const RtmEventArena&) = delete;
+
+  /// Makes sure the next `bytes` of allocations come from a single block.
+  void reserve(size_t bytes);
+  /// Returns every block to the pool. Pointers from earlier copies become invalid.
+  void reset();
+
+  size_t blockCount() const { return blockCount_; }
+  size_t bytesUsed() const { return bytesUsed_; }
+
+  void* allocate(size_t size, size_t alignment);
+
+  template <typename T>
+  T* allocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>, "arena memory is released without running destructors");
+    if (count == 0) return nullptr;
+    T* items = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    for (size_t i = 0; i < count; ++i) new (items + i) T();
+    return items;
+  }
+
+  const char* copy(const char* value);
+  const char* copy(const char* data, size_t length);
+  const char** copyStrings(const char* const* values, size_t count);
+  agora::rtm::UserList copy(const agora::rtm::UserList& list);
+  const agora::rtm::StateItem* copy(const agora::rtm::StateItem* items, size_t count);
+  agora::rtm::UserState* copy(const agora::rtm::UserState* states, size_t count);
+  agora::rtm::UserState copy(const agora::rtm::UserState& state);
+  agora::rtm::Metadata copy(const agora::rtm::Metadata& data);
+  const agora::rtm::LockDetail* copy(const agora::rtm::LockDetail* details, size_t count);
+  const agora::rtm::TopicInfo* copy(const agora::rtm::TopicInfo* topics, size_t count);
+  const agora::rtm::ChannelInfo* copy(const agora::rtm::ChannelInfo* channels, size_t count);
+
+  agora::rtm::IRtmEventHandler::LinkStateEvent copy(const agora::rtm::IRtmEventHandler::LinkStateEvent& event);
+  agora::rtm::IRtmEventHandler::MessageEvent copy(const agora::rtm::IRtmEventHandler::MessageEvent& event);
+  agora::rtm::IRtmEventHandler::PresenceEvent copy(const agora::rtm::IRtmEventHandler::PresenceEvent& event);
+  agora::rtm::IRtmEventHandler::TopicEvent copy(const agora::rtm::IRtmEventHandler::TopicEvent& event);
+  agora::rtm::IRtmEventHandler::LockEvent copy(const agora::rtm::IRtmEventHandler::LockEvent& event);
+  agora::rtm::IRtmEventHandler::StorageEvent copy(const agora::rtm::IRtmEventHandler::StorageEvent& event);
+
+  /// Upper bound of the arena bytes `copy(event)` uses.
+  static size_t footprint(const agora::rtm::IRtmEventHandler::LinkStateEvent& event);
+  static size_t footprint(const agora::rtm::IRtmEventHandler::MessageEvent& event);
+  static size_t footprint(const agora::rtm::IRtmEventHandler::PresenceEvent& event);
+  static size_t footprint(const agora::rtm::IRtmEventHandler::TopicEvent& event);
+  static size_t footprint(const agora::rtm::IRtmEventHandler::LockEvent& event);
+  static size_t footprint(const agora::rtm::IRtmEventHandler::StorageEvent& event);
+
+ private:
+  struct Block {
+    Block* next;
+    size_t capacity;
+  };
+
+  void addBlock(size_t bytes);
+
+  RtmEventBlockPool* pool_;
+  Block* head_ = nullptr;
+  char* cursor_ = nullptr;
+  char* end_ = nullptr;
+  size_t blockCount_ = 0;
+  size_t bytesUsed_ = 0;
+};
+
+}  // namespace rtm
+}  // namespace flat
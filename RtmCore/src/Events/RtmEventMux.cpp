@@ -0,0 +1,386 @@
+//
+//  RtmEventMux.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Events/RtmEventMux.h"
+
+#include <algorithm>
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+namespace {
+
+bool contains(const std::vector<std::string>& values, std::string_view value) {
+  return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+}  // namespace
+
+RtmEventMux::RtmEventMux() : index_(buildIndex({})) {}
+
+RtmEventMux::~RtmEventMux() = default;
+
+RtmEventMux::HandlerId RtmEventMux::add(IRtmEventHandler& handler) { return add(handler, Filter()); }
+
+RtmEventMux::HandlerId RtmEventMux::add(IRtmEventHandler& handler, Filter filter) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  HandlerId id = ++nextId_;
+  registrations_.push_back({id, &handler, std::move(filter)});
+  index_.store(buildIndex(registrations_), std::memory_order_release);
+  return id;
+}
+
+bool RtmEventMux::remove(HandlerId id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = std::find_if(registrations_.begin(), registrations_.end(),
+                            [id](const Registration& registration) { return registration.id == id; });
+  if (found == registrations_.end()) return false;
+  registrations_.erase(found);
+  index_.store(buildIndex(registrations_), std::memory_order_release);
+  return true;
+}
+
+size_t RtmEventMux::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return registrations_.size();
+}
+
+std::shared_ptr<const RtmEventMux::Index> RtmEventMux::buildIndex(const std::vector<Registration>& registrations) {
+  auto index = std::make_shared<Index>();
+
+  auto buildRoute = [&registrations](Route& route, auto&& matchesChannel) {
+    StringSet topics;
+    for (const Registration& registration : registrations) {
+      if (!matchesChannel(registration.filter)) continue;
+      route.events.push_back(registration.handler);
+      if (registration.filter.topics.empty()) route.messages.push_back(registration.handler);
+      topics.insert(registration.filter.topics.begin(), registration.filter.topics.end());
+    }
+    for (const std::string& topic : topics) {
+      Targets& targets = route.topicMessages[topic];
+      for (const Registration& registration : registrations) {
+        const Filter& filter = registration.filter;
+        if (!matchesChannel(filter)) continue;
+        if (filter.topics.empty() || contains(filter.topics, topic)) targets.push_back(registration.handler);
+      }
+    }
+  };
+
+  StringSet channels;
+  for (const Registration& registration : registrations) {
+    channels.insert(registration.filter.channels.begin(), registration.filter.channels.end());
+    if (registration.filter.userEvents) index->userEvents.push_back(registration.handler);
+    if (registration.filter.results) index->results.push_back(registration.handler);
+  }
+  for (const std::string& channel : channels) {
+    buildRoute(index->channels[channel], [&channel](const Filter& filter) {
+      return filter.channels.empty() || contains(filter.channels, channel);
+    });
+  }
+  buildRoute(index->anyChannel, [](const Filter& filter) { return filter.channels.empty(); });
+  return index;
+}
+
+const RtmEventMux::Route& RtmEventMux::routeFor(const Index& index, const char* channelName) const {
+  auto found = index.channels.find(viewOf(channelName));
+  return found == index.channels.end() ? index.anyChannel : found->second;
+}
+
+template <typename Call>
+void RtmEventMux::broadcast(Call&& call) {
+  std::shared_ptr<const Index> snapshot = index();
+  for (IRtmEventHandler* handler : snapshot->results) call(*handler);
+}
+
+template <typename Call>
+void RtmEventMux::toChannel(const char* channelName, Call&& call) {
+  std::shared_ptr<const Index> snapshot = index();
+  for (IRtmEventHandler* handler : routeFor(*snapshot, channelName).events) call(*handler);
+}
+
+// MARK: - Events
+
+void RtmEventMux::onLinkStateEvent(const LinkStateEvent& event) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onLinkStateEvent(event); });
+}
+
+void RtmEventMux::onMessageEvent(const MessageEvent& event) {
+  std::shared_ptr<const Index> snapshot = index();
+  const Targets* targets = &snapshot->userEvents;
+  if (event.channelType != RTM_CHANNEL_TYPE_USER) {
+    const Route& route = routeFor(*snapshot, event.channelName);
+    targets = &route.messages;
+    if (event.channelTopic && *event.channelTopic) {
+      auto topic = route.topicMessages.find(std::string_view(event.channelTopic));
+      if (topic != route.topicMessages.end()) targets = &topic->second;
+    }
+  }
+  for (IRtmEventHandler* handler : *targets) handler->onMessageEvent(event);
+}
+
+void RtmEventMux::onPresenceEvent(const PresenceEvent& event) {
+  toChannel(event.channelName, [&](IRtmEventHandler& handler) { handler.onPresenceEvent(event); });
+}
+
+void RtmEventMux::onTopicEvent(const TopicEvent& event) {
+  toChannel(event.channelName, [&](IRtmEventHandler& handler) { handler.onTopicEvent(event); });
+}
+
+void RtmEventMux::onLockEvent(const LockEvent& event) {
+  toChannel(event.channelName, [&](IRtmEventHandler& handler) { handler.onLockEvent(event); });
+}
+
+void RtmEventMux::onStorageEvent(const StorageEvent& event) {
+  if (event.storageType == RTM_STORAGE_TYPE_USER) {
+    std::shared_ptr<const Index> snapshot = index();
+    for (IRtmEventHandler* handler : snapshot->userEvents) handler->onStorageEvent(event);
+    return;
+  }
+  toChannel(event.target, [&](IRtmEventHandler& handler) { handler.onStorageEvent(event); });
+}
+
+void RtmEventMux::onConnectionStateChanged(const char* channelName, RTM_CONNECTION_STATE state,
+                                           RTM_CONNECTION_CHANGE_REASON reason) {
+  toChannel(channelName,
+            [&](IRtmEventHandler& handler) { handler.onConnectionStateChanged(channelName, state, reason); });
+}
+
+void RtmEventMux::onTokenPrivilegeWillExpire(const char* channelName) {
+  if (viewOf(channelName).empty()) {
+    broadcast([&](IRtmEventHandler& handler) { handler.onTokenPrivilegeWillExpire(channelName); });
+    return;
+  }
+  toChannel(channelName, [&](IRtmEventHandler& handler) { handler.onTokenPrivilegeWillExpire(channelName); });
+}
+
+// MARK: - Results
+
+void RtmEventMux::onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                               RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onJoinResult(requestId, channelName, userId, errorCode); });
+}
+
+void RtmEventMux::onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onLeaveResult(requestId, channelName, userId, errorCode); });
+}
+
+void RtmEventMux::onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                              RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onPublishTopicMessageResult(requestId, channelName, topic, errorCode);
+  });
+}
+
+void RtmEventMux::onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                    const char* topic, const char* meta, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onJoinTopicResult(requestId, channelName, userId, topic, meta, errorCode);
+  });
+}
+
+void RtmEventMux::onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                     const char* topic, const char* meta, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onLeaveTopicResult(requestId, channelName, userId, topic, meta, errorCode);
+  });
+}
+
+void RtmEventMux::onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                         const char* topic, UserList succeedUsers, UserList failedUsers,
+                                         RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onSubscribeTopicResult(requestId, channelName, userId, topic, succeedUsers, failedUsers, errorCode);
+  });
+}
+
+void RtmEventMux::onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                           RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onUnsubscribeTopicResult(requestId, channelName, topic, errorCode);
+  });
+}
+
+void RtmEventMux::onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                                UserList users, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onGetSubscribedUserListResult(requestId, channelName, topic, users, errorCode);
+  });
+}
+
+void RtmEventMux::onSubscribeResult(const uint64_t requestId, const char* channelName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onSubscribeResult(requestId, channelName, errorCode); });
+}
+
+void RtmEventMux::onUnsubscribeResult(const uint64_t requestId, const char* channelName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onUnsubscribeResult(requestId, channelName, errorCode); });
+}
+
+void RtmEventMux::onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onPublishResult(requestId, errorCode); });
+}
+
+void RtmEventMux::onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onLoginResult(requestId, errorCode); });
+}
+
+void RtmEventMux::onLogoutResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onLogoutResult(requestId, errorCode); });
+}
+
+void RtmEventMux::onRenewTokenResult(const uint64_t requestId, RTM_SERVICE_TYPE serverType, const char* channelName,
+                                     RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onRenewTokenResult(requestId, serverType, channelName, errorCode);
+  });
+}
+
+void RtmEventMux::onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                             RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onSetChannelMetadataResult(requestId, channelName, channelType, errorCode);
+  });
+}
+
+void RtmEventMux::onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onUpdateChannelMetadataResult(requestId, channelName, channelType, errorCode);
+  });
+}
+
+void RtmEventMux::onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onRemoveChannelMetadataResult(requestId, channelName, channelType, errorCode);
+  });
+}
+
+void RtmEventMux::onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                             RTM_CHANNEL_TYPE channelType, const Metadata& data,
+                                             RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onGetChannelMetadataResult(requestId, channelName, channelType, data, errorCode);
+  });
+}
+
+void RtmEventMux::onSetUserMetadataResult(const uint64_t requestId, const char* userId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onSetUserMetadataResult(requestId, userId, errorCode); });
+}
+
+void RtmEventMux::onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                             RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onUpdateUserMetadataResult(requestId, userId, errorCode); });
+}
+
+void RtmEventMux::onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                             RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onRemoveUserMetadataResult(requestId, userId, errorCode); });
+}
+
+void RtmEventMux::onGetUserMetadataResult(const uint64_t requestId, const char* userId, const Metadata& data,
+                                          RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onGetUserMetadataResult(requestId, userId, data, errorCode); });
+}
+
+void RtmEventMux::onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onSubscribeUserMetadataResult(requestId, userId, errorCode); });
+}
+
+void RtmEventMux::onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                                  RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onUnsubscribeUserMetadataResult(requestId, userId, errorCode);
+  });
+}
+
+void RtmEventMux::onSetLockResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                  const char* lockName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onSetLockResult(requestId, channelName, channelType, lockName, errorCode);
+  });
+}
+
+void RtmEventMux::onRemoveLockResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                     const char* lockName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onRemoveLockResult(requestId, channelName, channelType, lockName, errorCode);
+  });
+}
+
+void RtmEventMux::onReleaseLockResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                      const char* lockName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onReleaseLockResult(requestId, channelName, channelType, lockName, errorCode);
+  });
+}
+
+void RtmEventMux::onAcquireLockResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                      const char* lockName, RTM_ERROR_CODE errorCode, const char* errorDetails) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onAcquireLockResult(requestId, channelName, channelType, lockName, errorCode, errorDetails);
+  });
+}
+
+void RtmEventMux::onRevokeLockResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                     const char* lockName, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onRevokeLockResult(requestId, channelName, channelType, lockName, errorCode);
+  });
+}
+
+void RtmEventMux::onGetLocksResult(const uint64_t requestId, const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                   const LockDetail* lockDetailList, const size_t count, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onGetLocksResult(requestId, channelName, channelType, lockDetailList, count, errorCode);
+  });
+}
+
+void RtmEventMux::onWhoNowResult(const uint64_t requestId, const UserState* userStateList, const size_t count,
+                                 const char* nextPage, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onWhoNowResult(requestId, userStateList, count, nextPage, errorCode);
+  });
+}
+
+void RtmEventMux::onGetOnlineUsersResult(const uint64_t requestId, const UserState* userStateList, const size_t count,
+                                         const char* nextPage, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onGetOnlineUsersResult(requestId, userStateList, count, nextPage, errorCode);
+  });
+}
+
+void RtmEventMux::onWhereNowResult(const uint64_t requestId, const ChannelInfo* channels, const size_t count,
+                                   RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onWhereNowResult(requestId, channels, count, errorCode); });
+}
+
+void RtmEventMux::onGetUserChannelsResult(const uint64_t requestId, const ChannelInfo* channels, const size_t count,
+                                          RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) {
+    handler.onGetUserChannelsResult(requestId, channels, count, errorCode);
+  });
+}
+
+void RtmEventMux::onPresenceSetStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onPresenceSetStateResult(requestId, errorCode); });
+}
+
+void RtmEventMux::onPresenceRemoveStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onPresenceRemoveStateResult(requestId, errorCode); });
+}
+
+void RtmEventMux::onPresenceGetStateResult(const uint64_t requestId, const UserState& state,
+                                           RTM_ERROR_CODE errorCode) {
+  broadcast([&](IRtmEventHandler& handler) { handler.onPresenceGetStateResult(requestId, state, errorCode); });
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,188 @@
+//
+//  RtmEventMux.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Fans one `RtmConfig::eventHandler` out to many registered handlers.
+///
+/// Channel-scoped callbacks (messages, presence, topic, lock and channel storage events, token expiry,
+/// connection state) are routed through a hash index rebuilt on every `add`/`remove`, so a handler only
+/// sees the channels and topics in its `Filter`. Request results and link state carry no routing key and
+/// go to every handler that keeps `Filter::results` (requestIds are unique per client, so each handler
+/// ignores ids it did not issue). Channels are matched by name regardless of channel type.
+///
+/// Dispatch is lock-free against registration. `remove` does not wait for callbacks already in flight on
+/// the SDK thread.
+class RtmEventMux : public agora::rtm::IRtmEventHandler {
+ public:
+  using HandlerId = uint64_t;
+
+  struct Filter {
+    /// Empty matches every channel.
+    std::vector<std::string> channels;
+    /// Empty delivers every message of a matched channel; otherwise only messages on these topics.
+    std::vector<std::string> topics;
+    /// `RTM_CHANNEL_TYPE_USER` messages and user metadata events.
+    bool userEvents = true;
+    /// Request results, link state and other callbacks without a channel.
+    bool results = true;
+  };
+
+  RtmEventMux();
+  ~RtmEventMux() override;
+
+  RtmEventMux(const RtmEventMux&) = delete;
+  RtmEventMux& operator=(const RtmEventMux&) = delete;
+
+  HandlerId add(agora::rtm::IRtmEventHandler& handler);
+  HandlerId add(agora::rtm::IRtmEventHandler& handler, Filter filter);
+  bool remove(HandlerId id);
+  size_t size() const;
+
+  void onLinkStateEvent(const LinkStateEvent& event) override;
+  void onMessageEvent(const MessageEvent& event) override;
+  void onPresenceEvent(const PresenceEvent& event) override;
+  void onTopicEvent(const TopicEvent& event) override;
+  void onLockEvent(const LockEvent& event) override;
+  void onStorageEvent(const StorageEvent& event) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                         const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                          const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                              const char* topic, agora::rtm::UserList succeedUsers, agora::rtm::UserList failedUsers,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                     agora::rtm::UserList users, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onConnectionStateChanged(const char* channelName, agora::rtm::RTM_CONNECTION_STATE state,
+                                agora::rtm::RTM_CONNECTION_CHANGE_REASON reason) override;
+  void onTokenPrivilegeWillExpire(const char* channelName) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLoginResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLogoutResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRenewTokenResult(const uint64_t requestId, agora::rtm::RTM_SERVICE_TYPE serverType, const char* channelName,
+                          agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserMetadataResult(const uint64_t requestId, const char* userId, const agora::rtm::Metadata& data,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                       agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                       const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onReleaseLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onAcquireLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode,
+                           const char* errorDetails) override;
+  void onRevokeLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetLocksResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                        const agora::rtm::LockDetail* lockDetailList, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhereNowResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserChannelsResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceRemoveStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceGetStateResult(const uint64_t requestId, const agora::rtm::UserState& state,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  using Targets = std::vector<agora::rtm::IRtmEventHandler*>;
+
+  /// Everything a channel's events can reach, in registration order.
+  struct Route {
+    /// Every handler matching the channel: presence, lock, storage and topic events.
+    Targets events;
+    /// Messages without a topic, or on a topic no handler filters for.
+    Targets messages;
+    StringMap<Targets> topicMessages;
+  };
+
+  struct Index {
+    StringMap<Route> channels;
+    /// Used for channels no filter names: only handlers without a channel filter.
+    Route anyChannel;
+    Targets userEvents;
+    Targets results;
+  };
+
+  struct Registration {
+    HandlerId id;
+    agora::rtm::IRtmEventHandler* handler;
+    Filter filter;
+  };
+
+  static std::shared_ptr<const Index> buildIndex(const std::vector<Registration>& registrations);
+  const Route& routeFor(const Index& index, const char* channelName) const;
+  std::shared_ptr<const Index> index() const { return index_.load(std::memory_order_acquire); }
+
+  template <typename Call>
+  void broadcast(Call&& call);
+  template <typename Call>
+  void toChannel(const char* channelName, Call&& call);
+
+  mutable std::mutex mutex_;
+  std::vector<Registration> registrations_;
+  HandlerId nextId_ = 0;
+  std::atomic<std::shared_ptr<const Index>> index_;
+};
+
+}  // namespace rtm
+}  // namespace flat
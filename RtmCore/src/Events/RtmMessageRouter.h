@@ -0,0 +1,101 @@
+//
+//  RtmMessageRouter.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "Common/PerfectHash.h"
+#include "Common/StringMap.h"
+#include "Events/ForwardingRtmEventHandler.h"
+
+namespace flat {
+namespace rtm {
+
+/// Which messages a handler takes: a channel type and a customType. An empty customType matches messages
+/// published without one.
+struct RtmRoute {
+  agora::rtm::RTM_CHANNEL_TYPE channelType;
+  std::string_view customType;
+};
+
+/// The route set of a `RtmMessageRouter`, hashed at compile time:
+///
+///     constexpr auto kRoomRoutes = rtmRoutes({
+///         {agora::rtm::RTM_CHANNEL_TYPE_MESSAGE, RtmCommandCodec::kCustomType},
+///         {agora::rtm::RTM_CHANNEL_TYPE_USER, RtmCommandCodec::kCustomType},
+///     });
+template <size_t N>
+using RtmRouteTable = PerfectHashIndex<N>;
+
+template <size_t N>
+consteval RtmRouteTable<N> rtmRoutes(const RtmRoute (&routes)[N]) {
+  PerfectHashKey keys[N];
+  for (size_t i = 0; i < N; ++i) keys[i] = PerfectHashKey{routes[i].customType, routes[i].channelType};
+  return RtmRouteTable<N>(keys);
+}
+
+/// Delivers each message to the handler of its `(channelType, customType)` route, instead of every handler
+/// comparing channel names and types in turn. The route set is fixed at compile time, so dispatch is one hash,
+/// one key compare and one call.
+///
+/// Messages on routes without a handler, or on no route at all, are counted as unrouted and pass on to `next`
+/// with every other callback. Register handlers before the router receives events: dispatch reads them
+/// without a lock.
+template <size_t N>
+class RtmMessageRouter : public ForwardingRtmEventHandler {
+ public:
+  using Handler = std::function<void(const MessageEvent& event)>;
+
+  struct Stats {
+    uint64_t routed = 0;
+    uint64_t unrouted = 0;
+  };
+
+  RtmMessageRouter(const RtmRouteTable<N>& routes, agora::rtm::IRtmEventHandler& next)
+      : ForwardingRtmEventHandler(next), routes_(routes) {}
+
+  /// Handles the messages of `route`, replacing its handler; false when `route` is not in the table.
+  bool on(const RtmRoute& route, Handler handler) {
+    size_t index = routes_.find(route.customType, route.channelType);
+    if (index == N) return false;
+    handlers_[index] = std::move(handler);
+    return true;
+  }
+
+  Stats stats() const {
+    Stats stats;
+    stats.routed = routed_.load(std::memory_order_relaxed);
+    stats.unrouted = unrouted_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  void onMessageEvent(const MessageEvent& event) override {
+    size_t index = routes_.find(viewOf(event.customType), event.channelType);
+    if (index == N || !handlers_[index]) {
+      unrouted_.fetch_add(1, std::memory_order_relaxed);
+      next().onMessageEvent(event);
+      return;
+    }
+    routed_.fetch_add(1, std::memory_order_relaxed);
+    handlers_[index](event);
+  }
+
+ private:
+  const RtmRouteTable<N> routes_;
+  std::array<Handler, N> handlers_;
+  std::atomic<uint64_t> routed_{0};
+  std::atomic<uint64_t> unrouted_{0};
+};
+
+}  // namespace rtm
+}  // namespace flat
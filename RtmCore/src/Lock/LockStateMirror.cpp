@@ -0,0 +1,297 @@
+//
+//  LockStateMirror.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Lock/LockStateMirror.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+LockStateMirror::LockStateMirror(IRtmLock& lock, std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                 RtmClock::time_point now)
+    : LockStateMirror(lock, channelName, channelType, now, Options()) {}
+
+LockStateMirror::LockStateMirror(IRtmLock& lock, std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                 RtmClock::time_point now, Options options)
+    : lock_(lock),
+      channelName_(channelName),
+      channelType_(channelType),
+      wheel_(now, options.wheel),
+      unclaimed_(options.unclaimedCapacity) {}
+
+uint64_t LockStateMirror::refresh() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!startFetchLocked()) return 0;
+  }
+  return fetch();
+}
+
+bool LockStateMirror::synced() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return snapshotApplied_ && !fetching_;
+}
+
+size_t LockStateMirror::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return present_;
+}
+
+LockStateMirror::LockId LockStateMirror::find(std::string_view lockName) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = lockIds_.find(lockName);
+  return found == lockIds_.end() ? kInvalidLock : found->second;
+}
+
+bool LockStateMirror::owner(std::string_view lockName, std::string& owner) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = lockIds_.find(lockName);
+  if (found == lockIds_.end() || !slots_[found->second].present) return false;
+  owner = slots_[found->second].lock.owner;
+  return true;
+}
+
+bool LockStateMirror::owner(LockId lock, std::string& owner) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (lock >= slots_.size() || !slots_[lock].present) return false;
+  owner = slots_[lock].lock.owner;
+  return true;
+}
+
+bool LockStateMirror::get(std::string_view lockName, Lock& lock) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = lockIds_.find(lockName);
+  if (found == lockIds_.end() || !slots_[found->second].present) return false;
+  lock = slots_[found->second].lock;
+  return true;
+}
+
+std::vector<std::pair<std::string, LockStateMirror::Lock>> LockStateMirror::locks() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<std::pair<std::string, Lock>> locks;
+  locks.reserve(present_);
+  for (const Slot& slot : slots_) {
+    if (slot.present) locks.emplace_back(slot.name, slot.lock);
+  }
+  return locks;
+}
+
+size_t LockStateMirror::poll(RtmClock::time_point now) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  expired_.clear();
+  wheel_.advance(now, expired_);
+  for (uint64_t id : expired_) {
+    Slot& slot = slots_[id];
+    slot.timer = 0;
+    slot.lock.owner.clear();
+    slot.lock.expiring = false;
+    slot.lock.expiresAt = RtmClock::time_point::max();
+    slot.lock.predicted = true;
+  }
+  stats_.predictedExpiries += expired_.size();
+  return expired_.size();
+}
+
+LockStateMirror::Stats LockStateMirror::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Events
+
+void LockStateMirror::onLockEvent(const LockEvent& event) {
+  if (!isOurs(viewOf(event.channelName), event.channelType)) return;
+  bool needsFetch = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++stats_.events;
+    if (event.eventType == RTM_LOCK_EVENT_TYPE_SNAPSHOT) {
+      replaceLocked(event.lockDetailList, event.count);
+      ++stats_.snapshots;
+    } else {
+      for (size_t i = 0; i < event.count && event.lockDetailList; ++i) {
+        const LockDetail& detail = event.lockDetailList[i];
+        Slot& slot = slots_[internLocked(viewOf(detail.lockName))];
+        if (event.eventType == RTM_LOCK_EVENT_TYPE_LOCK_REMOVED) {
+          removeLocked(slot);
+          continue;
+        }
+        if (!slot.present) {
+          slot.present = true;
+          ++present_;
+        }
+        if (detail.ttl > 0) slot.lock.ttl = detail.ttl;
+        switch (event.eventType) {
+          case RTM_LOCK_EVENT_TYPE_LOCK_SET:
+            setOwnerLocked(slot, {});
+            break;
+          case RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED:
+            setOwnerLocked(slot, viewOf(detail.owner));
+            // Only snapshots promise an owner; ask the service rather than show the lock free.
+            needsFetch = needsFetch || slot.lock.owner.empty();
+            break;
+          case RTM_LOCK_EVENT_TYPE_LOCK_EXPIRED:
+            if (slot.lock.predicted) ++stats_.confirmedExpiries;
+            setOwnerLocked(slot, {});
+            break;
+          case RTM_LOCK_EVENT_TYPE_LOCK_RELEASED:
+            setOwnerLocked(slot, {});
+            break;
+          default:
+            break;
+        }
+      }
+    }
+    needsFetch = needsFetch && startFetchLocked();
+  }
+  if (needsFetch) fetch();
+}
+
+void LockStateMirror::onPresenceEvent(const PresenceEvent& event) {
+  if (!isOurs(viewOf(event.channelName), event.channelType)) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  switch (event.type) {
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL:
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_TIMEOUT:
+      ownerLeftLocked(viewOf(event.publisher));
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL:
+      ownerReturnedLocked(viewOf(event.publisher));
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_INTERVAL: {
+      const PresenceEvent::IntervalInfo& interval = event.interval;
+      for (size_t i = 0; i < interval.leaveUserList.userCount; ++i) {
+        ownerLeftLocked(viewOf(interval.leaveUserList.users[i]));
+      }
+      for (size_t i = 0; i < interval.timeoutUserList.userCount; ++i) {
+        ownerLeftLocked(viewOf(interval.timeoutUserList.users[i]));
+      }
+      for (size_t i = 0; i < interval.joinUserList.userCount; ++i) {
+        ownerReturnedLocked(viewOf(interval.joinUserList.users[i]));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void LockStateMirror::onGetLocksResult(const uint64_t requestId, const char* channelName,
+                                       RTM_CHANNEL_TYPE channelType, const LockDetail* lockDetailList,
+                                       const size_t count, RTM_ERROR_CODE errorCode) {
+  if (!isOurs(viewOf(channelName), channelType)) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (errorCode == RTM_ERROR_OK) {
+    replaceLocked(lockDetailList, count);
+    ++stats_.snapshots;
+  }
+  if (!fetching_) return;
+  if (fetchRequestId_ == 0) {
+    // The fetch is still being made; this may be its result.
+    unclaimed_.keep(requestId, errorCode);
+    return;
+  }
+  if (requestId == fetchRequestId_) settleFetchLocked(errorCode);
+}
+
+// MARK: - Private
+
+bool LockStateMirror::isOurs(std::string_view channelName, RTM_CHANNEL_TYPE channelType) const {
+  return channelType == channelType_ && channelName == channelName_;
+}
+
+LockStateMirror::LockId LockStateMirror::internLocked(std::string_view lockName) {
+  auto found = lockIds_.find(lockName);
+  if (found != lockIds_.end()) return found->second;
+  LockId id = static_cast<LockId>(slots_.size());
+  slots_.push_back({std::string(lockName), Lock(), false, 0});
+  lockIds_.emplace(std::string(lockName), id);
+  return id;
+}
+
+void LockStateMirror::replaceLocked(const LockDetail* details, size_t count) {
+  for (Slot& slot : slots_) removeLocked(slot);
+  for (size_t i = 0; i < count && details; ++i) {
+    Slot& slot = slots_[internLocked(viewOf(details[i].lockName))];
+    slot.present = true;
+    slot.lock.ttl = details[i].ttl;
+    setOwnerLocked(slot, viewOf(details[i].owner));
+    ++present_;
+  }
+  snapshotApplied_ = true;
+}
+
+void LockStateMirror::setOwnerLocked(Slot& slot, std::string_view owner) {
+  cancelCountdownLocked(slot);
+  slot.lock.owner.assign(owner);
+  slot.lock.predicted = false;
+}
+
+void LockStateMirror::removeLocked(Slot& slot) {
+  if (!slot.present) return;
+  cancelCountdownLocked(slot);
+  slot.lock = Lock();
+  slot.present = false;
+  --present_;
+}
+
+void LockStateMirror::ownerLeftLocked(std::string_view userId) {
+  if (userId.empty()) return;
+  for (size_t id = 0; id < slots_.size(); ++id) {
+    Slot& slot = slots_[id];
+    if (!slot.present || slot.timer != 0 || slot.lock.owner != userId) continue;
+    slot.lock.expiring = true;
+    slot.lock.expiresAt = wheel_.now() + std::chrono::seconds(slot.lock.ttl);
+    slot.timer = wheel_.schedule(slot.lock.expiresAt, id);
+    ++stats_.countdowns;
+  }
+}
+
+void LockStateMirror::ownerReturnedLocked(std::string_view userId) {
+  if (userId.empty()) return;
+  for (Slot& slot : slots_) {
+    if (slot.present && slot.lock.owner == userId) cancelCountdownLocked(slot);
+  }
+}
+
+void LockStateMirror::cancelCountdownLocked(Slot& slot) {
+  if (slot.timer != 0) wheel_.cancel(slot.timer);
+  slot.timer = 0;
+  slot.lock.expiring = false;
+  slot.lock.expiresAt = RtmClock::time_point::max();
+}
+
+bool LockStateMirror::startFetchLocked() {
+  if (fetching_) return false;
+  fetching_ = true;
+  fetchRequestId_ = 0;
+  ++stats_.fetches;
+  return true;
+}
+
+void LockStateMirror::settleFetchLocked(RTM_ERROR_CODE errorCode) {
+  fetching_ = false;
+  fetchRequestId_ = 0;
+  if (errorCode != RTM_ERROR_OK) ++stats_.fetchErrors;
+}
+
+uint64_t LockStateMirror::fetch() {
+  uint64_t requestId = 0;
+  lock_.getLocks(channelName_.c_str(), channelType_, requestId);
+  std::lock_guard<std::mutex> guard(mutex_);
+  RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+  if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+    fetchRequestId_ = requestId;
+    return requestId;
+  }
+  settleFetchLocked(errorCode);
+  return requestId;
+}
+
+}  // namespace rtm
+}  // namespace flat
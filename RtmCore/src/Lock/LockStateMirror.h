@@ -0,0 +1,157 @@
+//
+//  LockStateMirror.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "Common/TimingWheel.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmLock.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Local copy of one channel's locks and their owners, kept current from `onLockEvent` so "who holds the
+/// presenter lock" is a hash lookup instead of a `getLocks` round trip.
+///
+/// A SNAPSHOT, or any `onGetLocksResult` for the channel, replaces the copy; SET and REMOVED add and drop locks,
+/// ACQUIRED, RELEASED and EXPIRED change owners. An ACQUIRED event that names no owner is followed by a fetch.
+///
+/// The service frees a lock `ttl` seconds after its owner drops out of the channel; while the owner stays, the
+/// lock never runs out, which is why `RtmLeaseManager` does not renew it. When a presence event reports the
+/// owner leaving or timing out, the mirror starts that countdown on a `TimingWheel`; the owner rejoining cancels
+/// it. `poll` frees the locks whose countdown ran out and marks them `predicted` until the service's EXPIRED
+/// event confirms it, so readers see the lock free without waiting for the event. Subscribe or join the channel
+/// `withLock`, and `withPresence` for the predictions.
+///
+/// Lock names are interned: each gets a `LockId` that stays valid for the mirror's lifetime, also across removal.
+/// Register the mirror with the client's event handler. Countdowns start from the time of the last `poll`. Reads,
+/// events and `poll` may come from different threads; the fetch is made outside the mirror's lock, and it is
+/// only settled by the result carrying its requestId.
+class LockStateMirror : public agora::rtm::IRtmEventHandler {
+ public:
+  using LockId = uint32_t;
+  static constexpr LockId kInvalidLock = UINT32_MAX;
+
+  struct Lock {
+    /// Empty while the lock is free.
+    std::string owner;
+    /// Seconds the lock outlives its owner's presence.
+    uint32_t ttl = 0;
+    /// The owner left; the lock is freed at `expiresAt` unless they return first.
+    bool expiring = false;
+    RtmClock::time_point expiresAt = RtmClock::time_point::max();
+    /// Freed by the local countdown; the service has not confirmed the expiry yet.
+    bool predicted = false;
+  };
+
+  struct Options {
+    TimingWheel::Options wheel{std::chrono::milliseconds(10)};
+    /// `getLocks` results kept while the fetch is being made, in case one is its own.
+    size_t unclaimedCapacity = 8;
+  };
+
+  struct Stats {
+    uint64_t events = 0;
+    uint64_t snapshots = 0;
+    uint64_t fetches = 0;
+    uint64_t fetchErrors = 0;
+    uint64_t countdowns = 0;
+    uint64_t predictedExpiries = 0;
+    /// Predicted expiries the service's EXPIRED event later confirmed.
+    uint64_t confirmedExpiries = 0;
+  };
+
+  LockStateMirror(agora::rtm::IRtmLock& lock, std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                  RtmClock::time_point now);
+  LockStateMirror(agora::rtm::IRtmLock& lock, std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                  RtmClock::time_point now, Options options);
+
+  LockStateMirror(const LockStateMirror&) = delete;
+  LockStateMirror& operator=(const LockStateMirror&) = delete;
+
+  const std::string& channelName() const { return channelName_; }
+  agora::rtm::RTM_CHANNEL_TYPE channelType() const { return channelType_; }
+
+  /// Fetches the channel's locks unless a fetch is already outstanding. Returns the fetch's requestId, or 0 when
+  /// none was issued.
+  uint64_t refresh();
+
+  /// Whether a snapshot has been applied and no fetch is outstanding.
+  bool synced() const;
+  /// Number of locks present.
+  size_t size() const;
+
+  /// The id of `lockName`, or `kInvalidLock` if the lock was never seen.
+  LockId find(std::string_view lockName) const;
+  /// The lock's owner, empty while it is free. False when the lock does not exist.
+  bool owner(std::string_view lockName, std::string& owner) const;
+  bool owner(LockId lock, std::string& owner) const;
+  bool get(std::string_view lockName, Lock& lock) const;
+  /// Present locks, in id order.
+  std::vector<std::pair<std::string, Lock>> locks() const;
+
+  /// Frees the locks whose countdown ran out by `now`. Returns how many.
+  size_t poll(RtmClock::time_point now);
+  Stats stats() const;
+
+  void onLockEvent(const LockEvent& event) override;
+  void onPresenceEvent(const PresenceEvent& event) override;
+  void onGetLocksResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                        const agora::rtm::LockDetail* lockDetailList, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Slot {
+    std::string name;
+    Lock lock;
+    bool present = false;
+    TimingWheel::TimerId timer = 0;
+  };
+
+  bool isOurs(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType) const;
+  LockId internLocked(std::string_view lockName);
+  void replaceLocked(const agora::rtm::LockDetail* details, size_t count);
+  /// Sets the slot's owner and drops any countdown.
+  void setOwnerLocked(Slot& slot, std::string_view owner);
+  void removeLocked(Slot& slot);
+  void ownerLeftLocked(std::string_view userId);
+  void ownerReturnedLocked(std::string_view userId);
+  void cancelCountdownLocked(Slot& slot);
+  bool startFetchLocked();
+  void settleFetchLocked(agora::rtm::RTM_ERROR_CODE errorCode);
+  uint64_t fetch();
+
+  agora::rtm::IRtmLock& lock_;
+  const std::string channelName_;
+  const agora::rtm::RTM_CHANNEL_TYPE channelType_;
+
+  mutable std::mutex mutex_;
+  TimingWheel wheel_;
+  std::vector<uint64_t> expired_;
+  StringMap<LockId> lockIds_;
+  std::vector<Slot> slots_;
+  size_t present_ = 0;
+  bool snapshotApplied_ = false;
+  bool fetching_ = false;
+  uint64_t fetchRequestId_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,292 @@
+//
+//  RtmLeaseManager.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Lock/RtmLeaseManager.h"
+
+#include <algorithm>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+/// Channel names cannot hold control characters, so the separator keeps keys of different channels apart.
+std::string leaseKey(std::string_view channelName, RTM_CHANNEL_TYPE channelType, std::string_view lockName) {
+  std::string key = std::to_string(static_cast<int>(channelType));
+  key += ':';
+  key.append(channelName);
+  key += '\x1f';
+  key.append(lockName);
+  return key;
+}
+
+}  // namespace
+
+RtmLeaseManager::RtmLeaseManager(IRtmLock& lock, std::string_view userId)
+    : RtmLeaseManager(lock, userId, Options()) {}
+
+RtmLeaseManager::RtmLeaseManager(IRtmLock& lock, std::string_view userId, Options options)
+    : lock_(lock), userId_(userId), options_(options), unclaimed_(options.unclaimedCapacity) {}
+
+RtmLeaseManager::Ticket RtmLeaseManager::acquire(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                                 std::string_view lockName, Callback callback) {
+  Effects effects;
+  Ticket ticket;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::string key = leaseKey(channelName, channelType, lockName);
+    auto inserted = leases_.try_emplace(key);
+    Lease& lease = inserted.first->second;
+    if (inserted.second) {
+      lease.channelName.assign(channelName);
+      lease.channelType = channelType;
+      lease.lockName.assign(lockName);
+    }
+    ticket = nextTicket_++;
+    tickets_.emplace(ticket, std::move(key));
+    lease.waiters.push_back({ticket, std::move(callback)});
+    if (lease.remote == Remote::idle) callLocked(lease, CallKind::acquire, effects);
+  }
+  run(effects);
+  return ticket;
+}
+
+bool RtmLeaseManager::release(Ticket ticket) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = tickets_.find(ticket);
+    if (found == tickets_.end()) return false;
+    std::string key = std::move(found->second);
+    tickets_.erase(found);
+    Lease& lease = leases_.find(key)->second;
+    if (lease.holder.ticket == ticket) {
+      lease.holder = Waiter();
+      if (lease.remote == Remote::held) passOnLocked(lease, true, effects);
+    } else {
+      auto& waiters = lease.waiters;
+      auto waiter = std::find_if(waiters.begin(), waiters.end(),
+                                 [ticket](const Waiter& candidate) { return candidate.ticket == ticket; });
+      if (waiter != waiters.end()) waiters.erase(waiter);
+    }
+    pruneLocked(key);
+  }
+  run(effects);
+  return true;
+}
+
+bool RtmLeaseManager::held(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                           std::string_view lockName) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = leases_.find(leaseKey(channelName, channelType, lockName));
+  return found != leases_.end() && found->second.remote == Remote::held;
+}
+
+RtmLeaseManager::Stats RtmLeaseManager::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  for (const auto& entry : leases_) {
+    stats.held += entry.second.remote == Remote::held ? 1 : 0;
+    stats.waiting += entry.second.waiters.size();
+  }
+  return stats;
+}
+
+void RtmLeaseManager::onLockEvent(const LockEvent& event) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (size_t i = 0; i < event.count; ++i) {
+      const LockDetail& detail = event.lockDetailList[i];
+      Lease* lease = findLocked(viewOf(event.channelName), event.channelType, viewOf(detail.lockName));
+      if (!lease || lease->remote != Remote::held) continue;
+      switch (event.eventType) {
+        case RTM_LOCK_EVENT_TYPE_LOCK_RELEASED:
+        case RTM_LOCK_EVENT_TYPE_LOCK_EXPIRED:
+          // Someone else's hold ending, reported after ours began.
+          if (viewOf(detail.owner) != userId_) break;
+          loseLocked(*lease, RTM_ERROR_LOCK_NOT_ACQUIRED, effects);
+          break;
+        case RTM_LOCK_EVENT_TYPE_LOCK_REMOVED:
+          failWaitersLocked(*lease, RTM_ERROR_LOCK_NOT_EXIST, effects);
+          loseLocked(*lease, RTM_ERROR_LOCK_NOT_EXIST, effects);
+          break;
+        default:
+          break;
+      }
+      pruneLocked(leaseKey(lease->channelName, lease->channelType, lease->lockName));
+    }
+  }
+  run(effects);
+}
+
+void RtmLeaseManager::onAcquireLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                          RTM_ERROR_CODE errorCode, const char*) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Lease* lease = claimLocked(requestId);
+    if (!lease) {
+      // A call is still being made; this may be its result.
+      if (callsInFlight_ > 0) unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    if (lease->remote == Remote::acquiring) acquiredLocked(*lease, errorCode, effects);
+  }
+  run(effects);
+}
+
+void RtmLeaseManager::onReleaseLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                          RTM_ERROR_CODE errorCode) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Lease* lease = claimLocked(requestId);
+    if (!lease) {
+      if (callsInFlight_ > 0) unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    if (lease->remote == Remote::releasing) releasedLocked(*lease, effects);
+  }
+  run(effects);
+}
+
+// MARK: - Private
+
+RtmLeaseManager::Lease* RtmLeaseManager::findLocked(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                                    std::string_view lockName) {
+  auto found = leases_.find(leaseKey(channelName, channelType, lockName));
+  return found == leases_.end() ? nullptr : &found->second;
+}
+
+void RtmLeaseManager::callLocked(Lease& lease, CallKind kind, Effects& effects) {
+  switch (kind) {
+    case CallKind::acquire:
+      lease.remote = Remote::acquiring;
+      ++stats_.remoteAcquires;
+      break;
+    case CallKind::release:
+      lease.remote = Remote::releasing;
+      ++stats_.remoteReleases;
+      break;
+  }
+  lease.requestId = 0;
+  ++callsInFlight_;
+  effects.calls.push_back({kind, lease.channelName, lease.channelType, lease.lockName});
+}
+
+void RtmLeaseManager::calledLocked(const Call& call, uint64_t requestId, Effects& effects) {
+  --callsInFlight_;
+  Lease* lease = findLocked(call.channelName, call.channelType, call.lockName);
+  Remote expected = call.kind == CallKind::acquire ? Remote::acquiring : Remote::releasing;
+  if (!lease || lease->remote != expected || lease->requestId != 0) return;
+  RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+  if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+    lease->requestId = requestId;
+    requests_.insert(requestId, leaseKey(call.channelName, call.channelType, call.lockName));
+    return;
+  }
+  if (call.kind == CallKind::acquire) {
+    acquiredLocked(*lease, errorCode, effects);
+  } else {
+    releasedLocked(*lease, effects);
+  }
+}
+
+void RtmLeaseManager::acquiredLocked(Lease& lease, RTM_ERROR_CODE errorCode, Effects& effects) {
+  if (errorCode == RTM_ERROR_OK) {
+    lease.remote = Remote::held;
+    passOnLocked(lease, false, effects);
+  } else {
+    lease.remote = Remote::idle;
+    failWaitersLocked(lease, errorCode, effects);
+  }
+  pruneLocked(leaseKey(lease.channelName, lease.channelType, lease.lockName));
+}
+
+void RtmLeaseManager::releasedLocked(Lease& lease, Effects& effects) {
+  // Whatever the outcome, the lock is not ours to hand out any more.
+  lease.remote = Remote::idle;
+  if (!lease.waiters.empty()) callLocked(lease, CallKind::acquire, effects);
+  pruneLocked(leaseKey(lease.channelName, lease.channelType, lease.lockName));
+}
+
+RtmLeaseManager::Lease* RtmLeaseManager::claimLocked(uint64_t requestId) {
+  std::string key;
+  if (requestId == 0 || !requests_.take(requestId, key)) return nullptr;
+  auto found = leases_.find(key);
+  if (found == leases_.end() || found->second.requestId != requestId) return nullptr;
+  found->second.requestId = 0;
+  return &found->second;
+}
+
+void RtmLeaseManager::passOnLocked(Lease& lease, bool handoff, Effects& effects) {
+  if (lease.waiters.empty()) {
+    callLocked(lease, CallKind::release, effects);
+    return;
+  }
+  lease.holder = std::move(lease.waiters.front());
+  lease.waiters.pop_front();
+  ++stats_.grants;
+  if (handoff) ++stats_.handoffs;
+  effects.notices.push_back({lease.holder.callback, lease.holder.ticket, RTM_ERROR_OK});
+}
+
+void RtmLeaseManager::loseLocked(Lease& lease, RTM_ERROR_CODE errorCode, Effects& effects) {
+  lease.remote = Remote::idle;
+  ++stats_.lost;
+  if (lease.holder.ticket != 0) {
+    tickets_.erase(lease.holder.ticket);
+    effects.notices.push_back({std::move(lease.holder.callback), lease.holder.ticket, errorCode});
+    lease.holder = Waiter();
+  }
+  if (!lease.waiters.empty()) callLocked(lease, CallKind::acquire, effects);
+}
+
+void RtmLeaseManager::failWaitersLocked(Lease& lease, RTM_ERROR_CODE errorCode, Effects& effects) {
+  for (Waiter& waiter : lease.waiters) {
+    tickets_.erase(waiter.ticket);
+    effects.notices.push_back({std::move(waiter.callback), waiter.ticket, errorCode});
+    ++stats_.failed;
+  }
+  lease.waiters.clear();
+}
+
+void RtmLeaseManager::pruneLocked(const std::string& key) {
+  auto found = leases_.find(key);
+  if (found == leases_.end()) return;
+  const Lease& lease = found->second;
+  if (lease.remote == Remote::idle && lease.holder.ticket == 0 && lease.waiters.empty()) leases_.erase(found);
+}
+
+void RtmLeaseManager::run(Effects& effects) {
+  // Notices first, so a lost lock is reported before the acquire that replaces it can grant anyone.
+  for (Notice& notice : effects.notices) {
+    if (notice.callback) notice.callback(notice.ticket, notice.errorCode);
+  }
+  for (const Call& call : effects.calls) {
+    const char* channelName = call.channelName.c_str();
+    const char* lockName = call.lockName.c_str();
+    uint64_t requestId = 0;
+    if (call.kind == CallKind::release) {
+      lock_.releaseLock(channelName, call.channelType, lockName, requestId);
+    } else {
+      lock_.acquireLock(channelName, call.channelType, lockName, options_.retry, requestId);
+    }
+    Effects settled;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      calledLocked(call, requestId, settled);
+    }
+    run(settled);
+  }
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,171 @@
+//
+//  RtmLeaseManager.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmLock.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Shares `IRtmLock` locks between the tasks of one client, so contention inside the app costs no round trips.
+///
+/// Each `acquire` gets a ticket. Tickets for the same lock queue locally behind one remote `acquireLock`; once
+/// the lock is held, it passes from one ticket to the next on `release` without touching the service, and is
+/// released remotely only when no ticket waits. A classroom's "only one presenter" lock is acquired once however
+/// many of its tasks contend for it.
+///
+/// A held lock needs no renewal: its `LockDetail::ttl` only counts once the owner has left the channel, and the
+/// service frees the lock when the owner has not returned by then, as `LockStateMirror` predicts. A release,
+/// expiry or removal the manager did not ask for takes the lock from its ticket, whose callback then runs again
+/// with the error; waiting tickets are carried over to a new remote acquire. Those come as lock events, so
+/// subscribe or join the channel `withLock`. Only events naming this client as the owner count as a loss: the
+/// previous owner's release may arrive after the result that gave the lock to us.
+///
+/// Remote results are matched by request id alone, so the app's own `acquireLock` and `releaseLock` calls on
+/// the same lock do not settle the manager's.
+///
+/// Callbacks and SDK calls run without the manager's lock, on the thread of the call or the SDK callback that
+/// caused them. Register the manager with the client's event handler.
+class RtmLeaseManager : public agora::rtm::IRtmEventHandler {
+ public:
+  using Ticket = uint64_t;
+  /// Runs once with `RTM_ERROR_OK` when the ticket is granted, or with the error that ended its wait; a granted
+  /// ticket's callback runs once more if the lock is lost before the ticket is released.
+  using Callback = std::function<void(Ticket ticket, agora::rtm::RTM_ERROR_CODE errorCode)>;
+
+  struct Options {
+    /// Let the service queue the remote acquire while another user holds the lock, instead of failing it.
+    bool retry = true;
+    /// Lock results kept while a remote call is being made, in case one is its own.
+    size_t unclaimedCapacity = 8;
+  };
+
+  struct Stats {
+    uint64_t remoteAcquires = 0;
+    uint64_t remoteReleases = 0;
+    uint64_t grants = 0;
+    /// Grants passed from one ticket to the next without a remote call.
+    uint64_t handoffs = 0;
+    uint64_t lost = 0;
+    uint64_t failed = 0;
+    size_t held = 0;
+    size_t waiting = 0;
+  };
+
+  /// `userId` is the user of the client `lock` belongs to.
+  RtmLeaseManager(agora::rtm::IRtmLock& lock, std::string_view userId);
+  RtmLeaseManager(agora::rtm::IRtmLock& lock, std::string_view userId, Options options);
+
+  RtmLeaseManager(const RtmLeaseManager&) = delete;
+  RtmLeaseManager& operator=(const RtmLeaseManager&) = delete;
+
+  /// Queues a ticket for the lock. The callback may run before this returns.
+  Ticket acquire(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                 Callback callback);
+  /// Gives up a granted ticket, or cancels a waiting one. False for tickets already released or ended.
+  bool release(Ticket ticket);
+  /// Whether the lock is held remotely by this manager.
+  bool held(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName) const;
+
+  Stats stats() const;
+
+  void onLockEvent(const LockEvent& event) override;
+  void onAcquireLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode,
+                           const char* errorDetails) override;
+  void onReleaseLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  enum class Remote : uint8_t { idle, acquiring, held, releasing };
+
+  struct Waiter {
+    Ticket ticket = 0;
+    Callback callback;
+  };
+
+  struct Lease {
+    std::string channelName;
+    agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_NONE;
+    std::string lockName;
+    Remote remote = Remote::idle;
+    /// The outstanding acquire or release; 0 while the call is being made.
+    uint64_t requestId = 0;
+    Waiter holder;
+    std::deque<Waiter> waiters;
+  };
+
+  enum class CallKind : uint8_t { acquire, release };
+
+  struct Call {
+    CallKind kind = CallKind::acquire;
+    std::string channelName;
+    agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_NONE;
+    std::string lockName;
+  };
+
+  struct Notice {
+    Callback callback;
+    Ticket ticket = 0;
+    agora::rtm::RTM_ERROR_CODE errorCode = agora::rtm::RTM_ERROR_OK;
+  };
+
+  /// Work collected under the lock and carried out after it is released.
+  struct Effects {
+    std::vector<Call> calls;
+    std::vector<Notice> notices;
+  };
+
+  Lease* findLocked(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                    std::string_view lockName);
+  void callLocked(Lease& lease, CallKind kind, Effects& effects);
+  /// Files the id of a call that just returned, or settles it with the result that came during the call.
+  void calledLocked(const Call& call, uint64_t requestId, Effects& effects);
+  void acquiredLocked(Lease& lease, agora::rtm::RTM_ERROR_CODE errorCode, Effects& effects);
+  void releasedLocked(Lease& lease, Effects& effects);
+  /// The lease waiting for `requestId`, which is forgotten; null if none.
+  Lease* claimLocked(uint64_t requestId);
+  /// Gives a held lock to the next waiter, or releases it remotely when none is left.
+  void passOnLocked(Lease& lease, bool handoff, Effects& effects);
+  /// The lock is no longer ours: tell its holder and acquire it again for the waiters.
+  void loseLocked(Lease& lease, agora::rtm::RTM_ERROR_CODE errorCode, Effects& effects);
+  void failWaitersLocked(Lease& lease, agora::rtm::RTM_ERROR_CODE errorCode, Effects& effects);
+  void pruneLocked(const std::string& key);
+  void run(Effects& effects);
+
+  agora::rtm::IRtmLock& lock_;
+  std::string userId_;
+  Options options_;
+
+  mutable std::mutex mutex_;
+  StringMap<Lease> leases_;
+  /// Lease keys by the request id of their outstanding call.
+  RequestIdTable<std::string> requests_;
+  /// Remote calls collected but not yet returned.
+  size_t callsInFlight_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  std::unordered_map<Ticket, std::string> tickets_;
+  Ticket nextTicket_ = 1;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
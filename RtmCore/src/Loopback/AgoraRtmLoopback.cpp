@@ -0,0 +1,238 @@
+//
+//  AgoraRtmLoopback.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+// Drop-in replacements for the SDK entry points, so code written against IAgoraRtmClient.h links
+// against the loopback broker on hosts where the xcframework is unavailable. Results arrive on the
+// broker's dispatcher thread, as they would on the SDK's, so nothing has to pump the clients.
+
+#include "IAgoraRtmClient.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+
+namespace agora {
+namespace rtm {
+
+IRtmClient* createAgoraRtmClient(const RtmConfig& config, int& errorCode) {
+  flat::rtm::LoopbackRtmClient* client =
+      flat::rtm::createLoopbackRtmClient(flat::rtm::LoopbackBroker::shared(), config, errorCode);
+  if (client) client->setResultsOnDispatcher(true);
+  return client;
+}
+
+const char* getErrorReason(int errorCode) {
+  switch (errorCode) {
+    case RTM_ERROR_OK:
+      return "RTM_ERROR_OK";
+    case RTM_ERROR_NOT_INITIALIZED:
+      return "RTM_ERROR_NOT_INITIALIZED";
+    case RTM_ERROR_NOT_LOGIN:
+      return "RTM_ERROR_NOT_LOGIN";
+    case RTM_ERROR_INVALID_APP_ID:
+      return "RTM_ERROR_INVALID_APP_ID";
+    case RTM_ERROR_INVALID_EVENT_HANDLER:
+      return "RTM_ERROR_INVALID_EVENT_HANDLER";
+    case RTM_ERROR_INVALID_TOKEN:
+      return "RTM_ERROR_INVALID_TOKEN";
+    case RTM_ERROR_INVALID_USER_ID:
+      return "RTM_ERROR_INVALID_USER_ID";
+    case RTM_ERROR_INIT_SERVICE_FAILED:
+      return "RTM_ERROR_INIT_SERVICE_FAILED";
+    case RTM_ERROR_INVALID_CHANNEL_NAME:
+      return "RTM_ERROR_INVALID_CHANNEL_NAME";
+    case RTM_ERROR_TOKEN_EXPIRED:
+      return "RTM_ERROR_TOKEN_EXPIRED";
+    case RTM_ERROR_LOGIN_NO_SERVER_RESOURCES:
+      return "RTM_ERROR_LOGIN_NO_SERVER_RESOURCES";
+    case RTM_ERROR_LOGIN_TIMEOUT:
+      return "RTM_ERROR_LOGIN_TIMEOUT";
+    case RTM_ERROR_LOGIN_REJECTED:
+      return "RTM_ERROR_LOGIN_REJECTED";
+    case RTM_ERROR_LOGIN_ABORTED:
+      return "RTM_ERROR_LOGIN_ABORTED";
+    case RTM_ERROR_INVALID_PARAMETER:
+      return "RTM_ERROR_INVALID_PARAMETER";
+    case RTM_ERROR_LOGIN_NOT_AUTHORIZED:
+      return "RTM_ERROR_LOGIN_NOT_AUTHORIZED";
+    case RTM_ERROR_INCONSISTENT_APPID:
+      return "RTM_ERROR_INCONSISTENT_APPID";
+    case RTM_ERROR_DUPLICATE_OPERATION:
+      return "RTM_ERROR_DUPLICATE_OPERATION";
+    case RTM_ERROR_INSTANCE_ALREADY_RELEASED:
+      return "RTM_ERROR_INSTANCE_ALREADY_RELEASED";
+    case RTM_ERROR_INVALID_CHANNEL_TYPE:
+      return "RTM_ERROR_INVALID_CHANNEL_TYPE";
+    case RTM_ERROR_INVALID_ENCRYPTION_PARAMETER:
+      return "RTM_ERROR_INVALID_ENCRYPTION_PARAMETER";
+    case RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION:
+      return "RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION";
+    case RTM_ERROR_SERVICE_NOT_SUPPORTED:
+      return "RTM_ERROR_SERVICE_NOT_SUPPORTED";
+    case RTM_ERROR_LOGIN_CANCELED:
+      return "RTM_ERROR_LOGIN_CANCELED";
+    case RTM_ERROR_INVALID_PRIVATE_CONFIG:
+      return "RTM_ERROR_INVALID_PRIVATE_CONFIG";
+    case RTM_ERROR_NOT_CONNECTED:
+      return "RTM_ERROR_NOT_CONNECTED";
+    case RTM_ERROR_CHANNEL_NOT_JOINED:
+      return "RTM_ERROR_CHANNEL_NOT_JOINED";
+    case RTM_ERROR_CHANNEL_NOT_SUBSCRIBED:
+      return "RTM_ERROR_CHANNEL_NOT_SUBSCRIBED";
+    case RTM_ERROR_CHANNEL_EXCEED_TOPIC_USER_LIMITATION:
+      return "RTM_ERROR_CHANNEL_EXCEED_TOPIC_USER_LIMITATION";
+    case RTM_ERROR_CHANNEL_IN_REUSE:
+      return "RTM_ERROR_CHANNEL_IN_REUSE";
+    case RTM_ERROR_CHANNEL_INSTANCE_EXCEED_LIMITATION:
+      return "RTM_ERROR_CHANNEL_INSTANCE_EXCEED_LIMITATION";
+    case RTM_ERROR_CHANNEL_IN_ERROR_STATE:
+      return "RTM_ERROR_CHANNEL_IN_ERROR_STATE";
+    case RTM_ERROR_CHANNEL_JOIN_FAILED:
+      return "RTM_ERROR_CHANNEL_JOIN_FAILED";
+    case RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME:
+      return "RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME";
+    case RTM_ERROR_CHANNEL_INVALID_MESSAGE:
+      return "RTM_ERROR_CHANNEL_INVALID_MESSAGE";
+    case RTM_ERROR_CHANNEL_MESSAGE_LENGTH_EXCEED_LIMITATION:
+      return "RTM_ERROR_CHANNEL_MESSAGE_LENGTH_EXCEED_LIMITATION";
+    case RTM_ERROR_CHANNEL_INVALID_USER_LIST:
+      return "RTM_ERROR_CHANNEL_INVALID_USER_LIST";
+    case RTM_ERROR_CHANNEL_NOT_AVAILABLE:
+      return "RTM_ERROR_CHANNEL_NOT_AVAILABLE";
+    case RTM_ERROR_CHANNEL_TOPIC_NOT_SUBSCRIBED:
+      return "RTM_ERROR_CHANNEL_TOPIC_NOT_SUBSCRIBED";
+    case RTM_ERROR_CHANNEL_EXCEED_TOPIC_LIMITATION:
+      return "RTM_ERROR_CHANNEL_EXCEED_TOPIC_LIMITATION";
+    case RTM_ERROR_CHANNEL_JOIN_TOPIC_FAILED:
+      return "RTM_ERROR_CHANNEL_JOIN_TOPIC_FAILED";
+    case RTM_ERROR_CHANNEL_TOPIC_NOT_JOINED:
+      return "RTM_ERROR_CHANNEL_TOPIC_NOT_JOINED";
+    case RTM_ERROR_CHANNEL_TOPIC_NOT_EXIST:
+      return "RTM_ERROR_CHANNEL_TOPIC_NOT_EXIST";
+    case RTM_ERROR_CHANNEL_INVALID_TOPIC_META:
+      return "RTM_ERROR_CHANNEL_INVALID_TOPIC_META";
+    case RTM_ERROR_CHANNEL_SUBSCRIBE_TIMEOUT:
+      return "RTM_ERROR_CHANNEL_SUBSCRIBE_TIMEOUT";
+    case RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT:
+      return "RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT";
+    case RTM_ERROR_CHANNEL_SUBSCRIBE_FAILED:
+      return "RTM_ERROR_CHANNEL_SUBSCRIBE_FAILED";
+    case RTM_ERROR_CHANNEL_UNSUBSCRIBE_FAILED:
+      return "RTM_ERROR_CHANNEL_UNSUBSCRIBE_FAILED";
+    case RTM_ERROR_CHANNEL_ENCRYPT_MESSAGE_FAILED:
+      return "RTM_ERROR_CHANNEL_ENCRYPT_MESSAGE_FAILED";
+    case RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_FAILED:
+      return "RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_FAILED";
+    case RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT:
+      return "RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT";
+    case RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT:
+      return "RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT";
+    case RTM_ERROR_CHANNEL_NOT_CONNECTED:
+      return "RTM_ERROR_CHANNEL_NOT_CONNECTED";
+    case RTM_ERROR_CHANNEL_LEAVE_FAILED:
+      return "RTM_ERROR_CHANNEL_LEAVE_FAILED";
+    case RTM_ERROR_CHANNEL_CUSTOM_TYPE_LENGTH_OVERFLOW:
+      return "RTM_ERROR_CHANNEL_CUSTOM_TYPE_LENGTH_OVERFLOW";
+    case RTM_ERROR_CHANNEL_INVALID_CUSTOM_TYPE:
+      return "RTM_ERROR_CHANNEL_INVALID_CUSTOM_TYPE";
+    case RTM_ERROR_CHANNEL_UNSUPPORTED_MESSAGE_TYPE:
+      return "RTM_ERROR_CHANNEL_UNSUPPORTED_MESSAGE_TYPE";
+    case RTM_ERROR_CHANNEL_PRESENCE_NOT_READY:
+      return "RTM_ERROR_CHANNEL_PRESENCE_NOT_READY";
+    case RTM_ERROR_CHANNEL_RECEIVER_OFFLINE:
+      return "RTM_ERROR_CHANNEL_RECEIVER_OFFLINE";
+    case RTM_ERROR_CHANNEL_JOIN_CANCELED:
+      return "RTM_ERROR_CHANNEL_JOIN_CANCELED";
+    case RTM_ERROR_STORAGE_OPERATION_FAILED:
+      return "RTM_ERROR_STORAGE_OPERATION_FAILED";
+    case RTM_ERROR_STORAGE_METADATA_ITEM_EXCEED_LIMITATION:
+      return "RTM_ERROR_STORAGE_METADATA_ITEM_EXCEED_LIMITATION";
+    case RTM_ERROR_STORAGE_INVALID_METADATA_ITEM:
+      return "RTM_ERROR_STORAGE_INVALID_METADATA_ITEM";
+    case RTM_ERROR_STORAGE_INVALID_ARGUMENT:
+      return "RTM_ERROR_STORAGE_INVALID_ARGUMENT";
+    case RTM_ERROR_STORAGE_INVALID_REVISION:
+      return "RTM_ERROR_STORAGE_INVALID_REVISION";
+    case RTM_ERROR_STORAGE_METADATA_LENGTH_OVERFLOW:
+      return "RTM_ERROR_STORAGE_METADATA_LENGTH_OVERFLOW";
+    case RTM_ERROR_STORAGE_INVALID_LOCK_NAME:
+      return "RTM_ERROR_STORAGE_INVALID_LOCK_NAME";
+    case RTM_ERROR_STORAGE_LOCK_NOT_ACQUIRED:
+      return "RTM_ERROR_STORAGE_LOCK_NOT_ACQUIRED";
+    case RTM_ERROR_STORAGE_INVALID_KEY:
+      return "RTM_ERROR_STORAGE_INVALID_KEY";
+    case RTM_ERROR_STORAGE_INVALID_VALUE:
+      return "RTM_ERROR_STORAGE_INVALID_VALUE";
+    case RTM_ERROR_STORAGE_KEY_LENGTH_OVERFLOW:
+      return "RTM_ERROR_STORAGE_KEY_LENGTH_OVERFLOW";
+    case RTM_ERROR_STORAGE_VALUE_LENGTH_OVERFLOW:
+      return "RTM_ERROR_STORAGE_VALUE_LENGTH_OVERFLOW";
+    case RTM_ERROR_STORAGE_DUPLICATE_KEY:
+      return "RTM_ERROR_STORAGE_DUPLICATE_KEY";
+    case RTM_ERROR_STORAGE_OUTDATED_REVISION:
+      return "RTM_ERROR_STORAGE_OUTDATED_REVISION";
+    case RTM_ERROR_STORAGE_NOT_SUBSCRIBE:
+      return "RTM_ERROR_STORAGE_NOT_SUBSCRIBE";
+    case RTM_ERROR_STORAGE_INVALID_METADATA_INSTANCE:
+      return "RTM_ERROR_STORAGE_INVALID_METADATA_INSTANCE";
+    case RTM_ERROR_STORAGE_SUBSCRIBE_USER_EXCEED_LIMITATION:
+      return "RTM_ERROR_STORAGE_SUBSCRIBE_USER_EXCEED_LIMITATION";
+    case RTM_ERROR_STORAGE_OPERATION_TIMEOUT:
+      return "RTM_ERROR_STORAGE_OPERATION_TIMEOUT";
+    case RTM_ERROR_STORAGE_NOT_AVAILABLE:
+      return "RTM_ERROR_STORAGE_NOT_AVAILABLE";
+    case RTM_ERROR_PRESENCE_NOT_CONNECTED:
+      return "RTM_ERROR_PRESENCE_NOT_CONNECTED";
+    case RTM_ERROR_PRESENCE_NOT_WRITABLE:
+      return "RTM_ERROR_PRESENCE_NOT_WRITABLE";
+    case RTM_ERROR_PRESENCE_INVALID_ARGUMENT:
+      return "RTM_ERROR_PRESENCE_INVALID_ARGUMENT";
+    case RTM_ERROR_PRESENCE_CACHED_TOO_MANY_STATES:
+      return "RTM_ERROR_PRESENCE_CACHED_TOO_MANY_STATES";
+    case RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW:
+      return "RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW";
+    case RTM_ERROR_PRESENCE_INVALID_STATE_KEY:
+      return "RTM_ERROR_PRESENCE_INVALID_STATE_KEY";
+    case RTM_ERROR_PRESENCE_INVALID_STATE_VALUE:
+      return "RTM_ERROR_PRESENCE_INVALID_STATE_VALUE";
+    case RTM_ERROR_PRESENCE_STATE_KEY_SIZE_OVERFLOW:
+      return "RTM_ERROR_PRESENCE_STATE_KEY_SIZE_OVERFLOW";
+    case RTM_ERROR_PRESENCE_STATE_VALUE_SIZE_OVERFLOW:
+      return "RTM_ERROR_PRESENCE_STATE_VALUE_SIZE_OVERFLOW";
+    case RTM_ERROR_PRESENCE_STATE_DUPLICATE_KEY:
+      return "RTM_ERROR_PRESENCE_STATE_DUPLICATE_KEY";
+    case RTM_ERROR_PRESENCE_USER_NOT_EXIST:
+      return "RTM_ERROR_PRESENCE_USER_NOT_EXIST";
+    case RTM_ERROR_PRESENCE_OPERATION_TIMEOUT:
+      return "RTM_ERROR_PRESENCE_OPERATION_TIMEOUT";
+    case RTM_ERROR_PRESENCE_OPERATION_FAILED:
+      return "RTM_ERROR_PRESENCE_OPERATION_FAILED";
+    case RTM_ERROR_LOCK_OPERATION_FAILED:
+      return "RTM_ERROR_LOCK_OPERATION_FAILED";
+    case RTM_ERROR_LOCK_OPERATION_TIMEOUT:
+      return "RTM_ERROR_LOCK_OPERATION_TIMEOUT";
+    case RTM_ERROR_LOCK_OPERATION_PERFORMING:
+      return "RTM_ERROR_LOCK_OPERATION_PERFORMING";
+    case RTM_ERROR_LOCK_ALREADY_EXIST:
+      return "RTM_ERROR_LOCK_ALREADY_EXIST";
+    case RTM_ERROR_LOCK_INVALID_NAME:
+      return "RTM_ERROR_LOCK_INVALID_NAME";
+    case RTM_ERROR_LOCK_NOT_ACQUIRED:
+      return "RTM_ERROR_LOCK_NOT_ACQUIRED";
+    case RTM_ERROR_LOCK_ACQUIRE_FAILED:
+      return "RTM_ERROR_LOCK_ACQUIRE_FAILED";
+    case RTM_ERROR_LOCK_NOT_EXIST:
+      return "RTM_ERROR_LOCK_NOT_EXIST";
+    case RTM_ERROR_LOCK_NOT_AVAILABLE:
+      return "RTM_ERROR_LOCK_NOT_AVAILABLE";
+    default:
+      return "RTM_ERROR_UNKNOWN";
+  }
+}
+
+const char* getVersion() { return "2.2.1-loopback"; }
+
+}  // namespace rtm
+}  // namespace agora
@@ -0,0 +1,1401 @@
+//
+//  LoopbackBroker.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Loopback/LoopbackBroker.h"
+
+#include <algorithm>
+#include <charconv>
+#include <map>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "Loopback/LoopbackViews.h"
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+namespace {
+
+using SessionList = std::vector<LoopbackSessionPtr>;
+
+struct Member {
+  LoopbackSessionPtr session;
+  LoopbackMemberOptions options;
+  StatePairs states;
+};
+
+struct MetadataStore {
+  int64_t majorRevision = 0;
+  std::map<std::string, LoopbackMetadataItem, std::less<>> items;
+
+  bool empty() const { return items.empty(); }
+
+  LoopbackMetadata snapshot() const {
+    LoopbackMetadata data;
+    data.majorRevision = majorRevision;
+    data.items.reserve(items.size());
+    for (const auto& item : items) data.items.push_back(item.second);
+    return data;
+  }
+
+  RTM_ERROR_CODE apply(LoopbackMetadataOperation operation, const Metadata& data, const MetadataOptions& options,
+                       std::string_view author, LoopbackMetadata& changed) {
+    if (data.itemCount > 0 && !data.items) return RTM_ERROR_STORAGE_INVALID_METADATA_ITEM;
+    if (data.majorRevision >= 0 && data.majorRevision != majorRevision) return RTM_ERROR_STORAGE_OUTDATED_REVISION;
+    StringSet seen;
+    for (size_t i = 0; i < data.itemCount; ++i) {
+      const MetadataItem& item = data.items[i];
+      std::string_view key = viewOf(item.key);
+      if (key.empty()) return RTM_ERROR_STORAGE_INVALID_KEY;
+      if (!seen.emplace(key).second) return RTM_ERROR_STORAGE_DUPLICATE_KEY;
+      if (operation != LoopbackMetadataOperation::remove && !item.value) return RTM_ERROR_STORAGE_INVALID_VALUE;
+      auto existing = items.find(key);
+      if (operation == LoopbackMetadataOperation::update && existing == items.end()) {
+        return RTM_ERROR_STORAGE_INVALID_KEY;
+      }
+      int64_t current = existing == items.end() ? 0 : existing->second.revision;
+      if (item.revision >= 0 && item.revision != current) return RTM_ERROR_STORAGE_OUTDATED_REVISION;
+    }
+
+    ++majorRevision;
+    int64_t now = static_cast<int64_t>(rtmServerTimestamp());
+    changed.majorRevision = majorRevision;
+    if (operation == LoopbackMetadataOperation::remove) {
+      if (data.itemCount == 0) {
+        for (auto& entry : items) {
+          changed.items.push_back({entry.first, "", std::string(author), majorRevision, now});
+        }
+        items.clear();
+        return RTM_ERROR_OK;
+      }
+      for (size_t i = 0; i < data.itemCount; ++i) {
+        auto existing = items.find(viewOf(data.items[i].key));
+        if (existing == items.end()) continue;
+        changed.items.push_back({existing->first, "", std::string(author), majorRevision, now});
+        items.erase(existing);
+      }
+      return RTM_ERROR_OK;
+    }
+    for (size_t i = 0; i < data.itemCount; ++i) {
+      const MetadataItem& item = data.items[i];
+      LoopbackMetadataItem& stored = items[item.key];
+      stored.key = item.key;
+      stored.value = item.value;
+      stored.revision = majorRevision;
+      stored.updateTs = options.recordTs ? now : 0;
+      stored.authorUserId = options.recordUserId ? std::string(author) : std::string();
+      changed.items.push_back(stored);
+    }
+    return RTM_ERROR_OK;
+  }
+};
+
+struct LockWaiter {
+  LoopbackSessionPtr session;
+  uint64_t requestId = 0;
+};
+
+struct LockState {
+  std::string owner;
+  uint32_t ttl = 0;
+  std::vector<LockWaiter> waiters;
+  /// The owner left the channel at `ownerLeftAt`; the lock expires `ttl` seconds later unless they rejoin.
+  bool ownerAway = false;
+  RtmClock::time_point ownerLeftAt;
+};
+
+struct TopicPublisher {
+  std::string userId;
+  std::string meta;
+};
+
+struct TopicSubscription {
+  LoopbackSessionPtr session;
+  bool allPublishers = false;
+  std::vector<std::string> users;
+
+  bool wants(std::string_view publisher) const {
+    return allPublishers || std::find(users.begin(), users.end(), publisher) != users.end();
+  }
+};
+
+struct Topic {
+  std::vector<TopicPublisher> publishers;
+  std::vector<TopicSubscription> subscriptions;
+  /// Receivers per publisher, rebuilt lazily after any publisher or subscription change.
+  StringMap<std::shared_ptr<const SessionList>> targetsByPublisher;
+
+  bool empty() const { return publishers.empty() && subscriptions.empty(); }
+
+  bool hasPublisher(std::string_view userId) const {
+    return std::any_of(publishers.begin(), publishers.end(),
+                       [&](const TopicPublisher& publisher) { return publisher.userId == userId; });
+  }
+
+  TopicSubscription* findSubscription(const LoopbackSession* session) {
+    for (auto& subscription : subscriptions) {
+      if (subscription.session.get() == session) return &subscription;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<const SessionList> targetsFor(std::string_view publisher) {
+    auto cached = targetsByPublisher.find(publisher);
+    if (cached != targetsByPublisher.end()) return cached->second;
+    auto targets = std::make_shared<SessionList>();
+    for (const auto& subscription : subscriptions) {
+      if (subscription.session->userId != publisher && subscription.wants(publisher)) {
+        targets->push_back(subscription.session);
+      }
+    }
+    return targetsByPublisher.emplace(std::string(publisher), std::move(targets)).first->second;
+  }
+};
+
+struct OwnedTopicInfo {
+  std::string topic;
+  std::vector<TopicPublisher> publishers;
+};
+
+/// Presence changes a channel in interval mode holds until `flushPresenceIntervals`.
+struct PresenceInterval {
+  /// Net membership change per user since the last flush: true for joined, false for left.
+  StringMap<bool> membership;
+  StringMap<StatePairs> states;
+
+  bool empty() const { return membership.empty() && states.empty(); }
+
+  void join(std::string_view userId) {
+    auto found = membership.find(userId);
+    if (found != membership.end() && !found->second) {
+      // Left and came back within the interval: still present, with fresh states.
+      membership.erase(found);
+      states[std::string(userId)].clear();
+      return;
+    }
+    membership[std::string(userId)] = true;
+  }
+
+  void leave(std::string_view userId) {
+    auto state = states.find(userId);
+    if (state != states.end()) states.erase(state);
+    auto found = membership.find(userId);
+    if (found != membership.end() && found->second) {
+      membership.erase(found);
+      return;
+    }
+    membership[std::string(userId)] = false;
+  }
+
+  void setStates(std::string_view userId, const StatePairs& userStates) { states[std::string(userId)] = userStates; }
+};
+
+struct Channel {
+  std::vector<Member> members;
+  StringMap<size_t> memberIndex;
+  /// Members that are not `beQuiet`.
+  size_t visible = 0;
+  PresenceInterval interval;
+  std::shared_ptr<const SessionList> messageTargets = std::make_shared<SessionList>();
+  MetadataStore metadata;
+  std::map<std::string, LockState, std::less<>> locks;
+  std::map<std::string, Topic, std::less<>> topics;
+
+  bool empty() const { return members.empty() && metadata.empty() && locks.empty() && topics.empty(); }
+
+  Member* findMember(std::string_view userId) {
+    auto found = memberIndex.find(userId);
+    return found == memberIndex.end() ? nullptr : &members[found->second];
+  }
+
+  bool inIntervalMode(size_t threshold) const { return threshold > 0 && visible > threshold; }
+
+  void addMember(Member member) {
+    if (!member.options.beQuiet) ++visible;
+    memberIndex.emplace(member.session->userId, members.size());
+    members.push_back(std::move(member));
+    if (members.back().options.withMessage) rebuildMessageTargets();
+  }
+
+  Member removeMember(std::string_view userId) {
+    auto found = memberIndex.find(userId);
+    size_t index = found->second;
+    memberIndex.erase(found);
+    Member removed = std::move(members[index]);
+    if (index + 1 != members.size()) {
+      members[index] = std::move(members.back());
+      memberIndex[members[index].session->userId] = index;
+    }
+    members.pop_back();
+    if (!removed.options.beQuiet) --visible;
+    if (removed.options.withMessage) rebuildMessageTargets();
+    return removed;
+  }
+
+  void rebuildMessageTargets() {
+    auto targets = std::make_shared<SessionList>();
+    for (const auto& member : members) {
+      if (member.options.withMessage) targets->push_back(member.session);
+    }
+    messageTargets = std::move(targets);
+  }
+
+  template <typename Predicate>
+  SessionList sessionsWhere(Predicate predicate) const {
+    SessionList sessions;
+    for (const auto& member : members) {
+      if (predicate(member)) sessions.push_back(member.session);
+    }
+    return sessions;
+  }
+
+  SessionList presenceWatchers(const LoopbackSession* except) const {
+    return sessionsWhere([&](const Member& member) {
+      return member.options.withPresence && member.session.get() != except;
+    });
+  }
+
+  SessionList metadataWatchers() const {
+    return sessionsWhere([](const Member& member) { return member.options.withMetadata; });
+  }
+
+  SessionList lockWatchers() const {
+    return sessionsWhere([](const Member& member) { return member.options.withLock; });
+  }
+
+  SessionList everyoneBut(const LoopbackSession* except) const {
+    return sessionsWhere([&](const Member& member) { return member.session.get() != except; });
+  }
+
+  std::vector<LoopbackUserState> visibleUsers() const {
+    std::vector<LoopbackUserState> users;
+    users.reserve(members.size());
+    for (const auto& member : members) {
+      if (!member.options.beQuiet) users.push_back({member.session->userId, member.states});
+    }
+    return users;
+  }
+
+  std::vector<LoopbackLock> lockList() const {
+    std::vector<LoopbackLock> list;
+    list.reserve(locks.size());
+    for (const auto& lock : locks) list.push_back({lock.first, lock.second.owner, lock.second.ttl});
+    return list;
+  }
+
+  std::vector<OwnedTopicInfo> topicInfos() const {
+    std::vector<OwnedTopicInfo> infos;
+    for (const auto& topic : topics) {
+      if (!topic.second.publishers.empty()) infos.push_back({topic.first, topic.second.publishers});
+    }
+    return infos;
+  }
+};
+
+bool isChannelType(RTM_CHANNEL_TYPE channelType) {
+  return channelType == RTM_CHANNEL_TYPE_MESSAGE || channelType == RTM_CHANNEL_TYPE_STREAM;
+}
+
+RTM_ERROR_CODE notMemberError(RTM_CHANNEL_TYPE channelType) {
+  return channelType == RTM_CHANNEL_TYPE_STREAM ? RTM_ERROR_CHANNEL_NOT_JOINED : RTM_ERROR_CHANNEL_NOT_SUBSCRIBED;
+}
+
+void deliverTo(const SessionList& targets, const std::function<void(IRtmEventHandler&)>& call) {
+  for (const auto& target : targets) {
+    if (target->online.load(std::memory_order_relaxed)) call(*target->handler);
+  }
+}
+
+struct PresencePayload {
+  PresencePayload(RTM_PRESENCE_EVENT_TYPE type, RTM_CHANNEL_TYPE channelType, std::string_view channelName,
+                  std::string_view publisher, StatePairs states, std::vector<LoopbackUserState> snapshot)
+      : channelName(channelName),
+        publisher(publisher),
+        states(std::move(states)),
+        snapshot(std::move(snapshot)),
+        statesView(this->states),
+        snapshotView(this->snapshot) {
+    event.type = type;
+    event.channelType = channelType;
+    event.channelName = this->channelName.c_str();
+    event.publisher = this->publisher.c_str();
+    event.stateItems = statesView.data();
+    event.stateItemCount = statesView.size();
+    event.snapshot.userStateList = snapshotView.data();
+    event.snapshot.userCount = snapshotView.size();
+    event.timestamp = rtmServerTimestamp();
+  }
+
+  std::string channelName;
+  std::string publisher;
+  StatePairs states;
+  std::vector<LoopbackUserState> snapshot;
+  StateItemsView statesView;
+  UserStatesView snapshotView;
+  IRtmEventHandler::PresenceEvent event;
+};
+
+void queuePresenceEvent(LoopbackEventBatch& events, SessionList targets, RTM_PRESENCE_EVENT_TYPE type,
+                        RTM_CHANNEL_TYPE channelType, std::string_view channelName, std::string_view publisher,
+                        StatePairs states, std::vector<LoopbackUserState> snapshot = {}) {
+  if (targets.empty()) return;
+  auto payload = std::make_shared<PresencePayload>(type, channelType, channelName, publisher, std::move(states),
+                                                   std::move(snapshot));
+  events.add([payload, targets = std::move(targets)] {
+    deliverTo(targets, [&](IRtmEventHandler& handler) { handler.onPresenceEvent(payload->event); });
+  });
+}
+
+struct IntervalPayload {
+  IntervalPayload(RTM_CHANNEL_TYPE channelType, std::string_view channelName, std::vector<std::string> joins,
+                  std::vector<std::string> leaves, std::vector<LoopbackUserState> states)
+      : channelName(channelName),
+        joins(std::move(joins)),
+        leaves(std::move(leaves)),
+        states(std::move(states)),
+        joinsView(this->joins),
+        leavesView(this->leaves),
+        statesView(this->states) {
+    event.type = RTM_PRESENCE_EVENT_TYPE_INTERVAL;
+    event.channelType = channelType;
+    event.channelName = this->channelName.c_str();
+    event.publisher = "";
+    event.interval.joinUserList = joinsView.list();
+    event.interval.leaveUserList = leavesView.list();
+    event.interval.userStateList = statesView.data();
+    event.interval.userStateCount = statesView.size();
+    event.timestamp = rtmServerTimestamp();
+  }
+
+  std::string channelName;
+  std::vector<std::string> joins;
+  std::vector<std::string> leaves;
+  std::vector<LoopbackUserState> states;
+  UserListView joinsView;
+  UserListView leavesView;
+  UserStatesView statesView;
+  IRtmEventHandler::PresenceEvent event;
+};
+
+void queueIntervalEvent(LoopbackEventBatch& events, SessionList targets, RTM_CHANNEL_TYPE channelType,
+                        std::string_view channelName, PresenceInterval interval) {
+  if (targets.empty()) return;
+  std::vector<std::string> joins, leaves;
+  for (auto& entry : interval.membership) (entry.second ? joins : leaves).push_back(entry.first);
+  std::vector<LoopbackUserState> states;
+  states.reserve(interval.states.size());
+  for (auto& entry : interval.states) states.push_back({entry.first, std::move(entry.second)});
+  auto payload = std::make_shared<IntervalPayload>(channelType, channelName, std::move(joins), std::move(leaves),
+                                                   std::move(states));
+  events.add([payload, targets = std::move(targets)] {
+    deliverTo(targets, [&](IRtmEventHandler& handler) { handler.onPresenceEvent(payload->event); });
+  });
+}
+
+struct StoragePayload {
+  StoragePayload(RTM_STORAGE_EVENT_TYPE type, RTM_STORAGE_TYPE storageType, RTM_CHANNEL_TYPE channelType,
+                 std::string_view target, LoopbackMetadata data)
+      : target(target), data(std::move(data)), view(this->data) {
+    event.channelType = channelType;
+    event.storageType = storageType;
+    event.eventType = type;
+    event.target = this->target.c_str();
+    event.data = view.metadata();
+    event.timestamp = rtmServerTimestamp();
+  }
+
+  std::string target;
+  LoopbackMetadata data;
+  MetadataView view;
+  IRtmEventHandler::StorageEvent event;
+};
+
+void queueStorageEvent(LoopbackEventBatch& events, SessionList targets, RTM_STORAGE_EVENT_TYPE type,
+                       RTM_STORAGE_TYPE storageType, RTM_CHANNEL_TYPE channelType, std::string_view target,
+                       LoopbackMetadata data) {
+  if (targets.empty()) return;
+  auto payload = std::make_shared<StoragePayload>(type, storageType, channelType, target, std::move(data));
+  events.add([payload, targets = std::move(targets)] {
+    deliverTo(targets, [&](IRtmEventHandler& handler) { handler.onStorageEvent(payload->event); });
+  });
+}
+
+struct LockPayload {
+  LockPayload(RTM_LOCK_EVENT_TYPE type, RTM_CHANNEL_TYPE channelType, std::string_view channelName,
+              std::vector<LoopbackLock> locks)
+      : channelName(channelName), locks(std::move(locks)), view(this->locks) {
+    event.channelType = channelType;
+    event.eventType = type;
+    event.channelName = this->channelName.c_str();
+    event.lockDetailList = view.data();
+    event.count = view.size();
+    event.timestamp = rtmServerTimestamp();
+  }
+
+  std::string channelName;
+  std::vector<LoopbackLock> locks;
+  LockDetailsView view;
+  IRtmEventHandler::LockEvent event;
+};
+
+void queueLockEvent(LoopbackEventBatch& events, SessionList targets, RTM_LOCK_EVENT_TYPE type,
+                    RTM_CHANNEL_TYPE channelType, std::string_view channelName, std::vector<LoopbackLock> locks) {
+  if (targets.empty()) return;
+  auto payload = std::make_shared<LockPayload>(type, channelType, channelName, std::move(locks));
+  events.add([payload, targets = std::move(targets)] {
+    deliverTo(targets, [&](IRtmEventHandler& handler) { handler.onLockEvent(payload->event); });
+  });
+}
+
+void queueAcquireResult(LoopbackEventBatch& events, LoopbackSessionPtr session, uint64_t requestId,
+                        RTM_CHANNEL_TYPE channelType, std::string_view channelName, std::string_view lockName,
+                        RTM_ERROR_CODE errorCode) {
+  events.add([session = std::move(session), requestId, channelType, channelName = std::string(channelName),
+              lockName = std::string(lockName), errorCode] {
+    if (!session->online.load(std::memory_order_relaxed)) return;
+    session->handler->onAcquireLockResult(requestId, channelName.c_str(), channelType, lockName.c_str(), errorCode,
+                                          "");
+  });
+}
+
+struct TopicPayload {
+  TopicPayload(RTM_TOPIC_EVENT_TYPE type, std::string_view channelName, std::string_view publisher,
+               std::vector<OwnedTopicInfo> topics)
+      : channelName(channelName), publisher(publisher), topics(std::move(topics)) {
+    size_t publisherCount = 0;
+    for (const auto& topic : this->topics) publisherCount += topic.publishers.size();
+    publisherInfos.reserve(publisherCount);
+    topicInfos.reserve(this->topics.size());
+    for (const auto& topic : this->topics) {
+      TopicInfo info;
+      info.topic = topic.topic.c_str();
+      info.publishers = publisherInfos.data() + publisherInfos.size();
+      info.publisherCount = topic.publishers.size();
+      for (const auto& source : topic.publishers) {
+        PublisherInfo publisherInfo;
+        publisherInfo.publisherUserId = source.userId.c_str();
+        publisherInfo.publisherMeta = source.meta.c_str();
+        publisherInfos.push_back(publisherInfo);
+      }
+      topicInfos.push_back(info);
+    }
+    event.type = type;
+    event.channelName = this->channelName.c_str();
+    event.publisher = this->publisher.c_str();
+    event.topicInfos = topicInfos.empty() ? nullptr : topicInfos.data();
+    event.topicInfoCount = topicInfos.size();
+    event.timestamp = rtmServerTimestamp();
+  }
+
+  std::string channelName;
+  std::string publisher;
+  std::vector<OwnedTopicInfo> topics;
+  std::vector<PublisherInfo> publisherInfos;
+  std::vector<TopicInfo> topicInfos;
+  IRtmEventHandler::TopicEvent event;
+};
+
+void queueTopicEvent(LoopbackEventBatch& events, SessionList targets, RTM_TOPIC_EVENT_TYPE type,
+                     std::string_view channelName, std::string_view publisher, std::vector<OwnedTopicInfo> topics) {
+  if (targets.empty()) return;
+  auto payload = std::make_shared<TopicPayload>(type, channelName, publisher, std::move(topics));
+  events.add([payload, targets = std::move(targets)] {
+    deliverTo(targets, [&](IRtmEventHandler& handler) { handler.onTopicEvent(payload->event); });
+  });
+}
+
+RTM_STORAGE_EVENT_TYPE storageEventType(LoopbackMetadataOperation operation) {
+  switch (operation) {
+    case LoopbackMetadataOperation::set:
+      return RTM_STORAGE_EVENT_TYPE_SET;
+    case LoopbackMetadataOperation::update:
+      return RTM_STORAGE_EVENT_TYPE_UPDATE;
+    case LoopbackMetadataOperation::remove:
+      return RTM_STORAGE_EVENT_TYPE_REMOVE;
+  }
+  return RTM_STORAGE_EVENT_TYPE_NONE;
+}
+
+/// Frees a held lock and hands it to the first parked acquirer that is still online.
+/// Must be called with the owning shard locked.
+void handOverLock(Channel& channel, std::string_view lockName, LockState& lock, RTM_CHANNEL_TYPE channelType,
+                  std::string_view channelName, RTM_LOCK_EVENT_TYPE freedAs, LoopbackEventBatch& events) {
+  std::string previousOwner = std::move(lock.owner);
+  lock.owner.clear();
+  lock.ownerAway = false;
+  queueLockEvent(events, channel.lockWatchers(), freedAs, channelType, channelName,
+                 {{std::string(lockName), previousOwner, lock.ttl}});
+  while (!lock.waiters.empty()) {
+    LockWaiter waiter = std::move(lock.waiters.front());
+    lock.waiters.erase(lock.waiters.begin());
+    if (!waiter.session->online.load(std::memory_order_relaxed)) continue;
+    lock.owner = waiter.session->userId;
+    queueLockEvent(events, channel.lockWatchers(), RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED, channelType, channelName,
+                   {{std::string(lockName), lock.owner, lock.ttl}});
+    queueAcquireResult(events, std::move(waiter.session), waiter.requestId, channelType, channelName, lockName,
+                       RTM_ERROR_OK);
+    break;
+  }
+}
+
+/// Tells the channel's presence watchers about a member's new states, directly or with the next interval.
+void announceStates(Channel& channel, const Member& member, size_t intervalThreshold, RTM_CHANNEL_TYPE channelType,
+                    std::string_view channelName, LoopbackEventBatch& events) {
+  if (member.options.beQuiet) return;
+  if (channel.inIntervalMode(intervalThreshold)) {
+    channel.interval.setStates(member.session->userId, member.states);
+    return;
+  }
+  queuePresenceEvent(events, channel.presenceWatchers(member.session.get()),
+                     RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED, channelType, channelName, member.session->userId,
+                     member.states);
+}
+
+}  // namespace
+
+LoopbackResultDispatcher::~LoopbackResultDispatcher() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  if (thread_.joinable()) thread_.join();
+}
+
+void LoopbackResultDispatcher::post(LoopbackSessionPtr session, Result result) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopping_) return;
+    queue_.push_back({std::move(session), std::move(result)});
+    if (!thread_.joinable()) thread_ = std::thread([this] { run(); });
+  }
+  wake_.notify_one();
+}
+
+void LoopbackResultDispatcher::forget(const LoopbackSession& session) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                              [&](const Pending& pending) { return pending.session.get() == &session; }),
+               queue_.end());
+  if (std::this_thread::get_id() == thread_.get_id()) return;
+  delivered_.wait(lock, [&] { return delivering_ != &session; });
+}
+
+void LoopbackResultDispatcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (stopping_) return;
+    Pending next = std::move(queue_.front());
+    queue_.pop_front();
+    delivering_ = next.session.get();
+    lock.unlock();
+    next.result(*next.session->handler);
+    next = Pending();
+    lock.lock();
+    delivering_ = nullptr;
+    delivered_.notify_all();
+  }
+}
+
+struct LoopbackBroker::ChannelShard {
+  mutable std::mutex mutex;
+  StringMap<Channel> messageChannels;
+  StringMap<Channel> streamChannels;
+
+  StringMap<Channel>& channels(RTM_CHANNEL_TYPE channelType) {
+    return channelType == RTM_CHANNEL_TYPE_STREAM ? streamChannels : messageChannels;
+  }
+
+  Channel* find(std::string_view channelName, RTM_CHANNEL_TYPE channelType) {
+    auto& map = channels(channelType);
+    auto found = map.find(channelName);
+    return found == map.end() ? nullptr : &found->second;
+  }
+
+  Channel& ensure(std::string_view channelName, RTM_CHANNEL_TYPE channelType) {
+    auto& map = channels(channelType);
+    auto found = map.find(channelName);
+    if (found != map.end()) return found->second;
+    return map.emplace(std::string(channelName), Channel()).first->second;
+  }
+
+  void prune(std::string_view channelName, RTM_CHANNEL_TYPE channelType) {
+    auto& map = channels(channelType);
+    auto found = map.find(channelName);
+    if (found != map.end() && found->second.empty()) map.erase(found);
+  }
+};
+
+struct LoopbackBroker::UserShard {
+  mutable std::mutex mutex;
+  StringMap<LoopbackSessionPtr> sessions;
+  StringMap<MetadataStore> metadata;
+  StringMap<SessionList> metadataWatchers;
+};
+
+LoopbackBroker::LoopbackBroker() : LoopbackBroker(Options()) {}
+
+LoopbackBroker::LoopbackBroker(const Options& options) : options_(options) {
+  if (options_.shardCount == 0) options_.shardCount = 1;
+  if (options_.presencePageSize == 0) options_.presencePageSize = 1;
+  for (size_t i = 0; i < options_.shardCount; ++i) {
+    channelShards_.push_back(std::make_unique<ChannelShard>());
+    userShards_.push_back(std::make_unique<UserShard>());
+  }
+}
+
+LoopbackBroker::~LoopbackBroker() = default;
+
+LoopbackBroker& LoopbackBroker::shared() {
+  static LoopbackBroker broker;
+  return broker;
+}
+
+LoopbackBroker::ChannelShard& LoopbackBroker::channelShard(std::string_view channelName) const {
+  return *channelShards_[TransparentStringHash()(channelName) % channelShards_.size()];
+}
+
+LoopbackBroker::UserShard& LoopbackBroker::userShard(std::string_view userId) const {
+  return *userShards_[TransparentStringHash()(userId) % userShards_.size()];
+}
+
+RtmClock::time_point LoopbackBroker::now() const { return options_.clock ? options_.clock() : RtmClock::now(); }
+
+RTM_ERROR_CODE LoopbackBroker::login(const LoopbackSessionPtr& session, LoopbackEventBatch& events) {
+  if (session->online.load()) return RTM_ERROR_OK;
+  if (options_.loginsPerSecond > 0) {
+    RtmClock::time_point now = this->now();
+    std::lock_guard<std::mutex> guard(loginMutex_);
+    if (loginWindow_.admitted == 0 || now - loginWindow_.start >= std::chrono::seconds(1)) {
+      loginWindow_.start = now;
+      loginWindow_.admitted = 0;
+    }
+    if (loginWindow_.admitted >= options_.loginsPerSecond) return RTM_ERROR_LOGIN_NO_SERVER_RESOURCES;
+    ++loginWindow_.admitted;
+  }
+  LoopbackSessionPtr previous;
+  {
+    UserShard& shard = userShard(session->userId);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    LoopbackSessionPtr& slot = shard.sessions[session->userId];
+    previous = std::move(slot);
+    slot = session;
+  }
+  session->online.store(true);
+  if (previous && previous != session) {
+    logout(previous, events);
+    events.add([previous] {
+      IRtmEventHandler::LinkStateEvent event;
+      event.currentState = RTM_LINK_STATE_FAILED;
+      event.previousState = RTM_LINK_STATE_CONNECTED;
+      event.operation = RTM_LINK_OPERATION_SERVER_REJECT;
+      event.reason = "same uid login";
+      event.timestamp = rtmServerTimestamp();
+      previous->handler->onLinkStateEvent(event);
+    });
+  }
+  return RTM_ERROR_OK;
+}
+
+void LoopbackBroker::logout(const LoopbackSessionPtr& session, LoopbackEventBatch& events) {
+  std::vector<LoopbackChannelRef> channels;
+  {
+    std::lock_guard<std::mutex> guard(session->mutex);
+    channels = session->channels;
+  }
+  for (const auto& channel : channels) leaveChannel(session, channel.channelName, channel.channelType, events);
+  for (auto& shard : userShards_) {
+    std::lock_guard<std::mutex> guard(shard->mutex);
+    for (auto& watchers : shard->metadataWatchers) {
+      auto& list = watchers.second;
+      list.erase(std::remove(list.begin(), list.end(), session), list.end());
+    }
+  }
+  {
+    UserShard& shard = userShard(session->userId);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto found = shard.sessions.find(session->userId);
+    if (found != shard.sessions.end() && found->second == session) shard.sessions.erase(found);
+  }
+  session->online.store(false);
+}
+
+LoopbackSessionPtr LoopbackBroker::findSession(std::string_view userId) const {
+  UserShard& shard = userShard(userId);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto found = shard.sessions.find(userId);
+  return found == shard.sessions.end() ? nullptr : found->second;
+}
+
+bool LoopbackBroker::admit(LoopbackSession& session, LoopbackRateClass rateClass) {
+  size_t limit = rateClass == LoopbackRateClass::publish ? options_.publishesPerSecond : options_.subscribesPerSecond;
+  if (limit == 0) return true;
+  RtmClock::time_point now = this->now();
+  std::lock_guard<std::mutex> guard(session.mutex);
+  LoopbackRateWindow& window =
+      rateClass == LoopbackRateClass::publish ? session.publishWindow : session.subscribeWindow;
+  if (window.admitted == 0 || now - window.start >= std::chrono::seconds(1)) {
+    window.start = now;
+    window.admitted = 0;
+  }
+  if (window.admitted >= limit) return false;
+  ++window.admitted;
+  return true;
+}
+
+RTM_ERROR_CODE LoopbackBroker::joinChannel(const LoopbackSessionPtr& session, std::string_view channelName,
+                                           RTM_CHANNEL_TYPE channelType, const LoopbackMemberOptions& options,
+                                           LoopbackEventBatch& events) {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel& channel = shard.ensure(channelName, channelType);
+  if (channel.findMember(session->userId)) return RTM_ERROR_DUPLICATE_OPERATION;
+  channel.addMember({session, options, {}});
+  {
+    std::lock_guard<std::mutex> sessionGuard(session->mutex);
+    session->channels.push_back({std::string(channelName), channelType});
+  }
+  for (auto& entry : channel.locks) {
+    if (entry.second.owner == session->userId) entry.second.ownerAway = false;
+  }
+
+  if (!options.beQuiet) {
+    if (channel.inIntervalMode(options_.presenceIntervalThreshold)) {
+      channel.interval.join(session->userId);
+    } else {
+      queuePresenceEvent(events, channel.presenceWatchers(session.get()),
+                         RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL, channelType, channelName, session->userId, {});
+    }
+  }
+  if (options.withPresence) {
+    queuePresenceEvent(events, {session}, RTM_PRESENCE_EVENT_TYPE_SNAPSHOT, channelType, channelName, "", {},
+                       channel.visibleUsers());
+  }
+  if (options.withMetadata) {
+    queueStorageEvent(events, {session}, RTM_STORAGE_EVENT_TYPE_SNAPSHOT, RTM_STORAGE_TYPE_CHANNEL, channelType,
+                      channelName, channel.metadata.snapshot());
+  }
+  if (options.withLock) {
+    queueLockEvent(events, {session}, RTM_LOCK_EVENT_TYPE_SNAPSHOT, channelType, channelName, channel.lockList());
+  }
+  if (channelType == RTM_CHANNEL_TYPE_STREAM) {
+    queueTopicEvent(events, {session}, RTM_TOPIC_EVENT_TYPE_SNAPSHOT, channelName, "", channel.topicInfos());
+  }
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::leaveChannel(const LoopbackSessionPtr& session, std::string_view channelName,
+                                            RTM_CHANNEL_TYPE channelType, LoopbackEventBatch& events) {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (!channel || !channel->findMember(session->userId)) return notMemberError(channelType);
+
+  bool interval = channel->inIntervalMode(options_.presenceIntervalThreshold);
+  Member member = channel->removeMember(session->userId);
+  {
+    std::lock_guard<std::mutex> sessionGuard(session->mutex);
+    auto& channels = session->channels;
+    channels.erase(std::remove_if(channels.begin(), channels.end(),
+                                  [&](const LoopbackChannelRef& ref) {
+                                    return ref.channelType == channelType && ref.channelName == channelName;
+                                  }),
+                   channels.end());
+  }
+
+  if (!member.options.beQuiet) {
+    if (interval) {
+      channel->interval.leave(session->userId);
+    } else {
+      queuePresenceEvent(events, channel->presenceWatchers(nullptr), RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL,
+                         channelType, channelName, session->userId, {});
+    }
+  }
+
+  for (auto topic = channel->topics.begin(); topic != channel->topics.end();) {
+    auto& publishers = topic->second.publishers;
+    auto published = std::find_if(publishers.begin(), publishers.end(),
+                                  [&](const TopicPublisher& publisher) { return publisher.userId == session->userId; });
+    if (published != publishers.end()) {
+      queueTopicEvent(events, channel->everyoneBut(nullptr), RTM_TOPIC_EVENT_TYPE_REMOTE_LEAVE_TOPIC, channelName,
+                      session->userId, {{topic->first, {*published}}});
+      publishers.erase(published);
+    }
+    auto& subscriptions = topic->second.subscriptions;
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                       [&](const TopicSubscription& subscription) {
+                                         return subscription.session == session;
+                                       }),
+                        subscriptions.end());
+    topic->second.targetsByPublisher.clear();
+    topic = topic->second.empty() ? channel->topics.erase(topic) : std::next(topic);
+  }
+
+  for (auto& entry : channel->locks) {
+    LockState& lock = entry.second;
+    lock.waiters.erase(std::remove_if(lock.waiters.begin(), lock.waiters.end(),
+                                      [&](const LockWaiter& waiter) { return waiter.session == session; }),
+                       lock.waiters.end());
+    if (lock.owner != session->userId) continue;
+    if (lock.ttl == 0) {
+      handOverLock(*channel, entry.first, lock, channelType, channelName, RTM_LOCK_EVENT_TYPE_LOCK_EXPIRED, events);
+    } else if (!lock.ownerAway) {
+      lock.ownerAway = true;
+      lock.ownerLeftAt = now();
+    }
+  }
+
+  shard.prune(channelName, channelType);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::publish(const LoopbackSession& publisher, const char* channelName, const char* message,
+                                       size_t length, const PublishOptions& options) {
+  std::string_view name = viewOf(channelName);
+  if (name.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!message && length > 0) return RTM_ERROR_CHANNEL_INVALID_MESSAGE;
+  if (length > options_.maxMessageLength) return RTM_ERROR_CHANNEL_MESSAGE_LENGTH_EXCEED_LIMITATION;
+  if (viewOf(options.customType).size() > options_.maxCustomTypeLength) {
+    return RTM_ERROR_CHANNEL_CUSTOM_TYPE_LENGTH_OVERFLOW;
+  }
+
+  IRtmEventHandler::MessageEvent event;
+  event.messageType = options.messageType;
+  event.message = message;
+  event.messageLength = length;
+  event.publisher = publisher.userId.c_str();
+  event.customType = options.customType;
+  event.timestamp = rtmServerTimestamp();
+
+  if (options.channelType == RTM_CHANNEL_TYPE_USER) {
+    LoopbackSessionPtr receiver = findSession(name);
+    if (!receiver || !receiver->online.load(std::memory_order_relaxed)) return RTM_ERROR_CHANNEL_RECEIVER_OFFLINE;
+    event.channelType = RTM_CHANNEL_TYPE_USER;
+    event.channelName = publisher.userId.c_str();
+    receiver->handler->onMessageEvent(event);
+    return RTM_ERROR_OK;
+  }
+  if (options.channelType != RTM_CHANNEL_TYPE_MESSAGE) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+
+  std::shared_ptr<const SessionList> targets;
+  {
+    ChannelShard& shard = channelShard(name);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    Channel* channel = shard.find(name, RTM_CHANNEL_TYPE_MESSAGE);
+    if (!channel) return RTM_ERROR_OK;
+    targets = channel->messageTargets;
+  }
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.channelName = channelName;
+  for (const auto& target : *targets) {
+    if (target.get() != &publisher && target->online.load(std::memory_order_relaxed)) {
+      target->handler->onMessageEvent(event);
+    }
+  }
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::joinTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                         std::string_view topic, std::string_view meta, LoopbackEventBatch& events) {
+  if (topic.empty()) return RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, RTM_CHANNEL_TYPE_STREAM);
+  if (!channel || !channel->findMember(session->userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+  Topic& state = channel->topics[std::string(topic)];
+  if (state.hasPublisher(session->userId)) return RTM_ERROR_DUPLICATE_OPERATION;
+  TopicPublisher publisher{session->userId, std::string(meta)};
+  state.publishers.push_back(publisher);
+  state.targetsByPublisher.clear();
+  queueTopicEvent(events, channel->everyoneBut(session.get()), RTM_TOPIC_EVENT_TYPE_REMOTE_JOIN_TOPIC, channelName,
+                  session->userId, {{std::string(topic), {publisher}}});
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::leaveTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                          std::string_view topic, LoopbackEventBatch& events) {
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, RTM_CHANNEL_TYPE_STREAM);
+  if (!channel || !channel->findMember(session->userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+  auto state = channel->topics.find(topic);
+  if (state == channel->topics.end()) return RTM_ERROR_CHANNEL_TOPIC_NOT_JOINED;
+  auto& publishers = state->second.publishers;
+  auto published = std::find_if(publishers.begin(), publishers.end(),
+                                [&](const TopicPublisher& publisher) { return publisher.userId == session->userId; });
+  if (published == publishers.end()) return RTM_ERROR_CHANNEL_TOPIC_NOT_JOINED;
+  queueTopicEvent(events, channel->everyoneBut(session.get()), RTM_TOPIC_EVENT_TYPE_REMOTE_LEAVE_TOPIC, channelName,
+                  session->userId, {{state->first, {*published}}});
+  publishers.erase(published);
+  state->second.targetsByPublisher.clear();
+  if (state->second.empty()) channel->topics.erase(state);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::subscribeTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                              std::string_view topic, const std::vector<std::string>& users) {
+  if (topic.empty()) return RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, RTM_CHANNEL_TYPE_STREAM);
+  if (!channel || !channel->findMember(session->userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+  Topic& state = channel->topics[std::string(topic)];
+  TopicSubscription* subscription = state.findSubscription(session.get());
+  if (!subscription) {
+    state.subscriptions.push_back({session, false, {}});
+    subscription = &state.subscriptions.back();
+  }
+  if (users.empty()) subscription->allPublishers = true;
+  for (const auto& user : users) {
+    if (!subscription->wants(user)) subscription->users.push_back(user);
+  }
+  state.targetsByPublisher.clear();
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::unsubscribeTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                                std::string_view topic, const std::vector<std::string>& users) {
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, RTM_CHANNEL_TYPE_STREAM);
+  if (!channel || !channel->findMember(session->userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+  auto state = channel->topics.find(topic);
+  TopicSubscription* subscription =
+      state == channel->topics.end() ? nullptr : state->second.findSubscription(session.get());
+  if (!subscription) return RTM_ERROR_CHANNEL_TOPIC_NOT_SUBSCRIBED;
+  auto& subscriptions = state->second.subscriptions;
+  if (users.empty()) {
+    subscriptions.erase(subscriptions.begin() + (subscription - subscriptions.data()));
+  } else {
+    auto& list = subscription->users;
+    for (const auto& user : users) list.erase(std::remove(list.begin(), list.end(), user), list.end());
+  }
+  state->second.targetsByPublisher.clear();
+  if (state->second.empty()) channel->topics.erase(state);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::getSubscribedUsers(const LoopbackSessionPtr& session, std::string_view channelName,
+                                                  std::string_view topic, std::vector<std::string>& users) const {
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, RTM_CHANNEL_TYPE_STREAM);
+  if (!channel || !channel->findMember(session->userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+  auto state = channel->topics.find(topic);
+  TopicSubscription* subscription =
+      state == channel->topics.end() ? nullptr : state->second.findSubscription(session.get());
+  if (!subscription) return RTM_ERROR_CHANNEL_TOPIC_NOT_SUBSCRIBED;
+  if (!subscription->allPublishers) {
+    users = subscription->users;
+    return RTM_ERROR_OK;
+  }
+  for (const auto& publisher : state->second.publishers) {
+    if (publisher.userId != session->userId) users.push_back(publisher.userId);
+  }
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::publishTopicMessage(const LoopbackSession& publisher, const char* channelName,
+                                                   const char* topic, const char* message, size_t length,
+                                                   const TopicMessageOptions& options) {
+  std::string_view name = viewOf(channelName);
+  std::string_view topicName = viewOf(topic);
+  if (topicName.empty()) return RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME;
+  if (!message && length > 0) return RTM_ERROR_CHANNEL_INVALID_MESSAGE;
+  if (length > options_.maxMessageLength) return RTM_ERROR_CHANNEL_MESSAGE_LENGTH_EXCEED_LIMITATION;
+  if (viewOf(options.customType).size() > options_.maxCustomTypeLength) {
+    return RTM_ERROR_CHANNEL_CUSTOM_TYPE_LENGTH_OVERFLOW;
+  }
+
+  std::shared_ptr<const SessionList> targets;
+  {
+    ChannelShard& shard = channelShard(name);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    Channel* channel = shard.find(name, RTM_CHANNEL_TYPE_STREAM);
+    if (!channel || !channel->findMember(publisher.userId)) return RTM_ERROR_CHANNEL_NOT_JOINED;
+    auto state = channel->topics.find(topicName);
+    if (state == channel->topics.end() || !state->second.hasPublisher(publisher.userId)) {
+      return RTM_ERROR_CHANNEL_TOPIC_NOT_JOINED;
+    }
+    targets = state->second.targetsFor(publisher.userId);
+  }
+
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_STREAM;
+  event.messageType = options.messageType;
+  event.channelName = channelName;
+  event.channelTopic = topic;
+  event.message = message;
+  event.messageLength = length;
+  event.publisher = publisher.userId.c_str();
+  event.customType = options.customType;
+  event.timestamp = rtmServerTimestamp();
+  for (const auto& target : *targets) {
+    if (target->online.load(std::memory_order_relaxed)) target->handler->onMessageEvent(event);
+  }
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::writeChannelMetadata(const LoopbackSessionPtr& session, std::string_view channelName,
+                                                    RTM_CHANNEL_TYPE channelType, LoopbackMetadataOperation operation,
+                                                    const Metadata& data, const MetadataOptions& options,
+                                                    std::string_view lockName, LoopbackEventBatch& events) {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel& channel = shard.ensure(channelName, channelType);
+  RTM_ERROR_CODE code = RTM_ERROR_OK;
+  LoopbackMetadata changed;
+  if (!lockName.empty()) {
+    auto lock = channel.locks.find(lockName);
+    if (lock == channel.locks.end()) {
+      code = RTM_ERROR_STORAGE_INVALID_LOCK_NAME;
+    } else if (lock->second.owner != session->userId) {
+      code = RTM_ERROR_STORAGE_LOCK_NOT_ACQUIRED;
+    }
+  }
+  if (code == RTM_ERROR_OK) code = channel.metadata.apply(operation, data, options, session->userId, changed);
+  if (code == RTM_ERROR_OK) {
+    queueStorageEvent(events, channel.metadataWatchers(), storageEventType(operation), RTM_STORAGE_TYPE_CHANNEL,
+                      channelType, channelName, std::move(changed));
+  }
+  shard.prune(channelName, channelType);
+  return code;
+}
+
+RTM_ERROR_CODE LoopbackBroker::getChannelMetadata(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                                  LoopbackMetadata& data) const {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (channel) data = channel->metadata.snapshot();
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::writeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId,
+                                                 LoopbackMetadataOperation operation, const Metadata& data,
+                                                 const MetadataOptions& options, LoopbackEventBatch& events) {
+  if (userId.empty()) return RTM_ERROR_INVALID_USER_ID;
+  UserShard& shard = userShard(userId);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  MetadataStore& store = shard.metadata[std::string(userId)];
+  LoopbackMetadata changed;
+  RTM_ERROR_CODE code = store.apply(operation, data, options, session->userId, changed);
+  if (code != RTM_ERROR_OK) return code;
+  auto watchers = shard.metadataWatchers.find(userId);
+  if (watchers != shard.metadataWatchers.end()) {
+    queueStorageEvent(events, watchers->second, storageEventType(operation), RTM_STORAGE_TYPE_USER,
+                      RTM_CHANNEL_TYPE_USER, userId, std::move(changed));
+  }
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::getUserMetadata(std::string_view userId, LoopbackMetadata& data) const {
+  if (userId.empty()) return RTM_ERROR_INVALID_USER_ID;
+  UserShard& shard = userShard(userId);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto store = shard.metadata.find(userId);
+  if (store != shard.metadata.end()) data = store->second.snapshot();
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::subscribeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId,
+                                                     LoopbackEventBatch& events) {
+  if (userId.empty()) return RTM_ERROR_INVALID_USER_ID;
+  UserShard& shard = userShard(userId);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  SessionList& watchers = shard.metadataWatchers[std::string(userId)];
+  if (std::find(watchers.begin(), watchers.end(), session) == watchers.end()) watchers.push_back(session);
+  auto store = shard.metadata.find(userId);
+  queueStorageEvent(events, {session}, RTM_STORAGE_EVENT_TYPE_SNAPSHOT, RTM_STORAGE_TYPE_USER, RTM_CHANNEL_TYPE_USER,
+                    userId, store == shard.metadata.end() ? LoopbackMetadata() : store->second.snapshot());
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::unsubscribeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId) {
+  UserShard& shard = userShard(userId);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto watchers = shard.metadataWatchers.find(userId);
+  if (watchers == shard.metadataWatchers.end()) return RTM_ERROR_STORAGE_NOT_SUBSCRIBE;
+  auto& list = watchers->second;
+  auto found = std::find(list.begin(), list.end(), session);
+  if (found == list.end()) return RTM_ERROR_STORAGE_NOT_SUBSCRIBE;
+  list.erase(found);
+  if (list.empty()) shard.metadataWatchers.erase(watchers);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::whoNow(std::string_view channelName, RTM_CHANNEL_TYPE channelType, bool includeUserId,
+                                      bool includeState, std::string_view page, std::vector<LoopbackUserState>& users,
+                                      std::string& nextPage) const {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  size_t offset = 0;
+  if (!page.empty()) {
+    auto parsed = std::from_chars(page.data(), page.data() + page.size(), offset);
+    if (parsed.ec != std::errc() || parsed.ptr != page.data() + page.size()) {
+      return RTM_ERROR_PRESENCE_INVALID_ARGUMENT;
+    }
+  }
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (!channel) return RTM_ERROR_OK;
+  size_t visible = 0;
+  for (const auto& member : channel->members) {
+    if (member.options.beQuiet) continue;
+    if (visible >= offset && users.size() < options_.presencePageSize) {
+      LoopbackUserState state;
+      if (includeUserId) state.userId = member.session->userId;
+      if (includeState) state.states = member.states;
+      users.push_back(std::move(state));
+    }
+    ++visible;
+  }
+  if (offset + users.size() < visible) nextPage = std::to_string(offset + users.size());
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::whereNow(std::string_view userId, std::vector<LoopbackChannelRef>& channels) const {
+  if (userId.empty()) return RTM_ERROR_INVALID_USER_ID;
+  LoopbackSessionPtr session = findSession(userId);
+  if (!session) return RTM_ERROR_OK;
+  std::lock_guard<std::mutex> guard(session->mutex);
+  channels = session->channels;
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::setState(const LoopbackSessionPtr& session, std::string_view channelName,
+                                        RTM_CHANNEL_TYPE channelType, const StateItem* items, size_t count,
+                                        LoopbackEventBatch& events) {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  if (count > 0 && !items) return RTM_ERROR_PRESENCE_INVALID_ARGUMENT;
+  if (count > options_.maxStateCount) return RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  Member* member = channel ? channel->findMember(session->userId) : nullptr;
+  if (!member) return notMemberError(channelType);
+
+  StatePairs merged = member->states;
+  for (size_t i = 0; i < count; ++i) {
+    std::string_view key = viewOf(items[i].key);
+    if (key.empty()) return RTM_ERROR_PRESENCE_INVALID_STATE_KEY;
+    if (!items[i].value) return RTM_ERROR_PRESENCE_INVALID_STATE_VALUE;
+    auto existing = std::find_if(merged.begin(), merged.end(), [&](const auto& pair) { return pair.first == key; });
+    if (existing != merged.end()) {
+      existing->second = items[i].value;
+    } else {
+      merged.emplace_back(std::string(key), items[i].value);
+    }
+  }
+  if (merged.size() > options_.maxStateCount) return RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW;
+  member->states = std::move(merged);
+  announceStates(*channel, *member, options_.presenceIntervalThreshold, channelType, channelName, events);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::removeState(const LoopbackSessionPtr& session, std::string_view channelName,
+                                           RTM_CHANNEL_TYPE channelType, const char** keys, size_t count,
+                                           LoopbackEventBatch& events) {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  if (count > 0 && !keys) return RTM_ERROR_PRESENCE_INVALID_ARGUMENT;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  Member* member = channel ? channel->findMember(session->userId) : nullptr;
+  if (!member) return notMemberError(channelType);
+
+  StatePairs& states = member->states;
+  if (count == 0) {
+    states.clear();
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      std::string_view key = viewOf(keys[i]);
+      states.erase(std::remove_if(states.begin(), states.end(), [&](const auto& pair) { return pair.first == key; }),
+                   states.end());
+    }
+  }
+  announceStates(*channel, *member, options_.presenceIntervalThreshold, channelType, channelName, events);
+  return RTM_ERROR_OK;
+}
+
+void LoopbackBroker::flushPresenceIntervals() {
+  for (auto& shard : channelShards_) {
+    LoopbackEventBatch events;
+    {
+      std::lock_guard<std::mutex> guard(shard->mutex);
+      for (RTM_CHANNEL_TYPE channelType : {RTM_CHANNEL_TYPE_MESSAGE, RTM_CHANNEL_TYPE_STREAM}) {
+        for (auto& entry : shard->channels(channelType)) {
+          Channel& channel = entry.second;
+          if (channel.interval.empty()) continue;
+          queueIntervalEvent(events, channel.presenceWatchers(nullptr), channelType, entry.first,
+                             std::move(channel.interval));
+          channel.interval = PresenceInterval();
+        }
+      }
+    }
+    events.dispatch();
+  }
+}
+
+void LoopbackBroker::expireLocks() {
+  RtmClock::time_point now = this->now();
+  for (auto& shard : channelShards_) {
+    LoopbackEventBatch events;
+    {
+      std::lock_guard<std::mutex> guard(shard->mutex);
+      for (RTM_CHANNEL_TYPE channelType : {RTM_CHANNEL_TYPE_MESSAGE, RTM_CHANNEL_TYPE_STREAM}) {
+        for (auto& entry : shard->channels(channelType)) {
+          Channel& channel = entry.second;
+          for (auto& lock : channel.locks) {
+            LockState& state = lock.second;
+            if (!state.ownerAway || now - state.ownerLeftAt < std::chrono::seconds(state.ttl)) continue;
+            handOverLock(channel, lock.first, state, channelType, entry.first, RTM_LOCK_EVENT_TYPE_LOCK_EXPIRED,
+                         events);
+          }
+        }
+      }
+    }
+    events.dispatch();
+  }
+}
+
+RTM_ERROR_CODE LoopbackBroker::getState(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                        std::string_view userId, LoopbackUserState& state) const {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  Member* member = channel ? channel->findMember(userId) : nullptr;
+  if (!member) return RTM_ERROR_PRESENCE_USER_NOT_EXIST;
+  state.userId = member->session->userId;
+  state.states = member->states;
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::setLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                       RTM_CHANNEL_TYPE channelType, std::string_view lockName, uint32_t ttl,
+                                       LoopbackEventBatch& events) {
+  (void)session;
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  if (lockName.empty()) return RTM_ERROR_LOCK_INVALID_NAME;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel& channel = shard.ensure(channelName, channelType);
+  if (channel.locks.find(lockName) != channel.locks.end()) return RTM_ERROR_LOCK_ALREADY_EXIST;
+  LockState& lock = channel.locks[std::string(lockName)];
+  lock.ttl = ttl;
+  queueLockEvent(events, channel.lockWatchers(), RTM_LOCK_EVENT_TYPE_LOCK_SET, channelType, channelName,
+                 {{std::string(lockName), "", ttl}});
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::getLocks(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                        std::vector<LoopbackLock>& locks) const {
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (channel) locks = channel->lockList();
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::removeLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                          RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                          LoopbackEventBatch& events) {
+  (void)session;
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (!channel) return RTM_ERROR_LOCK_NOT_EXIST;
+  auto lock = channel->locks.find(lockName);
+  if (lock == channel->locks.end()) return RTM_ERROR_LOCK_NOT_EXIST;
+  for (auto& waiter : lock->second.waiters) {
+    queueAcquireResult(events, std::move(waiter.session), waiter.requestId, channelType, channelName, lockName,
+                       RTM_ERROR_LOCK_NOT_EXIST);
+  }
+  queueLockEvent(events, channel->lockWatchers(), RTM_LOCK_EVENT_TYPE_LOCK_REMOVED, channelType, channelName,
+                 {{lock->first, lock->second.owner, lock->second.ttl}});
+  channel->locks.erase(lock);
+  shard.prune(channelName, channelType);
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::acquireLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                           RTM_CHANNEL_TYPE channelType, std::string_view lockName, bool retry,
+                                           uint64_t requestId, bool& pending, std::string& errorDetails,
+                                           LoopbackEventBatch& events) {
+  pending = false;
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (!channel) return RTM_ERROR_LOCK_NOT_EXIST;
+  auto lock = channel->locks.find(lockName);
+  if (lock == channel->locks.end()) return RTM_ERROR_LOCK_NOT_EXIST;
+  LockState& state = lock->second;
+  if (state.owner == session->userId) return RTM_ERROR_OK;
+  if (state.owner.empty()) {
+    state.owner = session->userId;
+    queueLockEvent(events, channel->lockWatchers(), RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED, channelType, channelName,
+                   {{lock->first, state.owner, state.ttl}});
+    return RTM_ERROR_OK;
+  }
+  if (!retry) {
+    errorDetails = state.owner;
+    return RTM_ERROR_LOCK_ACQUIRE_FAILED;
+  }
+  state.waiters.push_back({session, requestId});
+  pending = true;
+  return RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE LoopbackBroker::releaseLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                           RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                           LoopbackEventBatch& events) {
+  return revokeLock(session, channelName, channelType, lockName, session->userId, events);
+}
+
+RTM_ERROR_CODE LoopbackBroker::revokeLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                          RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                          std::string_view owner, LoopbackEventBatch& events) {
+  (void)session;
+  if (channelName.empty()) return RTM_ERROR_INVALID_CHANNEL_NAME;
+  if (!isChannelType(channelType)) return RTM_ERROR_INVALID_CHANNEL_TYPE;
+  ChannelShard& shard = channelShard(channelName);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Channel* channel = shard.find(channelName, channelType);
+  if (!channel) return RTM_ERROR_LOCK_NOT_EXIST;
+  auto lock = channel->locks.find(lockName);
+  if (lock == channel->locks.end()) return RTM_ERROR_LOCK_NOT_EXIST;
+  if (owner.empty() || lock->second.owner != owner) return RTM_ERROR_LOCK_NOT_ACQUIRED;
+  handOverLock(*channel, lock->first, lock->second, channelType, channelName, RTM_LOCK_EVENT_TYPE_LOCK_RELEASED,
+               events);
+  return RTM_ERROR_OK;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,297 @@
+//
+//  LoopbackBroker.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+using StatePairs = std::vector<std::pair<std::string, std::string>>;
+
+struct LoopbackUserState {
+  std::string userId;
+  StatePairs states;
+};
+
+struct LoopbackMetadataItem {
+  std::string key;
+  std::string value;
+  std::string authorUserId;
+  int64_t revision = 0;
+  int64_t updateTs = 0;
+};
+
+struct LoopbackMetadata {
+  int64_t majorRevision = 0;
+  std::vector<LoopbackMetadataItem> items;
+};
+
+struct LoopbackLock {
+  std::string lockName;
+  std::string owner;
+  uint32_t ttl = 0;
+};
+
+struct LoopbackChannelRef {
+  std::string channelName;
+  agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_NONE;
+};
+
+/// Subscribe options of a message channel or join options of a stream channel, whichever created the membership.
+struct LoopbackMemberOptions {
+  bool withMessage = true;
+  bool withMetadata = false;
+  bool withPresence = true;
+  bool withLock = false;
+  bool beQuiet = false;
+};
+
+enum class LoopbackMetadataOperation { set, update, remove };
+
+/// Operation classes the broker rate-limits per session.
+enum class LoopbackRateClass { publish, subscribe };
+
+/// Fixed one-second admission window of one rate class.
+struct LoopbackRateWindow {
+  RtmClock::time_point start;
+  size_t admitted = 0;
+};
+
+/// One logged-in identity.
+/// Shared between its client and the broker, so deliveries already in flight outlive `release()`.
+struct LoopbackSession {
+  LoopbackSession(std::string userId, agora::rtm::IRtmEventHandler* handler)
+      : userId(std::move(userId)), handler(handler) {}
+
+  const std::string userId;
+  agora::rtm::IRtmEventHandler* const handler;
+  std::atomic<bool> online{false};
+
+  /// Channels this session subscribed or joined, guarded by `mutex`. Always taken after a shard lock.
+  std::mutex mutex;
+  std::vector<LoopbackChannelRef> channels;
+  /// Rate-limit windows, guarded by `mutex`.
+  LoopbackRateWindow publishWindow;
+  LoopbackRateWindow subscribeWindow;
+};
+
+using LoopbackSessionPtr = std::shared_ptr<LoopbackSession>;
+
+/// Event deliveries collected while a shard lock is held and run after it is released,
+/// so handlers are free to call back into the client.
+class LoopbackEventBatch {
+ public:
+  void add(std::function<void()> delivery) { deliveries_.push_back(std::move(delivery)); }
+
+  void dispatch() {
+    for (auto& delivery : deliveries_) delivery();
+    deliveries_.clear();
+  }
+
+ private:
+  std::vector<std::function<void()>> deliveries_;
+};
+
+/// Delivers request results on a thread of its own, the way the SDK answers on its callback thread, for clients
+/// that nobody pumps. Results of one session arrive in the order they were posted. The thread starts with the
+/// first result and stops with the dispatcher; results still queued then are dropped.
+class LoopbackResultDispatcher {
+ public:
+  using Result = std::function<void(agora::rtm::IRtmEventHandler&)>;
+
+  LoopbackResultDispatcher() = default;
+  ~LoopbackResultDispatcher();
+
+  LoopbackResultDispatcher(const LoopbackResultDispatcher&) = delete;
+  LoopbackResultDispatcher& operator=(const LoopbackResultDispatcher&) = delete;
+
+  /// Queues `result` for the session's handler.
+  void post(LoopbackSessionPtr session, Result result);
+  /// Drops the session's queued results and waits until none is being delivered, unless called from a delivery.
+  /// After it returns the session's handler is not called again.
+  void forget(const LoopbackSession& session);
+
+ private:
+  struct Pending {
+    LoopbackSessionPtr session;
+    Result result;
+  };
+
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable delivered_;
+  std::deque<Pending> queue_;
+  /// The session whose result is being delivered, if any.
+  const LoopbackSession* delivering_ = nullptr;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+/// In-process stand-in for the RTM service.
+///
+/// Channels and users are spread over independently locked shards, so clients publishing to different
+/// channels never contend. Events are delivered synchronously on the thread that triggered them; request results
+/// wait for `LoopbackRtmClient::pump` or go through the broker's `resultDispatcher()`.
+class LoopbackBroker {
+ public:
+  struct Options {
+    size_t shardCount = 16;
+    size_t maxMessageLength = 32 * 1024;
+    size_t maxCustomTypeLength = 32;
+    size_t maxStateCount = 32;
+    size_t presencePageSize = 100;
+    /// Publishes (channel and topic messages) admitted per session per second before the broker answers
+    /// `RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT`. 0 disables the limit.
+    size_t publishesPerSecond = 0;
+    /// Subscribes, unsubscribes and stream channel joins, answered with `RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT`.
+    size_t subscribesPerSecond = 0;
+    /// Logins admitted per second across all sessions, answered with `RTM_ERROR_LOGIN_NO_SERVER_RESOURCES` the way
+    /// the service sheds a login storm.
+    size_t loginsPerSecond = 0;
+    /// Time source of the rate limits and lock ttls; empty means `RtmClock::now`. Tests substitute a manual clock.
+    std::function<RtmClock::time_point()> clock;
+    /// Once a channel has more visible members than this, joins, leaves and state changes are held and delivered
+    /// as one `RTM_PRESENCE_EVENT_TYPE_INTERVAL` per channel by `flushPresenceIntervals`, the way the service
+    /// switches crowded channels to interval mode. 0 never switches.
+    size_t presenceIntervalThreshold = 0;
+  };
+
+  LoopbackBroker();
+  explicit LoopbackBroker(const Options& options);
+  ~LoopbackBroker();
+
+  LoopbackBroker(const LoopbackBroker&) = delete;
+  LoopbackBroker& operator=(const LoopbackBroker&) = delete;
+
+  /// The broker behind `createAgoraRtmClient`.
+  static LoopbackBroker& shared();
+
+  const Options& options() const { return options_; }
+  LoopbackResultDispatcher& resultDispatcher() { return resultDispatcher_; }
+
+  agora::rtm::RTM_ERROR_CODE login(const LoopbackSessionPtr& session, LoopbackEventBatch& events);
+  void logout(const LoopbackSessionPtr& session, LoopbackEventBatch& events);
+  LoopbackSessionPtr findSession(std::string_view userId) const;
+  /// Counts one operation against the session's rate limit; false when the current window is full.
+  bool admit(LoopbackSession& session, LoopbackRateClass rateClass);
+
+  agora::rtm::RTM_ERROR_CODE joinChannel(const LoopbackSessionPtr& session, std::string_view channelName,
+                                         agora::rtm::RTM_CHANNEL_TYPE channelType, const LoopbackMemberOptions& options,
+                                         LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE leaveChannel(const LoopbackSessionPtr& session, std::string_view channelName,
+                                          agora::rtm::RTM_CHANNEL_TYPE channelType, LoopbackEventBatch& events);
+
+  agora::rtm::RTM_ERROR_CODE publish(const LoopbackSession& publisher, const char* channelName, const char* message,
+                                     size_t length, const agora::rtm::PublishOptions& options);
+
+  agora::rtm::RTM_ERROR_CODE joinTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                       std::string_view topic, std::string_view meta, LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE leaveTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                        std::string_view topic, LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE subscribeTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                            std::string_view topic, const std::vector<std::string>& users);
+  agora::rtm::RTM_ERROR_CODE unsubscribeTopic(const LoopbackSessionPtr& session, std::string_view channelName,
+                                              std::string_view topic, const std::vector<std::string>& users);
+  agora::rtm::RTM_ERROR_CODE getSubscribedUsers(const LoopbackSessionPtr& session, std::string_view channelName,
+                                                std::string_view topic, std::vector<std::string>& users) const;
+  agora::rtm::RTM_ERROR_CODE publishTopicMessage(const LoopbackSession& publisher, const char* channelName,
+                                                 const char* topic, const char* message, size_t length,
+                                                 const agora::rtm::TopicMessageOptions& options);
+
+  agora::rtm::RTM_ERROR_CODE writeChannelMetadata(const LoopbackSessionPtr& session, std::string_view channelName,
+                                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                                  LoopbackMetadataOperation operation,
+                                                  const agora::rtm::Metadata& data,
+                                                  const agora::rtm::MetadataOptions& options,
+                                                  std::string_view lockName, LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE getChannelMetadata(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                                LoopbackMetadata& data) const;
+  agora::rtm::RTM_ERROR_CODE writeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId,
+                                               LoopbackMetadataOperation operation, const agora::rtm::Metadata& data,
+                                               const agora::rtm::MetadataOptions& options, LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE getUserMetadata(std::string_view userId, LoopbackMetadata& data) const;
+  agora::rtm::RTM_ERROR_CODE subscribeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId,
+                                                   LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE unsubscribeUserMetadata(const LoopbackSessionPtr& session, std::string_view userId);
+
+  /// `page` is the opaque cursor returned as `nextPage` by the previous call; empty means the first page.
+  agora::rtm::RTM_ERROR_CODE whoNow(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                    bool includeUserId, bool includeState, std::string_view page,
+                                    std::vector<LoopbackUserState>& users, std::string& nextPage) const;
+  agora::rtm::RTM_ERROR_CODE whereNow(std::string_view userId, std::vector<LoopbackChannelRef>& channels) const;
+  agora::rtm::RTM_ERROR_CODE setState(const LoopbackSessionPtr& session, std::string_view channelName,
+                                      agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::StateItem* items,
+                                      size_t count, LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE removeState(const LoopbackSessionPtr& session, std::string_view channelName,
+                                         agora::rtm::RTM_CHANNEL_TYPE channelType, const char** keys, size_t count,
+                                         LoopbackEventBatch& events);
+  /// Delivers the presence changes held by channels in interval mode; the service does this on a timer.
+  void flushPresenceIntervals();
+  /// Frees, as `RTM_LOCK_EVENT_TYPE_LOCK_EXPIRED`, the locks whose owner left the channel at least their ttl ago
+  /// and did not come back; the service does this on a timer. A lock with no ttl expires as its owner leaves.
+  void expireLocks();
+  agora::rtm::RTM_ERROR_CODE getState(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                      std::string_view userId, LoopbackUserState& state) const;
+
+  agora::rtm::RTM_ERROR_CODE setLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName, uint32_t ttl,
+                                     LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE getLocks(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                      std::vector<LoopbackLock>& locks) const;
+  agora::rtm::RTM_ERROR_CODE removeLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                        agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                        LoopbackEventBatch& events);
+  /// With `retry` set and the lock held by someone else, the request is parked and `pending` is set;
+  /// its `onAcquireLockResult` is delivered once the lock is handed over.
+  agora::rtm::RTM_ERROR_CODE acquireLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                         agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                         bool retry, uint64_t requestId, bool& pending, std::string& errorDetails,
+                                         LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE releaseLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                         agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                         LoopbackEventBatch& events);
+  agora::rtm::RTM_ERROR_CODE revokeLock(const LoopbackSessionPtr& session, std::string_view channelName,
+                                        agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view lockName,
+                                        std::string_view owner, LoopbackEventBatch& events);
+
+ private:
+  struct ChannelShard;
+  struct UserShard;
+
+  ChannelShard& channelShard(std::string_view channelName) const;
+  UserShard& userShard(std::string_view userId) const;
+  RtmClock::time_point now() const;
+
+  Options options_;
+  std::mutex loginMutex_;
+  LoopbackRateWindow loginWindow_;
+  std::vector<std::unique_ptr<ChannelShard>> channelShards_;
+  std::vector<std::unique_ptr<UserShard>> userShards_;
+  /// Last, so its thread stops before the shards go away.
+  LoopbackResultDispatcher resultDispatcher_;
+};
+
+}  // namespace rtm
+}  // namespace flat
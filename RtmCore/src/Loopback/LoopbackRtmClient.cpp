@@ -0,0 +1,556 @@
+//
+//  LoopbackRtmClient.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Loopback/LoopbackRtmClient.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "Loopback/LoopbackStreamChannel.h"
+#include "Loopback/LoopbackViews.h"
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+namespace {
+
+LoopbackMemberOptions memberOptions(const SubscribeOptions& options) {
+  LoopbackMemberOptions member;
+  member.withMessage = options.withMessage;
+  member.withMetadata = options.withMetadata;
+  member.withPresence = options.withPresence;
+  member.withLock = options.withLock;
+  member.beQuiet = options.beQuiet;
+  return member;
+}
+
+}  // namespace
+
+LoopbackRtmClient::LoopbackRtmClient(LoopbackBroker& broker, const RtmConfig& config)
+    : broker_(broker), session_(std::make_shared<LoopbackSession>(config.userId, config.eventHandler)) {}
+
+LoopbackRtmClient::~LoopbackRtmClient() = default;
+
+int LoopbackRtmClient::release() {
+  if (resultsOnDispatcher_.load(std::memory_order_relaxed)) broker_.resultDispatcher().forget(*session_);
+  if (isOnline()) {
+    LoopbackEventBatch events;
+    broker_.logout(session_, events);
+    events.dispatch();
+  }
+  delete this;
+  return 0;
+}
+
+size_t LoopbackRtmClient::pump() {
+  std::vector<std::function<void(IRtmEventHandler&)>> results;
+  {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    results.swap(results_);
+  }
+  for (auto& result : results) result(handler());
+  return results.size();
+}
+
+void LoopbackRtmClient::deferResult(std::function<void(IRtmEventHandler&)> result) {
+  bool inCall = resultsInCall_.load(std::memory_order_relaxed);
+  if (!inCall && resultsOnDispatcher_.load(std::memory_order_relaxed)) {
+    broker_.resultDispatcher().post(session_, std::move(result));
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    results_.push_back(std::move(result));
+  }
+  if (inCall) pump();
+}
+
+void LoopbackRtmClient::setResultsOnDispatcher(bool onDispatcher) {
+  std::lock_guard<std::mutex> guard(resultsMutex_);
+  resultsOnDispatcher_.store(onDispatcher, std::memory_order_relaxed);
+  if (!onDispatcher) return;
+  for (auto& result : results_) broker_.resultDispatcher().post(session_, std::move(result));
+  results_.clear();
+}
+
+void LoopbackRtmClient::emitLinkState(RTM_LINK_STATE previous, RTM_LINK_STATE current, RTM_LINK_OPERATION operation,
+                                      const char* reason) {
+  IRtmEventHandler::LinkStateEvent event;
+  event.previousState = previous;
+  event.currentState = current;
+  event.serviceType = RTM_SERVICE_TYPE_MESSAGE;
+  event.operation = operation;
+  event.reason = reason;
+  event.timestamp = rtmServerTimestamp();
+  handler().onLinkStateEvent(event);
+}
+
+void LoopbackRtmClient::reconnect(bool resumed) {
+  if (!isOnline()) return;
+  emitLinkState(RTM_LINK_STATE_CONNECTED, RTM_LINK_STATE_CONNECTING, RTM_LINK_OPERATION_AUTO_RECONNECT,
+                "network lost");
+  std::vector<LoopbackChannelRef> dropped;
+  if (!resumed) {
+    std::lock_guard<std::mutex> guard(session_->mutex);
+    dropped = session_->channels;
+  }
+  LoopbackEventBatch events;
+  std::vector<std::string> names;
+  for (const LoopbackChannelRef& channel : dropped) {
+    broker_.leaveChannel(session_, channel.channelName, channel.channelType, events);
+    names.push_back(channel.channelName);
+  }
+  UserListView unrestored(names);
+  IRtmEventHandler::LinkStateEvent event;
+  event.previousState = RTM_LINK_STATE_CONNECTING;
+  event.currentState = RTM_LINK_STATE_CONNECTED;
+  event.serviceType = RTM_SERVICE_TYPE_MESSAGE;
+  event.operation = RTM_LINK_OPERATION_RECONNECTED;
+  event.reason = "";
+  event.affectedChannels = unrestored.list().users;
+  event.affectedChannelCount = names.size();
+  event.unrestoredChannels = unrestored.list().users;
+  event.unrestoredChannelCount = names.size();
+  event.isResumed = resumed;
+  event.timestamp = rtmServerTimestamp();
+  handler().onLinkStateEvent(event);
+  events.dispatch();
+}
+
+void LoopbackRtmClient::login(const char* token, uint64_t& requestId) {
+  (void)token;
+  requestId = nextRequestId();
+  if (isOnline()) {
+    deferResult([id = requestId](IRtmEventHandler& handler) { handler.onLoginResult(id, RTM_ERROR_OK); });
+    return;
+  }
+  emitLinkState(RTM_LINK_STATE_IDLE, RTM_LINK_STATE_CONNECTING, RTM_LINK_OPERATION_LOGIN, "");
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = broker_.login(session_, events);
+  if (code == RTM_ERROR_OK) {
+    emitLinkState(RTM_LINK_STATE_CONNECTING, RTM_LINK_STATE_CONNECTED, RTM_LINK_OPERATION_LOGIN, "");
+  } else {
+    emitLinkState(RTM_LINK_STATE_CONNECTING, RTM_LINK_STATE_FAILED, RTM_LINK_OPERATION_LOGIN, "");
+  }
+  deferResult([id = requestId, code](IRtmEventHandler& handler) { handler.onLoginResult(id, code); });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::logout(uint64_t& requestId) {
+  requestId = nextRequestId();
+  if (!isOnline()) {
+    deferResult([id = requestId](IRtmEventHandler& handler) { handler.onLogoutResult(id, RTM_ERROR_NOT_LOGIN); });
+    return;
+  }
+  LoopbackEventBatch events;
+  broker_.logout(session_, events);
+  emitLinkState(RTM_LINK_STATE_CONNECTED, RTM_LINK_STATE_IDLE, RTM_LINK_OPERATION_LOGOUT, "");
+  deferResult([id = requestId](IRtmEventHandler& handler) { handler.onLogoutResult(id, RTM_ERROR_OK); });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::renewToken(const char* token, uint64_t& requestId) {
+  requestId = nextRequestId();
+  RTM_ERROR_CODE code = RTM_ERROR_OK;
+  if (!isOnline()) {
+    code = RTM_ERROR_NOT_LOGIN;
+  } else if (viewOf(token).empty()) {
+    code = RTM_ERROR_INVALID_TOKEN;
+  }
+  deferResult([id = requestId, code](IRtmEventHandler& handler) {
+    handler.onRenewTokenResult(id, RTM_SERVICE_TYPE_MESSAGE, "", code);
+  });
+}
+
+void LoopbackRtmClient::publish(const char* channelName, const char* message, const size_t length,
+                                const PublishOptions& option, uint64_t& requestId) {
+  requestId = nextRequestId();
+  RTM_ERROR_CODE code = RTM_ERROR_NOT_LOGIN;
+  if (isOnline()) {
+    code = broker_.admit(*session_, LoopbackRateClass::publish)
+               ? broker_.publish(*session_, channelName, message, length, option)
+               : RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT;
+  }
+  deferResult([id = requestId, code](IRtmEventHandler& handler) { handler.onPublishResult(id, code); });
+}
+
+void LoopbackRtmClient::subscribe(const char* channelName, const SubscribeOptions& options, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = RTM_ERROR_NOT_LOGIN;
+  if (isOnline()) {
+    code = broker_.admit(*session_, LoopbackRateClass::subscribe)
+               ? broker_.joinChannel(session_, viewOf(channelName), RTM_CHANNEL_TYPE_MESSAGE, memberOptions(options),
+                                     events)
+               : RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT;
+  }
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), code](IRtmEventHandler& handler) {
+    handler.onSubscribeResult(id, channel.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::unsubscribe(const char* channelName, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = RTM_ERROR_NOT_LOGIN;
+  if (isOnline()) {
+    code = broker_.admit(*session_, LoopbackRateClass::subscribe)
+               ? broker_.leaveChannel(session_, viewOf(channelName), RTM_CHANNEL_TYPE_MESSAGE, events)
+               : RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT;
+  }
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), code](IRtmEventHandler& handler) {
+    handler.onUnsubscribeResult(id, channel.c_str(), code);
+  });
+  events.dispatch();
+}
+
+IStreamChannel* LoopbackRtmClient::createStreamChannel(const char* channelName, int& errorCode) {
+  if (viewOf(channelName).empty()) {
+    errorCode = RTM_ERROR_INVALID_CHANNEL_NAME;
+    return nullptr;
+  }
+  errorCode = RTM_ERROR_OK;
+  return new LoopbackStreamChannel(*this, channelName);
+}
+
+int LoopbackRtmClient::setParameters(const char* parameters) {
+  (void)parameters;
+  return RTM_ERROR_OK;
+}
+
+void LoopbackRtmClient::writeChannelMetadata(LoopbackMetadataOperation operation, const char* channelName,
+                                             RTM_CHANNEL_TYPE channelType, const Metadata& data,
+                                             const MetadataOptions& options, const char* lockName,
+                                             uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.writeChannelMetadata(session_, viewOf(channelName), channelType,
+                                                                  operation, data, options, viewOf(lockName), events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([operation, id = requestId, channel = std::string(viewOf(channelName)), channelType,
+               code](IRtmEventHandler& handler) {
+    switch (operation) {
+      case LoopbackMetadataOperation::set:
+        handler.onSetChannelMetadataResult(id, channel.c_str(), channelType, code);
+        break;
+      case LoopbackMetadataOperation::update:
+        handler.onUpdateChannelMetadataResult(id, channel.c_str(), channelType, code);
+        break;
+      case LoopbackMetadataOperation::remove:
+        handler.onRemoveChannelMetadataResult(id, channel.c_str(), channelType, code);
+        break;
+    }
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::setChannelMetadata(const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                           const Metadata& data, const MetadataOptions& options,
+                                           const char* lockName, uint64_t& requestId) {
+  writeChannelMetadata(LoopbackMetadataOperation::set, channelName, channelType, data, options, lockName, requestId);
+}
+
+void LoopbackRtmClient::updateChannelMetadata(const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                              const Metadata& data, const MetadataOptions& options,
+                                              const char* lockName, uint64_t& requestId) {
+  writeChannelMetadata(LoopbackMetadataOperation::update, channelName, channelType, data, options, lockName,
+                       requestId);
+}
+
+void LoopbackRtmClient::removeChannelMetadata(const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                              const Metadata& data, const MetadataOptions& options,
+                                              const char* lockName, uint64_t& requestId) {
+  writeChannelMetadata(LoopbackMetadataOperation::remove, channelName, channelType, data, options, lockName,
+                       requestId);
+}
+
+void LoopbackRtmClient::getChannelMetadata(const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                           uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackMetadata data;
+  RTM_ERROR_CODE code = isOnline() ? broker_.getChannelMetadata(viewOf(channelName), channelType, data)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType, data = std::move(data),
+               code](IRtmEventHandler& handler) {
+    MetadataView view(data);
+    handler.onGetChannelMetadataResult(id, channel.c_str(), channelType, view.metadata(), code);
+  });
+}
+
+void LoopbackRtmClient::writeUserMetadata(LoopbackMetadataOperation operation, const char* userId,
+                                          const Metadata& data, const MetadataOptions& options, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.writeUserMetadata(session_, viewOf(userId), operation, data, options,
+                                                               events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([operation, id = requestId, user = std::string(viewOf(userId)), code](IRtmEventHandler& handler) {
+    switch (operation) {
+      case LoopbackMetadataOperation::set:
+        handler.onSetUserMetadataResult(id, user.c_str(), code);
+        break;
+      case LoopbackMetadataOperation::update:
+        handler.onUpdateUserMetadataResult(id, user.c_str(), code);
+        break;
+      case LoopbackMetadataOperation::remove:
+        handler.onRemoveUserMetadataResult(id, user.c_str(), code);
+        break;
+    }
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::setUserMetadata(const char* userId, const Metadata& data, const MetadataOptions& options,
+                                        uint64_t& requestId) {
+  writeUserMetadata(LoopbackMetadataOperation::set, userId, data, options, requestId);
+}
+
+void LoopbackRtmClient::updateUserMetadata(const char* userId, const Metadata& data, const MetadataOptions& options,
+                                           uint64_t& requestId) {
+  writeUserMetadata(LoopbackMetadataOperation::update, userId, data, options, requestId);
+}
+
+void LoopbackRtmClient::removeUserMetadata(const char* userId, const Metadata& data, const MetadataOptions& options,
+                                           uint64_t& requestId) {
+  writeUserMetadata(LoopbackMetadataOperation::remove, userId, data, options, requestId);
+}
+
+void LoopbackRtmClient::getUserMetadata(const char* userId, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackMetadata data;
+  RTM_ERROR_CODE code = isOnline() ? broker_.getUserMetadata(viewOf(userId), data) : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, user = std::string(viewOf(userId)), data = std::move(data),
+               code](IRtmEventHandler& handler) {
+    MetadataView view(data);
+    handler.onGetUserMetadataResult(id, user.c_str(), view.metadata(), code);
+  });
+}
+
+void LoopbackRtmClient::subscribeUserMetadata(const char* userId, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.subscribeUserMetadata(session_, viewOf(userId), events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, user = std::string(viewOf(userId)), code](IRtmEventHandler& handler) {
+    handler.onSubscribeUserMetadataResult(id, user.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::unsubscribeUserMetadata(const char* userId, uint64_t& requestId) {
+  requestId = nextRequestId();
+  RTM_ERROR_CODE code = isOnline() ? broker_.unsubscribeUserMetadata(session_, viewOf(userId)) : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, user = std::string(viewOf(userId)), code](IRtmEventHandler& handler) {
+    handler.onUnsubscribeUserMetadataResult(id, user.c_str(), code);
+  });
+}
+
+void LoopbackRtmClient::queryOnlineUsers(const char* channelName, RTM_CHANNEL_TYPE channelType, bool includeUserId,
+                                         bool includeState, const char* page, bool legacyWhoNow,
+                                         uint64_t& requestId) {
+  requestId = nextRequestId();
+  std::vector<LoopbackUserState> users;
+  std::string nextPage;
+  RTM_ERROR_CODE code = isOnline() ? broker_.whoNow(viewOf(channelName), channelType, includeUserId, includeState,
+                                                    viewOf(page), users, nextPage)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([legacyWhoNow, id = requestId, users = std::move(users), nextPage = std::move(nextPage),
+               code](IRtmEventHandler& handler) {
+    UserStatesView view(users);
+    if (legacyWhoNow) {
+      handler.onWhoNowResult(id, view.data(), view.size(), nextPage.c_str(), code);
+    } else {
+      handler.onGetOnlineUsersResult(id, view.data(), view.size(), nextPage.c_str(), code);
+    }
+  });
+}
+
+void LoopbackRtmClient::whoNow(const char* channelName, RTM_CHANNEL_TYPE channelType, const PresenceOptions& options,
+                               uint64_t& requestId) {
+  queryOnlineUsers(channelName, channelType, options.includeUserId, options.includeState, options.page, true,
+                   requestId);
+}
+
+void LoopbackRtmClient::getOnlineUsers(const char* channelName, RTM_CHANNEL_TYPE channelType,
+                                       const GetOnlineUsersOptions& options, uint64_t& requestId) {
+  queryOnlineUsers(channelName, channelType, options.includeUserId, options.includeState, options.page, false,
+                   requestId);
+}
+
+void LoopbackRtmClient::queryUserChannels(const char* userId, bool legacyWhereNow, uint64_t& requestId) {
+  requestId = nextRequestId();
+  std::vector<LoopbackChannelRef> channels;
+  RTM_ERROR_CODE code = isOnline() ? broker_.whereNow(viewOf(userId), channels) : RTM_ERROR_NOT_LOGIN;
+  deferResult([legacyWhereNow, id = requestId, channels = std::move(channels), code](IRtmEventHandler& handler) {
+    ChannelInfosView view(channels);
+    if (legacyWhereNow) {
+      handler.onWhereNowResult(id, view.data(), view.size(), code);
+    } else {
+      handler.onGetUserChannelsResult(id, view.data(), view.size(), code);
+    }
+  });
+}
+
+void LoopbackRtmClient::whereNow(const char* userId, uint64_t& requestId) {
+  queryUserChannels(userId, true, requestId);
+}
+
+void LoopbackRtmClient::getUserChannels(const char* userId, uint64_t& requestId) {
+  queryUserChannels(userId, false, requestId);
+}
+
+void LoopbackRtmClient::setState(const char* channelName, RTM_CHANNEL_TYPE channelType, const StateItem* items,
+                                 size_t count, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.setState(session_, viewOf(channelName), channelType, items, count, events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, code](IRtmEventHandler& handler) { handler.onPresenceSetStateResult(id, code); });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::removeState(const char* channelName, RTM_CHANNEL_TYPE channelType, const char** keys,
+                                    size_t count, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.removeState(session_, viewOf(channelName), channelType, keys, count,
+                                                         events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, code](IRtmEventHandler& handler) { handler.onPresenceRemoveStateResult(id, code); });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::getState(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* userId,
+                                 uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackUserState state;
+  RTM_ERROR_CODE code = isOnline() ? broker_.getState(viewOf(channelName), channelType, viewOf(userId), state)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, state = std::move(state), code](IRtmEventHandler& handler) {
+    StateItemsView items(state.states);
+    UserState userState;
+    userState.userId = state.userId.c_str();
+    userState.states = items.data();
+    userState.statesCount = items.size();
+    handler.onPresenceGetStateResult(id, userState, code);
+  });
+}
+
+void LoopbackRtmClient::setLock(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                uint32_t ttl, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.setLock(session_, viewOf(channelName), channelType, viewOf(lockName), ttl,
+                                                     events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType,
+               lock = std::string(viewOf(lockName)), code](IRtmEventHandler& handler) {
+    handler.onSetLockResult(id, channel.c_str(), channelType, lock.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::getLocks(const char* channelName, RTM_CHANNEL_TYPE channelType, uint64_t& requestId) {
+  requestId = nextRequestId();
+  std::vector<LoopbackLock> locks;
+  RTM_ERROR_CODE code = isOnline() ? broker_.getLocks(viewOf(channelName), channelType, locks) : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType, locks = std::move(locks),
+               code](IRtmEventHandler& handler) {
+    LockDetailsView view(locks);
+    handler.onGetLocksResult(id, channel.c_str(), channelType, view.data(), view.size(), code);
+  });
+}
+
+void LoopbackRtmClient::removeLock(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                   uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.removeLock(session_, viewOf(channelName), channelType, viewOf(lockName),
+                                                        events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType,
+               lock = std::string(viewOf(lockName)), code](IRtmEventHandler& handler) {
+    handler.onRemoveLockResult(id, channel.c_str(), channelType, lock.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::acquireLock(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                    bool retry, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  bool pending = false;
+  std::string errorDetails;
+  RTM_ERROR_CODE code = isOnline() ? broker_.acquireLock(session_, viewOf(channelName), channelType, viewOf(lockName),
+                                                         retry, requestId, pending, errorDetails, events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  if (!pending) {
+    deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType,
+                 lock = std::string(viewOf(lockName)), code,
+                 errorDetails = std::move(errorDetails)](IRtmEventHandler& handler) {
+      handler.onAcquireLockResult(id, channel.c_str(), channelType, lock.c_str(), code, errorDetails.c_str());
+    });
+  }
+  events.dispatch();
+}
+
+void LoopbackRtmClient::releaseLock(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                    uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.releaseLock(session_, viewOf(channelName), channelType,
+                                                         viewOf(lockName), events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType,
+               lock = std::string(viewOf(lockName)), code](IRtmEventHandler& handler) {
+    handler.onReleaseLockResult(id, channel.c_str(), channelType, lock.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackRtmClient::revokeLock(const char* channelName, RTM_CHANNEL_TYPE channelType, const char* lockName,
+                                   const char* owner, uint64_t& requestId) {
+  requestId = nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = isOnline() ? broker_.revokeLock(session_, viewOf(channelName), channelType, viewOf(lockName),
+                                                        viewOf(owner), events)
+                                   : RTM_ERROR_NOT_LOGIN;
+  deferResult([id = requestId, channel = std::string(viewOf(channelName)), channelType,
+               lock = std::string(viewOf(lockName)), code](IRtmEventHandler& handler) {
+    handler.onRevokeLockResult(id, channel.c_str(), channelType, lock.c_str(), code);
+  });
+  events.dispatch();
+}
+
+LoopbackRtmClient* createLoopbackRtmClient(LoopbackBroker& broker, const RtmConfig& config, int& errorCode) {
+  if (viewOf(config.appId).empty()) {
+    errorCode = RTM_ERROR_INVALID_APP_ID;
+    return nullptr;
+  }
+  if (viewOf(config.userId).empty()) {
+    errorCode = RTM_ERROR_INVALID_USER_ID;
+    return nullptr;
+  }
+  if (!config.eventHandler) {
+    errorCode = RTM_ERROR_INVALID_EVENT_HANDLER;
+    return nullptr;
+  }
+  errorCode = RTM_ERROR_OK;
+  return new LoopbackRtmClient(broker, config);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,155 @@
+//
+//  LoopbackRtmClient.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "IAgoraRtmClient.h"
+#include "Loopback/LoopbackBroker.h"
+
+namespace flat {
+namespace rtm {
+
+/// `IRtmClient` backed by a `LoopbackBroker` instead of the Agora service.
+///
+/// Storage, presence and lock are facets of the same object. Like the SDK, a request returns before its result:
+/// result callbacks are queued and delivered in request order, by the broker's dispatcher thread for clients from
+/// `createAgoraRtmClient`, or by `pump()` on the pumping thread, which tests use to choose when results land. The
+/// events a request causes, for this client and for others, are delivered before the calling method returns, so
+/// they can reach this client ahead of the result. Results still queued when the client is released are dropped.
+class LoopbackRtmClient : public agora::rtm::IRtmClient,
+                          public agora::rtm::IRtmStorage,
+                          public agora::rtm::IRtmPresence,
+                          public agora::rtm::IRtmLock {
+ public:
+  LoopbackRtmClient(LoopbackBroker& broker, const agora::rtm::RtmConfig& config);
+
+  LoopbackBroker& broker() const { return broker_; }
+  const LoopbackSessionPtr& session() const { return session_; }
+  const std::string& userId() const { return session_->userId; }
+  agora::rtm::IRtmEventHandler& handler() const { return *session_->handler; }
+  bool isOnline() const { return session_->online.load(std::memory_order_relaxed); }
+  uint64_t nextRequestId() { return nextRequestId_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+  /// Delivers the result callbacks queued before the call. Results of requests made by those callbacks wait for
+  /// the next `pump()`. Returns the number delivered.
+  size_t pump();
+  /// Queues a result callback for `pump()`. For the facets of this client, such as its stream channels.
+  void deferResult(std::function<void(agora::rtm::IRtmEventHandler&)> result);
+  /// With `inCall`, each call delivers the queued results, its own last, once its requestId is set but before the
+  /// caller can read it: what the SDK does when its thread answers before the call returns.
+  void setResultsInCall(bool inCall) { resultsInCall_.store(inCall, std::memory_order_relaxed); }
+  /// With `onDispatcher`, results go to the broker's `resultDispatcher()` instead of waiting for `pump()`; the
+  /// results already queued go first. `createAgoraRtmClient` turns it on. `setResultsInCall` takes precedence.
+  void setResultsOnDispatcher(bool onDispatcher);
+
+  /// Drops the link and brings it back the way the SDK's automatic reconnect does: CONNECTED to CONNECTING, then
+  /// RECONNECTED. With `resumed` the service kept the session. Without, it dropped every channel the session was in;
+  /// the RECONNECTED event lists them as unrestored and it is up to the app to subscribe and join again.
+  void reconnect(bool resumed);
+
+  // IRtmClient
+  int release() override;
+  void login(const char* token, uint64_t& requestId) override;
+  void logout(uint64_t& requestId) override;
+  agora::rtm::IRtmStorage* getStorage() override { return this; }
+  agora::rtm::IRtmLock* getLock() override { return this; }
+  agora::rtm::IRtmPresence* getPresence() override { return this; }
+  void renewToken(const char* token, uint64_t& requestId) override;
+  void publish(const char* channelName, const char* message, const size_t length,
+               const agora::rtm::PublishOptions& option, uint64_t& requestId) override;
+  void subscribe(const char* channelName, const agora::rtm::SubscribeOptions& options, uint64_t& requestId) override;
+  void unsubscribe(const char* channelName, uint64_t& requestId) override;
+  agora::rtm::IStreamChannel* createStreamChannel(const char* channelName, int& errorCode) override;
+  int setParameters(const char* parameters) override;
+
+  // IRtmStorage
+  void setChannelMetadata(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const agora::rtm::Metadata& data, const agora::rtm::MetadataOptions& options,
+                          const char* lockName, uint64_t& requestId) override;
+  void updateChannelMetadata(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                             const agora::rtm::Metadata& data, const agora::rtm::MetadataOptions& options,
+                             const char* lockName, uint64_t& requestId) override;
+  void removeChannelMetadata(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                             const agora::rtm::Metadata& data, const agora::rtm::MetadataOptions& options,
+                             const char* lockName, uint64_t& requestId) override;
+  void getChannelMetadata(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          uint64_t& requestId) override;
+  void setUserMetadata(const char* userId, const agora::rtm::Metadata& data,
+                       const agora::rtm::MetadataOptions& options, uint64_t& requestId) override;
+  void updateUserMetadata(const char* userId, const agora::rtm::Metadata& data,
+                          const agora::rtm::MetadataOptions& options, uint64_t& requestId) override;
+  void removeUserMetadata(const char* userId, const agora::rtm::Metadata& data,
+                          const agora::rtm::MetadataOptions& options, uint64_t& requestId) override;
+  void getUserMetadata(const char* userId, uint64_t& requestId) override;
+  void subscribeUserMetadata(const char* userId, uint64_t& requestId) override;
+  void unsubscribeUserMetadata(const char* userId, uint64_t& requestId) override;
+
+  // IRtmPresence
+  void whoNow(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+              const agora::rtm::PresenceOptions& options, uint64_t& requestId) override;
+  void whereNow(const char* userId, uint64_t& requestId) override;
+  void setState(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                const agora::rtm::StateItem* items, size_t count, uint64_t& requestId) override;
+  void removeState(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char** keys,
+                   size_t count, uint64_t& requestId) override;
+  void getState(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* userId,
+                uint64_t& requestId) override;
+  void getOnlineUsers(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                      const agora::rtm::GetOnlineUsersOptions& options, uint64_t& requestId) override;
+  void getUserChannels(const char* userId, uint64_t& requestId) override;
+
+  // IRtmLock
+  void setLock(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* lockName, uint32_t ttl,
+               uint64_t& requestId) override;
+  void getLocks(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, uint64_t& requestId) override;
+  void removeLock(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* lockName,
+                  uint64_t& requestId) override;
+  void acquireLock(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* lockName,
+                   bool retry, uint64_t& requestId) override;
+  void releaseLock(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* lockName,
+                   uint64_t& requestId) override;
+  void revokeLock(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, const char* lockName,
+                  const char* owner, uint64_t& requestId) override;
+
+ protected:
+  ~LoopbackRtmClient() override;
+
+ private:
+  void emitLinkState(agora::rtm::RTM_LINK_STATE previous, agora::rtm::RTM_LINK_STATE current,
+                     agora::rtm::RTM_LINK_OPERATION operation, const char* reason);
+  void writeChannelMetadata(LoopbackMetadataOperation operation, const char* channelName,
+                            agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                            const agora::rtm::MetadataOptions& options, const char* lockName, uint64_t& requestId);
+  void writeUserMetadata(LoopbackMetadataOperation operation, const char* userId, const agora::rtm::Metadata& data,
+                         const agora::rtm::MetadataOptions& options, uint64_t& requestId);
+  void queryOnlineUsers(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, bool includeUserId,
+                        bool includeState, const char* page, bool legacyWhoNow, uint64_t& requestId);
+  void queryUserChannels(const char* userId, bool legacyWhereNow, uint64_t& requestId);
+
+  LoopbackBroker& broker_;
+  LoopbackSessionPtr session_;
+  std::atomic<uint64_t> nextRequestId_{0};
+  std::mutex resultsMutex_;
+  std::vector<std::function<void(agora::rtm::IRtmEventHandler&)>> results_;
+  std::atomic<bool> resultsInCall_{false};
+  std::atomic<bool> resultsOnDispatcher_{false};
+};
+
+/// Creates a client on a caller-owned broker; `createAgoraRtmClient` uses `LoopbackBroker::shared()`.
+/// Returns null and sets `errorCode` when the config is rejected.
+LoopbackRtmClient* createLoopbackRtmClient(LoopbackBroker& broker, const agora::rtm::RtmConfig& config,
+                                           int& errorCode);
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,167 @@
+//
+//  LoopbackStreamChannel.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Loopback/LoopbackStreamChannel.h"
+
+#include <vector>
+
+#include "Common/StringMap.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Loopback/LoopbackViews.h"
+
+namespace flat {
+namespace rtm {
+
+using namespace agora::rtm;
+
+namespace {
+
+std::vector<std::string> usersOf(const TopicOptions& options) {
+  std::vector<std::string> users;
+  if (!options.users) return users;
+  users.reserve(options.userCount);
+  for (size_t i = 0; i < options.userCount; ++i) {
+    if (options.users[i]) users.emplace_back(options.users[i]);
+  }
+  return users;
+}
+
+}  // namespace
+
+LoopbackStreamChannel::LoopbackStreamChannel(LoopbackRtmClient& client, std::string channelName)
+    : client_(client), channelName_(std::move(channelName)) {}
+
+void LoopbackStreamChannel::join(const JoinChannelOptions& options, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  LoopbackMemberOptions member;
+  member.withMetadata = options.withMetadata;
+  member.withPresence = options.withPresence;
+  member.withLock = options.withLock;
+  member.beQuiet = options.beQuiet;
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = RTM_ERROR_NOT_LOGIN;
+  if (client_.isOnline()) {
+    code = client_.broker().admit(*client_.session(), LoopbackRateClass::subscribe)
+               ? client_.broker().joinChannel(client_.session(), channelName_, RTM_CHANNEL_TYPE_STREAM, member, events)
+               : RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT;
+  }
+  if (code == RTM_ERROR_OK) joined_.store(true);
+  client_.deferResult([channel = channelName_, user = client_.userId(), id = requestId,
+                       code](IRtmEventHandler& handler) {
+    handler.onJoinResult(id, channel.c_str(), user.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackStreamChannel::renewToken(const char* token, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  RTM_ERROR_CODE code = RTM_ERROR_OK;
+  if (!joined_.load()) {
+    code = RTM_ERROR_CHANNEL_NOT_JOINED;
+  } else if (viewOf(token).empty()) {
+    code = RTM_ERROR_INVALID_TOKEN;
+  }
+  client_.deferResult([channel = channelName_, id = requestId, code](IRtmEventHandler& handler) {
+    handler.onRenewTokenResult(id, RTM_SERVICE_TYPE_STREAM, channel.c_str(), code);
+  });
+}
+
+void LoopbackStreamChannel::leave(uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = client_.broker().leaveChannel(client_.session(), channelName_, RTM_CHANNEL_TYPE_STREAM, events);
+  joined_.store(false);
+  client_.deferResult([channel = channelName_, user = client_.userId(), id = requestId,
+                       code](IRtmEventHandler& handler) {
+    handler.onLeaveResult(id, channel.c_str(), user.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackStreamChannel::joinTopic(const char* topic, const JoinTopicOptions& options, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = client_.broker().joinTopic(client_.session(), channelName_, viewOf(topic),
+                                                   viewOf(options.meta), events);
+  client_.deferResult([channel = channelName_, user = client_.userId(), id = requestId,
+                       topic = std::string(viewOf(topic)), meta = std::string(viewOf(options.meta)),
+                       code](IRtmEventHandler& handler) {
+    handler.onJoinTopicResult(id, channel.c_str(), user.c_str(), topic.c_str(), meta.c_str(), code);
+  });
+  events.dispatch();
+}
+
+void LoopbackStreamChannel::publishTopicMessage(const char* topic, const char* message, size_t length,
+                                                const TopicMessageOptions& option, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  RTM_ERROR_CODE code = client_.broker().admit(*client_.session(), LoopbackRateClass::publish)
+                            ? client_.broker().publishTopicMessage(*client_.session(), channelName_.c_str(), topic,
+                                                                   message, length, option)
+                            : RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT;
+  client_.deferResult([channel = channelName_, id = requestId, topic = std::string(viewOf(topic)),
+                       code](IRtmEventHandler& handler) {
+    handler.onPublishTopicMessageResult(id, channel.c_str(), topic.c_str(), code);
+  });
+}
+
+void LoopbackStreamChannel::leaveTopic(const char* topic, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  LoopbackEventBatch events;
+  RTM_ERROR_CODE code = client_.broker().leaveTopic(client_.session(), channelName_, viewOf(topic), events);
+  client_.deferResult([channel = channelName_, user = client_.userId(), id = requestId,
+                       topic = std::string(viewOf(topic)), code](IRtmEventHandler& handler) {
+    handler.onLeaveTopicResult(id, channel.c_str(), user.c_str(), topic.c_str(), "", code);
+  });
+  events.dispatch();
+}
+
+void LoopbackStreamChannel::subscribeTopic(const char* topic, const TopicOptions& options, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  std::vector<std::string> users = usersOf(options);
+  RTM_ERROR_CODE code = client_.broker().subscribeTopic(client_.session(), channelName_, viewOf(topic), users);
+  client_.deferResult([channel = channelName_, user = client_.userId(), id = requestId,
+                       topic = std::string(viewOf(topic)), users = std::move(users), code](IRtmEventHandler& handler) {
+    UserListView succeed(code == RTM_ERROR_OK ? users : std::vector<std::string>());
+    UserListView failed(code == RTM_ERROR_OK ? std::vector<std::string>() : users);
+    handler.onSubscribeTopicResult(id, channel.c_str(), user.c_str(), topic.c_str(), succeed.list(), failed.list(),
+                                   code);
+  });
+}
+
+void LoopbackStreamChannel::unsubscribeTopic(const char* topic, const TopicOptions& options, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  RTM_ERROR_CODE code = client_.broker().unsubscribeTopic(client_.session(), channelName_, viewOf(topic),
+                                                          usersOf(options));
+  client_.deferResult([channel = channelName_, id = requestId, topic = std::string(viewOf(topic)),
+                       code](IRtmEventHandler& handler) {
+    handler.onUnsubscribeTopicResult(id, channel.c_str(), topic.c_str(), code);
+  });
+}
+
+void LoopbackStreamChannel::getSubscribedUserList(const char* topic, uint64_t& requestId) {
+  requestId = client_.nextRequestId();
+  std::vector<std::string> users;
+  RTM_ERROR_CODE code = client_.broker().getSubscribedUsers(client_.session(), channelName_, viewOf(topic), users);
+  client_.deferResult([channel = channelName_, id = requestId, topic = std::string(viewOf(topic)),
+                       users = std::move(users), code](IRtmEventHandler& handler) {
+    UserListView view(users);
+    handler.onGetSubscribedUserListResult(id, channel.c_str(), topic.c_str(), view.list(), code);
+  });
+}
+
+int LoopbackStreamChannel::release() {
+  if (joined_.load()) {
+    LoopbackEventBatch events;
+    client_.broker().leaveChannel(client_.session(), channelName_, RTM_CHANNEL_TYPE_STREAM, events);
+    events.dispatch();
+  }
+  delete this;
+  return 0;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,48 @@
+//
+//  LoopbackStreamChannel.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "IAgoraStreamChannel.h"
+
+namespace flat {
+namespace rtm {
+
+class LoopbackRtmClient;
+
+/// `IStreamChannel` created by `LoopbackRtmClient::createStreamChannel`. Must be released before its client.
+class LoopbackStreamChannel : public agora::rtm::IStreamChannel {
+ public:
+  LoopbackStreamChannel(LoopbackRtmClient& client, std::string channelName);
+
+  void join(const agora::rtm::JoinChannelOptions& options, uint64_t& requestId) override;
+  void renewToken(const char* token, uint64_t& requestId) override;
+  void leave(uint64_t& requestId) override;
+  const char* getChannelName() override { return channelName_.c_str(); }
+  void joinTopic(const char* topic, const agora::rtm::JoinTopicOptions& options, uint64_t& requestId) override;
+  void publishTopicMessage(const char* topic, const char* message, size_t length,
+                           const agora::rtm::TopicMessageOptions& option, uint64_t& requestId) override;
+  void leaveTopic(const char* topic, uint64_t& requestId) override;
+  void subscribeTopic(const char* topic, const agora::rtm::TopicOptions& options, uint64_t& requestId) override;
+  void unsubscribeTopic(const char* topic, const agora::rtm::TopicOptions& options, uint64_t& requestId) override;
+  void getSubscribedUserList(const char* topic, uint64_t& requestId) override;
+  int release() override;
+
+ protected:
+  ~LoopbackStreamChannel() override = default;
+
+ private:
+  LoopbackRtmClient& client_;
+  const std::string channelName_;
+  std::atomic<bool> joined_{false};
+};
+
+}  // namespace rtm
+}  // namespace flat
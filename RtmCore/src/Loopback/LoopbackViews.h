@@ -0,0 +1,153 @@
+//
+//  LoopbackViews.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Loopback/LoopbackBroker.h"
+
+namespace flat {
+namespace rtm {
+
+// Borrowed SDK structs over the broker's owned data. A view must not outlive the data it was built from.
+
+class StateItemsView {
+ public:
+  explicit StateItemsView(const StatePairs& states) {
+    items_.reserve(states.size());
+    for (const auto& state : states) {
+      agora::rtm::StateItem item;
+      item.key = state.first.c_str();
+      item.value = state.second.c_str();
+      items_.push_back(item);
+    }
+  }
+
+  const agora::rtm::StateItem* data() const { return items_.empty() ? nullptr : items_.data(); }
+  size_t size() const { return items_.size(); }
+
+ private:
+  std::vector<agora::rtm::StateItem> items_;
+};
+
+class UserStatesView {
+ public:
+  explicit UserStatesView(const std::vector<LoopbackUserState>& users) {
+    size_t itemCount = 0;
+    for (const auto& user : users) itemCount += user.states.size();
+    items_.reserve(itemCount);
+    states_.reserve(users.size());
+    for (const auto& user : users) {
+      agora::rtm::UserState state;
+      state.userId = user.userId.c_str();
+      state.states = items_.data() + items_.size();
+      state.statesCount = user.states.size();
+      for (const auto& pair : user.states) {
+        agora::rtm::StateItem item;
+        item.key = pair.first.c_str();
+        item.value = pair.second.c_str();
+        items_.push_back(item);
+      }
+      if (state.statesCount == 0) state.states = nullptr;
+      states_.push_back(state);
+    }
+  }
+
+  agora::rtm::UserState* data() { return states_.empty() ? nullptr : states_.data(); }
+  size_t size() const { return states_.size(); }
+
+ private:
+  std::vector<agora::rtm::StateItem> items_;
+  std::vector<agora::rtm::UserState> states_;
+};
+
+class UserListView {
+ public:
+  explicit UserListView(const std::vector<std::string>& users) {
+    users_.reserve(users.size());
+    for (const auto& user : users) users_.push_back(user.c_str());
+  }
+
+  agora::rtm::UserList list() const {
+    agora::rtm::UserList list;
+    list.users = users_.empty() ? nullptr : const_cast<const char**>(users_.data());
+    list.userCount = users_.size();
+    return list;
+  }
+
+ private:
+  std::vector<const char*> users_;
+};
+
+class MetadataView {
+ public:
+  explicit MetadataView(const LoopbackMetadata& data) {
+    items_.reserve(data.items.size());
+    for (const auto& source : data.items) {
+      agora::rtm::MetadataItem item(source.key.c_str(), source.value.c_str(), source.revision);
+      item.authorUserId = source.authorUserId.c_str();
+      item.updateTs = source.updateTs;
+      items_.push_back(item);
+    }
+    metadata_.majorRevision = data.majorRevision;
+    metadata_.items = items_.empty() ? nullptr : items_.data();
+    metadata_.itemCount = items_.size();
+  }
+
+  MetadataView(const MetadataView&) = delete;
+  MetadataView& operator=(const MetadataView&) = delete;
+
+  const agora::rtm::Metadata& metadata() const { return metadata_; }
+
+ private:
+  std::vector<agora::rtm::MetadataItem> items_;
+  agora::rtm::Metadata metadata_;
+};
+
+class LockDetailsView {
+ public:
+  explicit LockDetailsView(const std::vector<LoopbackLock>& locks) {
+    details_.reserve(locks.size());
+    for (const auto& lock : locks) {
+      agora::rtm::LockDetail detail;
+      detail.lockName = lock.lockName.c_str();
+      detail.owner = lock.owner.c_str();
+      detail.ttl = lock.ttl;
+      details_.push_back(detail);
+    }
+  }
+
+  const agora::rtm::LockDetail* data() const { return details_.empty() ? nullptr : details_.data(); }
+  size_t size() const { return details_.size(); }
+
+ private:
+  std::vector<agora::rtm::LockDetail> details_;
+};
+
+class ChannelInfosView {
+ public:
+  explicit ChannelInfosView(const std::vector<LoopbackChannelRef>& channels) {
+    infos_.reserve(channels.size());
+    for (const auto& channel : channels) {
+      agora::rtm::ChannelInfo info;
+      info.channelName = channel.channelName.c_str();
+      info.channelType = channel.channelType;
+      infos_.push_back(info);
+    }
+  }
+
+  const agora::rtm::ChannelInfo* data() const { return infos_.empty() ? nullptr : infos_.data(); }
+  size_t size() const { return infos_.size(); }
+
+ private:
+  std::vector<agora::rtm::ChannelInfo> infos_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,226 @@
+//
+//  OnlineUserStream.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Presence/OnlineUserStream.h"
+
+#include <algorithm>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+const char* cString(const char* value) { return value ? value : ""; }
+
+}  // namespace
+
+OnlineUserStream::OnlineUserStream(IRtmPresence& presence, std::string_view channelName, RTM_CHANNEL_TYPE channelType)
+    : OnlineUserStream(presence, channelName, channelType, Options()) {}
+
+OnlineUserStream::OnlineUserStream(IRtmPresence& presence, std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                   Options options)
+    : presence_(presence),
+      channelName_(channelName),
+      channelType_(channelType),
+      options_([&] {
+        options.maxBufferedPages = std::max<size_t>(options.maxBufferedPages, 1);
+        return options;
+      }()),
+      unclaimed_(options_.unclaimedCapacity) {}
+
+void OnlineUserStream::start() {
+  Fetch next;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (started_ || !startFetchLocked(next)) return;
+  }
+  fetch(next);
+}
+
+OnlineUserStream::Status OnlineUserStream::tryNext(const User*& user) {
+  Fetch next;
+  bool issue = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    releaseLocked();
+    issue = startFetchLocked(next);
+  }
+  if (issue) fetch(next);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!pages_.empty()) {
+    user = &pages_.front().users[cursor_++];
+    return Status::ready;
+  }
+  if (error_ != RTM_ERROR_OK) return Status::failed;
+  if (!fetching_ && nextPage_.empty()) return Status::end;
+  ++stats_.stalls;
+  return Status::pending;
+}
+
+RTM_ERROR_CODE OnlineUserStream::error() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return error_;
+}
+
+OnlineUserStream::Stats OnlineUserStream::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Events
+
+void OnlineUserStream::onWhoNowResult(const uint64_t requestId, const UserState* userStateList, const size_t count,
+                                      const char* nextPage, RTM_ERROR_CODE errorCode) {
+  if (options_.legacyWhoNow) onPage(requestId, userStateList, count, nextPage, errorCode);
+}
+
+void OnlineUserStream::onGetOnlineUsersResult(const uint64_t requestId, const UserState* userStateList,
+                                              const size_t count, const char* nextPage, RTM_ERROR_CODE errorCode) {
+  if (!options_.legacyWhoNow) onPage(requestId, userStateList, count, nextPage, errorCode);
+}
+
+// MARK: - Private
+
+bool OnlineUserStream::park(std::coroutine_handle<> handle) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // A page may have landed between `tryNext` and here.
+  if (settledLocked()) return false;
+  waiter_ = handle;
+  return true;
+}
+
+void OnlineUserStream::onPage(uint64_t requestId, const UserState* userStateList, size_t count,
+                              const char* nextPage, RTM_ERROR_CODE errorCode) {
+  std::coroutine_handle<> waiter;
+  Fetch next;
+  bool issue = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!fetching_ || (requestId_ != 0 && requestId_ != requestId)) return;
+    Answer answer = copyLocked(userStateList, count, nextPage, errorCode);
+    if (requestId_ == 0) {
+      // The request is still being issued; this may be its answer.
+      unclaimed_.keep(requestId, std::move(answer));
+      return;
+    }
+    issue = landLocked(std::move(answer), next);
+    if (waiter_ && settledLocked()) waiter = std::exchange(waiter_, {});
+  }
+  // Ask for the next page before handing this one over, so the round trip overlaps the consumer's work.
+  if (issue) fetch(next);
+  if (waiter) waiter.resume();
+}
+
+OnlineUserStream::Answer OnlineUserStream::copyLocked(const UserState* userStateList, size_t count,
+                                                      const char* nextPage, RTM_ERROR_CODE errorCode) {
+  Answer answer;
+  answer.errorCode = errorCode;
+  if (errorCode != RTM_ERROR_OK) return answer;
+  answer.nextPage = cString(nextPage);
+  if (count == 0 || !userStateList) return answer;
+  Page& filled = answer.page;
+  if (!spare_.empty()) {
+    filled = std::move(spare_.back());
+    spare_.pop_back();
+  }
+  if (filled.users.size() < count) filled.users.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const UserState& source = userStateList[i];
+    User& target = filled.users[i];
+    target.userId = cString(source.userId);
+    target.states.resize(source.states ? source.statesCount : 0);
+    for (size_t j = 0; j < target.states.size(); ++j) {
+      target.states[j].first = cString(source.states[j].key);
+      target.states[j].second = cString(source.states[j].value);
+    }
+  }
+  filled.size = count;
+  return answer;
+}
+
+bool OnlineUserStream::landLocked(Answer answer, Fetch& next) {
+  fetching_ = false;
+  requestId_ = 0;
+  if (answer.errorCode != RTM_ERROR_OK) {
+    error_ = answer.errorCode;
+    return false;
+  }
+  nextPage_ = std::move(answer.nextPage);
+  ++stats_.pages;
+  size_t count = answer.page.size;
+  if (count > 0) {
+    pages_.push_back(std::move(answer.page));
+    bufferedUsers_ += count;
+    stats_.users += count;
+    stats_.peakBufferedUsers = std::max(stats_.peakBufferedUsers, bufferedUsers_);
+  }
+  return startFetchLocked(next);
+}
+
+void OnlineUserStream::releaseLocked() {
+  while (!pages_.empty() && cursor_ >= pages_.front().size) {
+    bufferedUsers_ -= pages_.front().size;
+    spare_.push_back(std::move(pages_.front()));
+    pages_.pop_front();
+    cursor_ = 0;
+  }
+}
+
+bool OnlineUserStream::startFetchLocked(Fetch& next) {
+  if (fetching_ || error_ != RTM_ERROR_OK || pages_.size() >= options_.maxBufferedPages) return false;
+  if (started_ && nextPage_.empty()) return false;
+  started_ = true;
+  fetching_ = true;
+  requestId_ = 0;
+  next.page = nextPage_;
+  ++stats_.requests;
+  return true;
+}
+
+void OnlineUserStream::fetch(const Fetch& next) {
+  uint64_t requestId = 0;
+  const char* cursor = next.page.empty() ? nullptr : next.page.c_str();
+  if (options_.legacyWhoNow) {
+    PresenceOptions options;
+    options.includeState = options_.includeState;
+    options.page = cursor;
+    presence_.whoNow(channelName_.c_str(), channelType_, options, requestId);
+  } else {
+    GetOnlineUsersOptions options;
+    options.includeState = options_.includeState;
+    options.page = cursor;
+    presence_.getOnlineUsers(channelName_.c_str(), channelType_, options, requestId);
+  }
+
+  std::coroutine_handle<> waiter;
+  Fetch following;
+  bool issue = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Answer answer;
+    if (requestId == 0) {
+      answer.errorCode = RTM_ERROR_PRESENCE_OPERATION_FAILED;
+    } else if (!unclaimed_.take(requestId, answer)) {
+      requestId_ = requestId;
+      return;
+    }
+    issue = landLocked(std::move(answer), following);
+    if (waiter_ && settledLocked()) waiter = std::exchange(waiter_, {});
+  }
+  if (issue) fetch(following);
+  if (waiter) waiter.resume();
+}
+
+bool OnlineUserStream::settledLocked() const {
+  return !pages_.empty() || error_ != RTM_ERROR_OK || (!fetching_ && nextPage_.empty());
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,166 @@
+//
+//  OnlineUserStream.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmPresence.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Pull-based iterator over the users of a channel, paging through `getOnlineUsers` (or `whoNow`) with the
+/// `nextPage` cursor.
+///
+/// The consumer pulls one user at a time with `tryNext`, or `co_await stream.next()` from a coroutine. While it
+/// works through one page the next is already requested, so a consumer slower than the round trip never waits.
+/// At most `Options::maxBufferedPages` pages are held, the one being read included, so memory is bounded by the
+/// service's page size whatever the channel holds. Consumed pages are recycled and their strings reused.
+///
+/// Register the stream with the client's event handler. Results are matched by requestId only; one arriving
+/// while a request is being issued is kept until the call returns its id, as it may be another component's.
+/// The stream is single-use: it ends when a page comes back without a `nextPage`, or fails with the page's error
+/// code. Results may arrive on another thread than the consumer's; a parked coroutine resumes on that thread.
+/// Pending coroutines are not resumed on destruction.
+class OnlineUserStream : public agora::rtm::IRtmEventHandler {
+ public:
+  using States = std::vector<std::pair<std::string, std::string>>;
+
+  struct User {
+    std::string userId;
+    States states;
+  };
+
+  enum class Status { ready, pending, end, failed };
+
+  struct Options {
+    bool includeState = false;
+    /// Pages through `whoNow` instead of `getOnlineUsers`.
+    bool legacyWhoNow = false;
+    /// Pages held at once, the one being read included. 2 keeps one page in flight behind the reader.
+    size_t maxBufferedPages = 2;
+    /// Results kept while a request is being issued, in case one is its own. Each holds a copy of its page.
+    size_t unclaimedCapacity = 4;
+  };
+
+  struct Stats {
+    uint64_t requests = 0;
+    uint64_t pages = 0;
+    uint64_t users = 0;
+    /// `tryNext` calls that found nothing buffered yet.
+    uint64_t stalls = 0;
+    size_t peakBufferedUsers = 0;
+  };
+
+  /// Awaitable for the next user; resumes with nullptr once the stream ended or failed.
+  class Awaiter {
+   public:
+    explicit Awaiter(OnlineUserStream& stream) : stream_(stream) {}
+
+    bool await_ready() { return (status_ = stream_.tryNext(user_)) != Status::pending; }
+    bool await_suspend(std::coroutine_handle<> handle) { return stream_.park(handle); }
+    const User* await_resume() {
+      if (status_ == Status::pending) status_ = stream_.tryNext(user_);
+      return status_ == Status::ready ? user_ : nullptr;
+    }
+
+   private:
+    OnlineUserStream& stream_;
+    Status status_ = Status::pending;
+    const User* user_ = nullptr;
+  };
+
+  OnlineUserStream(agora::rtm::IRtmPresence& presence, std::string_view channelName,
+                   agora::rtm::RTM_CHANNEL_TYPE channelType);
+  OnlineUserStream(agora::rtm::IRtmPresence& presence, std::string_view channelName,
+                   agora::rtm::RTM_CHANNEL_TYPE channelType, Options options);
+
+  OnlineUserStream(const OnlineUserStream&) = delete;
+  OnlineUserStream& operator=(const OnlineUserStream&) = delete;
+
+  /// Requests the first page ahead of the first pull. Optional: `tryNext` starts the stream too.
+  void start();
+  /// Consumer thread. On `ready`, `user` points at the next user until the following `tryNext` or `next`.
+  /// Never blocks: `pending` means the page is still on its way.
+  Status tryNext(const User*& user);
+  Awaiter next() { return Awaiter(*this); }
+
+  /// The error that failed the stream, `RTM_ERROR_OK` otherwise.
+  agora::rtm::RTM_ERROR_CODE error() const;
+  Stats stats() const;
+
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Fetch {
+    std::string page;
+  };
+
+  struct Page {
+    /// Only the first `size` users are live; the rest keep their capacity for the next fill.
+    std::vector<User> users;
+    size_t size = 0;
+  };
+
+  /// A result as it came back, before it is buffered.
+  struct Answer {
+    agora::rtm::RTM_ERROR_CODE errorCode = agora::rtm::RTM_ERROR_OK;
+    Page page;
+    std::string nextPage;
+  };
+
+  bool park(std::coroutine_handle<> handle);
+  void onPage(uint64_t requestId, const agora::rtm::UserState* userStateList, size_t count, const char* nextPage,
+              agora::rtm::RTM_ERROR_CODE errorCode);
+  Answer copyLocked(const agora::rtm::UserState* userStateList, size_t count, const char* nextPage,
+                    agora::rtm::RTM_ERROR_CODE errorCode);
+  /// Settles the request in flight with its answer; true when `next` should be requested.
+  bool landLocked(Answer answer, Fetch& next);
+  /// Recycles the pages the consumer has read to the end.
+  void releaseLocked();
+  /// Marks a request in flight when the buffer has room and pages remain.
+  bool startFetchLocked(Fetch& next);
+  void fetch(const Fetch& next);
+  bool settledLocked() const;
+
+  agora::rtm::IRtmPresence& presence_;
+  const std::string channelName_;
+  const agora::rtm::RTM_CHANNEL_TYPE channelType_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  std::deque<Page> pages_;
+  std::vector<Page> spare_;
+  /// Next user to hand out from `pages_.front()`.
+  size_t cursor_ = 0;
+  size_t bufferedUsers_ = 0;
+  std::string nextPage_;
+  bool started_ = false;
+  bool fetching_ = false;
+  /// 0 while the request is being issued.
+  uint64_t requestId_ = 0;
+  UnclaimedResults<Answer> unclaimed_;
+  agora::rtm::RTM_ERROR_CODE error_ = agora::rtm::RTM_ERROR_OK;
+  std::coroutine_handle<> waiter_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,445 @@
+//
+//  PresenceQueryCache.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Presence/PresenceQueryCache.h"
+
+#include <utility>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+const char* cString(const char* value) { return value ? value : ""; }
+
+/// Prefix shared by every key about one channel. Channel names cannot hold control characters.
+std::string channelKey(std::string_view channelName, RTM_CHANNEL_TYPE channelType) {
+  std::string key = std::to_string(static_cast<int>(channelType));
+  key += ':';
+  key.append(channelName);
+  key += '\x1f';
+  return key;
+}
+
+/// Online-user lists add a flags character after the channel prefix, then the page cursor.
+constexpr char kUserIdFlag = 1;
+constexpr char kStateFlag = 2;
+
+std::string onlineUsersKey(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                           const GetOnlineUsersOptions& options) {
+  std::string key = channelKey(channelName, channelType);
+  key += static_cast<char>('@' + (options.includeUserId ? kUserIdFlag : 0) + (options.includeState ? kStateFlag : 0));
+  key.append(cString(options.page));
+  return key;
+}
+
+bool startsWith(std::string_view value, std::string_view prefix) {
+  return value.size() >= prefix.size() && value.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool listIncludesStates(std::string_view key, size_t prefixLength) {
+  return key.size() > prefixLength && ((key[prefixLength] - '@') & kStateFlag) != 0;
+}
+
+void copyStates(const UserState& source, PresenceQueryCache::UserStates& target) {
+  target.userId = cString(source.userId);
+  target.states.clear();
+  for (size_t i = 0; i < source.statesCount && source.states; ++i) {
+    target.states.emplace_back(cString(source.states[i].key), cString(source.states[i].value));
+  }
+}
+
+}  // namespace
+
+PresenceQueryCache::PresenceQueryCache(IRtmPresence& presence) : PresenceQueryCache(presence, Options()) {}
+
+PresenceQueryCache::PresenceQueryCache(IRtmPresence& presence, Options options)
+    : presence_(presence), options_(options), unclaimed_(options.unclaimedCapacity) {}
+
+// MARK: - Queries
+
+void PresenceQueryCache::getOnlineUsers(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                        const GetOnlineUsersOptions& options, RtmClock::time_point now,
+                                        Callback<OnlineUsers> callback) {
+  std::string key = onlineUsersKey(channelName, channelType, options);
+  std::shared_ptr<const OnlineUsers> hit;
+  bool send = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    send = lookupLocked(onlineUsers_, key, now, callback, hit);
+  }
+  if (hit) {
+    callback(RTM_ERROR_OK, std::move(hit));
+    return;
+  }
+  if (!send) return;
+  std::string name(channelName);
+  issue(Kind::onlineUsers, key, [&](uint64_t& requestId) {
+    presence_.getOnlineUsers(name.c_str(), channelType, options, requestId);
+  });
+}
+
+void PresenceQueryCache::getUserChannels(std::string_view userId, RtmClock::time_point now,
+                                         Callback<Channels> callback) {
+  std::string key(userId);
+  std::shared_ptr<const Channels> hit;
+  bool send = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    send = lookupLocked(userChannels_, key, now, callback, hit);
+  }
+  if (hit) {
+    callback(RTM_ERROR_OK, std::move(hit));
+    return;
+  }
+  if (!send) return;
+  issue(Kind::userChannels, key, [&](uint64_t& requestId) { presence_.getUserChannels(key.c_str(), requestId); });
+}
+
+void PresenceQueryCache::getState(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                  std::string_view userId, RtmClock::time_point now, Callback<UserStates> callback) {
+  std::string key = channelKey(channelName, channelType);
+  key.append(userId);
+  std::shared_ptr<const UserStates> hit;
+  bool send = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    send = lookupLocked(states_, key, now, callback, hit);
+  }
+  if (hit) {
+    callback(RTM_ERROR_OK, std::move(hit));
+    return;
+  }
+  if (!send) return;
+  std::string name(channelName);
+  std::string user(userId);
+  issue(Kind::state, key, [&](uint64_t& requestId) {
+    presence_.getState(name.c_str(), channelType, user.c_str(), requestId);
+  });
+}
+
+void PresenceQueryCache::invalidate(std::string_view channelName, RTM_CHANNEL_TYPE channelType) {
+  std::string prefix = channelKey(channelName, channelType);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto inChannel = [&](const std::string& key) { return startsWith(key, prefix); };
+  dropIfLocked(onlineUsers_, inChannel);
+  dropIfLocked(states_, inChannel);
+}
+
+size_t PresenceQueryCache::purge(RtmClock::time_point now) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t purged = 0;
+  auto sweep = [&](auto& slots) {
+    for (auto it = slots.begin(); it != slots.end();) {
+      if (!it->second.inFlight && it->second.expires <= now) {
+        it = slots.erase(it);
+        ++purged;
+      } else {
+        ++it;
+      }
+    }
+  };
+  sweep(onlineUsers_);
+  sweep(userChannels_);
+  sweep(states_);
+  return purged;
+}
+
+size_t PresenceQueryCache::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t kept = 0;
+  auto count = [&](const auto& slots) {
+    for (const auto& entry : slots) kept += entry.second.value != nullptr;
+  };
+  count(onlineUsers_);
+  count(userChannels_);
+  count(states_);
+  return kept;
+}
+
+PresenceQueryCache::Stats PresenceQueryCache::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Events
+
+void PresenceQueryCache::onPresenceEvent(const PresenceEvent& event) {
+  std::string prefix = channelKey(viewOf(event.channelName), event.channelType);
+  std::lock_guard<std::mutex> guard(mutex_);
+  switch (event.type) {
+    case RTM_PRESENCE_EVENT_TYPE_SNAPSHOT:
+    case RTM_PRESENCE_EVENT_TYPE_ERROR_OUT_OF_SERVICE: {
+      // Anything may have changed while the channel was out of sight, including who else is where.
+      auto inChannel = [&](const std::string& key) { return startsWith(key, prefix); };
+      dropIfLocked(onlineUsers_, inChannel);
+      dropIfLocked(states_, inChannel);
+      dropIfLocked(userChannels_, [](const std::string&) { return true; });
+      break;
+    }
+    case RTM_PRESENCE_EVENT_TYPE_INTERVAL: {
+      const PresenceEvent::IntervalInfo& interval = event.interval;
+      const UserList* membership[] = {&interval.joinUserList, &interval.leaveUserList, &interval.timeoutUserList};
+      bool membershipChanged = false;
+      for (const UserList* list : membership) {
+        for (size_t i = 0; i < list->userCount && list->users; ++i) {
+          dropMemberLocked(prefix, viewOf(list->users[i]));
+          membershipChanged = true;
+        }
+      }
+      for (size_t i = 0; i < interval.userStateCount && interval.userStateList; ++i) {
+        dropLocked(states_, prefix + cString(interval.userStateList[i].userId));
+      }
+      if (membershipChanged || interval.userStateCount > 0) dropListsLocked(prefix, !membershipChanged);
+      break;
+    }
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL:
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL:
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_TIMEOUT:
+      dropMemberLocked(prefix, viewOf(event.publisher));
+      dropListsLocked(prefix, false);
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED:
+      dropLocked(states_, prefix + cString(event.publisher));
+      dropListsLocked(prefix, true);
+      break;
+    default:
+      break;
+  }
+}
+
+void PresenceQueryCache::onGetOnlineUsersResult(const uint64_t requestId, const UserState* userStateList,
+                                                const size_t count, const char* nextPage, RTM_ERROR_CODE errorCode) {
+  Flight flight;
+  Claim claimed = claim(requestId, Kind::onlineUsers, flight);
+  if (claimed == Claim::other) return;
+  std::shared_ptr<OnlineUsers> value;
+  if (errorCode == RTM_ERROR_OK) {
+    value = std::make_shared<OnlineUsers>();
+    value->users.resize(userStateList ? count : 0);
+    for (size_t i = 0; i < value->users.size(); ++i) copyStates(userStateList[i], value->users[i]);
+    value->nextPage = cString(nextPage);
+  }
+  if (claimed == Claim::early && !park(requestId, Answer{Kind::onlineUsers, errorCode, value}, flight)) return;
+  finish<OnlineUsers>(onlineUsers_, flight.key, errorCode, std::move(value));
+}
+
+void PresenceQueryCache::onGetUserChannelsResult(const uint64_t requestId, const ChannelInfo* channels,
+                                                 const size_t count, RTM_ERROR_CODE errorCode) {
+  Flight flight;
+  Claim claimed = claim(requestId, Kind::userChannels, flight);
+  if (claimed == Claim::other) return;
+  std::shared_ptr<Channels> value;
+  if (errorCode == RTM_ERROR_OK) {
+    value = std::make_shared<Channels>();
+    for (size_t i = 0; i < count && channels; ++i) {
+      value->push_back(ChannelRef{cString(channels[i].channelName), channels[i].channelType});
+    }
+  }
+  if (claimed == Claim::early && !park(requestId, Answer{Kind::userChannels, errorCode, value}, flight)) return;
+  finish<Channels>(userChannels_, flight.key, errorCode, std::move(value));
+}
+
+void PresenceQueryCache::onPresenceGetStateResult(const uint64_t requestId, const UserState& state,
+                                                  RTM_ERROR_CODE errorCode) {
+  Flight flight;
+  Claim claimed = claim(requestId, Kind::state, flight);
+  if (claimed == Claim::other) return;
+  std::shared_ptr<UserStates> value;
+  if (errorCode == RTM_ERROR_OK) {
+    value = std::make_shared<UserStates>();
+    copyStates(state, *value);
+  }
+  if (claimed == Claim::early && !park(requestId, Answer{Kind::state, errorCode, value}, flight)) return;
+  finish<UserStates>(states_, flight.key, errorCode, std::move(value));
+}
+
+void PresenceQueryCache::onPresenceSetStateResult(const uint64_t, RTM_ERROR_CODE errorCode) {
+  if (errorCode != RTM_ERROR_OK) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  dropIfLocked(states_, [](const std::string&) { return true; });
+  dropIfLocked(onlineUsers_, [](const std::string& key) { return listIncludesStates(key, key.find('\x1f') + 1); });
+}
+
+void PresenceQueryCache::onPresenceRemoveStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  onPresenceSetStateResult(requestId, errorCode);
+}
+
+void PresenceQueryCache::onSubscribeResult(const uint64_t, const char* channelName, RTM_ERROR_CODE errorCode) {
+  if (errorCode != RTM_ERROR_OK) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  dropListsLocked(channelKey(viewOf(channelName), RTM_CHANNEL_TYPE_MESSAGE), false);
+  dropIfLocked(userChannels_, [](const std::string&) { return true; });
+}
+
+void PresenceQueryCache::onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                                             RTM_ERROR_CODE errorCode) {
+  onSubscribeResult(requestId, channelName, errorCode);
+}
+
+void PresenceQueryCache::onJoinResult(const uint64_t, const char* channelName, const char* userId,
+                                      RTM_ERROR_CODE errorCode) {
+  if (errorCode != RTM_ERROR_OK) return;
+  std::string prefix = channelKey(viewOf(channelName), RTM_CHANNEL_TYPE_STREAM);
+  std::lock_guard<std::mutex> guard(mutex_);
+  dropMemberLocked(prefix, viewOf(userId));
+  dropListsLocked(prefix, false);
+}
+
+void PresenceQueryCache::onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                                       RTM_ERROR_CODE errorCode) {
+  onJoinResult(requestId, channelName, userId, errorCode);
+}
+
+// MARK: - Private
+
+template <typename Value>
+bool PresenceQueryCache::lookupLocked(StringMap<Slot<Value>>& slots, std::string key, RtmClock::time_point now,
+                                      Callback<Value>& callback, std::shared_ptr<const Value>& hit) {
+  Slot<Value>& slot = slots[std::move(key)];
+  if (slot.inFlight) {
+    slot.waiters.push_back(std::move(callback));
+    ++stats_.misses;
+    ++stats_.coalesced;
+    return false;
+  }
+  if (slot.value && now < slot.expires) {
+    hit = slot.value;
+    ++stats_.hits;
+    return false;
+  }
+  slot.value.reset();
+  slot.expires = now + options_.ttl;
+  slot.inFlight = true;
+  slot.stale = false;
+  slot.waiters.push_back(std::move(callback));
+  ++stats_.misses;
+  return true;
+}
+
+PresenceQueryCache::Claim PresenceQueryCache::claim(uint64_t requestId, Kind kind, Flight& flight) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Flight* found = flights_.find(requestId);
+  if (found && found->kind == kind) {
+    flights_.take(requestId, flight);
+    return Claim::mine;
+  }
+  return calling_ > 0 && !found ? Claim::early : Claim::other;
+}
+
+bool PresenceQueryCache::park(uint64_t requestId, Answer answer, Flight& flight) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // The call may have returned while the result was being decoded.
+  if (Flight* found = flights_.find(requestId)) {
+    return found->kind == answer.kind && flights_.take(requestId, flight);
+  }
+  if (calling_ > 0) unclaimed_.keep(requestId, std::move(answer));
+  return false;
+}
+
+template <typename Value>
+void PresenceQueryCache::finish(StringMap<Slot<Value>>& slots, const std::string& key, RTM_ERROR_CODE errorCode,
+                                std::shared_ptr<const Value> value) {
+  std::vector<Callback<Value>> waiters;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = slots.find(key);
+    if (found == slots.end()) return;
+    Slot<Value>& slot = found->second;
+    waiters = std::move(slot.waiters);
+    if (errorCode != RTM_ERROR_OK) ++stats_.errors;
+    if (errorCode != RTM_ERROR_OK || slot.stale) {
+      slots.erase(found);
+    } else {
+      slot.value = value;
+      slot.inFlight = false;
+    }
+  }
+  for (Callback<Value>& waiter : waiters) waiter(errorCode, value);
+}
+
+void PresenceQueryCache::finish(Kind kind, const std::string& key, RTM_ERROR_CODE errorCode,
+                                std::shared_ptr<const void> value) {
+  switch (kind) {
+    case Kind::onlineUsers:
+      finish<OnlineUsers>(onlineUsers_, key, errorCode, std::static_pointer_cast<const OnlineUsers>(value));
+      break;
+    case Kind::userChannels:
+      finish<Channels>(userChannels_, key, errorCode, std::static_pointer_cast<const Channels>(value));
+      break;
+    case Kind::state:
+      finish<UserStates>(states_, key, errorCode, std::static_pointer_cast<const UserStates>(value));
+      break;
+  }
+}
+
+void PresenceQueryCache::issue(Kind kind, const std::string& key, const std::function<void(uint64_t&)>& send) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++calling_;
+  }
+  uint64_t requestId = 0;
+  send(requestId);
+  Answer early;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    --calling_;
+    bool answered = requestId != 0 && unclaimed_.take(requestId, early) && early.kind == kind;
+    if (!answered) {
+      if (requestId != 0 && flights_.insert(requestId, Flight{kind, key})) return;
+      early = Answer{kind, RTM_ERROR_PRESENCE_OPERATION_FAILED, nullptr};
+    }
+  }
+  finish(kind, key, early.errorCode, std::move(early.value));
+}
+
+template <typename Value, typename Predicate>
+void PresenceQueryCache::dropIfLocked(StringMap<Slot<Value>>& slots, Predicate predicate) {
+  for (auto it = slots.begin(); it != slots.end();) {
+    if (!predicate(it->first)) {
+      ++it;
+      continue;
+    }
+    ++stats_.invalidations;
+    if (it->second.inFlight) {
+      it->second.stale = true;
+      ++it;
+    } else {
+      it = slots.erase(it);
+    }
+  }
+}
+
+template <typename Value>
+void PresenceQueryCache::dropLocked(StringMap<Slot<Value>>& slots, const std::string& key) {
+  auto found = slots.find(key);
+  if (found == slots.end()) return;
+  ++stats_.invalidations;
+  if (found->second.inFlight) {
+    found->second.stale = true;
+  } else {
+    slots.erase(found);
+  }
+}
+
+void PresenceQueryCache::dropListsLocked(const std::string& channelKey, bool withStatesOnly) {
+  dropIfLocked(onlineUsers_, [&](const std::string& key) {
+    return startsWith(key, channelKey) && (!withStatesOnly || listIncludesStates(key, channelKey.size()));
+  });
+}
+
+void PresenceQueryCache::dropMemberLocked(const std::string& channelKey, std::string_view userId) {
+  std::string stateKey = channelKey;
+  stateKey.append(userId);
+  dropLocked(states_, stateKey);
+  dropLocked(userChannels_, std::string(userId));
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,194 @@
+//
+//  PresenceQueryCache.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmPresence.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Read-through cache in front of the presence queries: `getOnlineUsers` (`whoNow`), `getUserChannels`
+/// (`whereNow`) and `getState`.
+///
+/// Answers are kept for `Options::ttl` under their query: channel, channel type and options for online users,
+/// channel, type and user for states, user for user channels. Identical queries asked while one is in flight
+/// wait for it instead of issuing their own. Presence events drop exactly the answers they make stale: joins,
+/// leaves and timeouts drop the channel's user lists and that user's state and channels; state changes drop only
+/// lists that include states and that user's state; a snapshot or an out-of-service error drops the whole
+/// channel. The local user's own subscribes and joins drop that channel's lists; its state writes, whose results
+/// name no channel, drop every answer that includes states. An answer whose query was invalidated while in
+/// flight is handed to its waiters but not kept.
+///
+/// Callbacks run without the cache's lock, on the calling thread for hits and on the SDK callback thread for
+/// misses. Register the cache with the client's event handler. Results are matched to queries by requestId only;
+/// one that arrives while a query is still being issued is kept until the call returns its id.
+class PresenceQueryCache : public agora::rtm::IRtmEventHandler {
+ public:
+  using States = std::vector<std::pair<std::string, std::string>>;
+
+  struct UserStates {
+    std::string userId;
+    States states;
+  };
+
+  struct OnlineUsers {
+    std::vector<UserStates> users;
+    std::string nextPage;
+  };
+
+  struct ChannelRef {
+    std::string channelName;
+    agora::rtm::RTM_CHANNEL_TYPE channelType;
+  };
+  using Channels = std::vector<ChannelRef>;
+
+  template <typename Value>
+  using Callback = std::function<void(agora::rtm::RTM_ERROR_CODE errorCode, std::shared_ptr<const Value> value)>;
+
+  struct Options {
+    RtmClock::duration ttl = std::chrono::seconds(5);
+    /// Query results kept while a call is being issued, in case they are its answer.
+    size_t unclaimedCapacity = 64;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    /// Misses that joined a query already in flight.
+    uint64_t coalesced = 0;
+    uint64_t invalidations = 0;
+    uint64_t errors = 0;
+  };
+
+  explicit PresenceQueryCache(agora::rtm::IRtmPresence& presence);
+  PresenceQueryCache(agora::rtm::IRtmPresence& presence, Options options);
+
+  PresenceQueryCache(const PresenceQueryCache&) = delete;
+  PresenceQueryCache& operator=(const PresenceQueryCache&) = delete;
+
+  void getOnlineUsers(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                      const agora::rtm::GetOnlineUsersOptions& options, RtmClock::time_point now,
+                      Callback<OnlineUsers> callback);
+  void getUserChannels(std::string_view userId, RtmClock::time_point now, Callback<Channels> callback);
+  void getState(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType, std::string_view userId,
+                RtmClock::time_point now, Callback<UserStates> callback);
+
+  /// Drops every answer about the channel.
+  void invalidate(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType);
+  /// Drops expired answers; lookups skip them anyway.
+  size_t purge(RtmClock::time_point now);
+  /// Answers kept.
+  size_t size() const;
+  Stats stats() const;
+
+  void onPresenceEvent(const PresenceEvent& event) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserChannelsResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceGetStateResult(const uint64_t requestId, const agora::rtm::UserState& state,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceRemoveStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  enum class Kind : uint8_t { onlineUsers, userChannels, state };
+
+  template <typename Value>
+  struct Slot {
+    std::shared_ptr<const Value> value;
+    RtmClock::time_point expires;
+    bool inFlight = false;
+    /// Invalidated while in flight: the answer goes to the waiters only.
+    bool stale = false;
+    std::vector<Callback<Value>> waiters;
+  };
+
+  struct Flight {
+    Kind kind = Kind::onlineUsers;
+    std::string key;
+  };
+
+  /// A decoded result that arrived before its query's requestId was known.
+  struct Answer {
+    Kind kind = Kind::onlineUsers;
+    agora::rtm::RTM_ERROR_CODE errorCode = agora::rtm::RTM_ERROR_OK;
+    std::shared_ptr<const void> value;
+  };
+
+  enum class Claim : uint8_t {
+    mine,
+    /// No query waits for it yet, but one is being issued and may be its own.
+    early,
+    other,
+  };
+
+  /// Returns the hit in `hit`, or true when the caller must issue the query; otherwise `callback` waits for the
+  /// query in flight.
+  template <typename Value>
+  bool lookupLocked(StringMap<Slot<Value>>& slots, std::string key, RtmClock::time_point now,
+                    Callback<Value>& callback, std::shared_ptr<const Value>& hit);
+  /// Matches a result to its query by requestId.
+  Claim claim(uint64_t requestId, Kind kind, Flight& flight);
+  /// Keeps an early result until its call returns; true when its query was issued meanwhile and is in `flight`.
+  bool park(uint64_t requestId, Answer answer, Flight& flight);
+  template <typename Value>
+  void finish(StringMap<Slot<Value>>& slots, const std::string& key, agora::rtm::RTM_ERROR_CODE errorCode,
+              std::shared_ptr<const Value> value);
+  void finish(Kind kind, const std::string& key, agora::rtm::RTM_ERROR_CODE errorCode,
+              std::shared_ptr<const void> value);
+  /// Sends a query whose slot was just marked in flight.
+  void issue(Kind kind, const std::string& key, const std::function<void(uint64_t& requestId)>& send);
+
+  template <typename Value, typename Predicate>
+  void dropIfLocked(StringMap<Slot<Value>>& slots, Predicate predicate);
+  template <typename Value>
+  void dropLocked(StringMap<Slot<Value>>& slots, const std::string& key);
+  /// The channel's user lists; with `withStatesOnly`, only those that include states.
+  void dropListsLocked(const std::string& channelKey, bool withStatesOnly);
+  void dropMemberLocked(const std::string& channelKey, std::string_view userId);
+
+  agora::rtm::IRtmPresence& presence_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  StringMap<Slot<OnlineUsers>> onlineUsers_;
+  StringMap<Slot<Channels>> userChannels_;
+  StringMap<Slot<UserStates>> states_;
+  RequestIdTable<Flight> flights_;
+  UnclaimedResults<Answer> unclaimed_;
+  /// Calls in progress, whose requestIds are not known yet.
+  size_t calling_ = 0;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
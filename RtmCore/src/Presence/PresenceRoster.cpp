@@ -0,0 +1,180 @@
+//
+//  PresenceRoster.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Presence/PresenceRoster.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+PresenceRoster::PresenceRoster(std::string_view channelName, RTM_CHANNEL_TYPE channelType, UserIdTable& users)
+    : channelName_(channelName), channelType_(channelType), users_(users) {}
+
+bool PresenceRoster::synced() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return synced_;
+}
+
+size_t PresenceRoster::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return memberHandles_.size();
+}
+
+uint64_t PresenceRoster::version() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return version_;
+}
+
+bool PresenceRoster::contains(std::string_view userId) const { return contains(users_.find(userId)); }
+
+bool PresenceRoster::contains(UserHandle user) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return rowOf(user) != kAbsent;
+}
+
+bool PresenceRoster::states(std::string_view userId, States& states) const {
+  UserHandle user = users_.find(userId);
+  std::lock_guard<std::mutex> guard(mutex_);
+  uint32_t row = rowOf(user);
+  if (row == kAbsent) return false;
+  states = memberStates_[row];
+  return true;
+}
+
+std::vector<std::string> PresenceRoster::userIds() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<std::string> userIds;
+  userIds.reserve(memberHandles_.size());
+  for (UserHandle user : memberHandles_) userIds.emplace_back(users_.name(user));
+  return userIds;
+}
+
+std::vector<PresenceRoster::UserHandle> PresenceRoster::members() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return memberHandles_;
+}
+
+PresenceRoster::Stats PresenceRoster::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Events
+
+void PresenceRoster::onPresenceEvent(const PresenceEvent& event) {
+  if (event.channelType != channelType_ || viewOf(event.channelName) != channelName_) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  switch (event.type) {
+    case RTM_PRESENCE_EVENT_TYPE_SNAPSHOT: {
+      clear();
+      const PresenceEvent::SnapshotInfo& snapshot = event.snapshot;
+      memberHandles_.reserve(snapshot.userCount);
+      memberStates_.reserve(snapshot.userCount);
+      for (size_t i = 0; i < snapshot.userCount && snapshot.userStateList; ++i) {
+        const UserState& user = snapshot.userStateList[i];
+        setStates(viewOf(user.userId), user.states, user.statesCount);
+      }
+      synced_ = true;
+      ++stats_.snapshots;
+      break;
+    }
+    case RTM_PRESENCE_EVENT_TYPE_INTERVAL: {
+      const PresenceEvent::IntervalInfo& interval = event.interval;
+      for (size_t i = 0; i < interval.joinUserList.userCount; ++i) join(viewOf(interval.joinUserList.users[i]));
+      for (size_t i = 0; i < interval.leaveUserList.userCount; ++i) leave(viewOf(interval.leaveUserList.users[i]));
+      for (size_t i = 0; i < interval.timeoutUserList.userCount; ++i) {
+        leave(viewOf(interval.timeoutUserList.users[i]));
+      }
+      for (size_t i = 0; i < interval.userStateCount && interval.userStateList; ++i) {
+        const UserState& user = interval.userStateList[i];
+        setStates(viewOf(user.userId), user.states, user.statesCount);
+      }
+      stats_.joins += interval.joinUserList.userCount;
+      stats_.leaves += interval.leaveUserList.userCount;
+      stats_.timeouts += interval.timeoutUserList.userCount;
+      stats_.stateChanges += interval.userStateCount;
+      ++stats_.intervals;
+      break;
+    }
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL:
+      join(viewOf(event.publisher));
+      ++stats_.joins;
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL:
+      leave(viewOf(event.publisher));
+      ++stats_.leaves;
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_TIMEOUT:
+      leave(viewOf(event.publisher));
+      ++stats_.timeouts;
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED:
+      setStates(viewOf(event.publisher), event.stateItems, event.stateItemCount);
+      ++stats_.stateChanges;
+      break;
+    case RTM_PRESENCE_EVENT_TYPE_ERROR_OUT_OF_SERVICE:
+      synced_ = false;
+      break;
+    default:
+      return;
+  }
+  ++version_;
+}
+
+// MARK: - Private
+
+uint32_t PresenceRoster::rowOf(UserHandle user) const {
+  if (user == UserIdTable::kNoUser) return kAbsent;
+  const uint32_t* row = rows_.find(keyOf(user));
+  return row ? *row : kAbsent;
+}
+
+uint32_t PresenceRoster::join(std::string_view userId) {
+  UserHandle user = users_.intern(userId);
+  if (user == UserIdTable::kNoUser) return kAbsent;
+  uint32_t row = rowOf(user);
+  if (row != kAbsent) return row;
+  row = static_cast<uint32_t>(memberHandles_.size());
+  rows_.insert(keyOf(user), row);
+  memberHandles_.push_back(user);
+  memberStates_.emplace_back();
+  return row;
+}
+
+bool PresenceRoster::leave(std::string_view userId) {
+  UserHandle user = users_.find(userId);
+  uint32_t row = rowOf(user);
+  if (row == kAbsent) return false;
+  uint32_t last = static_cast<uint32_t>(memberHandles_.size() - 1);
+  if (row != last) {
+    memberHandles_[row] = memberHandles_[last];
+    memberStates_[row] = std::move(memberStates_[last]);
+    *rows_.find(keyOf(memberHandles_[row])) = row;
+  }
+  memberHandles_.pop_back();
+  memberStates_.pop_back();
+  rows_.erase(keyOf(user));
+  return true;
+}
+
+void PresenceRoster::setStates(std::string_view userId, const StateItem* items, size_t count) {
+  uint32_t row = join(userId);
+  if (row == kAbsent) return;
+  States& states = memberStates_[row];
+  states.clear();
+  for (size_t i = 0; i < count && items; ++i) states.emplace_back(viewOf(items[i].key), viewOf(items[i].value));
+}
+
+void PresenceRoster::clear() {
+  for (UserHandle user : memberHandles_) rows_.erase(keyOf(user));
+  memberHandles_.clear();
+  memberStates_.clear();
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,114 @@
+//
+//  PresenceRoster.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/UserIdTable.h"
+#include "IAgoraRtmClient.h"
+#include "Requests/RequestIdTable.h"
+
+namespace flat {
+namespace rtm {
+
+/// The members of one channel and their presence states, kept from `onPresenceEvent` so the member list never
+/// needs a `whoNow`/`getOnlineUsers` round trip.
+///
+/// A SNAPSHOT replaces the roster; INTERVAL, REMOTE_JOIN, REMOTE_LEAVE, REMOTE_TIMEOUT and REMOTE_STATE_CHANGED
+/// are applied in time proportional to the users they name. ERROR_OUT_OF_SERVICE marks the roster unsynced until
+/// the next snapshot.
+///
+/// User ids are interned in a `UserIdTable`, by default the shared one. Members live in parallel arrays (user
+/// handle, states) with a handle-to-row hash of the roster's own, so joins append, leaves swap the last row into
+/// the hole, walking the roster touches only the dense arrays, and memory follows the channel's members rather
+/// than every user the table has seen. Register the roster with the client's event handler and
+/// subscribe or join with `withPresence`. Reads and events may come from different threads.
+class PresenceRoster : public agora::rtm::IRtmEventHandler {
+ public:
+  using States = std::vector<std::pair<std::string, std::string>>;
+
+  struct Stats {
+    uint64_t snapshots = 0;
+    uint64_t intervals = 0;
+    uint64_t joins = 0;
+    uint64_t leaves = 0;
+    uint64_t timeouts = 0;
+    uint64_t stateChanges = 0;
+  };
+
+  using UserHandle = UserIdTable::UserHandle;
+
+  PresenceRoster(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                 UserIdTable& users = UserIdTable::shared());
+
+  PresenceRoster(const PresenceRoster&) = delete;
+  PresenceRoster& operator=(const PresenceRoster&) = delete;
+
+  const std::string& channelName() const { return channelName_; }
+  UserIdTable& users() const { return users_; }
+  agora::rtm::RTM_CHANNEL_TYPE channelType() const { return channelType_; }
+
+  /// Whether a snapshot has been applied since the roster was created or the service went away.
+  bool synced() const;
+  size_t size() const;
+  /// Bumped by every presence event applied, so views can skip redrawing when it has not moved.
+  uint64_t version() const;
+
+  bool contains(std::string_view userId) const;
+  bool contains(UserHandle user) const;
+  bool states(std::string_view userId, States& states) const;
+  std::vector<std::string> userIds() const;
+  /// Handles of the members, in no particular order.
+  std::vector<UserHandle> members() const;
+  /// Calls `visit(std::string_view userId, const States&)` for each member, with the roster locked.
+  template <typename Visit>
+  void forEach(Visit&& visit) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (size_t row = 0; row < memberHandles_.size(); ++row) {
+      visit(users_.name(memberHandles_[row]), memberStates_[row]);
+    }
+  }
+
+  Stats stats() const;
+
+  void onPresenceEvent(const PresenceEvent& event) override;
+
+ private:
+  static constexpr uint32_t kAbsent = UINT32_MAX;
+
+  /// `rows_` key of a handle: handles start at 0, which the table reserves.
+  static uint64_t keyOf(UserHandle user) { return static_cast<uint64_t>(user) + 1; }
+  /// The member's row, `kAbsent` when the user is not in the channel.
+  uint32_t rowOf(UserHandle user) const;
+  /// The member's row, adding it when absent; `kAbsent` for an empty id.
+  uint32_t join(std::string_view userId);
+  bool leave(std::string_view userId);
+  void setStates(std::string_view userId, const agora::rtm::StateItem* items, size_t count);
+  void clear();
+
+  const std::string channelName_;
+  const agora::rtm::RTM_CHANNEL_TYPE channelType_;
+  UserIdTable& users_;
+  mutable std::mutex mutex_;
+  /// Row of each member, by `keyOf` its handle.
+  RequestIdTable<uint32_t> rows_;
+  /// Members, one row per user.
+  std::vector<UserHandle> memberHandles_;
+  std::vector<States> memberStates_;
+  bool synced_ = false;
+  uint64_t version_ = 0;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
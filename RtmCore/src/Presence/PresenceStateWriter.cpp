@@ -0,0 +1,216 @@
+//
+//  PresenceStateWriter.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Presence/PresenceStateWriter.h"
+
+#include <algorithm>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+PresenceStateWriter::PresenceStateWriter(IRtmPresence& presence, std::string_view channelName,
+                                         RTM_CHANNEL_TYPE channelType)
+    : PresenceStateWriter(presence, channelName, channelType, Options()) {}
+
+PresenceStateWriter::PresenceStateWriter(IRtmPresence& presence, std::string_view channelName,
+                                         RTM_CHANNEL_TYPE channelType, Options options)
+    : presence_(presence),
+      channelName_(channelName),
+      channelType_(channelType),
+      options_(std::move(options)),
+      unclaimed_(options_.unclaimedCapacity) {
+  if (options_.maxDelay < options_.debounce) options_.maxDelay = options_.debounce;
+}
+
+RTM_ERROR_CODE PresenceStateWriter::set(std::string_view key, std::string_view value, RtmClock::time_point now) {
+  if (key.empty()) return RTM_ERROR_PRESENCE_INVALID_STATE_KEY;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const std::string* expected = expectedLocked(key);
+    auto found = pendingIndex_.find(key);
+    if (found != pendingIndex_.end()) {
+      ++stats_.changes;
+      ++stats_.coalesced;
+      if (expected && *expected == value) {
+        erasePendingLocked(found->second);
+      } else {
+        pending_[found->second].second.assign(value);
+        lastPending_ = now;
+      }
+      return RTM_ERROR_OK;
+    }
+    if (expected) {
+      if (*expected == value) {
+        ++stats_.changes;
+        ++stats_.unchanged;
+        return RTM_ERROR_OK;
+      }
+    } else {
+      // A key the service does not hold yet; the ones it holds or is about to hold count against the cap.
+      size_t keys = acked_.size();
+      for (const auto& item : sent_) keys += acked_.count(item.first) ? 0 : 1;
+      for (const auto& item : pending_) keys += expectedLocked(item.first) ? 0 : 1;
+      if (keys >= options_.maxKeys) return RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW;
+    }
+    ++stats_.changes;
+    if (pending_.empty()) firstPending_ = now;
+    lastPending_ = now;
+    pendingIndex_.emplace(std::string(key), pending_.size());
+    pending_.emplace_back(std::string(key), std::string(value));
+  }
+  poll(now);
+  return RTM_ERROR_OK;
+}
+
+size_t PresenceStateWriter::poll(RtmClock::time_point now) { return issue(now, false); }
+
+size_t PresenceStateWriter::flush() { return issue(RtmClock::time_point::max(), true); }
+
+RtmClock::time_point PresenceStateWriter::nextDeadline() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (inFlight_ || pending_.empty()) return RtmClock::time_point::max();
+  return std::min(lastPending_ + options_.debounce, firstPending_ + options_.maxDelay);
+}
+
+bool PresenceStateWriter::busy() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return inFlight_;
+}
+
+bool PresenceStateWriter::acknowledged(std::string_view key, std::string& value) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = acked_.find(key);
+  if (found == acked_.end()) return false;
+  value = found->second;
+  return true;
+}
+
+PresenceStateWriter::Stats PresenceStateWriter::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  stats.pending = pending_.size();
+  return stats;
+}
+
+void PresenceStateWriter::onPresenceSetStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  std::vector<std::string> keys;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!inFlight_) return;
+    if (inFlightRequestId_ == 0) {
+      // The call is still being made; this may be its result.
+      unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    if (inFlightRequestId_ != requestId) return;
+    keys = completeLocked(errorCode);
+  }
+  if (options_.onComplete) options_.onComplete(keys, errorCode);
+}
+
+void PresenceStateWriter::onSubscribeResult(const uint64_t, const char* channelName,
+                                            RTM_ERROR_CODE errorCode) {
+  forget(viewOf(channelName), RTM_CHANNEL_TYPE_MESSAGE, errorCode);
+}
+
+void PresenceStateWriter::onUnsubscribeResult(const uint64_t, const char* channelName,
+                                              RTM_ERROR_CODE errorCode) {
+  forget(viewOf(channelName), RTM_CHANNEL_TYPE_MESSAGE, errorCode);
+}
+
+void PresenceStateWriter::onJoinResult(const uint64_t, const char* channelName, const char*,
+                                       RTM_ERROR_CODE errorCode) {
+  forget(viewOf(channelName), RTM_CHANNEL_TYPE_STREAM, errorCode);
+}
+
+void PresenceStateWriter::onLeaveResult(const uint64_t, const char* channelName, const char*,
+                                        RTM_ERROR_CODE errorCode) {
+  forget(viewOf(channelName), RTM_CHANNEL_TYPE_STREAM, errorCode);
+}
+
+// MARK: - Private
+
+size_t PresenceStateWriter::issue(RtmClock::time_point now, bool force) {
+  std::vector<std::pair<std::string, std::string>> write;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (inFlight_ || pending_.empty()) return 0;
+    if (!force && now < std::min(lastPending_ + options_.debounce, firstPending_ + options_.maxDelay)) return 0;
+    write.swap(pending_);
+    pendingIndex_.clear();
+    sent_ = write;
+    inFlight_ = true;
+    inFlightRequestId_ = 0;
+    ++stats_.calls;
+    stats_.sentItems += write.size();
+  }
+
+  std::vector<StateItem> items(write.size());
+  for (size_t i = 0; i < write.size(); ++i) {
+    items[i].key = write[i].first.c_str();
+    items[i].value = write[i].second.c_str();
+  }
+  uint64_t requestId = 0;
+  presence_.setState(channelName_.c_str(), channelType_, items.data(), items.size(), requestId);
+  RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+  std::vector<std::string> keys;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+      inFlightRequestId_ = requestId;
+      return 1;
+    }
+    keys = completeLocked(errorCode);
+  }
+  if (options_.onComplete) options_.onComplete(keys, errorCode);
+  return requestId != 0 ? 1 : 0;
+}
+
+std::vector<std::string> PresenceStateWriter::completeLocked(RTM_ERROR_CODE errorCode) {
+  inFlight_ = false;
+  inFlightRequestId_ = 0;
+  std::vector<std::string> keys;
+  keys.reserve(sent_.size());
+  for (auto& item : sent_) {
+    if (errorCode == RTM_ERROR_OK) {
+      acked_.insert_or_assign(item.first, std::move(item.second));
+    } else {
+      // The service may or may not hold the value now.
+      acked_.erase(item.first);
+    }
+    keys.push_back(std::move(item.first));
+  }
+  sent_.clear();
+  if (errorCode != RTM_ERROR_OK) ++stats_.failed;
+  return keys;
+}
+
+void PresenceStateWriter::forget(std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                 RTM_ERROR_CODE errorCode) {
+  if (errorCode != RTM_ERROR_OK || channelType != channelType_ || channelName != channelName_) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  acked_.clear();
+}
+
+const std::string* PresenceStateWriter::expectedLocked(std::string_view key) const {
+  for (const auto& item : sent_) {
+    if (item.first == key) return &item.second;
+  }
+  auto found = acked_.find(key);
+  return found == acked_.end() ? nullptr : &found->second;
+}
+
+void PresenceStateWriter::erasePendingLocked(size_t index) {
+  pendingIndex_.erase(pending_[index].first);
+  pending_.erase(pending_.begin() + index);
+  for (size_t i = index; i < pending_.size(); ++i) pendingIndex_[pending_[i].first] = i;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,137 @@
+//
+//  PresenceStateWriter.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmPresence.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Debounces the local user's presence state changes in one channel into few `setState` calls.
+///
+/// `set` records a key's new value. Pending keys go out together once no change has arrived for
+/// `Options::debounce`, or `Options::maxDelay` after the first, carrying only the keys whose value differs
+/// from what the service was last acknowledged to hold. A change back to that value before the flush cancels the
+/// key, so a camera toggled off and on again sends nothing. One call is in flight at a time; changes made
+/// meanwhile wait for its result. A failed call is reported through `Options::onComplete` and its keys count as
+/// unacknowledged, so setting them again resends them.
+///
+/// `Stats` reports how many changes were asked for against the calls and items actually sent; `amplification` is
+/// items sent per change, well below 1 when toggles are merged or cancelled.
+///
+/// Register the writer with the client's event handler. Results are matched to the call by requestId; one that
+/// arrives while the call is still being made is kept until the call returns its id. The acknowledged state is
+/// forgotten when the local user subscribes, unsubscribes, joins or leaves the channel. SDK calls are made outside
+/// the writer's lock.
+class PresenceStateWriter : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Options {
+    /// Quiet time after the last change before pending keys are sent.
+    RtmClock::duration debounce = std::chrono::milliseconds(50);
+    /// Longest a change waits while others keep arriving.
+    RtmClock::duration maxDelay = std::chrono::milliseconds(250);
+    /// Distinct keys the writer accepts, as the service caps the states per user.
+    size_t maxKeys = 32;
+    /// `setState` results kept while the call is being made, in case one is its own.
+    size_t unclaimedCapacity = 16;
+    /// Called once per call with the keys it carried and its result.
+    std::function<void(const std::vector<std::string>& keys, agora::rtm::RTM_ERROR_CODE errorCode)> onComplete;
+  };
+
+  struct Stats {
+    uint64_t changes = 0;
+    /// Changes to the value the service already holds, or about to hold.
+    uint64_t unchanged = 0;
+    /// Changes that replaced a pending value or cancelled it.
+    uint64_t coalesced = 0;
+    uint64_t calls = 0;
+    uint64_t sentItems = 0;
+    uint64_t failed = 0;
+    size_t pending = 0;
+
+    double amplification() const { return changes ? static_cast<double>(sentItems) / changes : 0; }
+  };
+
+  PresenceStateWriter(agora::rtm::IRtmPresence& presence, std::string_view channelName,
+                      agora::rtm::RTM_CHANNEL_TYPE channelType);
+  PresenceStateWriter(agora::rtm::IRtmPresence& presence, std::string_view channelName,
+                      agora::rtm::RTM_CHANNEL_TYPE channelType, Options options);
+
+  PresenceStateWriter(const PresenceStateWriter&) = delete;
+  PresenceStateWriter& operator=(const PresenceStateWriter&) = delete;
+
+  /// Records `key = value`. `RTM_ERROR_PRESENCE_INVALID_STATE_KEY` for an empty key,
+  /// `RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW` for a new key beyond `Options::maxKeys`.
+  agora::rtm::RTM_ERROR_CODE set(std::string_view key, std::string_view value, RtmClock::time_point now);
+
+  /// Sends the pending keys once the debounce or the delay cap has passed. Returns the calls made, 0 or 1.
+  size_t poll(RtmClock::time_point now);
+  /// Sends the pending keys now, unless a call is in flight.
+  size_t flush();
+  /// When `poll` has work, or `time_point::max()` when nothing is pending or a call is in flight.
+  RtmClock::time_point nextDeadline() const;
+  bool busy() const;
+
+  /// The value the service acknowledged for `key`.
+  bool acknowledged(std::string_view key, std::string& value) const;
+  Stats stats() const;
+
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  size_t issue(RtmClock::time_point now, bool force);
+  /// Settles the call in flight; returns the keys it carried.
+  std::vector<std::string> completeLocked(agora::rtm::RTM_ERROR_CODE errorCode);
+  void forget(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+              agora::rtm::RTM_ERROR_CODE errorCode);
+  /// The value the key will hold once the call in flight lands, if the writer knows it.
+  const std::string* expectedLocked(std::string_view key) const;
+  void erasePendingLocked(size_t index);
+
+  agora::rtm::IRtmPresence& presence_;
+  const std::string channelName_;
+  const agora::rtm::RTM_CHANNEL_TYPE channelType_;
+  Options options_;
+  mutable std::mutex mutex_;
+  StringMap<std::string> acked_;
+  /// Pending keys in first-change order, and their positions in it.
+  std::vector<std::pair<std::string, std::string>> pending_;
+  StringMap<size_t> pendingIndex_;
+  RtmClock::time_point firstPending_;
+  RtmClock::time_point lastPending_;
+  bool inFlight_ = false;
+  /// 0 while the call is being made.
+  uint64_t inFlightRequestId_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  std::vector<std::pair<std::string, std::string>> sent_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
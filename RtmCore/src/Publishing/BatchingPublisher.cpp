@@ -0,0 +1,184 @@
+//
+//  BatchingPublisher.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/BatchingPublisher.h"
+
+#include <iterator>
+#include <utility>
+
+#include "Publishing/MessageBatch.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+BatchingPublisher::BatchingPublisher(IRtmClient& client) : BatchingPublisher(client, Options()) {}
+
+BatchingPublisher::BatchingPublisher(IRtmClient& client, Options options) : client_(client), options_(options) {}
+
+RTM_ERROR_CODE BatchingPublisher::publish(const char* channelName, const char* message, size_t length,
+                                          const PublishOptions& options, RtmClock::time_point now) {
+  if (!channelName || (!message && length > 0)) return RTM_ERROR_INVALID_PARAMETER;
+  std::string_view customType = viewOf(options.customType);
+  size_t frameSize = MessageBatch::frameSize(customType.size(), length);
+  auto entry = batchFor(channelName, options.channelType);
+  Batch& batch = entry->second;
+  ++stats_.messages;
+
+  if (MessageBatch::kHeaderSize + frameSize > options_.maxBatchBytes) {
+    if (batch.count > 0) close(batch);
+    release(entry);
+    Batch single;
+    single.channelName = channelName;
+    single.channelType = options.channelType;
+    single.count = 1;
+    single.firstType = options.messageType;
+    single.firstCustomType.assign(customType);
+    single.envelope.assign(message, length);
+    single.firstLength = length;
+    outgoing_.push_back(std::move(single));
+    ++stats_.oversized;
+    send();
+    return RTM_ERROR_OK;
+  }
+
+  // The full batch is sent once this message is in the next one: a publish re-entered from `send` may release
+  // the entry.
+  if (batch.count > 0 && batch.envelope.size() + frameSize > options_.maxBatchBytes) {
+    close(batch);
+    ++stats_.fullFlushes;
+  }
+  if (batch.count == 0) {
+    batch.opened = now;
+    batch.firstType = options.messageType;
+    batch.firstCustomType.assign(customType);
+    batch.firstLength = length;
+    MessageBatch::beginEnvelope(batch.envelope);
+  }
+  size_t offset = MessageBatch::appendFrame(batch.envelope, options.messageType, customType, message, length);
+  if (batch.count++ == 0) batch.firstOffset = offset;
+  if (options_.window.count() <= 0) {
+    close(batch);
+    release(entry);
+  }
+  if (!outgoing_.empty()) send();
+  return RTM_ERROR_OK;
+}
+
+size_t BatchingPublisher::poll(RtmClock::time_point now) {
+  for (auto entry = batches_.begin(); entry != batches_.end();) {
+    Batch& batch = entry->second;
+    if (batch.count > 0 && now - batch.opened < options_.window) {
+      ++entry;
+      continue;
+    }
+    if (batch.count > 0) close(batch);
+    entry = release(entry);
+  }
+  return send();
+}
+
+size_t BatchingPublisher::flush() {
+  for (auto entry = batches_.begin(); entry != batches_.end();) {
+    if (entry->second.count > 0) close(entry->second);
+    entry = release(entry);
+  }
+  return send();
+}
+
+RtmClock::time_point BatchingPublisher::nextDeadline() const {
+  RtmClock::time_point deadline = RtmClock::time_point::max();
+  for (const auto& [key, batch] : batches_) {
+    if (batch.count > 0 && batch.opened + options_.window < deadline) deadline = batch.opened + options_.window;
+  }
+  return deadline;
+}
+
+size_t BatchingPublisher::pendingMessages() const {
+  size_t pending = 0;
+  for (const auto& [key, batch] : batches_) pending += batch.count;
+  return pending;
+}
+
+// MARK: - Batches
+
+BatchingPublisher::Batches::iterator BatchingPublisher::batchFor(const char* channelName,
+                                                                 RTM_CHANNEL_TYPE channelType) {
+  key_.assign(channelName);
+  key_.push_back('\0');
+  key_.push_back(static_cast<char>('0' + channelType));
+  auto found = batches_.find(std::string_view(key_));
+  if (found != batches_.end()) return found;
+  if (spareBatches_.empty()) {
+    found = batches_.emplace(key_, Batch()).first;
+  } else {
+    Batches::node_type spare = std::move(spareBatches_.back());
+    spareBatches_.pop_back();
+    spare.key().assign(key_);
+    found = batches_.insert(std::move(spare)).position;
+  }
+  found->second.channelName.assign(channelName);
+  found->second.channelType = channelType;
+  return found;
+}
+
+void BatchingPublisher::close(Batch& batch) {
+  Batch closed;
+  closed.channelName = batch.channelName;
+  closed.channelType = batch.channelType;
+  closed.count = batch.count;
+  closed.firstType = batch.firstType;
+  closed.firstCustomType = batch.firstCustomType;
+  closed.firstOffset = batch.firstOffset;
+  closed.firstLength = batch.firstLength;
+  closed.envelope.swap(batch.envelope);
+  if (!spareEnvelopes_.empty()) {
+    batch.envelope.swap(spareEnvelopes_.back());
+    spareEnvelopes_.pop_back();
+  }
+  batch.count = 0;
+  outgoing_.push_back(std::move(closed));
+}
+
+BatchingPublisher::Batches::iterator BatchingPublisher::release(Batches::iterator entry) {
+  auto next = std::next(entry);
+  spareBatches_.push_back(batches_.extract(entry));
+  return next;
+}
+
+size_t BatchingPublisher::send() {
+  // Publishing can re-enter `publish` from a synchronous event handler; work from a detached list.
+  std::vector<Batch> outgoing;
+  outgoing.swap(outgoing_);
+  for (Batch& batch : outgoing) {
+    PublishOptions options;
+    options.channelType = batch.channelType;
+    uint64_t requestId = 0;
+    if (batch.count == 1) {
+      options.messageType = batch.firstType;
+      options.customType = batch.firstCustomType.empty() ? nullptr : batch.firstCustomType.c_str();
+      client_.publish(batch.channelName.c_str(), batch.envelope.data() + batch.firstOffset, batch.firstLength,
+                      options, requestId);
+    } else {
+      options.messageType = RTM_MESSAGE_TYPE_BINARY;
+      options.customType = MessageBatch::kCustomType;
+      client_.publish(batch.channelName.c_str(), batch.envelope.data(), batch.envelope.size(), options, requestId);
+      ++stats_.envelopes;
+    }
+    ++stats_.publishes;
+    batch.envelope.clear();
+    spareEnvelopes_.push_back(std::move(batch.envelope));
+  }
+  size_t sent = outgoing.size();
+  outgoing.clear();
+  if (outgoing_.empty()) outgoing_.swap(outgoing);
+  return sent;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,111 @@
+//
+//  BatchingPublisher.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Coalesces small `IRtmClient::publish` calls to the same channel into one `MessageBatch` envelope.
+///
+/// A batch opens with its first message and is published when its window ends (`poll`), when the next
+/// message would push it past `maxBatchBytes`, or on `flush`. A batch that still holds a single message is
+/// published as that plain message, so peers without a `DebatchingEventHandler` only miss out on multi-message
+/// batches. Messages too large for any batch flush their channel's batch and go out on their own, keeping
+/// per-channel order. User and message channels of the same name batch separately. Only channels with an open
+/// batch have an entry: a published batch gives its entry back to a spare list, so a session that moves through
+/// many rooms holds entries for the ones it is sending to, not for every one it ever sent to.
+///
+/// Publish results arrive at the client's event handler, one per envelope. Not thread-safe: call from the
+/// thread that owns the send path.
+class BatchingPublisher {
+ public:
+  struct Options {
+    std::chrono::milliseconds window{5};
+    /// Envelope limit, below the SDK's 32 KB message limit.
+    size_t maxBatchBytes = 16 * 1024;
+  };
+
+  struct Stats {
+    uint64_t messages = 0;
+    /// `IRtmClient::publish` calls made, envelopes and plain messages together.
+    uint64_t publishes = 0;
+    uint64_t envelopes = 0;
+    /// Batches published early because the next message did not fit.
+    uint64_t fullFlushes = 0;
+    /// Messages published alone because they exceed `maxBatchBytes`.
+    uint64_t oversized = 0;
+  };
+
+  BatchingPublisher(agora::rtm::IRtmClient& client, Options options);
+  explicit BatchingPublisher(agora::rtm::IRtmClient& client);
+
+  BatchingPublisher(const BatchingPublisher&) = delete;
+  BatchingPublisher& operator=(const BatchingPublisher&) = delete;
+
+  /// Queues a message. `options.customType` and `options.messageType` travel with it; the payload is copied.
+  agora::rtm::RTM_ERROR_CODE publish(const char* channelName, const char* message, size_t length,
+                                     const agora::rtm::PublishOptions& options, RtmClock::time_point now);
+  /// Publishes every batch whose window has ended. Returns the number of publishes made.
+  size_t poll(RtmClock::time_point now);
+  /// Publishes every open batch.
+  size_t flush();
+  /// When the oldest open batch is due, or `time_point::max()` when nothing is pending.
+  RtmClock::time_point nextDeadline() const;
+
+  size_t pendingMessages() const;
+  /// Channels with an open batch.
+  size_t openBatches() const { return batches_.size(); }
+  Stats stats() const { return stats_; }
+
+ private:
+  struct Batch {
+    std::string channelName;
+    agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_MESSAGE;
+    std::string envelope;
+    size_t count = 0;
+    RtmClock::time_point opened;
+    /// The first message, published without an envelope if the batch ends up holding only it.
+    agora::rtm::RTM_MESSAGE_TYPE firstType = agora::rtm::RTM_MESSAGE_TYPE_BINARY;
+    std::string firstCustomType;
+    size_t firstOffset = 0;
+    size_t firstLength = 0;
+  };
+
+  using Batches = StringMap<Batch>;
+
+  /// The channel's entry, opening one, from the spares when there are any, if it has none.
+  Batches::iterator batchFor(const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType);
+  /// Moves the batch's contents into `outgoing_`, leaving it empty.
+  void close(Batch& batch);
+  /// Moves an emptied entry to the spares; returns the entry after it.
+  Batches::iterator release(Batches::iterator entry);
+  size_t send();
+
+  agora::rtm::IRtmClient& client_;
+  Options options_;
+  /// Keyed by channel name, a NUL and the channel type.
+  Batches batches_;
+  /// Released entries, reused with their key and envelope buffers.
+  std::vector<Batches::node_type> spareBatches_;
+  std::string key_;
+  std::vector<Batch> outgoing_;
+  std::vector<std::string> spareEnvelopes_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
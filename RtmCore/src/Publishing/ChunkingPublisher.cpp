@@ -0,0 +1,247 @@
+//
+//  ChunkingPublisher.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/ChunkingPublisher.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include "Common/StringMap.h"
+#include "Publishing/MessageChunk.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+ChunkingPublisher::ChunkingPublisher(IRtmClient& client, RtmRateGovernor& governor)
+    : ChunkingPublisher(client, governor, Options()) {}
+
+ChunkingPublisher::ChunkingPublisher(IRtmClient& client, RtmRateGovernor& governor, Options options)
+    : client_(client),
+      governor_(governor),
+      options_(std::move(options)),
+      unclaimed_(options_.unclaimedCapacity) {
+  if (options_.maxFragmentsInFlight == 0) options_.maxFragmentsInFlight = 1;
+  // Ids only have to differ between the transfers of one publisher that a receiver holds at once; a random start
+  // keeps a restarted client from reusing the ids of its previous session.
+  nextTransferId_ = std::random_device()();
+}
+
+RTM_ERROR_CODE ChunkingPublisher::publish(const char* channelName, const char* message, size_t length,
+                                          const PublishOptions& options, uint64_t& requestId) {
+  if (length <= options_.maxMessageLength) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      ++stats_.messages;
+    }
+    client_.publish(channelName, message, length, options, requestId);
+    return sent(requestId);
+  }
+  Fragment destination;
+  destination.target = viewOf(channelName);
+  destination.channelType = options.channelType;
+  return split(destination, options.messageType, options.customType, message, length, requestId);
+}
+
+RTM_ERROR_CODE ChunkingPublisher::publishTopicMessage(IStreamChannel& channel, const char* topic,
+                                                      const char* message, size_t length,
+                                                      const TopicMessageOptions& options, uint64_t& requestId) {
+  if (length <= options_.maxMessageLength) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      ++stats_.messages;
+    }
+    channel.publishTopicMessage(topic, message, length, options, requestId);
+    return sent(requestId);
+  }
+  Fragment destination;
+  destination.channel = &channel;
+  destination.target = viewOf(topic);
+  destination.channelType = RTM_CHANNEL_TYPE_STREAM;
+  destination.sendTs = options.sendTs;
+  return split(destination, options.messageType, options.customType, message, length, requestId);
+}
+
+void ChunkingPublisher::onFragmentComplete(RtmRateGovernor::Ticket ticket, RTM_ERROR_CODE errorCode) {
+  std::vector<Completion> completions;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Fragment fragment;
+    if (!inFlight_.take(ticket, fragment)) {
+      // A fragment is still being submitted; this may be its ticket.
+      if (submitting_) unclaimed_.keep(ticket, errorCode);
+      return;
+    }
+    settleLocked(std::move(fragment), errorCode, completions);
+  }
+  notify(completions);
+  dispatch();
+}
+
+ChunkingPublisher::Stats ChunkingPublisher::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Private
+
+RTM_ERROR_CODE ChunkingPublisher::sent(uint64_t requestId) {
+  return requestId == 0 ? RTM_ERROR_NOT_INITIALIZED : RTM_ERROR_OK;
+}
+
+RTM_ERROR_CODE ChunkingPublisher::split(const Fragment& destination, RTM_MESSAGE_TYPE messageType,
+                                        const char* customType, const char* message, size_t length,
+                                        uint64_t& requestId) {
+  requestId = 0;
+  MessageChunk::Header header;
+  header.messageType = messageType;
+  header.customType = viewOf(customType);
+  size_t headerSize = MessageChunk::maxHeaderSize(header.customType.size());
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++stats_.messages;
+    if (!message || options_.maxMessageLength <= headerSize) {
+      ++stats_.rejected;
+      return RTM_ERROR_CHANNEL_INVALID_MESSAGE;
+    }
+    size_t maxSlice = options_.maxMessageLength - headerSize;
+    header.count = (length + maxSlice - 1) / maxSlice;
+    if (stats_.queuedBytes + length + header.count * headerSize > options_.maxQueuedBytes) {
+      ++stats_.rejected;
+      return RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION;
+    }
+    header.transferId = nextTransferId_++;
+    header.length = length;
+    // Slices as even as the count allows; with `count` rounded up from `maxSlice`, none of them is empty.
+    uint64_t sliceLength = MessageChunk::sliceLength(length, header.count);
+    for (header.index = 0; header.index < header.count; ++header.index) {
+      size_t offset = header.index * sliceLength;
+      size_t slice = std::min<size_t>(sliceLength, length - offset);
+      Fragment& fragment = queue_.emplace_back(destination);
+      fragment.transfer = header.transferId;
+      fragment.payload.reserve(headerSize + slice);
+      MessageChunk::appendHeader(fragment.payload, header);
+      fragment.payload.append(message + offset, slice);
+      stats_.queuedBytes += fragment.payload.size();
+    }
+    stats_.queuedFragments += header.count;
+    ++stats_.transfers;
+    remaining_.emplace(header.transferId, header.count);
+    requestId = header.transferId;
+  }
+  dispatch();
+  return RTM_ERROR_OK;
+}
+
+void ChunkingPublisher::dispatch() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (dispatching_) return;
+    dispatching_ = true;
+  }
+  std::vector<Completion> completions;
+  for (;;) {
+    Fragment fragment;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (queue_.empty() || inFlight_.size() >= options_.maxFragmentsInFlight) {
+        dispatching_ = false;
+        break;
+      }
+      fragment = std::move(queue_.front());
+      queue_.pop_front();
+      submitting_ = true;
+      ++stats_.fragmentsSent;
+    }
+    RtmRateGovernor::Ticket ticket = submit(fragment);
+    std::lock_guard<std::mutex> guard(mutex_);
+    submitting_ = false;
+    RTM_ERROR_CODE early;
+    if (ticket == 0) {
+      // The governor's queue is full.
+      settleLocked(std::move(fragment), RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION, completions);
+    } else if (unclaimed_.take(ticket, early)) {
+      settleLocked(std::move(fragment), early, completions);
+    } else {
+      inFlight_.insert(ticket, std::move(fragment));
+    }
+  }
+  notify(completions);
+}
+
+RtmRateGovernor::Ticket ChunkingPublisher::submit(const Fragment& fragment) {
+  // The governor refills its buckets on its own `poll`; submitting only spends the tokens already there.
+  RtmClock::time_point now = RtmClock::time_point::min();
+  if (fragment.channel) {
+    TopicMessageOptions options;
+    options.messageType = RTM_MESSAGE_TYPE_BINARY;
+    options.customType = MessageChunk::kCustomType;
+    options.sendTs = fragment.sendTs;
+    return governor_.publishTopicMessage(*fragment.channel, fragment.target.c_str(), fragment.payload.data(),
+                                         fragment.payload.size(), options, options_.priority, now);
+  }
+  PublishOptions options;
+  options.channelType = fragment.channelType;
+  options.messageType = RTM_MESSAGE_TYPE_BINARY;
+  options.customType = MessageChunk::kCustomType;
+  return governor_.publish(fragment.target.c_str(), fragment.payload.data(), fragment.payload.size(), options,
+                           options_.priority, now);
+}
+
+void ChunkingPublisher::settleLocked(Fragment fragment, RTM_ERROR_CODE errorCode,
+                                     std::vector<Completion>& completions) {
+  auto transfer = remaining_.find(fragment.transfer);
+  if (transfer == remaining_.end()) {
+    // Its transfer was aborted while it was out.
+    forgetLocked(fragment);
+    return;
+  }
+  if (errorCode == RTM_ERROR_OK) {
+    forgetLocked(fragment);
+    if (--transfer->second == 0) {
+      remaining_.erase(transfer);
+      completions.push_back({fragment.transfer, RTM_ERROR_OK});
+    }
+    return;
+  }
+  if (fragment.retries < options_.maxFragmentRetries) {
+    ++fragment.retries;
+    ++stats_.retries;
+    queue_.push_front(std::move(fragment));
+    return;
+  }
+  forgetLocked(fragment);
+  abortLocked(fragment.transfer, errorCode, completions);
+}
+
+void ChunkingPublisher::abortLocked(TransferId transfer, RTM_ERROR_CODE errorCode,
+                                    std::vector<Completion>& completions) {
+  remaining_.erase(transfer);
+  auto aborted = std::remove_if(queue_.begin(), queue_.end(), [&](const Fragment& fragment) {
+    if (fragment.transfer != transfer) return false;
+    forgetLocked(fragment);
+    return true;
+  });
+  queue_.erase(aborted, queue_.end());
+  ++stats_.aborted;
+  completions.push_back({transfer, errorCode});
+}
+
+void ChunkingPublisher::forgetLocked(const Fragment& fragment) {
+  --stats_.queuedFragments;
+  stats_.queuedBytes -= fragment.payload.size();
+}
+
+void ChunkingPublisher::notify(const std::vector<Completion>& completions) const {
+  if (!options_.onComplete) return;
+  for (const Completion& completion : completions) options_.onComplete(completion.transfer, completion.errorCode);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,147 @@
+//
+//  ChunkingPublisher.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Publishing/RtmRateGovernor.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Splits messages over the SDK's message limit into `MessageChunk` fragments for `IRtmClient::publish` and
+/// `IStreamChannel::publishTopicMessage`, so room snapshots and roster exports stay on RTM instead of failing
+/// with `RTM_ERROR_CHANNEL_MESSAGE_LENGTH_EXCEED_LIMITATION`.
+///
+/// Messages that fit go out at once and as they are; they may overtake the fragments of a larger message still
+/// queued. Fragments go through an `RtmRateGovernor` at `Options::priority`, so they share its buckets and its
+/// backoff with everything else the client sends; at most `maxFragmentsInFlight` of them are in the governor's
+/// hands at a time, the rest wait here. A fragment that fails is sent again up to `maxFragmentRetries` times,
+/// after the governor's own retries of rate-limit errors; past that the transfer is aborted, its queued
+/// fragments are dropped and `Options::onComplete` reports the error. A `ReassemblingEventHandler` on the
+/// receiving side puts the message back together, and lets an aborted transfer time out.
+///
+/// Forward the governor's `Options::onComplete` to `onFragmentComplete`. Publishing and completions may come from
+/// different threads; SDK and governor calls are made outside the publisher's lock.
+class ChunkingPublisher {
+ public:
+  using TransferId = uint64_t;
+
+  struct Options {
+    /// Largest payload of one publish: larger messages are split into fragments of at most this size.
+    size_t maxMessageLength = 32 * 1024;
+    /// Fragments submitted to the governor and not yet completed, across transfers.
+    size_t maxFragmentsInFlight = 8;
+    uint32_t maxFragmentRetries = 2;
+    agora::rtm::RTM_MESSAGE_PRIORITY priority = agora::rtm::RTM_MESSAGE_PRIORITY_LOW;
+    /// Bytes of fragments not yet published; a message that would exceed it is refused.
+    size_t maxQueuedBytes = 4 * 1024 * 1024;
+    /// Governor completions kept while a fragment is being submitted, in case one is its own.
+    size_t unclaimedCapacity = 64;
+    /// Runs once per split message: `RTM_ERROR_OK` when every fragment was published, or the error that aborted
+    /// the transfer.
+    std::function<void(TransferId transfer, agora::rtm::RTM_ERROR_CODE errorCode)> onComplete;
+  };
+
+  struct Stats {
+    uint64_t messages = 0;
+    /// Messages split into fragments.
+    uint64_t transfers = 0;
+    /// Fragments submitted to the governor, retries included.
+    uint64_t fragmentsSent = 0;
+    uint64_t retries = 0;
+    uint64_t aborted = 0;
+    uint64_t rejected = 0;
+    /// Fragments, and their bytes, not yet published.
+    size_t queuedFragments = 0;
+    size_t queuedBytes = 0;
+  };
+
+  ChunkingPublisher(agora::rtm::IRtmClient& client, RtmRateGovernor& governor);
+  ChunkingPublisher(agora::rtm::IRtmClient& client, RtmRateGovernor& governor, Options options);
+
+  ChunkingPublisher(const ChunkingPublisher&) = delete;
+  ChunkingPublisher& operator=(const ChunkingPublisher&) = delete;
+
+  /// A message that fits is published as it is: `requestId` is the SDK's, and the result arrives at the client's
+  /// event handler. A larger one is split: `requestId` is its `TransferId`, and the result goes to
+  /// `Options::onComplete`. Returns the error that kept the message from going out: `RTM_ERROR_NOT_INITIALIZED`
+  /// when the SDK gave no requestId, `RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION` when the fragments would
+  /// overflow `maxQueuedBytes`.
+  agora::rtm::RTM_ERROR_CODE publish(const char* channelName, const char* message, size_t length,
+                                     const agora::rtm::PublishOptions& options, uint64_t& requestId);
+  /// `channel` must outlive the fragments queued for it.
+  agora::rtm::RTM_ERROR_CODE publishTopicMessage(agora::rtm::IStreamChannel& channel, const char* topic,
+                                                 const char* message, size_t length,
+                                                 const agora::rtm::TopicMessageOptions& options, uint64_t& requestId);
+
+  /// The governor's completion of `ticket`; tickets that are not this publisher's fragments are ignored.
+  void onFragmentComplete(RtmRateGovernor::Ticket ticket, agora::rtm::RTM_ERROR_CODE errorCode);
+
+  Stats stats() const;
+
+ private:
+  /// A fragment and where it goes: a topic of `channel`, or the channel `target` of the client.
+  struct Fragment {
+    TransferId transfer = 0;
+    agora::rtm::IStreamChannel* channel = nullptr;
+    std::string target;
+    agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_MESSAGE;
+    uint64_t sendTs = 0;
+    uint32_t retries = 0;
+    std::string payload;
+  };
+
+  struct Completion {
+    TransferId transfer;
+    agora::rtm::RTM_ERROR_CODE errorCode;
+  };
+
+  static agora::rtm::RTM_ERROR_CODE sent(uint64_t requestId);
+  /// Queues the fragments of the message, all addressed like `destination`.
+  agora::rtm::RTM_ERROR_CODE split(const Fragment& destination, agora::rtm::RTM_MESSAGE_TYPE messageType,
+                                   const char* customType, const char* message, size_t length, uint64_t& requestId);
+  /// Hands queued fragments to the governor while fewer than `maxFragmentsInFlight` are in its hands.
+  void dispatch();
+  RtmRateGovernor::Ticket submit(const Fragment& fragment);
+  /// The fragment's outcome: done, queued again, or the end of its transfer.
+  void settleLocked(Fragment fragment, agora::rtm::RTM_ERROR_CODE errorCode, std::vector<Completion>& completions);
+  void abortLocked(TransferId transfer, agora::rtm::RTM_ERROR_CODE errorCode, std::vector<Completion>& completions);
+  void forgetLocked(const Fragment& fragment);
+  void notify(const std::vector<Completion>& completions) const;
+
+  agora::rtm::IRtmClient& client_;
+  RtmRateGovernor& governor_;
+  Options options_;
+
+  mutable std::mutex mutex_;
+  std::deque<Fragment> queue_;
+  /// Governor ticket -> the fragment it carries.
+  RequestIdTable<Fragment> inFlight_;
+  /// Fragments of each transfer still to be published.
+  std::unordered_map<TransferId, size_t> remaining_;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  TransferId nextTransferId_;
+  /// Set while `dispatch` runs, so completions it causes leave the next fragments to it.
+  bool dispatching_ = false;
+  bool submitting_ = false;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,77 @@
+//
+//  CompressingPublisher.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/CompressingPublisher.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+CompressingPublisher::CompressingPublisher(IRtmClient& client, Options options)
+    : client_(client), options_(options), deflater_(options.level) {}
+
+CompressingPublisher::CompressingPublisher(IRtmClient& client) : CompressingPublisher(client, Options()) {}
+
+void CompressingPublisher::enable(const char* channelName) { channels_.emplace(viewOf(channelName)); }
+
+void CompressingPublisher::disable(const char* channelName) {
+  auto found = channels_.find(viewOf(channelName));
+  if (found != channels_.end()) channels_.erase(found);
+}
+
+bool CompressingPublisher::enabled(const char* channelName) const {
+  return channels_.find(viewOf(channelName)) != channels_.end();
+}
+
+void CompressingPublisher::publish(const char* channelName, const char* message, size_t length,
+                                   const PublishOptions& options, uint64_t& requestId) {
+  if (!compress(channelName, options.messageType, options.customType, message, length)) {
+    client_.publish(channelName, message, length, options, requestId);
+    return;
+  }
+  PublishOptions compressed = options;
+  compressed.messageType = RTM_MESSAGE_TYPE_BINARY;
+  compressed.customType = PayloadCompression::kCustomType;
+  client_.publish(channelName, frame_.data(), frame_.size(), compressed, requestId);
+}
+
+void CompressingPublisher::publishTopicMessage(IStreamChannel& channel, const char* topic, const char* message,
+                                               size_t length, const TopicMessageOptions& options,
+                                               uint64_t& requestId) {
+  if (!compress(channel.getChannelName(), options.messageType, options.customType, message, length)) {
+    channel.publishTopicMessage(topic, message, length, options, requestId);
+    return;
+  }
+  TopicMessageOptions compressed = options;
+  compressed.messageType = RTM_MESSAGE_TYPE_BINARY;
+  compressed.customType = PayloadCompression::kCustomType;
+  channel.publishTopicMessage(topic, frame_.data(), frame_.size(), compressed, requestId);
+}
+
+// MARK: - Private
+
+bool CompressingPublisher::compress(const char* channelName, RTM_MESSAGE_TYPE messageType, const char* customType,
+                                    const char* message, size_t length) {
+  ++stats_.messages;
+  stats_.bytesIn += length;
+  if (!enabled(channelName)) {
+    stats_.bytesOut += length;
+    return false;
+  }
+  if (length < options_.minLength || !deflater_.deflate(messageType, viewOf(customType), message, length, frame_)) {
+    ++stats_.uncompressed;
+    stats_.bytesOut += length;
+    return false;
+  }
+  ++stats_.compressed;
+  stats_.bytesOut += frame_.size();
+  return true;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,83 @@
+//
+//  CompressingPublisher.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Publishing/PayloadCompression.h"
+
+namespace flat {
+namespace rtm {
+
+/// Deflates large messages on their way to `IRtmClient::publish` and `IStreamChannel::publishTopicMessage`.
+///
+/// Compression is negotiated per channel: a channel is only compressed once `enable` is called for it, which the
+/// app does when every member has advertised that it reads `PayloadCompression::kCustomType` (a
+/// `DecompressingEventHandler` in its handler chain). Until then, and for messages below `minLength` or that do
+/// not shrink, messages go out exactly as given, so older clients see no difference.
+///
+/// Publish results arrive at the client's event handler as usual. Not thread-safe: call from the thread that owns
+/// the send path.
+class CompressingPublisher {
+ public:
+  struct Options {
+    /// Smaller messages are sent as they are: deflate rarely saves enough on them to pay for the frame.
+    size_t minLength = 128;
+    /// zlib's level, 1 (fastest) to 9 (smallest).
+    int level = 6;
+  };
+
+  struct Stats {
+    uint64_t messages = 0;
+    uint64_t compressed = 0;
+    /// Messages on enabled channels sent as they are, because they were short or did not shrink.
+    uint64_t uncompressed = 0;
+    /// Payload bytes of every message before and after compression.
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+
+    uint64_t bytesSaved() const { return bytesIn - bytesOut; }
+  };
+
+  CompressingPublisher(agora::rtm::IRtmClient& client, Options options);
+  explicit CompressingPublisher(agora::rtm::IRtmClient& client);
+
+  CompressingPublisher(const CompressingPublisher&) = delete;
+  CompressingPublisher& operator=(const CompressingPublisher&) = delete;
+
+  /// Starts compressing messages to `channelName`, on message, user and stream channels of that name.
+  void enable(const char* channelName);
+  void disable(const char* channelName);
+  bool enabled(const char* channelName) const;
+
+  void publish(const char* channelName, const char* message, size_t length,
+               const agora::rtm::PublishOptions& options, uint64_t& requestId);
+  void publishTopicMessage(agora::rtm::IStreamChannel& channel, const char* topic, const char* message,
+                           size_t length, const agora::rtm::TopicMessageOptions& options, uint64_t& requestId);
+
+  Stats stats() const { return stats_; }
+
+ private:
+  /// Deflates into `frame_` when the message is worth it; false to send it as it is.
+  bool compress(const char* channelName, agora::rtm::RTM_MESSAGE_TYPE messageType, const char* customType,
+                const char* message, size_t length);
+
+  agora::rtm::IRtmClient& client_;
+  Options options_;
+  PayloadDeflater deflater_;
+  StringSet channels_;
+  std::string frame_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
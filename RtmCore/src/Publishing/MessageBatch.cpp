@@ -0,0 +1,84 @@
+//
+//  MessageBatch.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/MessageBatch.h"
+
+#include "Common/StringMap.h"
+#include "Common/Varint.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+size_t MessageBatch::frameSize(size_t customTypeLength, size_t length) {
+  return 1 + varintLength(customTypeLength) + customTypeLength + varintLength(length) + length;
+}
+
+void MessageBatch::beginEnvelope(std::string& envelope) {
+  envelope.clear();
+  envelope.push_back(static_cast<char>(kVersion));
+}
+
+size_t MessageBatch::appendFrame(std::string& envelope, RTM_MESSAGE_TYPE messageType, std::string_view customType,
+                                 const char* message, size_t length) {
+  envelope.push_back(static_cast<char>(messageType));
+  appendVarint(envelope, customType.size());
+  envelope.append(customType);
+  appendVarint(envelope, length);
+  size_t offset = envelope.size();
+  envelope.append(message, length);
+  return offset;
+}
+
+bool MessageBatch::isEnvelope(const IRtmEventHandler::MessageEvent& event) {
+  return event.messageType == RTM_MESSAGE_TYPE_BINARY && viewOf(event.customType) == kCustomType;
+}
+
+// MARK: - MessageBatchReader
+
+MessageBatchReader::MessageBatchReader(const IRtmEventHandler::MessageEvent& envelope)
+    : envelope_(envelope), cursor_(envelope.message), end_(envelope.message + envelope.messageLength) {
+  if (envelope.messageLength < MessageBatch::kHeaderSize ||
+      static_cast<uint8_t>(*cursor_) != MessageBatch::kVersion) {
+    malformed_ = true;
+    cursor_ = end_;
+    return;
+  }
+  cursor_ += MessageBatch::kHeaderSize;
+}
+
+bool MessageBatchReader::next(IRtmEventHandler::MessageEvent& message) {
+  if (cursor_ == end_ || malformed_) return false;
+  auto messageType = static_cast<RTM_MESSAGE_TYPE>(static_cast<uint8_t>(*cursor_++));
+  uint64_t customTypeLength = 0;
+  uint64_t length = 0;
+  if (messageType != RTM_MESSAGE_TYPE_BINARY && messageType != RTM_MESSAGE_TYPE_STRING) {
+    malformed_ = true;
+    return false;
+  }
+  if (!readVarint(cursor_, end_, customTypeLength) || customTypeLength > static_cast<uint64_t>(end_ - cursor_)) {
+    malformed_ = true;
+    return false;
+  }
+  customType_.assign(cursor_, customTypeLength);
+  cursor_ += customTypeLength;
+  if (!readVarint(cursor_, end_, length) || length > static_cast<uint64_t>(end_ - cursor_)) {
+    malformed_ = true;
+    return false;
+  }
+  message = envelope_;
+  message.messageType = messageType;
+  message.message = cursor_;
+  message.messageLength = length;
+  message.customType = customType_.empty() ? nullptr : customType_.c_str();
+  cursor_ += length;
+  return true;
+}
+
+}  // namespace rtm
+}  // namespace flat
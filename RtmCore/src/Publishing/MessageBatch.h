@@ -0,0 +1,59 @@
+//
+//  MessageBatch.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Envelope that carries several messages in one publish.
+///
+/// The envelope is published as a binary message with customType `kCustomType`. Its payload is a version
+/// byte followed by one frame per message: `[messageType u8][varint customType length][customType]
+/// [varint payload length][payload]`.
+struct MessageBatch {
+  static constexpr const char* kCustomType = "flat.batch";
+  static constexpr uint8_t kVersion = 1;
+
+  /// Envelope bytes before the first frame.
+  static constexpr size_t kHeaderSize = 1;
+
+  static size_t frameSize(size_t customTypeLength, size_t length);
+  static void beginEnvelope(std::string& envelope);
+  /// Returns the offset of the payload inside `envelope`.
+  static size_t appendFrame(std::string& envelope, agora::rtm::RTM_MESSAGE_TYPE messageType,
+                            std::string_view customType, const char* message, size_t length);
+  static bool isEnvelope(const agora::rtm::IRtmEventHandler::MessageEvent& event);
+};
+
+/// Walks the frames of an envelope. `next` fills a `MessageEvent` that borrows the envelope's channel,
+/// publisher and payload bytes, and this reader's copy of the frame's customType.
+class MessageBatchReader {
+ public:
+  explicit MessageBatchReader(const agora::rtm::IRtmEventHandler::MessageEvent& envelope);
+
+  /// False at the end of the envelope or on a malformed frame; `malformed()` tells them apart.
+  bool next(agora::rtm::IRtmEventHandler::MessageEvent& message);
+  bool malformed() const { return malformed_; }
+
+ private:
+  const agora::rtm::IRtmEventHandler::MessageEvent& envelope_;
+  const char* cursor_;
+  const char* end_;
+  std::string customType_;
+  bool malformed_ = false;
+};
+
+}  // namespace rtm
+}  // namespace flat
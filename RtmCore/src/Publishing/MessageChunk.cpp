@@ -0,0 +1,69 @@
+//
+//  MessageChunk.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/MessageChunk.h"
+
+#include <algorithm>
+
+#include "Common/StringMap.h"
+#include "Common/Varint.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+size_t MessageChunk::maxHeaderSize(size_t customTypeLength) {
+  return 2 + varintLength(customTypeLength) + customTypeLength + 4 * kMaxVarintLength;
+}
+
+void MessageChunk::appendHeader(std::string& out, const Header& header) {
+  out.push_back(static_cast<char>(kVersion));
+  out.push_back(static_cast<char>(header.messageType));
+  appendVarint(out, header.customType.size());
+  out.append(header.customType);
+  appendVarint(out, header.transferId);
+  appendVarint(out, header.index);
+  appendVarint(out, header.count);
+  appendVarint(out, header.length);
+}
+
+bool MessageChunk::isChunk(const IRtmEventHandler::MessageEvent& event) {
+  return event.messageType == RTM_MESSAGE_TYPE_BINARY && viewOf(event.customType) == kCustomType;
+}
+
+bool MessageChunk::read(const IRtmEventHandler::MessageEvent& event, Header& header, std::string_view& slice) {
+  if (!isChunk(event) || event.messageLength < 2 || static_cast<uint8_t>(event.message[0]) != kVersion) {
+    return false;
+  }
+  const char* cursor = event.message + 1;
+  const char* end = event.message + event.messageLength;
+  header.messageType = static_cast<RTM_MESSAGE_TYPE>(static_cast<uint8_t>(*cursor++));
+  if (header.messageType != RTM_MESSAGE_TYPE_BINARY && header.messageType != RTM_MESSAGE_TYPE_STRING) return false;
+  uint64_t customTypeLength = 0;
+  if (!readVarint(cursor, end, customTypeLength) || customTypeLength > static_cast<uint64_t>(end - cursor)) {
+    return false;
+  }
+  header.customType = std::string_view(cursor, customTypeLength);
+  cursor += customTypeLength;
+  if (!readVarint(cursor, end, header.transferId) || !readVarint(cursor, end, header.index) ||
+      !readVarint(cursor, end, header.count) || !readVarint(cursor, end, header.length)) {
+    return false;
+  }
+  // Every fragment holds at least one byte, so a message has at most `length` of them.
+  if (header.count == 0 || header.index >= header.count || header.count > header.length) return false;
+  uint64_t sliceLength = MessageChunk::sliceLength(header.length, header.count);
+  uint64_t offset = header.index * sliceLength;
+  if (offset >= header.length) return false;
+  uint64_t expected = std::min(sliceLength, header.length - offset);
+  if (expected != static_cast<uint64_t>(end - cursor)) return false;
+  slice = std::string_view(cursor, end - cursor);
+  return true;
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,52 @@
+//
+//  MessageChunk.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Fragment of a message too large for one publish.
+///
+/// Fragments are published as binary messages with customType `kCustomType`. Each payload is a header,
+/// `[version u8][messageType u8][varint customType length][customType][varint transferId][varint index]
+/// [varint count][varint length]`, followed by the fragment's slice of the message. `length` is the whole
+/// message's; every fragment but the last carries `sliceLength(length, count)` bytes. Each fragment repeats the
+/// message's type and customType, so fragments can be read in any order.
+struct MessageChunk {
+  static constexpr const char* kCustomType = "flat.chunk";
+  static constexpr uint8_t kVersion = 1;
+
+  struct Header {
+    agora::rtm::RTM_MESSAGE_TYPE messageType = agora::rtm::RTM_MESSAGE_TYPE_BINARY;
+    std::string_view customType;
+    uint64_t transferId = 0;
+    uint64_t index = 0;
+    uint64_t count = 0;
+    uint64_t length = 0;
+  };
+
+  /// Header bytes for any fragment of a message with this customType.
+  static size_t maxHeaderSize(size_t customTypeLength);
+  /// Bytes of the message carried by every fragment but the last.
+  static uint64_t sliceLength(uint64_t length, uint64_t count) { return (length + count - 1) / count; }
+  static void appendHeader(std::string& out, const Header& header);
+  static bool isChunk(const agora::rtm::IRtmEventHandler::MessageEvent& event);
+  /// Parses a fragment; `slice` borrows the event's payload. False on a malformed fragment.
+  static bool read(const agora::rtm::IRtmEventHandler::MessageEvent& event, Header& header,
+                   std::string_view& slice);
+};
+
+}  // namespace rtm
+}  // namespace flat
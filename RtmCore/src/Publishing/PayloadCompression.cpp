@@ -0,0 +1,144 @@
+//
+//  PayloadCompression.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/PayloadCompression.h"
+
+#include <zlib.h>
+
+#include "Common/StringMap.h"
+#include "Common/Varint.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+/// Raw deflate: the customType already names the format, so the zlib header and checksum would be dead weight.
+constexpr int kWindowBits = -15;
+
+/// Built from the classroom's messages: whiteboard scene lists, member info, commands and chat, in the order the
+/// apps' encoders write them. deflate reaches the end of the dictionary most cheaply, so the most common strings
+/// come last.
+constexpr std::string_view kDictionary =
+    "{\"scenePath\":\"/\",\"scenes\":[{\"name\":\"1\",\"ppt\":{\"height\":720,\"width\":1280,\"previewURL\":"
+    "\"https://convertcdn.netless.link/dynamicConvert/\",\"src\":\"pptx://convertcdn.netless.link/dynamicConvert/"
+    "\"}},{\"name\":\"2\",\"ppt\":{\"height\":1080,\"width\":1920,\"src\":\"https://convertcdn.netless.link/"
+    "staticConvert/\",\"previewURL\":\"\"}}],\"taskUUID\":\"\",\"taskToken\":\"NETLESSTASK_\",\"region\":\"cn-hz\","
+    "\"convertStep\":\"Done\",\"resourceType\":\"WhiteboardProjector\",\"fileURL\":\"https://flat-storage."
+    "oss-accelerate.aliyuncs.com/cloud-storage/\",\".pptx\",\".pdf\",\".png\",\".jpg\",\".mp4\",\"fileName\":\""
+    "{\"t\":\"room-expire\",\"v\":{\"roomUUID\":\"\",\"expireInfo\":{\"roomLevel\":0,\"expireAt\":"
+    "{\"t\":\"update-room-status\",\"v\":{\"roomUUID\":\"\",\"status\":\"Started\"}}\"Paused\"\"Stopped\""
+    "{\"t\":\"request-device-response\",\"v\":{\"roomUUID\":\"\",\"camera\":true,\"mic\":false}}"
+    "{\"t\":\"request-device\",\"v\":{\"roomUUID\":\"\",\"mic\":true,\"camera\":false}}"
+    "{\"t\":\"notify-device-off\",\"v\":{\"roomUUID\":\"\",\"camera\":false}}"
+    "{\"t\":\"ban\",\"v\":{\"roomUUID\":\"\",\"status\":true}}"
+    "{\"t\":\"reward\",\"v\":{\"roomUUID\":\"\",\"userUUID\":\"\"}}"
+    "{\"t\":\"raise-hand\",\"v\":{\"roomUUID\":\"\",\"status\":false}}"
+    "\"avatarURL\":\"https://flat-storage.oss-accelerate.aliyuncs.com/flat-resources/avatar/\",\".png\"}"
+    "\"avatarURL\":\"https://thirdwx.qlogo.cn/mmopen/vi_32/\",\"avatarURL\":\"https://avatars.githubusercontent.com/u/"
+    "{\"t\":\"enter\",\"v\":{\"roomUUID\":\"\",\"userUUID\":\"\",\"userInfo\":{\"name\":\"\",\"rtcUID\":"
+    "{\"t\":\"notice\",\"v\":{\"roomUUID\":\"\",\"text\":\"";
+
+}  // namespace
+
+std::string_view PayloadCompression::dictionary() { return kDictionary; }
+
+bool PayloadCompression::isCompressed(const IRtmEventHandler::MessageEvent& event) {
+  return event.messageType == RTM_MESSAGE_TYPE_BINARY && viewOf(event.customType) == kCustomType;
+}
+
+// MARK: - PayloadDeflater
+
+PayloadDeflater::PayloadDeflater(int level) : stream_(std::make_unique<z_stream_s>()) {
+  ready_ = deflateInit2(stream_.get(), level, Z_DEFLATED, kWindowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+PayloadDeflater::~PayloadDeflater() {
+  if (ready_) deflateEnd(stream_.get());
+}
+
+bool PayloadDeflater::deflate(RTM_MESSAGE_TYPE messageType, std::string_view customType, const char* message,
+                              size_t length, std::string& out) {
+  out.clear();
+  if (!ready_ || length == 0) return false;
+  out.push_back(static_cast<char>(messageType));
+  appendVarint(out, customType.size());
+  out.append(customType);
+  appendVarint(out, length);
+  if (out.size() >= length) return false;
+  // Only a frame smaller than the message is worth sending, so deflate stops as soon as it would not be.
+  size_t header = out.size();
+  out.resize(length);
+  z_stream_s& stream = *stream_;
+  if (deflateReset(&stream) != Z_OK ||
+      deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(kDictionary.data()),
+                           static_cast<uInt>(kDictionary.size())) != Z_OK) {
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(message));
+  stream.avail_in = static_cast<uInt>(length);
+  stream.next_out = reinterpret_cast<Bytef*>(out.data() + header);
+  stream.avail_out = static_cast<uInt>(length - header);
+  if (::deflate(&stream, Z_FINISH) != Z_STREAM_END || stream.avail_out == 0) return false;
+  out.resize(length - stream.avail_out);
+  return true;
+}
+
+// MARK: - PayloadInflater
+
+PayloadInflater::PayloadInflater() : stream_(std::make_unique<z_stream_s>()) {
+  ready_ = inflateInit2(stream_.get(), kWindowBits) == Z_OK;
+}
+
+PayloadInflater::~PayloadInflater() {
+  if (ready_) inflateEnd(stream_.get());
+}
+
+bool PayloadInflater::inflate(const IRtmEventHandler::MessageEvent& compressed,
+                              IRtmEventHandler::MessageEvent& message) {
+  if (!ready_ || !PayloadCompression::isCompressed(compressed) || compressed.messageLength == 0) return false;
+  const char* cursor = compressed.message;
+  const char* end = compressed.message + compressed.messageLength;
+  auto messageType = static_cast<RTM_MESSAGE_TYPE>(static_cast<uint8_t>(*cursor++));
+  if (messageType != RTM_MESSAGE_TYPE_BINARY && messageType != RTM_MESSAGE_TYPE_STRING) return false;
+  uint64_t customTypeLength = 0;
+  uint64_t length = 0;
+  if (!readVarint(cursor, end, customTypeLength) || customTypeLength > static_cast<uint64_t>(end - cursor)) {
+    return false;
+  }
+  customType_.assign(cursor, customTypeLength);
+  cursor += customTypeLength;
+  if (!readVarint(cursor, end, length) || length == 0 || length > PayloadCompression::kMaxInflatedLength) {
+    return false;
+  }
+
+  payload_.resize(length);
+  z_stream_s& stream = *stream_;
+  if (inflateReset(&stream) != Z_OK ||
+      inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(kDictionary.data()),
+                           static_cast<uInt>(kDictionary.size())) != Z_OK) {
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(cursor));
+  stream.avail_in = static_cast<uInt>(end - cursor);
+  stream.next_out = reinterpret_cast<Bytef*>(payload_.data());
+  stream.avail_out = static_cast<uInt>(length);
+  // The stream must end exactly at the declared length and consume the whole frame.
+  if (::inflate(&stream, Z_FINISH) != Z_STREAM_END || stream.avail_out != 0 || stream.avail_in != 0) return false;
+
+  message = compressed;
+  message.messageType = messageType;
+  message.message = payload_.data();
+  message.messageLength = payload_.size();
+  message.customType = customType_.empty() ? nullptr : customType_.c_str();
+  return true;
+}
+
+}  // namespace rtm
+}  // namespace flat
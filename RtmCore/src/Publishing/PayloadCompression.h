@@ -0,0 +1,82 @@
+//
+//  PayloadCompression.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "IAgoraRtmClient.h"
+
+struct z_stream_s;
+
+namespace flat {
+namespace rtm {
+
+/// Deflated message carrying another message.
+///
+/// It is published as a binary message with customType `kCustomType`, so a client that does not know it never
+/// mistakes it for its own traffic. The payload is `[messageType u8][varint customType length][customType]
+/// [varint length][raw deflate of the message]`, deflated against `dictionary()`: JSON keys, command names and
+/// URL prefixes of the room's traffic, which is what lets messages of a few hundred bytes shrink at all. A new
+/// dictionary gets a new customType.
+struct PayloadCompression {
+  static constexpr const char* kCustomType = "flat.z.1";
+  /// Inflated messages larger than this are malformed, whatever their frame claims.
+  static constexpr size_t kMaxInflatedLength = 1024 * 1024;
+
+  static std::string_view dictionary();
+  static bool isCompressed(const agora::rtm::IRtmEventHandler::MessageEvent& event);
+};
+
+/// Compresses messages one at a time, reusing one deflate stream.
+class PayloadDeflater {
+ public:
+  /// `level` is zlib's, 1 (fastest) to 9 (smallest).
+  explicit PayloadDeflater(int level = 6);
+  ~PayloadDeflater();
+
+  PayloadDeflater(const PayloadDeflater&) = delete;
+  PayloadDeflater& operator=(const PayloadDeflater&) = delete;
+
+  /// Writes the compressed frame of the message to `out`. False when the frame would not be smaller than the
+  /// message, in which case the message should go out as it is.
+  bool deflate(agora::rtm::RTM_MESSAGE_TYPE messageType, std::string_view customType, const char* message,
+               size_t length, std::string& out);
+
+ private:
+  std::unique_ptr<z_stream_s> stream_;
+  bool ready_ = false;
+};
+
+/// Restores compressed messages, reusing one inflate stream.
+class PayloadInflater {
+ public:
+  PayloadInflater();
+  ~PayloadInflater();
+
+  PayloadInflater(const PayloadInflater&) = delete;
+  PayloadInflater& operator=(const PayloadInflater&) = delete;
+
+  /// Fills `message` with the original message of `compressed`: its channel, topic, publisher and timestamp,
+  /// and this inflater's copies of the payload and customType, valid until the next call. False on a malformed
+  /// frame.
+  bool inflate(const agora::rtm::IRtmEventHandler::MessageEvent& compressed,
+               agora::rtm::IRtmEventHandler::MessageEvent& message);
+
+ private:
+  std::unique_ptr<z_stream_s> stream_;
+  bool ready_ = false;
+  std::string customType_;
+  std::string payload_;
+};
+
+}  // namespace rtm
+}  // namespace flat
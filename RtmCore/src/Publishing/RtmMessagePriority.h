@@ -0,0 +1,35 @@
+//
+//  RtmMessagePriority.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "IAgoraStreamChannel.h"
+
+namespace flat {
+namespace rtm {
+
+/// Number of distinct `RTM_MESSAGE_PRIORITY` values.
+constexpr size_t kRtmPriorityLevels = 4;
+
+/// Dense index of a priority, 0 for `HIGHEST` through 3 for `LOW`. Unknown values count as `LOW`.
+inline size_t priorityLevel(agora::rtm::RTM_MESSAGE_PRIORITY priority) {
+  switch (priority) {
+    case agora::rtm::RTM_MESSAGE_PRIORITY_HIGHEST:
+      return 0;
+    case agora::rtm::RTM_MESSAGE_PRIORITY_HIGH:
+      return 1;
+    case agora::rtm::RTM_MESSAGE_PRIORITY_NORMAL:
+      return 2;
+    default:
+      return 3;
+  }
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,345 @@
+//
+//  RtmRateGovernor.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/RtmRateGovernor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "Common/StringMap.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+double secondsBetween(RtmClock::time_point from, RtmClock::time_point to) {
+  return to > from ? std::chrono::duration<double>(to - from).count() : 0;
+}
+
+}  // namespace
+
+RtmRateGovernor::RtmRateGovernor(IRtmClient& client, RtmClock::time_point now)
+    : RtmRateGovernor(client, now, Options()) {}
+
+RtmRateGovernor::RtmRateGovernor(IRtmClient& client, RtmClock::time_point now, Options options)
+    : client_(client),
+      options_(std::move(options)),
+      unclaimed_(options_.unclaimedCapacity) {
+  const Limit limits[] = {options_.publish, options_.subscribe, options_.topicMessage};
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    Bucket& bucket = buckets_[i];
+    bucket.limit = limits[i];
+    bucket.limit.perSecond = std::max(bucket.limit.perSecond, options_.minPerSecond);
+    bucket.limit.burst = std::max(bucket.limit.burst, 1.0);
+    bucket.perSecond = bucket.limit.perSecond;
+    bucket.tokens = bucket.limit.burst;
+    bucket.refilled = now;
+  }
+}
+
+RtmRateGovernor::~RtmRateGovernor() = default;
+
+// MARK: - Submission
+
+RtmRateGovernor::Ticket RtmRateGovernor::publish(const char* channelName, const char* message, size_t length,
+                                                 const PublishOptions& options, RTM_MESSAGE_PRIORITY priority,
+                                                 RtmClock::time_point now) {
+  if (!channelName || (!message && length > 0)) return 0;
+  Operation operation;
+  operation.kind = Kind::publish;
+  operation.priority = priorityLevel(priority);
+  operation.channelName = channelName;
+  operation.payload.assign(message, length);
+  operation.customType = viewOf(options.customType);
+  operation.channelType = options.channelType;
+  operation.messageType = options.messageType;
+  return submit(std::move(operation), now);
+}
+
+RtmRateGovernor::Ticket RtmRateGovernor::subscribe(const char* channelName, const SubscribeOptions& options,
+                                                   RTM_MESSAGE_PRIORITY priority, RtmClock::time_point now) {
+  if (!channelName) return 0;
+  Operation operation;
+  operation.kind = Kind::subscribe;
+  operation.priority = priorityLevel(priority);
+  operation.channelName = channelName;
+  operation.subscribeOptions = options;
+  return submit(std::move(operation), now);
+}
+
+RtmRateGovernor::Ticket RtmRateGovernor::unsubscribe(const char* channelName, RTM_MESSAGE_PRIORITY priority,
+                                                     RtmClock::time_point now) {
+  if (!channelName) return 0;
+  Operation operation;
+  operation.kind = Kind::unsubscribe;
+  operation.priority = priorityLevel(priority);
+  operation.channelName = channelName;
+  return submit(std::move(operation), now);
+}
+
+RtmRateGovernor::Ticket RtmRateGovernor::publishTopicMessage(IStreamChannel& channel, const char* topic,
+                                                             const char* message, size_t length,
+                                                             const TopicMessageOptions& options,
+                                                             RTM_MESSAGE_PRIORITY priority,
+                                                             RtmClock::time_point now) {
+  if (!topic || (!message && length > 0)) return 0;
+  Operation operation;
+  operation.kind = Kind::topicMessage;
+  operation.priority = priorityLevel(priority);
+  operation.topic = topic;
+  operation.payload.assign(message, length);
+  operation.customType = viewOf(options.customType);
+  operation.messageType = options.messageType;
+  operation.sendTs = options.sendTs;
+  operation.streamChannel = &channel;
+  return submit(std::move(operation), now);
+}
+
+RtmRateGovernor::Ticket RtmRateGovernor::submit(Operation operation, RtmClock::time_point now) {
+  Ticket ticket;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& target = bucket(classOf(operation.kind));
+    if (target.queued >= options_.maxQueued) {
+      ++stats_.rejected;
+      return 0;
+    }
+    ticket = operation.ticket = ++nextTicket_;
+    ++stats_.submitted;
+    ++target.queued;
+    target.queues[operation.priority].push_back(std::move(operation));
+  }
+  poll(now);
+  return ticket;
+}
+
+// MARK: - Dispatch
+
+size_t RtmRateGovernor::poll(RtmClock::time_point now) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dispatching_) return 0;
+    dispatching_ = true;
+    for (Bucket& each : buckets_) refill(each, now);
+  }
+  size_t calls = 0;
+  std::vector<Completion> completions;
+  for (;;) {
+    Operation operation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!takeNext(operation)) {
+        dispatching_ = false;
+        break;
+      }
+    }
+    uint64_t requestId = issue(operation);
+    ++calls;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.dispatched;
+    RTM_ERROR_CODE early;
+    if (requestId == 0) {
+      resolve(operation, RTM_ERROR_NOT_INITIALIZED, completions);
+    } else if (unclaimed_.take(requestId, early)) {
+      resolve(operation, early, completions);
+    } else {
+      uint32_t index;
+      if (!freeSlots_.empty()) {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+      } else {
+        index = static_cast<uint32_t>(inFlight_.size());
+        inFlight_.emplace_back();
+      }
+      inFlight_[index] = std::move(operation);
+      pending_.insert(requestId, index);
+    }
+  }
+  notify(completions);
+  return calls;
+}
+
+RtmClock::time_point RtmRateGovernor::nextDeadline() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RtmClock::time_point deadline = RtmClock::time_point::max();
+  for (const Bucket& each : buckets_) {
+    if (each.queued == 0) continue;
+    RtmClock::time_point ready = each.refilled;
+    if (each.tokens < 1) {
+      ready += std::chrono::duration_cast<RtmClock::duration>(
+          std::chrono::duration<double>((1 - each.tokens) / each.perSecond));
+    }
+    deadline = std::min(deadline, ready);
+  }
+  return deadline;
+}
+
+double RtmRateGovernor::ratePerSecond(RtmOperationClass operationClass) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buckets_[static_cast<size_t>(operationClass)].perSecond;
+}
+
+RtmRateGovernor::Stats RtmRateGovernor::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.queued = 0;
+  for (const Bucket& each : buckets_) stats.queued += each.queued;
+  stats.inFlight = pending_.size();
+  stats.unclaimedDropped = unclaimed_.dropped();
+  return stats;
+}
+
+void RtmRateGovernor::refill(Bucket& target, RtmClock::time_point now) {
+  double elapsed = secondsBetween(target.refilled, now);
+  target.refilled = std::max(target.refilled, now);
+  target.perSecond = std::min(target.limit.perSecond, target.perSecond + options_.recoveryPerSecond * elapsed);
+  // A backed-off bucket also holds a proportionally smaller burst.
+  double burst = std::max(1.0, target.limit.burst * target.perSecond / target.limit.perSecond);
+  target.tokens = std::min(burst, target.tokens + target.perSecond * elapsed);
+}
+
+bool RtmRateGovernor::takeNext(Operation& operation) {
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    size_t index = (nextBucket_ + i) % buckets_.size();
+    Bucket& candidate = buckets_[index];
+    if (candidate.queued == 0 || candidate.tokens < 1) continue;
+    for (std::deque<Operation>& queue : candidate.queues) {
+      if (queue.empty()) continue;
+      operation = std::move(queue.front());
+      queue.pop_front();
+      --candidate.queued;
+      candidate.tokens -= 1;
+      nextBucket_ = (index + 1) % buckets_.size();
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t RtmRateGovernor::issue(const Operation& operation) {
+  uint64_t requestId = 0;
+  const char* customType = operation.customType.empty() ? nullptr : operation.customType.c_str();
+  switch (operation.kind) {
+    case Kind::publish: {
+      PublishOptions options;
+      options.channelType = operation.channelType;
+      options.messageType = operation.messageType;
+      options.customType = customType;
+      client_.publish(operation.channelName.c_str(), operation.payload.data(), operation.payload.size(), options,
+                      requestId);
+      break;
+    }
+    case Kind::subscribe:
+      client_.subscribe(operation.channelName.c_str(), operation.subscribeOptions, requestId);
+      break;
+    case Kind::unsubscribe:
+      client_.unsubscribe(operation.channelName.c_str(), requestId);
+      break;
+    case Kind::topicMessage: {
+      TopicMessageOptions options;
+      options.messageType = operation.messageType;
+      options.sendTs = operation.sendTs;
+      options.customType = customType;
+      operation.streamChannel->publishTopicMessage(operation.topic.c_str(), operation.payload.data(),
+                                                   operation.payload.size(), options, requestId);
+      break;
+    }
+  }
+  return requestId;
+}
+
+// MARK: - Results
+
+void RtmRateGovernor::resolve(Operation& operation, RTM_ERROR_CODE errorCode, std::vector<Completion>& completions) {
+  if (isRateLimited(errorCode)) {
+    ++stats_.rateLimited;
+    Bucket& target = bucket(classOf(operation.kind));
+    target.perSecond = std::max(options_.minPerSecond, target.perSecond * options_.backoffFactor);
+    target.tokens = std::min(target.tokens, 0.0);
+    if (operation.retries < options_.maxRetries && target.queued < options_.maxQueued) {
+      ++operation.retries;
+      ++stats_.retried;
+      ++target.queued;
+      // Ahead of everything submitted after it, so retries of several refused operations keep their order.
+      auto& queue = target.queues[operation.priority];
+      auto later = std::find_if(queue.begin(), queue.end(), [&](const Operation& queued) {
+        return queued.ticket > operation.ticket;
+      });
+      queue.insert(later, std::move(operation));
+      return;
+    }
+  }
+  ++stats_.completed;
+  completions.push_back({operation.ticket, errorCode});
+}
+
+void RtmRateGovernor::result(uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  std::vector<Completion> completions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index;
+    if (!pending_.take(requestId, index)) {
+      unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    Operation operation = std::move(inFlight_[index]);
+    inFlight_[index] = Operation();
+    freeSlots_.push_back(index);
+    resolve(operation, errorCode, completions);
+  }
+  notify(completions);
+}
+
+void RtmRateGovernor::notify(const std::vector<Completion>& completions) const {
+  if (!options_.onComplete) return;
+  for (const Completion& completion : completions) options_.onComplete(completion.ticket, completion.errorCode);
+}
+
+void RtmRateGovernor::onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  result(requestId, errorCode);
+}
+
+void RtmRateGovernor::onSubscribeResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  result(requestId, errorCode);
+}
+
+void RtmRateGovernor::onUnsubscribeResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  result(requestId, errorCode);
+}
+
+void RtmRateGovernor::onPublishTopicMessageResult(const uint64_t requestId, const char*, const char*,
+                                                  RTM_ERROR_CODE errorCode) {
+  result(requestId, errorCode);
+}
+
+// MARK: - Classification
+
+RtmOperationClass RtmRateGovernor::classOf(Kind kind) {
+  switch (kind) {
+    case Kind::publish:
+      return RtmOperationClass::publish;
+    case Kind::subscribe:
+    case Kind::unsubscribe:
+      return RtmOperationClass::subscribe;
+    case Kind::topicMessage:
+      return RtmOperationClass::topicMessage;
+  }
+  return RtmOperationClass::publish;
+}
+
+bool RtmRateGovernor::isRateLimited(RTM_ERROR_CODE errorCode) {
+  return errorCode == RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT ||
+         errorCode == RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT ||
+         errorCode == RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION;
+}
+
+}  // namespace rtm
+}  // namespace flat
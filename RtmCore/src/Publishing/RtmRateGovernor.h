@@ -0,0 +1,190 @@
+//
+//  RtmRateGovernor.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Publishing/RtmMessagePriority.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Operation classes the RTM service rate-limits separately.
+enum class RtmOperationClass {
+  /// `IRtmClient::publish`.
+  publish,
+  /// `IRtmClient::subscribe`/`unsubscribe`.
+  subscribe,
+  /// `IStreamChannel::publishTopicMessage`.
+  topicMessage,
+};
+
+/// Client-side token buckets in front of the rate-limited RTM calls, so bursts queue instead of failing with
+/// `RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT`, `RTM_ERROR_CHANNEL_SUBSCRIBE_TOO_FREQUENT` or
+/// `RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION`.
+///
+/// Each operation class has a bucket and four queues, one per `RTM_MESSAGE_PRIORITY`; higher priorities
+/// always go first. When the service still answers with one of those errors, the class's rate is cut by
+/// `backoffFactor` and the operation is queued again ahead of its priority's later submissions; the rate then
+/// climbs back by `recoveryPerSecond` per second up to its configured limit.
+///
+/// Register the governor with the client's event handler (usually through `RtmEventMux`) so it sees the
+/// results of the calls it makes. Each submitted operation gets a ticket, completed once through
+/// `Options::onComplete` with the final result, from the thread that delivered it; with a synchronous client
+/// that can happen before the submitting call returns. Payloads are copied. Submitting dispatches at once
+/// when the bucket allows, `poll(now)` refills the buckets and dispatches the rest. SDK calls are made
+/// outside the governor's lock.
+class RtmRateGovernor : public agora::rtm::IRtmEventHandler {
+ public:
+  /// 0 is never a valid ticket; it is returned when a queue is full.
+  using Ticket = uint64_t;
+
+  struct Limit {
+    double perSecond;
+    double burst;
+  };
+
+  struct Options {
+    Limit publish{60, 20};
+    Limit subscribe{10, 10};
+    Limit topicMessage{120, 40};
+    double backoffFactor = 0.5;
+    double minPerSecond = 1;
+    double recoveryPerSecond = 2;
+    /// Queued operations per class, across priorities. Retries count against it too: a rate-limited operation
+    /// that finds its class's queues full completes with the rate-limit error instead of going back in.
+    size_t maxQueued = 4096;
+    /// Re-queues after a rate-limit error before the error is reported.
+    uint32_t maxRetries = 3;
+    /// Results kept for calls that are still being issued, as in `RtmRequestTracker`.
+    size_t unclaimedCapacity = 256;
+    std::function<void(Ticket, agora::rtm::RTM_ERROR_CODE)> onComplete;
+  };
+
+  struct Stats {
+    uint64_t submitted = 0;
+    uint64_t dispatched = 0;
+    uint64_t completed = 0;
+    uint64_t rejected = 0;
+    uint64_t rateLimited = 0;
+    uint64_t retried = 0;
+    /// Unclaimed results evicted before their call returned.
+    uint64_t unclaimedDropped = 0;
+    size_t queued = 0;
+    size_t inFlight = 0;
+  };
+
+  RtmRateGovernor(agora::rtm::IRtmClient& client, RtmClock::time_point now);
+  RtmRateGovernor(agora::rtm::IRtmClient& client, RtmClock::time_point now, Options options);
+  ~RtmRateGovernor() override;
+
+  RtmRateGovernor(const RtmRateGovernor&) = delete;
+  RtmRateGovernor& operator=(const RtmRateGovernor&) = delete;
+
+  Ticket publish(const char* channelName, const char* message, size_t length,
+                 const agora::rtm::PublishOptions& options, agora::rtm::RTM_MESSAGE_PRIORITY priority,
+                 RtmClock::time_point now);
+  Ticket subscribe(const char* channelName, const agora::rtm::SubscribeOptions& options,
+                   agora::rtm::RTM_MESSAGE_PRIORITY priority, RtmClock::time_point now);
+  Ticket unsubscribe(const char* channelName, agora::rtm::RTM_MESSAGE_PRIORITY priority, RtmClock::time_point now);
+  /// `channel` must outlive the operation.
+  Ticket publishTopicMessage(agora::rtm::IStreamChannel& channel, const char* topic, const char* message,
+                             size_t length, const agora::rtm::TopicMessageOptions& options,
+                             agora::rtm::RTM_MESSAGE_PRIORITY priority, RtmClock::time_point now);
+
+  /// Refills the buckets and dispatches whatever they allow. Returns the number of calls made.
+  size_t poll(RtmClock::time_point now);
+  /// When the next queued operation can go, or `time_point::max()` when nothing is queued.
+  RtmClock::time_point nextDeadline() const;
+
+  /// The current, possibly backed-off, rate of a class.
+  double ratePerSecond(RtmOperationClass operationClass) const;
+  Stats stats() const;
+
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  enum class Kind { publish, subscribe, unsubscribe, topicMessage };
+
+  struct Operation {
+    Ticket ticket = 0;
+    Kind kind = Kind::publish;
+    size_t priority = 0;
+    uint32_t retries = 0;
+    std::string channelName;
+    std::string topic;
+    std::string payload;
+    std::string customType;
+    agora::rtm::RTM_CHANNEL_TYPE channelType = agora::rtm::RTM_CHANNEL_TYPE_MESSAGE;
+    agora::rtm::RTM_MESSAGE_TYPE messageType = agora::rtm::RTM_MESSAGE_TYPE_BINARY;
+    uint64_t sendTs = 0;
+    agora::rtm::SubscribeOptions subscribeOptions;
+    agora::rtm::IStreamChannel* streamChannel = nullptr;
+  };
+
+  struct Bucket {
+    Limit limit{};
+    double perSecond = 0;
+    double tokens = 0;
+    RtmClock::time_point refilled;
+    std::array<std::deque<Operation>, kRtmPriorityLevels> queues;
+    size_t queued = 0;
+  };
+
+  struct Completion {
+    Ticket ticket;
+    agora::rtm::RTM_ERROR_CODE errorCode;
+  };
+
+  static RtmOperationClass classOf(Kind kind);
+  static bool isRateLimited(agora::rtm::RTM_ERROR_CODE errorCode);
+
+  Bucket& bucket(RtmOperationClass operationClass) { return buckets_[static_cast<size_t>(operationClass)]; }
+  Ticket submit(Operation operation, RtmClock::time_point now);
+  void refill(Bucket& bucket, RtmClock::time_point now);
+  bool takeNext(Operation& operation);
+  uint64_t issue(const Operation& operation);
+  void resolve(Operation& operation, agora::rtm::RTM_ERROR_CODE errorCode, std::vector<Completion>& completions);
+  void result(uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode);
+  void notify(const std::vector<Completion>& completions) const;
+
+  agora::rtm::IRtmClient& client_;
+  Options options_;
+  mutable std::mutex mutex_;
+  std::array<Bucket, 3> buckets_;
+  size_t nextBucket_ = 0;
+  Ticket nextTicket_ = 0;
+  /// requestId -> index into `inFlight_`.
+  RequestIdTable<uint32_t> pending_;
+  std::vector<Operation> inFlight_;
+  std::vector<uint32_t> freeSlots_;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  /// Set while `poll` dispatches, so a re-entrant `poll` from a result callback returns at once.
+  bool dispatching_ = false;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,138 @@
+//
+//  TopicSendScheduler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Publishing/TopicSendScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+TopicSendScheduler::TopicSendScheduler(IStreamChannel& channel, RtmClock::time_point now)
+    : TopicSendScheduler(channel, now, Options()) {}
+
+TopicSendScheduler::TopicSendScheduler(IStreamChannel& channel, RtmClock::time_point now, Options options)
+    : channel_(channel), options_(options), budget_(static_cast<double>(options.burstBytes)), refilled_(now) {
+  if (options_.bytesPerSecond == 0) options_.bytesPerSecond = 1;
+  if (options_.quantumBytes == 0) options_.quantumBytes = 1;
+}
+
+void TopicSendScheduler::setTopicPriority(const char* topic, RTM_MESSAGE_PRIORITY priority) {
+  topicFor(viewOf(topic)).level = priorityLevel(priority);
+}
+
+RTM_ERROR_CODE TopicSendScheduler::enqueue(const char* topic, const char* message, size_t length,
+                                           const TopicMessageOptions& options, RtmClock::time_point now) {
+  if (viewOf(topic).empty()) return RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME;
+  if (!message && length > 0) return RTM_ERROR_CHANNEL_INVALID_MESSAGE;
+  Topic& target = topicFor(topic);
+  if (target.queue.size() >= options_.maxQueuedPerTopic) {
+    ++stats_.rejected;
+    return RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION;
+  }
+  target.queue.push_back({std::string(message, length), std::string(viewOf(options.customType)),
+                          options.messageType, options.sendTs});
+  ++stats_.enqueued;
+  ++stats_.queuedMessages;
+  stats_.queuedBytes += length;
+  if (!target.active) {
+    target.active = true;
+    active_.push_back(&target);
+  }
+  poll(now);
+  return RTM_ERROR_OK;
+}
+
+size_t TopicSendScheduler::poll(RtmClock::time_point now) {
+  if (polling_) return 0;
+  polling_ = true;
+  refill(now);
+  size_t sent = 0;
+  while (!active_.empty() && budget_ > 0) {
+    Topic& topic = *active_.front();
+    if (!topic.inTurn) {
+      topic.inTurn = true;
+      topic.deficit += options_.quantumBytes * options_.weights[topic.level];
+    }
+    while (!topic.queue.empty() && topic.queue.front().payload.size() <= topic.deficit && budget_ > 0) {
+      send(topic);
+      ++sent;
+    }
+    if (budget_ <= 0 && !topic.queue.empty() && topic.queue.front().payload.size() <= topic.deficit) {
+      break;  // Out of budget mid-turn: the topic keeps the turn and its deficit.
+    }
+    topic.inTurn = false;
+    active_.pop_front();
+    if (topic.queue.empty()) {
+      topic.active = false;
+      topic.deficit = 0;
+    } else {
+      active_.push_back(&topic);
+    }
+  }
+  polling_ = false;
+  return sent;
+}
+
+RtmClock::time_point TopicSendScheduler::nextDeadline() const {
+  if (active_.empty()) return RtmClock::time_point::max();
+  if (budget_ > 0) return refilled_;
+  double seconds = (1 - budget_) / static_cast<double>(options_.bytesPerSecond);
+  return refilled_ + std::chrono::duration_cast<RtmClock::duration>(std::chrono::duration<double>(seconds));
+}
+
+size_t TopicSendScheduler::queued(const char* topic) const {
+  auto found = topics_.find(viewOf(topic));
+  return found == topics_.end() ? 0 : found->second.queue.size();
+}
+
+TopicSendScheduler::Stats TopicSendScheduler::stats() const { return stats_; }
+
+// MARK: - Scheduling
+
+TopicSendScheduler::Topic& TopicSendScheduler::topicFor(std::string_view name) {
+  auto found = topics_.find(name);
+  if (found != topics_.end()) return found->second;
+  Topic& topic = topics_[std::string(name)];
+  topic.name = name;
+  return topic;
+}
+
+void TopicSendScheduler::refill(RtmClock::time_point now) {
+  if (now <= refilled_) return;
+  double elapsed = std::chrono::duration<double>(now - refilled_).count();
+  refilled_ = now;
+  budget_ = std::min(static_cast<double>(options_.burstBytes),
+                     budget_ + elapsed * static_cast<double>(options_.bytesPerSecond));
+}
+
+void TopicSendScheduler::send(Topic& topic) {
+  Message message = std::move(topic.queue.front());
+  topic.queue.pop_front();
+  size_t length = message.payload.size();
+  topic.deficit -= length;
+  // A message may overdraw the budget, so one larger than the burst still goes out.
+  budget_ -= static_cast<double>(length);
+  --stats_.queuedMessages;
+  stats_.queuedBytes -= length;
+  ++stats_.sent;
+  stats_.sentBytes += length;
+
+  TopicMessageOptions options;
+  options.messageType = message.messageType;
+  options.sendTs = message.sendTs;
+  options.customType = message.customType.empty() ? nullptr : message.customType.c_str();
+  uint64_t requestId = 0;
+  channel_.publishTopicMessage(topic.name.c_str(), message.payload.data(), length, options, requestId);
+}
+
+}  // namespace rtm
+}  // namespace flat
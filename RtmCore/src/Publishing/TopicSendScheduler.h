@@ -0,0 +1,107 @@
+//
+//  TopicSendScheduler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraStreamChannel.h"
+#include "Publishing/RtmMessagePriority.h"
+
+namespace flat {
+namespace rtm {
+
+/// Weighted deficit round robin between the topics of one stream channel, in front of
+/// `IStreamChannel::publishTopicMessage`.
+///
+/// Sends are paced to `bytesPerSecond`. Every topic with queued messages takes turns; a turn adds
+/// `quantumBytes` times its priority's weight to the topic's deficit and sends messages while they fit in it.
+/// A control topic therefore waits at most one round of the other topics' quanta however deep a bulk topic's
+/// backlog is, and saturated topics share the link in proportion to their weights.
+///
+/// Results of the sends arrive at the client's event handler as usual. Not thread-safe.
+class TopicSendScheduler {
+ public:
+  struct Options {
+    size_t bytesPerSecond = 64 * 1024;
+    size_t burstBytes = 16 * 1024;
+    size_t quantumBytes = 1024;
+    /// Quanta per turn, indexed by `priorityLevel`: HIGHEST, HIGH, NORMAL, LOW.
+    std::array<uint32_t, kRtmPriorityLevels> weights{8, 4, 2, 1};
+    size_t maxQueuedPerTopic = 1024;
+  };
+
+  struct Stats {
+    uint64_t enqueued = 0;
+    uint64_t sent = 0;
+    uint64_t sentBytes = 0;
+    uint64_t rejected = 0;
+    size_t queuedMessages = 0;
+    size_t queuedBytes = 0;
+  };
+
+  TopicSendScheduler(agora::rtm::IStreamChannel& channel, RtmClock::time_point now);
+  TopicSendScheduler(agora::rtm::IStreamChannel& channel, RtmClock::time_point now, Options options);
+
+  TopicSendScheduler(const TopicSendScheduler&) = delete;
+  TopicSendScheduler& operator=(const TopicSendScheduler&) = delete;
+
+  /// Topics default to `RTM_MESSAGE_PRIORITY_NORMAL`; pass the priority the topic was joined with.
+  void setTopicPriority(const char* topic, agora::rtm::RTM_MESSAGE_PRIORITY priority);
+  /// Queues a message and sends whatever the pacing allows. `RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME` for an
+  /// empty topic, `RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION` when the topic's queue is full.
+  agora::rtm::RTM_ERROR_CODE enqueue(const char* topic, const char* message, size_t length,
+                                     const agora::rtm::TopicMessageOptions& options, RtmClock::time_point now);
+  /// Sends as much as the pacing allows. Returns the number of messages sent.
+  size_t poll(RtmClock::time_point now);
+  /// When pacing next allows a send, or `time_point::max()` when nothing is queued.
+  RtmClock::time_point nextDeadline() const;
+
+  size_t queued(const char* topic) const;
+  Stats stats() const;
+
+ private:
+  struct Message {
+    std::string payload;
+    std::string customType;
+    agora::rtm::RTM_MESSAGE_TYPE messageType;
+    uint64_t sendTs;
+  };
+
+  struct Topic {
+    std::string name;
+    size_t level = 2;
+    std::deque<Message> queue;
+    size_t deficit = 0;
+    /// In `active_`; its quantum for the current turn was already granted when `inTurn` is set.
+    bool active = false;
+    bool inTurn = false;
+  };
+
+  Topic& topicFor(std::string_view name);
+  void refill(RtmClock::time_point now);
+  void send(Topic& topic);
+
+  agora::rtm::IStreamChannel& channel_;
+  Options options_;
+  StringMap<Topic> topics_;
+  /// Topics with queued messages, in turn order; the front one holds the turn.
+  std::deque<Topic*> active_;
+  double budget_;
+  RtmClock::time_point refilled_;
+  /// Set while `poll` sends, so an `enqueue` from a synchronous result handler only queues.
+  bool polling_ = false;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,115 @@
+//
+//  RequestIdTable.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace flat {
+namespace rtm {
+
+/// Open-addressing map from SDK requestIds to small values, with linear probing and backward-shift deletion
+/// so no tombstones build up as requests churn. Keys are spread with a Fibonacci multiply because requestIds
+/// are sequential. Grows at half load. Key 0 is reserved as the empty marker.
+///
+/// Not thread-safe.
+template <typename Value>
+class RequestIdTable {
+ public:
+  explicit RequestIdTable(size_t initialCapacity = 64) {
+    size_t capacity = 16;
+    while (capacity < initialCapacity) capacity <<= 1;
+    resize(capacity);
+  }
+
+  /// Returns false, leaving the table unchanged, if `key` is 0 or already present.
+  bool insert(uint64_t key, Value value) {
+    if (key == 0) return false;
+    if ((size_ + 1) * 2 > entries_.size()) resize(entries_.size() * 2);
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      Entry& entry = entries_[i];
+      if (entry.key == key) return false;
+      if (entry.key == 0) {
+        entry.key = key;
+        entry.value = std::move(value);
+        ++size_;
+        return true;
+      }
+    }
+  }
+
+  Value* find(uint64_t key) {
+    if (key == 0) return nullptr;
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      Entry& entry = entries_[i];
+      if (entry.key == key) return &entry.value;
+      if (entry.key == 0) return nullptr;
+    }
+  }
+
+  const Value* find(uint64_t key) const { return const_cast<RequestIdTable*>(this)->find(key); }
+
+  /// Moves the value out into `value` and removes the entry.
+  bool take(uint64_t key, Value& value) {
+    if (key == 0) return false;
+    size_t i = home(key);
+    while (entries_[i].key != key) {
+      if (entries_[i].key == 0) return false;
+      i = (i + 1) & mask_;
+    }
+    value = std::move(entries_[i].value);
+    // Shift later members of the probe run back into the hole so lookups never stop early.
+    for (size_t next = (i + 1) & mask_; entries_[next].key != 0; next = (next + 1) & mask_) {
+      size_t wanted = home(entries_[next].key);
+      if (((next - wanted) & mask_) >= ((next - i) & mask_)) {
+        entries_[i] = std::move(entries_[next]);
+        i = next;
+      }
+    }
+    entries_[i].key = 0;
+    --size_;
+    return true;
+  }
+
+  bool erase(uint64_t key) {
+    Value value;
+    return take(key, value);
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t key = 0;
+    Value value{};
+  };
+
+  size_t home(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+  void resize(size_t capacity) {
+    std::vector<Entry> old = std::move(entries_);
+    entries_.assign(capacity, Entry());
+    mask_ = capacity - 1;
+    shift_ = 64;
+    for (size_t bits = capacity; bits > 1; bits >>= 1) --shift_;
+    size_ = 0;
+    for (Entry& entry : old) {
+      if (entry.key != 0) insert(entry.key, std::move(entry.value));
+    }
+  }
+
+  std::vector<Entry> entries_;
+  size_t mask_ = 0;
+  int shift_ = 64;
+  size_t size_ = 0;
+};
+
+}  // namespace rtm
+}  // namespace flat
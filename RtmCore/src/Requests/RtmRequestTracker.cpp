@@ -0,0 +1,288 @@
+//
+//  RtmRequestTracker.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Requests/RtmRequestTracker.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+RtmRequestTracker::RtmRequestTracker(RtmClock::time_point now) : RtmRequestTracker(now, Options()) {}
+
+RtmRequestTracker::RtmRequestTracker(RtmClock::time_point now, Options options)
+    : options_(options),
+      wheel_(now, options.wheel),
+      pending_(256),
+      unclaimed_(options.unclaimedCapacity) {}
+
+RtmRequestTracker::~RtmRequestTracker() = default;
+
+size_t RtmRequestTracker::poll(RtmClock::time_point now) {
+  std::vector<std::coroutine_handle<>> overdue;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expired_.clear();
+    wheel_.advance(now, expired_);
+    for (uint64_t requestId : expired_) {
+      uint32_t index;
+      if (!pending_.take(requestId, index)) continue;
+      Slot& slot = slots_[index];
+      *slot.result = slot.timeoutCode;
+      overdue.push_back(slot.handle);
+      slot = Slot();
+      freeSlots_.push_back(index);
+      ++stats_.timedOut;
+    }
+  }
+  for (std::coroutine_handle<> handle : overdue) handle.resume();
+  return overdue.size();
+}
+
+size_t RtmRequestTracker::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+RtmRequestTracker::Stats RtmRequestTracker::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.inFlight = pending_.size();
+  stats.unclaimedDropped = unclaimed_.dropped();
+  return stats;
+}
+
+// MARK: - Slots
+
+bool RtmRequestTracker::park(uint64_t requestId, std::coroutine_handle<> handle, RTM_ERROR_CODE& result,
+                             RTM_ERROR_CODE timeoutCode, std::chrono::milliseconds timeout) {
+  // The SDK leaves the id unset when it rejects a call before it is queued; no result will ever come.
+  if (requestId == 0) {
+    result = RTM_ERROR_NOT_INITIALIZED;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  RTM_ERROR_CODE early;
+  if (unclaimed_.take(requestId, early)) {
+    result = early;
+    ++stats_.completed;
+    return false;
+  }
+  uint32_t index;
+  if (!freeSlots_.empty()) {
+    index = freeSlots_.back();
+    freeSlots_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.emplace_back();
+  }
+  Slot& slot = slots_[index];
+  slot.handle = handle;
+  slot.result = &result;
+  slot.timeoutCode = timeoutCode;
+  slot.timer = wheel_.schedule(wheel_.now() + timeout, requestId);
+  pending_.insert(requestId, index);
+  return true;
+}
+
+void RtmRequestTracker::complete(uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  std::coroutine_handle<> handle;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index;
+    if (!pending_.take(requestId, index)) {
+      unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    Slot& slot = slots_[index];
+    wheel_.cancel(slot.timer);
+    *slot.result = errorCode;
+    handle = slot.handle;
+    slot = Slot();
+    freeSlots_.push_back(index);
+    ++stats_.completed;
+  }
+  handle.resume();
+}
+
+// MARK: - Results
+
+void RtmRequestTracker::onJoinResult(const uint64_t requestId, const char*, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onLeaveResult(const uint64_t requestId, const char*, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onPublishTopicMessageResult(const uint64_t requestId, const char*, const char*,
+                                                    RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onJoinTopicResult(const uint64_t requestId, const char*, const char*, const char*,
+                                          const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onLeaveTopicResult(const uint64_t requestId, const char*, const char*, const char*,
+                                           const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSubscribeTopicResult(const uint64_t requestId, const char*, const char*, const char*,
+                                               UserList, UserList, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onUnsubscribeTopicResult(const uint64_t requestId, const char*, const char*,
+                                                 RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetSubscribedUserListResult(const uint64_t requestId, const char*, const char*, UserList,
+                                                      RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSubscribeResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onUnsubscribeResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onLogoutResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onRenewTokenResult(const uint64_t requestId, RTM_SERVICE_TYPE, const char*,
+                                           RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSetChannelMetadataResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE,
+                                                   RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onUpdateChannelMetadataResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE,
+                                                      RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onRemoveChannelMetadataResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE,
+                                                      RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetChannelMetadataResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE,
+                                                   const Metadata&, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSetUserMetadataResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onUpdateUserMetadataResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onRemoveUserMetadataResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetUserMetadataResult(const uint64_t requestId, const char*, const Metadata&,
+                                                RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSubscribeUserMetadataResult(const uint64_t requestId, const char*,
+                                                      RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onUnsubscribeUserMetadataResult(const uint64_t requestId, const char*,
+                                                        RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onSetLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                        RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onRemoveLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                           RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onReleaseLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                            RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onAcquireLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                            RTM_ERROR_CODE errorCode, const char*) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onRevokeLockResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const char*,
+                                           RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetLocksResult(const uint64_t requestId, const char*, RTM_CHANNEL_TYPE, const LockDetail*,
+                                         const size_t, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onWhoNowResult(const uint64_t requestId, const UserState*, const size_t, const char*,
+                                       RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetOnlineUsersResult(const uint64_t requestId, const UserState*, const size_t, const char*,
+                                               RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onWhereNowResult(const uint64_t requestId, const ChannelInfo*, const size_t,
+                                         RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onGetUserChannelsResult(const uint64_t requestId, const ChannelInfo*, const size_t,
+                                                RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onPresenceSetStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onPresenceRemoveStateResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmRequestTracker::onPresenceGetStateResult(const uint64_t requestId, const UserState&,
+                                                 RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+}  // namespace rtm
+}  // namespace flat
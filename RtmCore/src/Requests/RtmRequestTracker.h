@@ -0,0 +1,291 @@
+//
+//  RtmRequestTracker.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/TimingWheel.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmLock.h"
+#include "IAgoraRtmPresence.h"
+#include "IAgoraRtmStorage.h"
+#include "IAgoraStreamChannel.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Correlates SDK requestIds with their `on*Result` callbacks so a coroutine can write
+/// `RTM_ERROR_CODE code = co_await tracker.publish(*client, "room", data, size, options);`.
+///
+/// Register the tracker with the client's event handler (usually through `RtmEventMux`). Each awaited call
+/// issues the SDK request inside `await_suspend` and parks the coroutine in a slot keyed by requestId in an
+/// open-addressing table; the matching result resumes it with the result's error code. No closure is
+/// allocated per request: the awaiter lives in the coroutine frame and the slot table is reused.
+///
+/// Results may arrive before the request is parked: the SDK may deliver them on its own thread before the call
+/// returns. Results with no waiting slot are kept in a bounded table of unclaimed results, which the next park
+/// checks first.
+///
+/// Every request gets a deadline on a `TimingWheel` (`Options::timeout` after the last `poll`). `poll` resumes
+/// overdue requests with the timeout code their operation would report (`RTM_ERROR_LOGIN_TIMEOUT`,
+/// `RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT`, ...); a result arriving later is dropped.
+///
+/// Coroutines resume on the thread that delivered their result, or on the `poll` thread for timeouts. Await
+/// the returned objects immediately: they hold the call's arguments by reference. Pending coroutines are not
+/// resumed on destruction, so keep polling until `size()` is 0 before destroying the tracker.
+class RtmRequestTracker : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Options {
+    std::chrono::milliseconds timeout{10000};
+    /// Results kept for requests that are not awaited yet. Results of requests issued around the tracker
+    /// pass through here too, so size it for the traffic between a call and its `await_suspend` returning.
+    size_t unclaimedCapacity = 1024;
+    TimingWheel::Options wheel;
+  };
+
+  struct Stats {
+    size_t inFlight = 0;
+    uint64_t completed = 0;
+    uint64_t timedOut = 0;
+    /// Unclaimed results evicted before anyone awaited them.
+    uint64_t unclaimedDropped = 0;
+  };
+
+  /// Awaitable for one SDK call. `Issue` is invoked as `issue(uint64_t& requestId)`.
+  template <typename Issue>
+  class Awaiter {
+   public:
+    Awaiter(RtmRequestTracker& tracker, Issue issue, agora::rtm::RTM_ERROR_CODE timeoutCode,
+            std::chrono::milliseconds timeout)
+        : tracker_(tracker), issue_(std::move(issue)), timeoutCode_(timeoutCode), timeout_(timeout) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      uint64_t requestId = 0;
+      issue_(requestId);
+      return tracker_.park(requestId, handle, result_, timeoutCode_, timeout_);
+    }
+
+    agora::rtm::RTM_ERROR_CODE await_resume() const noexcept { return result_; }
+
+   private:
+    RtmRequestTracker& tracker_;
+    Issue issue_;
+    agora::rtm::RTM_ERROR_CODE timeoutCode_;
+    std::chrono::milliseconds timeout_;
+    agora::rtm::RTM_ERROR_CODE result_ = agora::rtm::RTM_ERROR_OK;
+  };
+
+  explicit RtmRequestTracker(RtmClock::time_point now);
+  RtmRequestTracker(RtmClock::time_point now, Options options);
+  ~RtmRequestTracker() override;
+
+  RtmRequestTracker(const RtmRequestTracker&) = delete;
+  RtmRequestTracker& operator=(const RtmRequestTracker&) = delete;
+
+  /// Awaits any SDK call: `co_await tracker.track([&](uint64_t& id) { lock->getLocks(..., id); }, code)`.
+  template <typename Issue>
+  Awaiter<Issue> track(Issue issue, agora::rtm::RTM_ERROR_CODE timeoutCode) {
+    return Awaiter<Issue>(*this, std::move(issue), timeoutCode, options_.timeout);
+  }
+  template <typename Issue>
+  Awaiter<Issue> track(Issue issue, agora::rtm::RTM_ERROR_CODE timeoutCode, std::chrono::milliseconds timeout) {
+    return Awaiter<Issue>(*this, std::move(issue), timeoutCode, timeout);
+  }
+
+  // MARK: - IRtmClient
+
+  auto login(agora::rtm::IRtmClient& client, const char* token) {
+    return track([&client, token](uint64_t& id) { client.login(token, id); }, agora::rtm::RTM_ERROR_LOGIN_TIMEOUT);
+  }
+  auto logout(agora::rtm::IRtmClient& client) {
+    return track([&client](uint64_t& id) { client.logout(id); }, agora::rtm::RTM_ERROR_LOGIN_TIMEOUT);
+  }
+  auto publish(agora::rtm::IRtmClient& client, const char* channelName, const char* message, size_t length,
+               const agora::rtm::PublishOptions& options) {
+    return track([&, channelName, message, length](
+                     uint64_t& id) { client.publish(channelName, message, length, options, id); },
+                 agora::rtm::RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT);
+  }
+  auto subscribe(agora::rtm::IRtmClient& client, const char* channelName,
+                 const agora::rtm::SubscribeOptions& options) {
+    return track([&, channelName](uint64_t& id) { client.subscribe(channelName, options, id); },
+                 agora::rtm::RTM_ERROR_CHANNEL_SUBSCRIBE_TIMEOUT);
+  }
+  auto unsubscribe(agora::rtm::IRtmClient& client, const char* channelName) {
+    return track([&client, channelName](uint64_t& id) { client.unsubscribe(channelName, id); },
+                 agora::rtm::RTM_ERROR_CHANNEL_SUBSCRIBE_TIMEOUT);
+  }
+
+  // MARK: - IStreamChannel
+
+  auto join(agora::rtm::IStreamChannel& channel, const agora::rtm::JoinChannelOptions& options) {
+    return track([&](uint64_t& id) { channel.join(options, id); }, agora::rtm::RTM_ERROR_CHANNEL_SUBSCRIBE_TIMEOUT);
+  }
+  auto publishTopicMessage(agora::rtm::IStreamChannel& channel, const char* topic, const char* message,
+                           size_t length, const agora::rtm::TopicMessageOptions& options) {
+    return track([&, topic, message, length](
+                     uint64_t& id) { channel.publishTopicMessage(topic, message, length, options, id); },
+                 agora::rtm::RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT);
+  }
+
+  // MARK: - IRtmStorage, IRtmLock, IRtmPresence
+
+  auto setChannelMetadata(agora::rtm::IRtmStorage& storage, const char* channelName,
+                          agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                          const agora::rtm::MetadataOptions& options, const char* lockName = nullptr) {
+    return track([&, channelName, channelType, lockName](uint64_t& id) {
+      storage.setChannelMetadata(channelName, channelType, data, options, lockName, id);
+    }, agora::rtm::RTM_ERROR_STORAGE_OPERATION_TIMEOUT);
+  }
+  auto updateChannelMetadata(agora::rtm::IRtmStorage& storage, const char* channelName,
+                             agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                             const agora::rtm::MetadataOptions& options, const char* lockName = nullptr) {
+    return track([&, channelName, channelType, lockName](uint64_t& id) {
+      storage.updateChannelMetadata(channelName, channelType, data, options, lockName, id);
+    }, agora::rtm::RTM_ERROR_STORAGE_OPERATION_TIMEOUT);
+  }
+  auto acquireLock(agora::rtm::IRtmLock& lock, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                   const char* lockName, bool retry) {
+    return track([&lock, channelName, channelType, lockName, retry](uint64_t& id) {
+      lock.acquireLock(channelName, channelType, lockName, retry, id);
+    }, agora::rtm::RTM_ERROR_LOCK_OPERATION_TIMEOUT);
+  }
+  auto releaseLock(agora::rtm::IRtmLock& lock, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                   const char* lockName) {
+    return track([&lock, channelName, channelType, lockName](uint64_t& id) {
+      lock.releaseLock(channelName, channelType, lockName, id);
+    }, agora::rtm::RTM_ERROR_LOCK_OPERATION_TIMEOUT);
+  }
+  auto setState(agora::rtm::IRtmPresence& presence, const char* channelName,
+                agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::StateItem* items, size_t count) {
+    return track([&presence, channelName, channelType, items, count](uint64_t& id) {
+      presence.setState(channelName, channelType, items, count, id);
+    }, agora::rtm::RTM_ERROR_PRESENCE_OPERATION_TIMEOUT);
+  }
+
+  /// Advances the deadline wheel and resumes every request past its deadline. Returns how many timed out.
+  size_t poll(RtmClock::time_point now);
+  /// Requests currently awaited.
+  size_t size() const;
+  Stats stats() const;
+
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveResult(const uint64_t requestId, const char* channelName, const char* userId,
+                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishTopicMessageResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                         const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLeaveTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                          const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                              const char* topic, agora::rtm::UserList succeedUsers, agora::rtm::UserList failedUsers,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetSubscribedUserListResult(const uint64_t requestId, const char* channelName, const char* topic,
+                                     agora::rtm::UserList users, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeResult(const uint64_t requestId, const char* channelName,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLoginResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onLogoutResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRenewTokenResult(const uint64_t requestId, agora::rtm::RTM_SERVICE_TYPE serverType, const char* channelName,
+                          agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetUserMetadataResult(const uint64_t requestId, const char* userId,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveUserMetadataResult(const uint64_t requestId, const char* userId,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserMetadataResult(const uint64_t requestId, const char* userId, const agora::rtm::Metadata& data,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUnsubscribeUserMetadataResult(const uint64_t requestId, const char* userId,
+                                       agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSetLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                       const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onRemoveLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onReleaseLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onAcquireLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                           const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode,
+                           const char* errorDetails) override;
+  void onRevokeLockResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                          const char* lockName, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetLocksResult(const uint64_t requestId, const char* channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+                        const agora::rtm::LockDetail* lockDetailList, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetOnlineUsersResult(const uint64_t requestId, const agora::rtm::UserState* userStateList,
+                              const size_t count, const char* nextPage,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onWhereNowResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                        agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onGetUserChannelsResult(const uint64_t requestId, const agora::rtm::ChannelInfo* channels, const size_t count,
+                               agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceRemoveStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onPresenceGetStateResult(const uint64_t requestId, const agora::rtm::UserState& state,
+                                agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Slot {
+    std::coroutine_handle<> handle;
+    agora::rtm::RTM_ERROR_CODE* result = nullptr;
+    agora::rtm::RTM_ERROR_CODE timeoutCode = agora::rtm::RTM_ERROR_OK;
+    TimingWheel::TimerId timer = 0;
+  };
+
+  /// False when the result is already known and written to `result`: the caller resumes at once.
+  bool park(uint64_t requestId, std::coroutine_handle<> handle, agora::rtm::RTM_ERROR_CODE& result,
+            agora::rtm::RTM_ERROR_CODE timeoutCode, std::chrono::milliseconds timeout);
+  void complete(uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode);
+
+  Options options_;
+  mutable std::mutex mutex_;
+  TimingWheel wheel_;
+  /// requestId -> index into `slots_`.
+  RequestIdTable<uint32_t> pending_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> freeSlots_;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  std::vector<uint64_t> expired_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
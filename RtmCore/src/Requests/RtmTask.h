@@ -0,0 +1,29 @@
+//
+//  RtmTask.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+
+namespace flat {
+namespace rtm {
+
+/// Fire-and-forget coroutine return type: runs eagerly up to its first suspension and frees its own frame
+/// when it finishes. Exceptions terminate, as RtmCore reports failures through `RTM_ERROR_CODE`.
+struct RtmTask {
+  struct promise_type {
+    RtmTask get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+}  // namespace rtm
+}  // namespace flat
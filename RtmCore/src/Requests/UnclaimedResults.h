@@ -0,0 +1,59 @@
+//
+//  UnclaimedResults.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Requests/RequestIdTable.h"
+
+namespace flat {
+namespace rtm {
+
+/// Results that arrived before their request's id was known to the caller. The SDK reports the id through the
+/// call's out-parameter but may deliver the result on its own thread before the call returns, so a component
+/// that matches results by id keeps the ones it cannot place yet and claims them with `take` once the call
+/// has returned.
+///
+/// Bounded: once `capacity` results are kept, each new one evicts the oldest, which counts as `dropped()`.
+/// A capacity of 0 keeps nothing. Not thread-safe: guard it with the owner's lock.
+template <typename Result>
+class UnclaimedResults {
+ public:
+  explicit UnclaimedResults(size_t capacity)
+      : results_(capacity * 2), order_(capacity > 0 ? capacity : 1, 0), capacity_(capacity) {}
+
+  /// Keeps `result` for `requestId`. A second result for an id already kept is ignored.
+  void keep(uint64_t requestId, Result result) {
+    if (capacity_ == 0 || requestId == 0 || results_.find(requestId)) return;
+    uint64_t& oldest = order_[next_];
+    if (results_.erase(oldest)) ++dropped_;
+    oldest = requestId;
+    next_ = (next_ + 1) % order_.size();
+    results_.insert(requestId, std::move(result));
+  }
+
+  /// Moves the result kept for `requestId` into `result` and forgets it.
+  bool take(uint64_t requestId, Result& result) { return results_.take(requestId, result); }
+
+  size_t size() const { return results_.size(); }
+  /// Results evicted before anyone claimed them.
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  RequestIdTable<Result> results_;
+  /// Arrival order, for eviction. May name ids that were claimed since.
+  std::vector<uint64_t> order_;
+  size_t next_ = 0;
+  size_t capacity_;
+  uint64_t dropped_ = 0;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,366 @@
+//
+//  RtmClientPool.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Session/RtmClientPool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Events/ForwardingRtmEventHandler.h"
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+/// Sits between a session's queue and the bot's handler, on the shard thread, to keep shed logins from the bot.
+class RtmClientPool::SessionHandler final : public ForwardingRtmEventHandler {
+ public:
+  SessionHandler(RtmClientPool& pool, Session& session, IRtmEventHandler& next)
+      : ForwardingRtmEventHandler(next), pool_(pool), session_(session) {}
+
+  void onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) override {
+    if (pool_.loginResult(session_, errorCode)) ForwardingRtmEventHandler::onLoginResult(requestId, errorCode);
+  }
+
+  void onLogoutResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) override {
+    if (errorCode == RTM_ERROR_OK) pool_.loggedOut(session_);
+    ForwardingRtmEventHandler::onLogoutResult(requestId, errorCode);
+  }
+
+ private:
+  RtmClientPool& pool_;
+  Session& session_;
+};
+
+struct RtmClientPool::Session : std::enable_shared_from_this<Session> {
+  Session(RtmClientPool& pool, SessionId id, std::string token, IRtmEventHandler& target)
+      : id(id), shard(pool.shardOf(id)), token(std::move(token)), handler(pool, *this, target) {
+    QueuedRtmEventHandler::Options queueOptions;
+    queueOptions.capacity = pool.options_.queueCapacity;
+    queueOptions.maxBatch = pool.options_.maxBatch;
+    queueOptions.overflow = pool.options_.overflow;
+    queueOptions.pool = &pool.arenas_;
+    queueOptions.notify = [&pool, this] { pool.schedule(*this); };
+    queue = std::make_unique<QueuedRtmEventHandler>(handler, queueOptions);
+  }
+
+  const SessionId id;
+  const size_t shard;
+  const std::string token;
+  SessionHandler handler;
+  std::unique_ptr<QueuedRtmEventHandler> queue;
+
+  /// Held by `poll` while it logs in, so `remove` cannot release the client underneath it.
+  std::mutex clientMutex;
+  IRtmClient* client = nullptr;
+  /// Held by the shard while it delivers, so no callback outlives `remove`.
+  std::mutex deliverMutex;
+  bool removed = false;
+  /// Whether the session is on its shard's ready ring.
+  std::atomic<bool> scheduled{false};
+
+  // Guarded by the pool's mutex.
+  LoginState login = LoginState::waiting;
+  uint32_t attempts = 0;
+};
+
+RtmClientPool::RtmClientPool(RtmClock::time_point now) : RtmClientPool(now, Options()) {}
+
+RtmClientPool::RtmClientPool(RtmClock::time_point now, Options options)
+    : options_(std::move(options)),
+      arenas_(options_.arenas ? *options_.arenas : RtmEventBlockPool::shared()),
+      userIds_(options_.userIds ? *options_.userIds : UserIdTable::shared()),
+      now_(now),
+      random_(options_.seed != 0 ? options_.seed : std::random_device()()),
+      loginTokens_(static_cast<double>(options_.loginBurst)),
+      refilledAt_(now) {
+  // Each session is on its shard's ring at most once, so a ring never needs more slots than the pool has sessions.
+  size_t shardCount = std::max<size_t>(options_.shards, 1);
+  for (size_t i = 0; i < shardCount; ++i) shards_.push_back(std::make_unique<Shard>(options_.maxSessions));
+}
+
+RtmClientPool::~RtmClientPool() {
+  stop();
+  std::unordered_map<SessionId, SessionPtr> sessions;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    sessions.swap(sessions_);
+  }
+  for (auto& entry : sessions) {
+    std::lock_guard<std::mutex> guard(entry.second->clientMutex);
+    if (entry.second->client) entry.second->client->release();
+    entry.second->client = nullptr;
+  }
+  SessionPtr session;
+  for (auto& shard : shards_) {
+    while (shard->ready.tryPop(session)) session.reset();
+  }
+}
+
+RtmClientPool::SessionId RtmClientPool::add(const RtmConfig& config, std::string token, IRtmEventHandler& handler,
+                                            int& errorCode) {
+  SessionId id = userIds_.intern(config.userId);
+  if (id == kInvalidSession) {
+    errorCode = RTM_ERROR_INVALID_USER_ID;
+    return kInvalidSession;
+  }
+  auto admissible = [this, id, &errorCode] {
+    if (sessions_.count(id) > 0) {
+      errorCode = RTM_ERROR_DUPLICATE_OPERATION;
+    } else if (sessions_.size() >= options_.maxSessions) {
+      errorCode = RTM_ERROR_LOGIN_NO_SERVER_RESOURCES;
+    } else {
+      return true;
+    }
+    return false;
+  };
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!admissible()) return kInvalidSession;
+  }
+
+  SessionPtr session = std::make_shared<Session>(*this, id, std::move(token), handler);
+  RtmConfig sessionConfig = config;
+  sessionConfig.eventHandler = session->queue.get();
+  errorCode = RTM_ERROR_OK;
+  IRtmClient* client =
+      options_.create ? options_.create(sessionConfig, errorCode) : createAgoraRtmClient(sessionConfig, errorCode);
+  if (!client) {
+    if (errorCode == RTM_ERROR_OK) errorCode = RTM_ERROR_NOT_INITIALIZED;
+    return kInvalidSession;
+  }
+  session->client = client;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Another add of the same user may have won while the client was created.
+    if (admissible()) {
+      sessions_.emplace(id, session);
+      queueLoginLocked(id, now_);
+      return id;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> guard(session->deliverMutex);
+    session->removed = true;
+  }
+  client->release();
+  return kInvalidSession;
+}
+
+bool RtmClientPool::remove(SessionId id) {
+  SessionPtr session;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = sessions_.find(id);
+    if (found == sessions_.end()) return false;
+    session = std::move(found->second);
+    sessions_.erase(found);
+  }
+  {
+    std::lock_guard<std::mutex> guard(session->clientMutex);
+    session->client->release();
+    session->client = nullptr;
+  }
+  // Whatever the client queued on its way out is dropped with the session.
+  std::lock_guard<std::mutex> guard(session->deliverMutex);
+  session->removed = true;
+  return true;
+}
+
+IRtmClient* RtmClientPool::client(SessionId id) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = sessions_.find(id);
+  return found == sessions_.end() ? nullptr : found->second->client;
+}
+
+bool RtmClientPool::online(SessionId id) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = sessions_.find(id);
+  return found != sessions_.end() && found->second->login == LoginState::online;
+}
+
+void RtmClientPool::start() {
+  if (running_.exchange(true)) return;
+  for (auto& shard : shards_) {
+    Shard* served = shard.get();
+    shard->thread = std::thread([this, served] { run(*served); });
+  }
+}
+
+void RtmClientPool::stop() {
+  if (!running_.exchange(false)) return;
+  for (auto& shard : shards_) {
+    shard->wakeups.fetch_add(1, std::memory_order_seq_cst);
+    shard->wakeups.notify_one();
+  }
+  for (auto& shard : shards_) shard->thread.join();
+}
+
+size_t RtmClientPool::drain(size_t shard, size_t maxEvents) {
+  Shard& served = *shards_[shard];
+  size_t delivered = 0;
+  while (delivered < maxEvents) {
+    size_t count = serve(served, maxEvents - delivered);
+    delivered += count;
+    if (count == 0 && served.ready.size() == 0) break;
+  }
+  return delivered;
+}
+
+size_t RtmClientPool::poll(RtmClock::time_point now) {
+  std::vector<SessionPtr> due;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    now_ = now;
+    refillLocked();
+    bool paced = options_.loginsPerSecond > 0;
+    while (!logins_.empty() && logins_.front().dueAt <= now_ && (!paced || loginTokens_ >= 1)) {
+      std::pop_heap(logins_.begin(), logins_.end(), std::greater<>());
+      SessionId id = logins_.back().id;
+      logins_.pop_back();
+      auto found = sessions_.find(id);
+      if (found == sessions_.end() || found->second->login != LoginState::waiting) continue;
+      Session& session = *found->second;
+      session.login = LoginState::sent;
+      ++session.attempts;
+      if (paced) loginTokens_ -= 1;
+      ++stats_.logins;
+      due.push_back(found->second);
+    }
+  }
+  for (const SessionPtr& session : due) {
+    std::lock_guard<std::mutex> guard(session->clientMutex);
+    if (!session->client) continue;
+    uint64_t requestId = 0;
+    session->client->login(session->token.c_str(), requestId);
+  }
+  return due.size();
+}
+
+RtmClock::time_point RtmClientPool::nextDeadline() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (logins_.empty()) return RtmClock::time_point::max();
+  RtmClock::time_point deadline = logins_.front().dueAt;
+  if (options_.loginsPerSecond > 0 && loginTokens_ < 1) {
+    std::chrono::duration<double> refill((1 - loginTokens_) / options_.loginsPerSecond);
+    deadline = std::max(deadline, refilledAt_ + std::chrono::ceil<RtmClock::duration>(refill));
+  }
+  return deadline;
+}
+
+RtmClientPool::Stats RtmClientPool::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  stats.sessions = sessions_.size();
+  for (const auto& entry : sessions_) {
+    const Session& session = *entry.second;
+    if (session.login == LoginState::online) ++stats.online;
+    if (session.login == LoginState::waiting) ++stats.waiting;
+    QueuedRtmEventHandler::Stats queue = session.queue->stats();
+    stats.delivered += queue.delivered;
+    stats.dropped += queue.dropped;
+  }
+  return stats;
+}
+
+// MARK: - Private
+
+void RtmClientPool::schedule(Session& session) {
+  if (session.scheduled.exchange(true, std::memory_order_seq_cst)) return;
+  Shard& shard = *shards_[session.shard];
+  SessionPtr ready = session.shared_from_this();
+  while (!shard.ready.tryPush(ready)) std::this_thread::yield();
+  // Pairs with the seq_cst sleep flag in run(), as in QueuedRtmEventHandler.
+  shard.wakeups.fetch_add(1, std::memory_order_seq_cst);
+  if (shard.sleeping.load(std::memory_order_seq_cst)) shard.wakeups.notify_one();
+}
+
+size_t RtmClientPool::serve(Shard& shard, size_t maxEvents) {
+  size_t delivered = 0;
+  SessionPtr session;
+  // Sessions rescheduled along the way wait for the next pass, behind the others.
+  for (size_t ready = shard.ready.size(); ready > 0 && delivered < maxEvents && shard.ready.tryPop(session);
+       --ready) {
+    bool removed;
+    {
+      std::lock_guard<std::mutex> guard(session->deliverMutex);
+      removed = session->removed;
+      if (!removed) {
+        // A read-modify-write, so a producer that found the flag still set has its callback seen by the drain.
+        session->scheduled.exchange(false, std::memory_order_seq_cst);
+        delivered += session->queue->drain(std::min(options_.maxBatch, maxEvents - delivered));
+      }
+    }
+    if (!removed && session->queue->depth() > 0) schedule(*session);
+    session.reset();
+  }
+  return delivered;
+}
+
+void RtmClientPool::run(Shard& shard) {
+  for (;;) {
+    if (serve(shard, SIZE_MAX) > 0 || shard.ready.size() > 0) continue;
+    if (!running_.load(std::memory_order_acquire)) {
+      // A final pass for anything queued between the empty check and stop().
+      while (serve(shard, SIZE_MAX) > 0 || shard.ready.size() > 0) {
+      }
+      return;
+    }
+    uint32_t observed = shard.wakeups.load(std::memory_order_seq_cst);
+    shard.sleeping.store(true, std::memory_order_seq_cst);
+    if (shard.ready.size() == 0 && running_.load(std::memory_order_acquire)) shard.wakeups.wait(observed);
+    shard.sleeping.store(false, std::memory_order_relaxed);
+  }
+}
+
+bool RtmClientPool::loginResult(Session& session, RTM_ERROR_CODE errorCode) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (errorCode == RTM_ERROR_OK) {
+    session.login = LoginState::online;
+    return true;
+  }
+  if (session.login != LoginState::sent) return true;
+  bool shed = errorCode == RTM_ERROR_LOGIN_NO_SERVER_RESOURCES || errorCode == RTM_ERROR_LOGIN_TIMEOUT;
+  if (shed && session.attempts < options_.maxLoginAttempts && sessions_.count(session.id) > 0) {
+    session.login = LoginState::waiting;
+    ++stats_.loginRetries;
+    queueLoginLocked(session.id, now_ + backoffLocked(session.attempts));
+    return false;
+  }
+  session.login = LoginState::offline;
+  ++stats_.loginFailures;
+  return true;
+}
+
+void RtmClientPool::loggedOut(Session& session) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  session.login = LoginState::offline;
+}
+
+void RtmClientPool::refillLocked() {
+  if (now_ <= refilledAt_) return;
+  double refill = options_.loginsPerSecond * std::chrono::duration<double>(now_ - refilledAt_).count();
+  loginTokens_ = std::min(static_cast<double>(options_.loginBurst), loginTokens_ + refill);
+  refilledAt_ = now_;
+}
+
+void RtmClientPool::queueLoginLocked(SessionId id, RtmClock::time_point dueAt) {
+  logins_.push_back({dueAt, ++loginSequence_, id});
+  std::push_heap(logins_.begin(), logins_.end(), std::greater<>());
+}
+
+RtmClock::duration RtmClientPool::backoffLocked(uint32_t attempts) {
+  RtmClock::duration ceiling = options_.retryBackoff;
+  for (uint32_t i = 1; i < attempts && ceiling < options_.maxRetryBackoff; ++i) ceiling *= 2;
+  ceiling = std::min(ceiling, options_.maxRetryBackoff);
+  std::uniform_int_distribution<RtmClock::rep> jitter(ceiling.count() / 2, ceiling.count());
+  return RtmClock::duration(jitter(random_));
+}
+
+}  // namespace rtm
+}  // namespace flat
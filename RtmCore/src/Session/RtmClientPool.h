@@ -0,0 +1,191 @@
+//
+//  RtmClientPool.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/MpscRing.h"
+#include "Common/RtmClock.h"
+#include "Common/UserIdTable.h"
+#include "Events/QueuedRtmEventHandler.h"
+#include "Events/RtmEventArena.h"
+#include "IAgoraRtmClient.h"
+
+namespace flat {
+namespace rtm {
+
+/// Hosts many `IRtmClient` sessions in one process, for server-side bots, on a fixed set of event-loop threads.
+///
+/// Each session's callbacks go through its own `QueuedRtmEventHandler` and are delivered on the thread of the
+/// session's shard, always the same one, so a bot's handler never runs on two threads and needs no lock of its
+/// own. A shard serves its ready sessions in turn, `Options::maxBatch` callbacks each, so a busy room cannot starve
+/// the quiet ones. All sessions copy their callbacks into one `RtmEventBlockPool` and are named by the handle of
+/// their user id in one `UserIdTable`, which the bots can share for their own rosters.
+///
+/// Logins do not go out when a session is added: `poll` sends them at `Options::loginsPerSecond` after a burst of
+/// `Options::loginBurst`, so a restart of thousands of bots does not storm the service. A login the service still
+/// sheds with `RTM_ERROR_LOGIN_NO_SERVER_RESOURCES` or `RTM_ERROR_LOGIN_TIMEOUT` is queued again after an
+/// exponential backoff with jitter; the bot only sees its link state going to FAILED and back, and the login
+/// result once it is final. Times are those of the last `poll`.
+class RtmClientPool {
+ public:
+  /// The handle of the session's user id in `userIds()`.
+  using SessionId = UserIdTable::UserHandle;
+  static constexpr SessionId kInvalidSession = UserIdTable::kNoUser;
+  using ClientFactory = std::function<agora::rtm::IRtmClient*(const agora::rtm::RtmConfig& config, int& errorCode)>;
+
+  struct Options {
+    /// Event-loop threads; sessions are spread over them by id.
+    size_t shards = 4;
+    size_t maxSessions = 16384;
+    /// Queued callbacks per session.
+    size_t queueCapacity = 1024;
+    /// Callbacks delivered for one session before its shard moves on to the next.
+    size_t maxBatch = 64;
+    QueuedRtmEventHandler::OverflowPolicy overflow = QueuedRtmEventHandler::OverflowPolicy::dropNewest;
+    /// Logins sent per second once the burst is spent; 0 sends every due login at once.
+    double loginsPerSecond = 50;
+    size_t loginBurst = 10;
+    /// Wait before a shed login is sent again, doubled for each further attempt up to `maxRetryBackoff`. Each
+    /// wait is drawn uniformly from its upper half.
+    RtmClock::duration retryBackoff = std::chrono::seconds(1);
+    RtmClock::duration maxRetryBackoff = std::chrono::seconds(30);
+    /// Logins per session, first one included, before the result is handed to the bot.
+    uint32_t maxLoginAttempts = 8;
+    /// Seed of the jitter; 0 seeds from `std::random_device`.
+    uint32_t seed = 0;
+    /// Null means `RtmEventBlockPool::shared()`.
+    RtmEventBlockPool* arenas = nullptr;
+    /// Null means `UserIdTable::shared()`.
+    UserIdTable* userIds = nullptr;
+    /// Creates the clients; empty means `createAgoraRtmClient`.
+    ClientFactory create;
+  };
+
+  struct Stats {
+    size_t sessions = 0;
+    size_t online = 0;
+    /// Sessions whose login has not been sent yet, or is waiting out a backoff.
+    size_t waiting = 0;
+    uint64_t logins = 0;
+    uint64_t loginRetries = 0;
+    /// Logins that failed for good.
+    uint64_t loginFailures = 0;
+    /// Callbacks delivered and dropped by the queues of the current sessions.
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+  };
+
+  explicit RtmClientPool(RtmClock::time_point now);
+  RtmClientPool(RtmClock::time_point now, Options options);
+  /// Stops the shards and releases every client.
+  ~RtmClientPool();
+
+  RtmClientPool(const RtmClientPool&) = delete;
+  RtmClientPool& operator=(const RtmClientPool&) = delete;
+
+  /// Creates a client for `config` whose callbacks reach `handler` on the session's shard, and queues its login
+  /// with `token`. `config.eventHandler` is replaced. `kInvalidSession` when the user already has a session
+  /// (`RTM_ERROR_DUPLICATE_OPERATION`), the pool is full (`RTM_ERROR_LOGIN_NO_SERVER_RESOURCES`) or the factory
+  /// failed. `handler` must outlive the session.
+  SessionId add(const agora::rtm::RtmConfig& config, std::string token, agora::rtm::IRtmEventHandler& handler,
+                int& errorCode);
+  /// Releases the session's client. No callback reaches its handler once this returns; not to be called from
+  /// the session's own callbacks. False when there is no such session.
+  bool remove(SessionId id);
+
+  /// The session's client, for the bot's calls; null when there is no such session.
+  agora::rtm::IRtmClient* client(SessionId id) const;
+  size_t shardOf(SessionId id) const { return id % shards_.size(); }
+  size_t shards() const { return shards_.size(); }
+  bool online(SessionId id) const;
+  UserIdTable& userIds() const { return userIds_; }
+  RtmEventBlockPool& arenas() const { return arenas_; }
+
+  /// Starts the shard threads. Idempotent.
+  void start();
+  /// Delivers everything already queued, then joins the shard threads.
+  void stop();
+  /// Delivers up to `maxEvents` of the shard's queued callbacks on the calling thread. Only valid while the
+  /// shard threads are not running. Returns the number delivered.
+  size_t drain(size_t shard, size_t maxEvents = SIZE_MAX);
+
+  /// Sends the logins that are due and within the rate. Returns the logins sent.
+  size_t poll(RtmClock::time_point now);
+  /// When the next login may go out, or `time_point::max()` when none is waiting.
+  RtmClock::time_point nextDeadline() const;
+  Stats stats() const;
+
+ private:
+  class SessionHandler;
+  struct Session;
+  using SessionPtr = std::shared_ptr<Session>;
+
+  enum class LoginState : uint8_t { waiting, sent, online, offline };
+
+  struct Shard {
+    explicit Shard(size_t capacity) : ready(capacity) {}
+    /// Sessions with queued callbacks, each at most once.
+    MpscRing<SessionPtr> ready;
+    std::thread thread;
+    std::atomic<bool> sleeping{false};
+    std::atomic<uint32_t> wakeups{0};
+  };
+
+  struct Login {
+    RtmClock::time_point dueAt;
+    uint64_t sequence;
+    SessionId id;
+    /// Min-heap order on (`dueAt`, `sequence`), so logins due together go out in the order they were queued.
+    bool operator>(const Login& other) const {
+      return dueAt != other.dueAt ? dueAt > other.dueAt : sequence > other.sequence;
+    }
+  };
+
+  /// Producer side: puts the session on its shard's ready ring unless it is already there.
+  void schedule(Session& session);
+  /// Serves the sessions ready on entry. Returns the callbacks delivered.
+  size_t serve(Shard& shard, size_t maxEvents);
+  void run(Shard& shard);
+  /// Shard side. False when the result is swallowed because the login is sent again.
+  bool loginResult(Session& session, agora::rtm::RTM_ERROR_CODE errorCode);
+  void loggedOut(Session& session);
+  void refillLocked();
+  void queueLoginLocked(SessionId id, RtmClock::time_point dueAt);
+  RtmClock::duration backoffLocked(uint32_t attempts);
+
+  const Options options_;
+  RtmEventBlockPool& arenas_;
+  UserIdTable& userIds_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<bool> running_{false};
+
+  mutable std::mutex mutex_;
+  RtmClock::time_point now_;
+  std::minstd_rand random_;
+  std::unordered_map<SessionId, SessionPtr> sessions_;
+  /// Min-heap of logins to send; entries of removed or already sent sessions are skipped when popped.
+  std::vector<Login> logins_;
+  uint64_t loginSequence_ = 0;
+  double loginTokens_;
+  RtmClock::time_point refilledAt_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
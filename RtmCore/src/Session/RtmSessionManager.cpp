@@ -0,0 +1,555 @@
+//
+//  RtmSessionManager.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Session/RtmSessionManager.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+/// Channel names cannot hold control characters, so the separator keeps the channel apart from the topic.
+std::string opKey(uint8_t kind, std::string_view channelName, std::string_view topic) {
+  std::string key(1, static_cast<char>('0' + kind));
+  key += ':';
+  key.append(channelName);
+  key += '\x1f';
+  key.append(topic);
+  return key;
+}
+
+std::vector<std::string> usersOf(const TopicOptions& options) {
+  std::vector<std::string> users;
+  for (size_t i = 0; i < options.userCount && options.users; ++i) {
+    if (options.users[i]) users.emplace_back(options.users[i]);
+  }
+  return users;
+}
+
+}  // namespace
+
+RtmSessionManager::RtmSessionManager(IRtmClient& client, RtmClock::time_point now)
+    : RtmSessionManager(client, now, Options()) {}
+
+RtmSessionManager::RtmSessionManager(IRtmClient& client, RtmClock::time_point now, Options options)
+    : client_(client),
+      options_(std::move(options)),
+      now_(now),
+      random_(options_.seed != 0 ? options_.seed : std::random_device()()),
+      unclaimed_(options_.unclaimedCapacity),
+      downSince_(now) {}
+
+void RtmSessionManager::subscribe(const char* channelName, const SubscribeOptions& options, uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    subscriptions_.insert_or_assign(std::string(viewOf(channelName)), options);
+    // The app's own call supersedes a restore call that has not gone out yet.
+    auto found = ops_.find(opKey(static_cast<uint8_t>(OpKind::subscribe), viewOf(channelName), {}));
+    if (found != ops_.end() && found->second.state != OpState::inFlight) ops_.erase(found);
+    finishLocked(effects);
+  }
+  client_.subscribe(channelName, options, requestId);
+  run(effects);
+}
+
+void RtmSessionManager::unsubscribe(const char* channelName, uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = subscriptions_.find(viewOf(channelName));
+    if (found != subscriptions_.end()) subscriptions_.erase(found);
+    pruneLocked(effects);
+  }
+  client_.unsubscribe(channelName, requestId);
+  run(effects);
+}
+
+void RtmSessionManager::join(IStreamChannel& channel, const JoinChannelOptions& options, uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::string_view channelName = viewOf(channel.getChannelName());
+    Stream& stream = streams_[std::string(channelName)];
+    stream.channel = &channel;
+    stream.options = options;
+    stream.token.assign(viewOf(options.token));
+    auto found = ops_.find(opKey(static_cast<uint8_t>(OpKind::join), channelName, {}));
+    if (found != ops_.end() && found->second.state != OpState::inFlight) ops_.erase(found);
+    finishLocked(effects);
+  }
+  channel.join(options, requestId);
+  run(effects);
+}
+
+void RtmSessionManager::renewToken(IStreamChannel& channel, const char* token, uint64_t& requestId) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = streams_.find(viewOf(channel.getChannelName()));
+    if (found != streams_.end()) found->second.token.assign(viewOf(token));
+  }
+  channel.renewToken(token, requestId);
+}
+
+void RtmSessionManager::leave(IStreamChannel& channel, uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = streams_.find(viewOf(channel.getChannelName()));
+    if (found != streams_.end()) streams_.erase(found);
+    pruneLocked(effects);
+  }
+  channel.leave(requestId);
+  run(effects);
+}
+
+void RtmSessionManager::joinTopic(IStreamChannel& channel, const char* topic, const JoinTopicOptions& options,
+                                  uint64_t& requestId) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = streams_.find(viewOf(channel.getChannelName()));
+    if (found != streams_.end()) {
+      Topic& entry = found->second.topics[std::string(viewOf(topic))];
+      entry.joined = true;
+      entry.options = options;
+      entry.meta.assign(viewOf(options.meta));
+    }
+  }
+  channel.joinTopic(topic, options, requestId);
+}
+
+void RtmSessionManager::leaveTopic(IStreamChannel& channel, const char* topic, uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (Topic* entry = findTopicLocked(viewOf(channel.getChannelName()), viewOf(topic))) {
+      entry->joined = false;
+      if (!entry->subscribed) streams_.find(viewOf(channel.getChannelName()))->second.topics.erase(std::string(topic));
+    }
+    pruneLocked(effects);
+  }
+  channel.leaveTopic(topic, requestId);
+  run(effects);
+}
+
+void RtmSessionManager::subscribeTopic(IStreamChannel& channel, const char* topic, const TopicOptions& options,
+                                       uint64_t& requestId) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = streams_.find(viewOf(channel.getChannelName()));
+    if (found != streams_.end()) {
+      Topic& entry = found->second.topics[std::string(viewOf(topic))];
+      entry.subscribed = true;
+      for (std::string& user : usersOf(options)) {
+        if (std::find(entry.users.begin(), entry.users.end(), user) == entry.users.end()) {
+          entry.users.push_back(std::move(user));
+        }
+      }
+    }
+  }
+  channel.subscribeTopic(topic, options, requestId);
+}
+
+void RtmSessionManager::unsubscribeTopic(IStreamChannel& channel, const char* topic, const TopicOptions& options,
+                                         uint64_t& requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (Topic* entry = findTopicLocked(viewOf(channel.getChannelName()), viewOf(topic))) {
+      std::vector<std::string> users = usersOf(options);
+      for (const std::string& user : users) {
+        entry->users.erase(std::remove(entry->users.begin(), entry->users.end(), user), entry->users.end());
+      }
+      if (users.empty() || entry->users.empty()) entry->subscribed = false;
+      if (!entry->subscribed && !entry->joined) {
+        streams_.find(viewOf(channel.getChannelName()))->second.topics.erase(std::string(topic));
+      }
+    }
+    pruneLocked(effects);
+  }
+  channel.unsubscribeTopic(topic, options, requestId);
+  run(effects);
+}
+
+bool RtmSessionManager::restoring() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return restoring_;
+}
+
+size_t RtmSessionManager::poll(RtmClock::time_point now) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    now_ = now;
+    for (auto& entry : ops_) {
+      Op& op = entry.second;
+      if (op.state == OpState::backoff && op.notBefore <= now) {
+        op.state = OpState::ready;
+        ready_.push_back(entry.first);
+      }
+    }
+    pumpLocked(effects);
+    finishLocked(effects);
+  }
+  size_t calls = effects.calls.size();
+  run(effects);
+  return calls;
+}
+
+RtmClock::time_point RtmSessionManager::nextDeadline() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  RtmClock::time_point deadline = RtmClock::time_point::max();
+  for (const auto& entry : ops_) {
+    if (entry.second.state == OpState::backoff) deadline = std::min(deadline, entry.second.notBefore);
+  }
+  return deadline;
+}
+
+RtmSessionManager::Stats RtmSessionManager::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  stats.subscriptions = subscriptions_.size();
+  stats.streamChannels = streams_.size();
+  for (const auto& entry : streams_) stats.topics += entry.second.topics.size();
+  stats.pending = ops_.size();
+  return stats;
+}
+
+// MARK: - Events
+
+void RtmSessionManager::onLinkStateEvent(const LinkStateEvent& event) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    switch (event.currentState) {
+      case RTM_LINK_STATE_CONNECTED: {
+        connected_ = true;
+        if (event.operation != RTM_LINK_OPERATION_RECONNECTED) {
+          down_ = false;
+          break;
+        }
+        ++stats_.reconnects;
+        // Calls that were out when the link dropped may never be answered; send them again.
+        for (auto& entry : ops_) {
+          if (entry.second.state != OpState::inFlight) continue;
+          entry.second.state = OpState::ready;
+          ready_.push_back(entry.first);
+        }
+        inFlight_ = 0;
+        if (!down_) downSince_ = now_;
+        if (!event.isResumed) {
+          for (const auto& subscription : subscriptions_) queueLocked(OpKind::subscribe, subscription.first, {});
+          for (const auto& stream : streams_) queueLocked(OpKind::join, stream.first, {});
+        } else if (event.unrestoredChannelCount > 0 && event.unrestoredChannels) {
+          for (size_t i = 0; i < event.unrestoredChannelCount; ++i) {
+            queueChannelLocked(std::string(viewOf(event.unrestoredChannels[i])));
+          }
+        }
+        if (event.isResumed && ops_.empty()) {
+          ++stats_.resumed;
+        } else if (!restoring_) {
+          ++stats_.restores;
+        }
+        if (!restoring_) restoreFailed_ = 0;
+        // finishLocked reports the restore, at once when the service resumed everything.
+        restoring_ = true;
+        break;
+      }
+      case RTM_LINK_STATE_CONNECTING:
+      case RTM_LINK_STATE_DISCONNECTED:
+      case RTM_LINK_STATE_SUSPENDED:
+        // A drop during a restore keeps the time of the first one.
+        if (connected_ && !down_) downSince_ = now_;
+        connected_ = false;
+        down_ = true;
+        break;
+      default:
+        // Logged out, kicked or failed: there is no session to restore into.
+        connected_ = false;
+        down_ = false;
+        restoring_ = false;
+        ops_.clear();
+        ready_.clear();
+        inFlight_ = 0;
+        break;
+    }
+    pumpLocked(effects);
+    finishLocked(effects);
+  }
+  run(effects);
+}
+
+void RtmSessionManager::onSubscribeResult(const uint64_t requestId, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmSessionManager::onJoinResult(const uint64_t requestId, const char*, const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmSessionManager::onJoinTopicResult(const uint64_t requestId, const char*, const char*, const char*,
+                                          const char*, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+void RtmSessionManager::onSubscribeTopicResult(const uint64_t requestId, const char*, const char*, const char*,
+                                               UserList, UserList, RTM_ERROR_CODE errorCode) {
+  complete(requestId, errorCode);
+}
+
+// MARK: - Private
+
+RtmSessionManager::Topic* RtmSessionManager::findTopicLocked(std::string_view channelName, std::string_view topic) {
+  auto stream = streams_.find(channelName);
+  if (stream == streams_.end()) return nullptr;
+  auto found = stream->second.topics.find(topic);
+  return found == stream->second.topics.end() ? nullptr : &found->second;
+}
+
+void RtmSessionManager::pruneLocked(Effects& effects) {
+  for (auto op = ops_.begin(); op != ops_.end();) {
+    op = op->second.state != OpState::inFlight && !wantedLocked(op->second) ? ops_.erase(op) : std::next(op);
+  }
+  finishLocked(effects);
+}
+
+void RtmSessionManager::queueLocked(OpKind kind, std::string_view channelName, std::string_view topic) {
+  std::string key = opKey(static_cast<uint8_t>(kind), channelName, topic);
+  auto inserted = ops_.try_emplace(key);
+  if (!inserted.second) return;
+  Op& op = inserted.first->second;
+  op.kind = kind;
+  op.channelName.assign(channelName);
+  op.topic.assign(topic);
+  ready_.push_back(std::move(key));
+}
+
+void RtmSessionManager::queueTopicsLocked(const std::string& channelName, const Stream& stream) {
+  for (const auto& entry : stream.topics) {
+    if (entry.second.joined) queueLocked(OpKind::joinTopic, channelName, entry.first);
+    if (entry.second.subscribed) queueLocked(OpKind::subscribeTopic, channelName, entry.first);
+  }
+}
+
+void RtmSessionManager::queueChannelLocked(const std::string& channelName) {
+  // The event does not say which kind of channel was lost; a name may be both.
+  if (subscriptions_.find(channelName) != subscriptions_.end()) queueLocked(OpKind::subscribe, channelName, {});
+  if (streams_.find(channelName) != streams_.end()) queueLocked(OpKind::join, channelName, {});
+}
+
+bool RtmSessionManager::wantedLocked(const Op& op) const {
+  switch (op.kind) {
+    case OpKind::subscribe:
+      return subscriptions_.find(op.channelName) != subscriptions_.end();
+    case OpKind::join:
+      return streams_.find(op.channelName) != streams_.end();
+    case OpKind::joinTopic:
+    case OpKind::subscribeTopic: {
+      auto stream = streams_.find(op.channelName);
+      if (stream == streams_.end()) return false;
+      auto topic = stream->second.topics.find(op.topic);
+      if (topic == stream->second.topics.end()) return false;
+      return op.kind == OpKind::joinTopic ? topic->second.joined : topic->second.subscribed;
+    }
+  }
+  return false;
+}
+
+RtmSessionManager::Call RtmSessionManager::callLocked(const Op& op) const {
+  Call call;
+  call.kind = op.kind;
+  call.channelName = op.channelName;
+  call.topic = op.topic;
+  if (op.kind == OpKind::subscribe) {
+    call.subscribeOptions = subscriptions_.find(op.channelName)->second;
+    return call;
+  }
+  const Stream& stream = streams_.find(op.channelName)->second;
+  call.channel = stream.channel;
+  switch (op.kind) {
+    case OpKind::join:
+      call.joinOptions = stream.options;
+      call.text = stream.token;
+      break;
+    case OpKind::joinTopic: {
+      const Topic& topic = stream.topics.find(op.topic)->second;
+      call.topicOptions = topic.options;
+      call.text = topic.meta;
+      break;
+    }
+    case OpKind::subscribeTopic:
+      call.users = stream.topics.find(op.topic)->second.users;
+      break;
+    default:
+      break;
+  }
+  return call;
+}
+
+void RtmSessionManager::pumpLocked(Effects& effects) {
+  while (connected_ && inFlight_ < options_.maxInFlight && !ready_.empty()) {
+    std::string key = std::move(ready_.front());
+    ready_.pop_front();
+    auto found = ops_.find(key);
+    if (found == ops_.end() || found->second.state != OpState::ready) continue;
+    Op& op = found->second;
+    if (!wantedLocked(op)) {
+      ops_.erase(found);
+      continue;
+    }
+    op.state = OpState::inFlight;
+    op.requestId = 0;
+    ++op.attempts;
+    ++inFlight_;
+    ++unreturned_;
+    ++stats_.calls;
+    stats_.peakInFlight = std::max(stats_.peakInFlight, inFlight_);
+    effects.calls.push_back(callLocked(op));
+  }
+}
+
+void RtmSessionManager::finishLocked(Effects& effects) {
+  if (!restoring_ || !connected_ || !ops_.empty()) return;
+  restoring_ = false;
+  down_ = false;
+  RtmClock::duration elapsed = now_ - downSince_;
+  stats_.lastTimeToRestore = elapsed;
+  stats_.maxTimeToRestore = std::max(stats_.maxTimeToRestore, elapsed);
+  effects.restored = true;
+  effects.timeToRestore = elapsed;
+  effects.failed = restoreFailed_;
+}
+
+void RtmSessionManager::complete(uint64_t requestId, RTM_ERROR_CODE errorCode) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::string key;
+    auto found = requestId != 0 && requests_.take(requestId, key) ? ops_.find(key) : ops_.end();
+    if (found == ops_.end() || found->second.state != OpState::inFlight || found->second.requestId != requestId) {
+      // A call is still being made; this may be its result.
+      if (unreturned_ > 0) unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    settleLocked(found, errorCode, effects);
+  }
+  run(effects);
+}
+
+void RtmSessionManager::issued(const Call& call, uint64_t requestId) {
+  Effects effects;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    --unreturned_;
+    std::string key = opKey(static_cast<uint8_t>(call.kind), call.channelName, call.topic);
+    auto found = ops_.find(key);
+    // Dropped while the call was made, when the session ended.
+    if (found == ops_.end() || found->second.state != OpState::inFlight || found->second.requestId != 0) return;
+    RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+    if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+      found->second.requestId = requestId;
+      requests_.insert(requestId, std::move(key));
+      return;
+    }
+    settleLocked(found, errorCode, effects);
+  }
+  run(effects);
+}
+
+void RtmSessionManager::settleLocked(StringMap<Op>::iterator found, RTM_ERROR_CODE errorCode, Effects& effects) {
+  Op& op = found->second;
+  --inFlight_;
+  if (errorCode == RTM_ERROR_OK) {
+    auto stream = op.kind == OpKind::join ? streams_.find(op.channelName) : streams_.end();
+    ops_.erase(found);
+    if (stream != streams_.end()) queueTopicsLocked(stream->first, stream->second);
+  } else if (op.attempts >= options_.maxAttempts) {
+    ops_.erase(found);
+    ++stats_.failed;
+    ++restoreFailed_;
+  } else {
+    op.state = OpState::backoff;
+    op.notBefore = now_ + backoffLocked(op.attempts);
+    ++stats_.retries;
+  }
+  pumpLocked(effects);
+  finishLocked(effects);
+}
+
+RtmClock::duration RtmSessionManager::backoffLocked(uint32_t attempts) {
+  RtmClock::duration ceiling = options_.backoff;
+  for (uint32_t i = 1; i < attempts && ceiling < options_.maxBackoff; ++i) ceiling *= 2;
+  ceiling = std::min(ceiling, options_.maxBackoff);
+  std::uniform_int_distribution<RtmClock::rep> jitter(ceiling.count() / 2, ceiling.count());
+  return RtmClock::duration(jitter(random_));
+}
+
+void RtmSessionManager::run(Effects& effects) {
+  if (effects.restored && options_.onRestored) options_.onRestored(effects.timeToRestore, effects.failed);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Results delivered while a call is still being made would otherwise nest one call per restored channel.
+    if (issuing_) {
+      std::move(effects.calls.begin(), effects.calls.end(), std::back_inserter(deferred_));
+      return;
+    }
+    issuing_ = true;
+  }
+  std::vector<Call> calls = std::move(effects.calls);
+  while (true) {
+    for (const Call& call : calls) issue(call);
+    std::lock_guard<std::mutex> guard(mutex_);
+    calls = std::move(deferred_);
+    deferred_.clear();
+    if (calls.empty()) {
+      issuing_ = false;
+      return;
+    }
+  }
+}
+
+void RtmSessionManager::issue(const Call& call) {
+  const char* channelName = call.channelName.c_str();
+  const char* topic = call.topic.c_str();
+  uint64_t requestId = 0;
+  switch (call.kind) {
+    case OpKind::subscribe:
+      client_.subscribe(channelName, call.subscribeOptions, requestId);
+      break;
+    case OpKind::join: {
+      JoinChannelOptions options = call.joinOptions;
+      options.token = call.text.empty() ? nullptr : call.text.c_str();
+      call.channel->join(options, requestId);
+      break;
+    }
+    case OpKind::joinTopic: {
+      JoinTopicOptions options = call.topicOptions;
+      options.meta = call.text.empty() ? nullptr : call.text.c_str();
+      call.channel->joinTopic(topic, options, requestId);
+      break;
+    }
+    case OpKind::subscribeTopic: {
+      std::vector<const char*> users;
+      for (const std::string& user : call.users) users.push_back(user.c_str());
+      TopicOptions options;
+      options.users = users.empty() ? nullptr : users.data();
+      options.userCount = users.size();
+      call.channel->subscribeTopic(topic, options, requestId);
+      break;
+    }
+  }
+  issued(call, requestId);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,224 @@
+//
+//  RtmSessionManager.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Remembers what the app subscribed and joined, and restores it after a reconnect that lost the session.
+///
+/// Subscriptions, stream channels and their topics go through the manager's `subscribe`, `join`, `joinTopic` and
+/// `subscribeTopic`, which record them and forward to the SDK. When `onLinkStateEvent` reports RECONNECTED without
+/// `isResumed`, everything recorded is subscribed and joined again; a resumed reconnect that still lists
+/// `unrestoredChannels` restores only those. The calls go out at once, `Options::maxInFlight` at a time, instead of
+/// one after another behind a fixed wait. A stream channel's topics follow as soon as its join succeeds. A failed
+/// call is retried after an exponential backoff with jitter, so many clients reconnecting together do not retry
+/// in step, and given up after `Options::maxAttempts`.
+///
+/// The time from the link dropping to the last restore call succeeding is kept in `Stats` and passed to
+/// `Options::onRestored`. Times are those of the last `poll`, which also sends the retries that are due; poll at
+/// least as often as the precision wanted from the metric.
+///
+/// Register the manager with the client's event handler. Results of the restore calls reach the app's handler
+/// too, under requestIds it never saw; the manager matches results by requestId alone, so the app's own calls
+/// on a channel being restored do not settle the restore. SDK calls and callbacks run without the manager's lock;
+/// stream channels must stay alive until they are left through the manager.
+class RtmSessionManager : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Options {
+    /// Restore calls awaiting their result at once.
+    size_t maxInFlight = 8;
+    /// Calls per channel or topic, first one included, before the manager gives up on it until the next reconnect.
+    uint32_t maxAttempts = 5;
+    /// Wait before the first retry, doubled for each further one up to `maxBackoff`. Each wait is drawn uniformly
+    /// from its upper half.
+    RtmClock::duration backoff = std::chrono::milliseconds(200);
+    RtmClock::duration maxBackoff = std::chrono::seconds(5);
+    /// Seed of the jitter; 0 seeds from `std::random_device`.
+    uint32_t seed = 0;
+    /// Runs when a reconnect is fully restored, with the time since the link dropped and the calls given up.
+    std::function<void(RtmClock::duration timeToRestore, size_t failed)> onRestored;
+    /// Results kept while a restore call is being made, in case one is its own.
+    size_t unclaimedCapacity = 8;
+  };
+
+  struct Stats {
+    uint64_t reconnects = 0;
+    /// Reconnects the service resumed entirely, with nothing to restore.
+    uint64_t resumed = 0;
+    uint64_t restores = 0;
+    uint64_t calls = 0;
+    uint64_t retries = 0;
+    uint64_t failed = 0;
+    size_t peakInFlight = 0;
+    RtmClock::duration lastTimeToRestore{0};
+    RtmClock::duration maxTimeToRestore{0};
+    size_t subscriptions = 0;
+    size_t streamChannels = 0;
+    size_t topics = 0;
+    /// Restore calls not finished yet.
+    size_t pending = 0;
+  };
+
+  RtmSessionManager(agora::rtm::IRtmClient& client, RtmClock::time_point now);
+  RtmSessionManager(agora::rtm::IRtmClient& client, RtmClock::time_point now, Options options);
+
+  RtmSessionManager(const RtmSessionManager&) = delete;
+  RtmSessionManager& operator=(const RtmSessionManager&) = delete;
+
+  void subscribe(const char* channelName, const agora::rtm::SubscribeOptions& options, uint64_t& requestId);
+  void unsubscribe(const char* channelName, uint64_t& requestId);
+  void join(agora::rtm::IStreamChannel& channel, const agora::rtm::JoinChannelOptions& options, uint64_t& requestId);
+  /// Forwards the renewal and keeps the token for the next restore.
+  void renewToken(agora::rtm::IStreamChannel& channel, const char* token, uint64_t& requestId);
+  void leave(agora::rtm::IStreamChannel& channel, uint64_t& requestId);
+  /// Topic calls on a stream channel not joined through the manager are forwarded without being recorded.
+  void joinTopic(agora::rtm::IStreamChannel& channel, const char* topic, const agora::rtm::JoinTopicOptions& options,
+                 uint64_t& requestId);
+  void leaveTopic(agora::rtm::IStreamChannel& channel, const char* topic, uint64_t& requestId);
+  void subscribeTopic(agora::rtm::IStreamChannel& channel, const char* topic,
+                      const agora::rtm::TopicOptions& options, uint64_t& requestId);
+  /// Without users, drops the topic's subscription; with users, only theirs.
+  void unsubscribeTopic(agora::rtm::IStreamChannel& channel, const char* topic,
+                        const agora::rtm::TopicOptions& options, uint64_t& requestId);
+
+  /// Whether a restore is under way.
+  bool restoring() const;
+  /// Sends the retries that are due by `now`. Returns the calls sent.
+  size_t poll(RtmClock::time_point now);
+  /// When the next retry is due, or `time_point::max()` when none waits.
+  RtmClock::time_point nextDeadline() const;
+  Stats stats() const;
+
+  void onLinkStateEvent(const LinkStateEvent& event) override;
+  void onSubscribeResult(const uint64_t requestId, const char* channelName,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinResult(const uint64_t requestId, const char* channelName, const char* userId,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onJoinTopicResult(const uint64_t requestId, const char* channelName, const char* userId, const char* topic,
+                         const char* meta, agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onSubscribeTopicResult(const uint64_t requestId, const char* channelName, const char* userId,
+                              const char* topic, agora::rtm::UserList succeedUsers, agora::rtm::UserList failedUsers,
+                              agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Topic {
+    bool joined = false;
+    agora::rtm::JoinTopicOptions options;
+    std::string meta;
+    bool subscribed = false;
+    std::vector<std::string> users;
+  };
+
+  struct Stream {
+    agora::rtm::IStreamChannel* channel = nullptr;
+    agora::rtm::JoinChannelOptions options;
+    std::string token;
+    StringMap<Topic> topics;
+  };
+
+  enum class OpKind : uint8_t { subscribe, join, joinTopic, subscribeTopic };
+  enum class OpState : uint8_t { ready, backoff, inFlight };
+
+  struct Op {
+    OpKind kind = OpKind::subscribe;
+    std::string channelName;
+    std::string topic;
+    OpState state = OpState::ready;
+    uint32_t attempts = 0;
+    RtmClock::time_point notBefore = RtmClock::time_point::min();
+    /// The call in flight; 0 while it is being made.
+    uint64_t requestId = 0;
+  };
+
+  /// Everything a restore call needs, copied so it can be made without the lock.
+  struct Call {
+    OpKind kind = OpKind::subscribe;
+    std::string channelName;
+    std::string topic;
+    agora::rtm::IStreamChannel* channel = nullptr;
+    agora::rtm::SubscribeOptions subscribeOptions;
+    agora::rtm::JoinChannelOptions joinOptions;
+    agora::rtm::JoinTopicOptions topicOptions;
+    /// The join's token or the topic's meta.
+    std::string text;
+    std::vector<std::string> users;
+  };
+
+  struct Effects {
+    std::vector<Call> calls;
+    bool restored = false;
+    RtmClock::duration timeToRestore{0};
+    size_t failed = 0;
+  };
+
+  Topic* findTopicLocked(std::string_view channelName, std::string_view topic);
+  /// Drops the restore calls not sent yet that the app has made or undone itself.
+  void pruneLocked(Effects& effects);
+  void queueLocked(OpKind kind, std::string_view channelName, std::string_view topic);
+  void queueTopicsLocked(const std::string& channelName, const Stream& stream);
+  void queueChannelLocked(const std::string& channelName);
+  bool wantedLocked(const Op& op) const;
+  Call callLocked(const Op& op) const;
+  void pumpLocked(Effects& effects);
+  void finishLocked(Effects& effects);
+  /// Settles the restore call `requestId` belongs to, if any.
+  void complete(uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode);
+  /// Files the id of a call that just returned, or settles it with the result that came during the call.
+  void issued(const Call& call, uint64_t requestId);
+  void settleLocked(StringMap<Op>::iterator found, agora::rtm::RTM_ERROR_CODE errorCode, Effects& effects);
+  RtmClock::duration backoffLocked(uint32_t attempts);
+  void run(Effects& effects);
+  void issue(const Call& call);
+
+  agora::rtm::IRtmClient& client_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  RtmClock::time_point now_;
+  std::minstd_rand random_;
+  StringMap<agora::rtm::SubscribeOptions> subscriptions_;
+  StringMap<Stream> streams_;
+  StringMap<Op> ops_;
+  std::deque<std::string> ready_;
+  size_t inFlight_ = 0;
+  /// Op keys by the requestId of their call.
+  RequestIdTable<std::string> requests_;
+  /// Calls collected but not returned yet.
+  size_t unreturned_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  bool connected_ = true;
+  bool down_ = false;
+  bool restoring_ = false;
+  RtmClock::time_point downSince_;
+  size_t restoreFailed_ = 0;
+  /// Calls made while another thread, or an outer frame of this one, is already issuing.
+  std::vector<Call> deferred_;
+  bool issuing_ = false;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
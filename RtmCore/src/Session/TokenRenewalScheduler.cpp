@@ -0,0 +1,238 @@
+//
+//  TokenRenewalScheduler.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Session/TokenRenewalScheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+TokenRenewalScheduler::TokenRenewalScheduler(IRtmClient& client, Provider provider, RtmClock::time_point now)
+    : TokenRenewalScheduler(client, std::move(provider), now, Options()) {}
+
+TokenRenewalScheduler::TokenRenewalScheduler(IRtmClient& client, Provider provider, RtmClock::time_point now,
+                                             Options options)
+    : client_(client),
+      provider_(std::move(provider)),
+      options_(std::move(options)),
+      now_(now),
+      random_(options_.seed != 0 ? options_.seed : std::random_device()()),
+      unclaimed_(options_.unclaimedCapacity) {}
+
+void TokenRenewalScheduler::trackClient(RtmClock::time_point expiresAt) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  trackLocked({}, nullptr, expiresAt);
+}
+
+void TokenRenewalScheduler::trackChannel(IStreamChannel& channel, RtmClock::time_point expiresAt) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  trackLocked(viewOf(channel.getChannelName()), &channel, expiresAt);
+}
+
+bool TokenRenewalScheduler::untrack(std::string_view target) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = targets_.find(target);
+  if (found == targets_.end()) return false;
+  targets_.erase(found);
+  dropStaleLocked();
+  return true;
+}
+
+RtmClock::time_point TokenRenewalScheduler::expiresAt(std::string_view target) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = targets_.find(target);
+  return found == targets_.end() ? RtmClock::time_point::min() : found->second.expiresAt;
+}
+
+size_t TokenRenewalScheduler::poll(RtmClock::time_point now) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    now_ = now;
+  }
+  return fetchDue();
+}
+
+RtmClock::time_point TokenRenewalScheduler::nextDeadline() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return heap_.empty() ? RtmClock::time_point::max() : heap_.front().dueAt;
+}
+
+TokenRenewalScheduler::Stats TokenRenewalScheduler::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  stats.tracked = targets_.size();
+  return stats;
+}
+
+// MARK: - Events
+
+void TokenRenewalScheduler::onTokenPrivilegeWillExpire(const char* channelName) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto found = targets_.find(viewOf(channelName));
+    if (found == targets_.end() || found->second.phase != Phase::idle) return;
+    ++stats_.urgent;
+    scheduleLocked(found->first, found->second, now_);
+  }
+  fetchDue();
+}
+
+void TokenRenewalScheduler::onRenewTokenResult(const uint64_t requestId, RTM_SERVICE_TYPE, const char*,
+                                               RTM_ERROR_CODE errorCode) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::string name;
+  auto found = requestId != 0 && requests_.take(requestId, name) ? targets_.find(name) : targets_.end();
+  if (found == targets_.end() || found->second.phase != Phase::renewing || found->second.requestId != requestId) {
+    // A renewal is still being made; this may be its result.
+    if (unreturned_ > 0) unclaimed_.keep(requestId, errorCode);
+    return;
+  }
+  renewedLocked(found, errorCode);
+}
+
+// MARK: - Private
+
+void TokenRenewalScheduler::trackLocked(std::string_view name, IStreamChannel* channel,
+                                        RtmClock::time_point expiresAt) {
+  auto inserted = targets_.try_emplace(std::string(name));
+  Target& target = inserted.first->second;
+  target.channel = channel;
+  target.expiresAt = expiresAt;
+  // A fetch or renewal under way brings its own expiry.
+  if (target.phase != Phase::idle) return;
+  std::uniform_int_distribution<RtmClock::rep> spread(0, options_.spread.count());
+  scheduleLocked(inserted.first->first, target,
+                 expiresAt - options_.renewBefore - RtmClock::duration(spread(random_)));
+}
+
+void TokenRenewalScheduler::scheduleLocked(const std::string& name, Target& target, RtmClock::time_point dueAt) {
+  target.dueAt = dueAt;
+  heap_.push_back({dueAt, ++target.generation, name});
+  std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+  dropStaleLocked();
+}
+
+bool TokenRenewalScheduler::isCurrentLocked(const Deadline& deadline) const {
+  auto found = targets_.find(deadline.target);
+  return found != targets_.end() && found->second.phase == Phase::idle &&
+         found->second.generation == deadline.generation;
+}
+
+void TokenRenewalScheduler::dropStaleLocked() {
+  while (!heap_.empty() && !isCurrentLocked(heap_.front())) {
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+    heap_.pop_back();
+  }
+}
+
+std::vector<std::string> TokenRenewalScheduler::takeBatchLocked() {
+  std::vector<std::string> batch;
+  // Once one target is due, those due shortly after ride along in the same fetch.
+  while (!heap_.empty() && batch.size() < options_.maxBatch &&
+         heap_.front().dueAt <= (batch.empty() ? now_ : now_ + options_.batchWindow)) {
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+    Deadline deadline = std::move(heap_.back());
+    heap_.pop_back();
+    targets_.find(deadline.target)->second.phase = Phase::fetching;
+    batch.push_back(std::move(deadline.target));
+    dropStaleLocked();
+  }
+  return batch;
+}
+
+size_t TokenRenewalScheduler::fetchDue() {
+  std::vector<std::vector<std::string>> batches;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (std::vector<std::string> batch = takeBatchLocked(); !batch.empty(); batch = takeBatchLocked()) {
+      batches.push_back(std::move(batch));
+    }
+    stats_.fetches += batches.size();
+  }
+  for (std::vector<std::string>& batch : batches) fetch(std::move(batch));
+  return batches.size();
+}
+
+void TokenRenewalScheduler::fetch(std::vector<std::string> targets) {
+  if (!provider_) {
+    fetched(targets, {});
+    return;
+  }
+  std::vector<std::string> asked = targets;
+  provider_(targets, [this, asked = std::move(asked)](std::vector<Token> tokens) {
+    fetched(asked, std::move(tokens));
+  });
+}
+
+void TokenRenewalScheduler::fetched(const std::vector<std::string>& targets, std::vector<Token> tokens) {
+  std::vector<Renewal> renewals;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (Token& token : tokens) {
+      auto found = targets_.find(token.target);
+      if (found == targets_.end() || found->second.phase != Phase::fetching) continue;
+      Target& target = found->second;
+      target.phase = Phase::renewing;
+      target.requestId = 0;
+      target.renewingExpiresAt = token.expiresAt;
+      ++unreturned_;
+      ++stats_.fetchedTokens;
+      ++stats_.renewals;
+      if (now_ >= target.expiresAt) ++stats_.late;
+      renewals.push_back({found->first, target.channel, std::move(token.token)});
+    }
+    for (const std::string& name : targets) {
+      auto found = targets_.find(name);
+      if (found == targets_.end() || found->second.phase != Phase::fetching) continue;
+      found->second.phase = Phase::idle;
+      ++stats_.missingTokens;
+      scheduleLocked(found->first, found->second, now_ + options_.retryDelay);
+    }
+  }
+  for (const Renewal& renewal : renewals) renew(renewal);
+}
+
+void TokenRenewalScheduler::renew(const Renewal& renewal) {
+  uint64_t requestId = 0;
+  if (!renewal.channel) {
+    client_.renewToken(renewal.token.c_str(), requestId);
+  } else if (options_.renewChannel) {
+    options_.renewChannel(*renewal.channel, renewal.token.c_str(), requestId);
+  } else {
+    renewal.channel->renewToken(renewal.token.c_str(), requestId);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  --unreturned_;
+  auto found = targets_.find(renewal.target);
+  // Untracked while the call was made.
+  if (found == targets_.end() || found->second.phase != Phase::renewing || found->second.requestId != 0) return;
+  RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+  if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+    found->second.requestId = requestId;
+    requests_.insert(requestId, found->first);
+    return;
+  }
+  renewedLocked(found, errorCode);
+}
+
+void TokenRenewalScheduler::renewedLocked(StringMap<Target>::iterator found, RTM_ERROR_CODE errorCode) {
+  Target& target = found->second;
+  target.phase = Phase::idle;
+  if (errorCode != RTM_ERROR_OK) {
+    ++stats_.renewFailures;
+    scheduleLocked(found->first, target, now_ + options_.retryDelay);
+    return;
+  }
+  trackLocked(found->first, target.channel, target.renewingExpiresAt);
+}
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,175 @@
+//
+//  TokenRenewalScheduler.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Requests/RequestIdTable.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Renews the client's token and every stream channel's token before they expire, from one min-heap of deadlines.
+///
+/// Each tracked token is due `Options::renewBefore` ahead of its expiry, moved earlier by a random part of
+/// `Options::spread`, so rooms whose tokens were issued together do not all renew at the same instant. `poll`
+/// takes the due tokens, together with those due within `Options::batchWindow`, and asks the provider for fresh
+/// ones in one batch of at most `Options::maxBatch` targets. Each token that comes back is passed to
+/// `IRtmClient::renewToken` or `IStreamChannel::renewToken` and tracked with its new expiry.
+///
+/// `onTokenPrivilegeWillExpire` makes its target due at once, in case the deadline was missed. A target the
+/// provider did not return, or whose renewal failed, is tried again after `Options::retryDelay`. Renewal results
+/// are matched by requestId, so the app's own `renewToken` calls do not settle the scheduler's.
+///
+/// Targets are named by channel; the empty name is the client's own token. Register the scheduler with the client's
+/// event handler. The provider and SDK calls run without the scheduler's lock; the provider may answer on any
+/// thread, also before it returns, but must answer before the scheduler is destroyed. Times are those of the last
+/// `poll`.
+class TokenRenewalScheduler : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Token {
+    /// Channel name, or empty for the client's token.
+    std::string target;
+    std::string token;
+    RtmClock::time_point expiresAt;
+  };
+
+  /// Answers with the tokens it could get, once per call.
+  using Done = std::function<void(std::vector<Token> tokens)>;
+  /// Fetches fresh tokens for `targets`, typically in one request to the app server.
+  using Provider = std::function<void(const std::vector<std::string>& targets, Done done)>;
+
+  struct Options {
+    RtmClock::duration renewBefore = std::chrono::seconds(60);
+    RtmClock::duration spread = std::chrono::seconds(30);
+    RtmClock::duration batchWindow = std::chrono::seconds(2);
+    size_t maxBatch = 32;
+    RtmClock::duration retryDelay = std::chrono::seconds(5);
+    /// Seed of the spread; 0 seeds from `std::random_device`.
+    uint32_t seed = 0;
+    /// Renews a stream channel's token; empty means `IStreamChannel::renewToken`. Route it through
+    /// `RtmSessionManager::renewToken` so a restore joins with the fresh token.
+    std::function<void(agora::rtm::IStreamChannel& channel, const char* token, uint64_t& requestId)> renewChannel;
+    /// Renewal results kept while a renewal is being made, in case one is its own.
+    size_t unclaimedCapacity = 8;
+  };
+
+  struct Stats {
+    uint64_t fetches = 0;
+    uint64_t fetchedTokens = 0;
+    /// Targets a fetch did not return a token for.
+    uint64_t missingTokens = 0;
+    uint64_t renewals = 0;
+    uint64_t renewFailures = 0;
+    /// `onTokenPrivilegeWillExpire` events for a token not already being renewed.
+    uint64_t urgent = 0;
+    /// Renewals sent after the token had expired.
+    uint64_t late = 0;
+    size_t tracked = 0;
+  };
+
+  TokenRenewalScheduler(agora::rtm::IRtmClient& client, Provider provider, RtmClock::time_point now);
+  TokenRenewalScheduler(agora::rtm::IRtmClient& client, Provider provider, RtmClock::time_point now,
+                        Options options);
+
+  TokenRenewalScheduler(const TokenRenewalScheduler&) = delete;
+  TokenRenewalScheduler& operator=(const TokenRenewalScheduler&) = delete;
+
+  /// Tracks the login token, or updates its expiry.
+  void trackClient(RtmClock::time_point expiresAt);
+  /// Tracks the channel's join token, or updates its expiry. The channel must outlive its tracking.
+  void trackChannel(agora::rtm::IStreamChannel& channel, RtmClock::time_point expiresAt);
+  /// Stops renewing the target. False when it was not tracked.
+  bool untrack(std::string_view target);
+  /// The tracked expiry of the target, or `time_point::min()` when it is not tracked.
+  RtmClock::time_point expiresAt(std::string_view target) const;
+
+  /// Fetches tokens for the targets due by `now`. Returns the fetches started.
+  size_t poll(RtmClock::time_point now);
+  /// When the next target is due, or `time_point::max()` when none is tracked.
+  RtmClock::time_point nextDeadline() const;
+  Stats stats() const;
+
+  void onTokenPrivilegeWillExpire(const char* channelName) override;
+  void onRenewTokenResult(const uint64_t requestId, agora::rtm::RTM_SERVICE_TYPE serverType, const char* channelName,
+                          agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  enum class Phase : uint8_t { idle, fetching, renewing };
+
+  struct Target {
+    agora::rtm::IStreamChannel* channel = nullptr;
+    RtmClock::time_point expiresAt;
+    /// Expiry of the token being renewed, taken over once the renewal succeeds.
+    RtmClock::time_point renewingExpiresAt;
+    RtmClock::time_point dueAt;
+    /// Bumped whenever `dueAt` changes; heap entries of older generations are stale.
+    uint64_t generation = 0;
+    Phase phase = Phase::idle;
+    /// The renewal in flight; 0 while it is being made.
+    uint64_t requestId = 0;
+  };
+
+  struct Deadline {
+    RtmClock::time_point dueAt;
+    uint64_t generation;
+    std::string target;
+    bool operator>(const Deadline& other) const { return dueAt > other.dueAt; }
+  };
+
+  struct Renewal {
+    std::string target;
+    agora::rtm::IStreamChannel* channel = nullptr;
+    std::string token;
+  };
+
+  void trackLocked(std::string_view name, agora::rtm::IStreamChannel* channel, RtmClock::time_point expiresAt);
+  void scheduleLocked(const std::string& name, Target& target, RtmClock::time_point dueAt);
+  bool isCurrentLocked(const Deadline& deadline) const;
+  void dropStaleLocked();
+  /// Pops the due targets and those due within the batch window, up to one batch.
+  std::vector<std::string> takeBatchLocked();
+  /// Fetches every due batch. Returns the fetches started.
+  size_t fetchDue();
+  void fetch(std::vector<std::string> targets);
+  void fetched(const std::vector<std::string>& targets, std::vector<Token> tokens);
+  void renew(const Renewal& renewal);
+  void renewedLocked(StringMap<Target>::iterator found, agora::rtm::RTM_ERROR_CODE errorCode);
+
+  agora::rtm::IRtmClient& client_;
+  const Provider provider_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  RtmClock::time_point now_;
+  std::minstd_rand random_;
+  StringMap<Target> targets_;
+  /// Min-heap on `dueAt`, with lazy removal of stale entries.
+  std::vector<Deadline> heap_;
+  /// Target names by the requestId of their renewal.
+  RequestIdTable<std::string> requests_;
+  /// Renewals collected but not returned yet.
+  size_t unreturned_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
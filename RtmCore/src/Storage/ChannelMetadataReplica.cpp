@@ -0,0 +1,296 @@
+//
+//  ChannelMetadataReplica.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Storage/ChannelMetadataReplica.h"
+
+#include <utility>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+ChannelMetadataReplica::ChannelMetadataReplica(IRtmStorage& storage, std::string_view channelName,
+                                               RTM_CHANNEL_TYPE channelType)
+    : ChannelMetadataReplica(storage, channelName, channelType, Options()) {}
+
+ChannelMetadataReplica::ChannelMetadataReplica(IRtmStorage& storage, std::string_view channelName,
+                                               RTM_CHANNEL_TYPE channelType, Options options)
+    : storage_(storage),
+      channelName_(channelName),
+      channelType_(channelType),
+      options_(options),
+      unclaimed_(options.unclaimedCapacity) {
+  if (options_.maxHeldEvents == 0) options_.maxHeldEvents = 1;
+  if (options_.minEventsBetweenFetches == 0) options_.minEventsBetweenFetches = 1;
+}
+
+uint64_t ChannelMetadataReplica::refresh() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!startFetchLocked()) return 0;
+  }
+  return fetch();
+}
+
+bool ChannelMetadataReplica::synced() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return majorRevision_ >= 0 && !stale_ && !fetching_;
+}
+
+int64_t ChannelMetadataReplica::majorRevision() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return majorRevision_;
+}
+
+size_t ChannelMetadataReplica::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return present_;
+}
+
+ChannelMetadataReplica::KeyId ChannelMetadataReplica::intern(std::string_view key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return internLocked(key);
+}
+
+ChannelMetadataReplica::KeyId ChannelMetadataReplica::find(std::string_view key) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = keyIds_.find(key);
+  return found == keyIds_.end() ? kInvalidKey : found->second;
+}
+
+bool ChannelMetadataReplica::get(std::string_view key, Item& item) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = keyIds_.find(key);
+  if (found == keyIds_.end() || !slots_[found->second].present) return false;
+  item = slots_[found->second].item;
+  return true;
+}
+
+bool ChannelMetadataReplica::get(KeyId key, Item& item) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (key >= slots_.size() || !slots_[key].present) return false;
+  item = slots_[key].item;
+  return true;
+}
+
+bool ChannelMetadataReplica::value(std::string_view key, std::string& value) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = keyIds_.find(key);
+  if (found == keyIds_.end() || !slots_[found->second].present) return false;
+  value = slots_[found->second].item.value;
+  return true;
+}
+
+int64_t ChannelMetadataReplica::revision(std::string_view key) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = keyIds_.find(key);
+  if (found == keyIds_.end() || !slots_[found->second].present) return 0;
+  return slots_[found->second].item.revision;
+}
+
+std::vector<std::pair<std::string, ChannelMetadataReplica::Item>> ChannelMetadataReplica::items() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<std::pair<std::string, Item>> items;
+  items.reserve(present_);
+  for (const Slot& slot : slots_) {
+    if (slot.present) items.emplace_back(slot.key, slot.item);
+  }
+  return items;
+}
+
+ChannelMetadataReplica::Stats ChannelMetadataReplica::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+// MARK: - Events
+
+void ChannelMetadataReplica::onStorageEvent(const StorageEvent& event) {
+  if (event.storageType != RTM_STORAGE_TYPE_CHANNEL || !isOurs(viewOf(event.target), event.channelType)) return;
+  bool needsFetch = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++stats_.events;
+    switch (event.eventType) {
+      case RTM_STORAGE_EVENT_TYPE_SNAPSHOT:
+        if (event.data.majorRevision < majorRevision_) {
+          ++stats_.ignored;
+          return;
+        }
+        replaceLocked(event.data);
+        replayLocked();
+        needsFetch = refetchLocked();
+        break;
+      case RTM_STORAGE_EVENT_TYPE_SET:
+      case RTM_STORAGE_EVENT_TYPE_UPDATE:
+      case RTM_STORAGE_EVENT_TYPE_REMOVE: {
+        if (eventsSinceFetch_ < SIZE_MAX) ++eventsSinceFetch_;
+        if (majorRevision_ >= 0 && !fetching_ && event.data.majorRevision <= majorRevision_) {
+          ++stats_.ignored;
+          return;
+        }
+        HeldEvent change = hold(event.eventType, event.data);
+        if (!fetching_ && majorRevision_ >= 0) {
+          applyLocked(change);
+          needsFetch = refetchLocked();
+          break;
+        }
+        if (held_.size() >= options_.maxHeldEvents) held_.pop_front();
+        held_.push_back(std::move(change));
+        // Without a copy yet there is nothing to apply the event to.
+        needsFetch = !fetching_ && startFetchLocked();
+        break;
+      }
+      default:
+        ++stats_.ignored;
+        return;
+    }
+  }
+  if (needsFetch) fetch();
+}
+
+void ChannelMetadataReplica::onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                        RTM_CHANNEL_TYPE channelType, const Metadata& data,
+                                                        RTM_ERROR_CODE errorCode) {
+  if (!isOurs(viewOf(channelName), channelType)) return;
+  bool needsFetch = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (errorCode == RTM_ERROR_OK && data.majorRevision >= majorRevision_) replaceLocked(data);
+    if (fetching_) {
+      if (fetchRequestId_ == 0) {
+        // The fetch is still being made; this may be its result.
+        unclaimed_.keep(requestId, errorCode);
+        return;
+      }
+      if (requestId != fetchRequestId_) return;
+      settleFetchLocked(errorCode);
+    }
+    replayLocked();
+    needsFetch = refetchLocked();
+  }
+  if (needsFetch) fetch();
+}
+
+// MARK: - Private
+
+bool ChannelMetadataReplica::isOurs(std::string_view channelName, RTM_CHANNEL_TYPE channelType) const {
+  return channelType == channelType_ && channelName == channelName_;
+}
+
+ChannelMetadataReplica::KeyId ChannelMetadataReplica::internLocked(std::string_view key) {
+  auto found = keyIds_.find(key);
+  if (found != keyIds_.end()) return found->second;
+  KeyId id = static_cast<KeyId>(slots_.size());
+  slots_.push_back({std::string(key), Item(), false});
+  keyIds_.emplace(std::string(key), id);
+  return id;
+}
+
+ChannelMetadataReplica::HeldEvent ChannelMetadataReplica::hold(RTM_STORAGE_EVENT_TYPE type, const Metadata& data) {
+  HeldEvent event{type, data.majorRevision, {}};
+  event.items.reserve(data.itemCount);
+  for (size_t i = 0; i < data.itemCount && data.items; ++i) {
+    const MetadataItem& item = data.items[i];
+    event.items.emplace_back(internLocked(viewOf(item.key)), Item{std::string(viewOf(item.value)),
+                                                                  std::string(viewOf(item.authorUserId)),
+                                                                  item.revision, item.updateTs});
+  }
+  return event;
+}
+
+void ChannelMetadataReplica::replaceLocked(const Metadata& data) {
+  for (Slot& slot : slots_) slot.present = false;
+  present_ = 0;
+  for (size_t i = 0; i < data.itemCount && data.items; ++i) {
+    const MetadataItem& item = data.items[i];
+    Slot& slot = slots_[internLocked(viewOf(item.key))];
+    slot.item.value.assign(viewOf(item.value));
+    slot.item.authorUserId.assign(viewOf(item.authorUserId));
+    slot.item.revision = item.revision;
+    slot.item.updateTs = item.updateTs;
+    if (!slot.present) ++present_;
+    slot.present = true;
+  }
+  majorRevision_ = data.majorRevision;
+  stale_ = false;
+  ++stats_.snapshots;
+}
+
+void ChannelMetadataReplica::applyLocked(const HeldEvent& event) {
+  for (const auto& [id, item] : event.items) {
+    Slot& slot = slots_[id];
+    if (slot.present && item.revision < slot.item.revision) continue;
+    if (event.type == RTM_STORAGE_EVENT_TYPE_REMOVE) {
+      if (slot.present) --present_;
+      slot.present = false;
+      continue;
+    }
+    if (!slot.present) ++present_;
+    slot.item = item;
+    slot.present = true;
+  }
+  if (event.majorRevision != majorRevision_ + 1) {
+    ++stats_.gaps;
+    stale_ = true;
+  }
+  majorRevision_ = event.majorRevision;
+  ++stats_.applied;
+}
+
+void ChannelMetadataReplica::replayLocked() {
+  if (majorRevision_ < 0) return;
+  for (; !held_.empty(); held_.pop_front()) {
+    if (held_.front().majorRevision <= majorRevision_) {
+      ++stats_.ignored;
+    } else {
+      applyLocked(held_.front());
+    }
+  }
+}
+
+bool ChannelMetadataReplica::startFetchLocked() {
+  if (fetching_) return false;
+  fetching_ = true;
+  fetchRequestId_ = 0;
+  eventsSinceFetch_ = 0;
+  ++stats_.fetches;
+  return true;
+}
+
+bool ChannelMetadataReplica::refetchLocked() {
+  return stale_ && eventsSinceFetch_ >= options_.minEventsBetweenFetches && startFetchLocked();
+}
+
+void ChannelMetadataReplica::settleFetchLocked(RTM_ERROR_CODE errorCode) {
+  fetching_ = false;
+  fetchRequestId_ = 0;
+  if (errorCode != RTM_ERROR_OK) ++stats_.fetchErrors;
+}
+
+uint64_t ChannelMetadataReplica::fetch() {
+  uint64_t requestId = 0;
+  storage_.getChannelMetadata(channelName_.c_str(), channelType_, requestId);
+  bool needsFetch = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+    if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+      fetchRequestId_ = requestId;
+      return requestId;
+    }
+    settleFetchLocked(errorCode);
+    replayLocked();
+    needsFetch = refetchLocked();
+  }
+  if (needsFetch) fetch();
+  return requestId;
+}
+
+}  // namespace rtm
+}  // namespace flat
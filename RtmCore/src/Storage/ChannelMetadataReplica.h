@@ -0,0 +1,165 @@
+//
+//  ChannelMetadataReplica.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmStorage.h"
+#include "Requests/UnclaimedResults.h"
+
+namespace flat {
+namespace rtm {
+
+/// Local copy of one channel's metadata, kept current from `onStorageEvent` so room state can be read without a
+/// `getChannelMetadata` round trip.
+///
+/// A SNAPSHOT replaces the copy; SET, UPDATE and REMOVE are applied item by item as soon as their
+/// `majorRevision` is newer than the copy's. Events at or below the current revision are ignored, as are items
+/// older than the stored item. The SDK does not promise that revisions step by one, so an event that skips ahead
+/// only may mean events were missed: the replica marks the copy stale and refetches with
+/// `IRtmStorage::getChannelMetadata`, at most once per `minEventsBetweenFetches` events, holding later events
+/// until its own result arrives and replaying the ones newer than it. Any successful `onGetChannelMetadataResult`
+/// for the channel is taken as a snapshot when it is newer than the copy; only the one carrying the fetch's
+/// requestId ends the fetch.
+///
+/// Keys are interned: each distinct key gets a `KeyId` that stays valid for the replica's lifetime, also across
+/// removal, so hot keys can be read by index. Register the replica with the client's event handler (usually
+/// through `RtmEventMux`) and subscribe or join the channel with `withMetadata`, or call `refresh()`. Reads and
+/// events may come from different threads; the fetch is made outside the replica's lock.
+class ChannelMetadataReplica : public agora::rtm::IRtmEventHandler {
+ public:
+  using KeyId = uint32_t;
+  static constexpr KeyId kInvalidKey = UINT32_MAX;
+
+  struct Item {
+    std::string value;
+    std::string authorUserId;
+    int64_t revision = 0;
+    int64_t updateTs = 0;
+  };
+
+  struct Options {
+    /// Events kept while a fetch is outstanding; the oldest is dropped beyond this, which shows up as another
+    /// gap once the fetch lands.
+    size_t maxHeldEvents = 1024;
+    /// Storage events that must arrive between two fetches for skipped revisions; at least 1, so a fetch that
+    /// leaves the copy stale waits for the next event rather than refetching back to back.
+    size_t minEventsBetweenFetches = 32;
+    /// `getChannelMetadata` results kept while the fetch is being made, in case one is its own.
+    size_t unclaimedCapacity = 8;
+  };
+
+  struct Stats {
+    uint64_t events = 0;
+    uint64_t applied = 0;
+    uint64_t ignored = 0;
+    /// Events that skipped revisions.
+    uint64_t gaps = 0;
+    uint64_t fetches = 0;
+    uint64_t fetchErrors = 0;
+    uint64_t snapshots = 0;
+  };
+
+  ChannelMetadataReplica(agora::rtm::IRtmStorage& storage, std::string_view channelName,
+                         agora::rtm::RTM_CHANNEL_TYPE channelType);
+  ChannelMetadataReplica(agora::rtm::IRtmStorage& storage, std::string_view channelName,
+                         agora::rtm::RTM_CHANNEL_TYPE channelType, Options options);
+
+  ChannelMetadataReplica(const ChannelMetadataReplica&) = delete;
+  ChannelMetadataReplica& operator=(const ChannelMetadataReplica&) = delete;
+
+  const std::string& channelName() const { return channelName_; }
+  agora::rtm::RTM_CHANNEL_TYPE channelType() const { return channelType_; }
+
+  /// Fetches the whole metadata unless a fetch is already outstanding. Returns the fetch's requestId, or 0 when none
+  /// was issued.
+  uint64_t refresh();
+
+  /// Whether a snapshot has been applied, no revision was skipped since and no fetch is outstanding.
+  bool synced() const;
+  /// The revision of the copy, -1 before the first snapshot.
+  int64_t majorRevision() const;
+  /// Number of keys present.
+  size_t size() const;
+
+  /// The id of `key`, allocating one if the key was never seen.
+  KeyId intern(std::string_view key);
+  /// The id of `key`, or `kInvalidKey` if the key was never seen.
+  KeyId find(std::string_view key) const;
+
+  bool get(std::string_view key, Item& item) const;
+  bool get(KeyId key, Item& item) const;
+  bool value(std::string_view key, std::string& value) const;
+  /// The item's revision, 0 when the key is absent, the way the service compares `MetadataItem::revision`.
+  int64_t revision(std::string_view key) const;
+  /// Present keys and their items, in key-id order.
+  std::vector<std::pair<std::string, Item>> items() const;
+
+  Stats stats() const;
+
+  void onStorageEvent(const StorageEvent& event) override;
+  void onGetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType, const agora::rtm::Metadata& data,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Slot {
+    std::string key;
+    Item item;
+    bool present = false;
+  };
+
+  struct HeldEvent {
+    agora::rtm::RTM_STORAGE_EVENT_TYPE type;
+    int64_t majorRevision;
+    std::vector<std::pair<KeyId, Item>> items;
+  };
+
+  bool isOurs(std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType) const;
+  KeyId internLocked(std::string_view key);
+  HeldEvent hold(agora::rtm::RTM_STORAGE_EVENT_TYPE type, const agora::rtm::Metadata& data);
+  void replaceLocked(const agora::rtm::Metadata& data);
+  /// Applies the event, marking the copy stale when it skips revisions.
+  void applyLocked(const HeldEvent& event);
+  /// Applies held events newer than the copy, in arrival order.
+  void replayLocked();
+  bool startFetchLocked();
+  /// Starts a fetch when the copy is stale and enough events arrived since the last one.
+  bool refetchLocked();
+  void settleFetchLocked(agora::rtm::RTM_ERROR_CODE errorCode);
+  uint64_t fetch();
+
+  agora::rtm::IRtmStorage& storage_;
+  const std::string channelName_;
+  const agora::rtm::RTM_CHANNEL_TYPE channelType_;
+  Options options_;
+  mutable std::mutex mutex_;
+  StringMap<KeyId> keyIds_;
+  std::vector<Slot> slots_;
+  size_t present_ = 0;
+  int64_t majorRevision_ = -1;
+  /// A revision was skipped since the last snapshot.
+  bool stale_ = false;
+  /// Storage events since the last fetch started; the first skip after construction fetches at once.
+  size_t eventsSinceFetch_ = SIZE_MAX;
+  bool fetching_ = false;
+  uint64_t fetchRequestId_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  std::deque<HeldEvent> held_;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,230 @@
+//
+//  MetadataWriteCoalescer.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include "Storage/MetadataWriteCoalescer.h"
+
+#include <algorithm>
+
+using namespace agora::rtm;
+
+namespace flat {
+namespace rtm {
+
+namespace {
+
+std::vector<std::string> keysOf(const std::vector<std::pair<std::string, std::string>>& items) {
+  std::vector<std::string> keys;
+  keys.reserve(items.size());
+  for (const auto& item : items) keys.push_back(item.first);
+  return keys;
+}
+
+}  // namespace
+
+MetadataWriteCoalescer::MetadataWriteCoalescer(IRtmStorage& storage, ChannelMetadataReplica& replica)
+    : MetadataWriteCoalescer(storage, replica, Options()) {}
+
+MetadataWriteCoalescer::MetadataWriteCoalescer(IRtmStorage& storage, ChannelMetadataReplica& replica,
+                                               Options options)
+    : storage_(storage), replica_(replica), options_(std::move(options)), unclaimed_(options_.unclaimedCapacity) {
+  if (options_.maxBatchItems == 0) options_.maxBatchItems = 1;
+}
+
+RTM_ERROR_CODE MetadataWriteCoalescer::set(std::string_view key, std::string_view value, RtmClock::time_point now) {
+  if (key.empty()) return RTM_ERROR_STORAGE_INVALID_KEY;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++stats_.writes;
+    auto found = pendingIndex_.find(key);
+    if (found != pendingIndex_.end()) {
+      pending_[found->second].second.assign(value);
+      ++stats_.coalesced;
+    } else {
+      if (pending_.empty()) firstPending_ = now;
+      pendingIndex_.emplace(std::string(key), pending_.size());
+      pending_.emplace_back(std::string(key), std::string(value));
+    }
+  }
+  poll(now);
+  return RTM_ERROR_OK;
+}
+
+size_t MetadataWriteCoalescer::poll(RtmClock::time_point now) { return issue(now, false); }
+
+size_t MetadataWriteCoalescer::flush() { return issue(RtmClock::time_point::max(), true); }
+
+RtmClock::time_point MetadataWriteCoalescer::nextDeadline() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (inFlight_) return RtmClock::time_point::max();
+  if (rebaseReady_) return replica_.synced() ? RtmClock::time_point::min() : RtmClock::time_point::max();
+  if (pending_.empty()) return RtmClock::time_point::max();
+  if (pending_.size() >= options_.maxBatchItems) return RtmClock::time_point::min();
+  return firstPending_ + options_.window;
+}
+
+bool MetadataWriteCoalescer::busy() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return inFlight_;
+}
+
+MetadataWriteCoalescer::Stats MetadataWriteCoalescer::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats = stats_;
+  stats.pending = pending_.size() + (rebaseReady_ ? write_.items.size() : 0);
+  return stats;
+}
+
+void MetadataWriteCoalescer::onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                        RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  result(requestId, viewOf(channelName), channelType, errorCode);
+}
+
+void MetadataWriteCoalescer::onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                                           RTM_CHANNEL_TYPE channelType, RTM_ERROR_CODE errorCode) {
+  result(requestId, viewOf(channelName), channelType, errorCode);
+}
+
+// MARK: - Private
+
+size_t MetadataWriteCoalescer::issue(RtmClock::time_point now, bool force) {
+  Write write;
+  std::vector<std::pair<std::string, std::string>> rebased;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (inFlight_) return 0;
+    if (rebaseReady_) {
+      if (!replica_.synced()) return 0;
+    } else if (pending_.empty() ||
+               (!force && now < firstPending_ + options_.window && pending_.size() < options_.maxBatchItems)) {
+      return 0;
+    }
+    if (rebaseReady_) {
+      rebaseReady_ = false;
+      write.rebases = write_.rebases + 1;
+      for (auto& item : write_.items) {
+        if (!pendingIndex_.count(item.first)) rebased.push_back(std::move(item));
+      }
+    }
+    size_t take = std::min(pending_.size(), options_.maxBatchItems);
+    write.items.assign(std::make_move_iterator(pending_.begin()), std::make_move_iterator(pending_.begin() + take));
+    pending_.erase(pending_.begin(), pending_.begin() + take);
+    pendingIndex_.clear();
+    for (size_t i = 0; i < pending_.size(); ++i) pendingIndex_.emplace(pending_[i].first, i);
+    inFlight_ = true;
+    inFlightRequestId_ = 0;
+    write_ = Write();
+  }
+
+  // Rebased values meet the replica outside the lock; `Options::rebase` is user code.
+  std::vector<std::pair<std::string, std::string>> dropped;
+  for (auto& item : rebased) {
+    std::string current;
+    replica_.value(item.first, current);
+    if (options_.rebase && !options_.rebase(item.first, current, item.second)) {
+      dropped.push_back(std::move(item));
+    } else {
+      write.items.push_back(std::move(item));
+    }
+  }
+  if (!dropped.empty() && options_.onComplete) {
+    options_.onComplete(keysOf(dropped), RTM_ERROR_STORAGE_OUTDATED_REVISION);
+  }
+  if (write.items.empty()) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    inFlight_ = false;
+    return 0;
+  }
+
+  write.basedOn = replica_.majorRevision();
+  std::vector<MetadataItem> items;
+  items.reserve(write.items.size());
+  bool allPresent = true;
+  for (const auto& item : write.items) {
+    int64_t revision = replica_.revision(item.first);
+    allPresent = allPresent && revision > 0;
+    items.emplace_back(item.first.c_str(), item.second.c_str(), revision);
+  }
+  Metadata data;
+  data.items = items.data();
+  data.itemCount = items.size();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    write_ = std::move(write);
+  }
+  const std::string& channelName = replica_.channelName();
+  uint64_t requestId = 0;
+  // The items point into `write_`, which stays put until the result arrives.
+  if (allPresent) {
+    storage_.updateChannelMetadata(channelName.c_str(), replica_.channelType(), data, options_.metadataOptions,
+                                   nullptr, requestId);
+  } else {
+    storage_.setChannelMetadata(channelName.c_str(), replica_.channelType(), data, options_.metadataOptions, nullptr,
+                                requestId);
+  }
+  RTM_ERROR_CODE errorCode = RTM_ERROR_NOT_INITIALIZED;
+  std::vector<std::string> keys;
+  bool refresh = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (requestId != 0 && !unclaimed_.take(requestId, errorCode)) {
+      inFlightRequestId_ = requestId;
+      return 1;
+    }
+    refresh = settleLocked(errorCode, keys);
+  }
+  finish(refresh, keys, errorCode);
+  return requestId != 0 ? 1 : 0;
+}
+
+void MetadataWriteCoalescer::result(uint64_t requestId, std::string_view channelName, RTM_CHANNEL_TYPE channelType,
+                                    RTM_ERROR_CODE errorCode) {
+  if (channelType != replica_.channelType() || channelName != replica_.channelName()) return;
+  std::vector<std::string> keys;
+  bool refresh = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!inFlight_) return;
+    if (inFlightRequestId_ == 0) {
+      // The call is still being made; this may be its result.
+      unclaimed_.keep(requestId, errorCode);
+      return;
+    }
+    if (inFlightRequestId_ != requestId) return;
+    refresh = settleLocked(errorCode, keys);
+  }
+  finish(refresh, keys, errorCode);
+}
+
+bool MetadataWriteCoalescer::settleLocked(RTM_ERROR_CODE errorCode, std::vector<std::string>& keys) {
+  inFlight_ = false;
+  inFlightRequestId_ = 0;
+  if (errorCode == RTM_ERROR_STORAGE_OUTDATED_REVISION && write_.rebases < options_.maxRebases) {
+    ++stats_.conflicts;
+    ++stats_.rebases;
+    rebaseReady_ = true;
+    return replica_.majorRevision() <= write_.basedOn;
+  }
+  if (errorCode == RTM_ERROR_OK) {
+    ++stats_.flushes;
+    stats_.flushedItems += write_.items.size();
+  } else {
+    if (errorCode == RTM_ERROR_STORAGE_OUTDATED_REVISION) ++stats_.conflicts;
+    ++stats_.failed;
+  }
+  keys = keysOf(write_.items);
+  write_ = Write();
+  return false;
+}
+
+void MetadataWriteCoalescer::finish(bool refresh, const std::vector<std::string>& keys, RTM_ERROR_CODE errorCode) {
+  // The replica has not seen the write that beat ours yet.
+  if (refresh) replica_.refresh();
+  if (!keys.empty() && options_.onComplete) options_.onComplete(keys, errorCode);
+}
+
+}  // namespace rtm
+}  // namespace flat
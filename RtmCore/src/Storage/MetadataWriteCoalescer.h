@@ -0,0 +1,134 @@
+//
+//  MetadataWriteCoalescer.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/RtmClock.h"
+#include "Common/StringMap.h"
+#include "IAgoraRtmClient.h"
+#include "IAgoraRtmStorage.h"
+#include "Requests/UnclaimedResults.h"
+#include "Storage/ChannelMetadataReplica.h"
+
+namespace flat {
+namespace rtm {
+
+/// Merges bursts of small channel metadata writes into one storage call per flush window.
+///
+/// Writes to the same key within a window collapse to the last value. A flush sends every pending key in one
+/// `updateChannelMetadata`, or `setChannelMetadata` when a key is not in the replica yet, with each item's
+/// `revision` taken from `replica` so the service rejects the write if someone else changed the key first. On
+/// `RTM_ERROR_STORAGE_OUTDATED_REVISION` the items are rebased: the replica is refreshed unless it has already
+/// moved past the revision the write was based on, `Options::rebase` may merge each value with the current one,
+/// and the write goes out again on the next `poll` without waiting for the window. Keys written again in the
+/// meantime keep their newer value.
+///
+/// One write is in flight at a time, since the next one needs the revisions this one produces; keys left over
+/// beyond `maxBatchItems` go out on the next `poll`. Register the coalescer with the same client's event handler
+/// as `replica`. Results are matched to the write by requestId; one that arrives while the call is still being
+/// made is kept until the call returns its id. A write issued before the replica has seen the previous write's
+/// storage event conflicts once and is rebased. SDK calls are made outside the coalescer's lock.
+class MetadataWriteCoalescer : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Options {
+    /// How long the first pending write waits for others.
+    RtmClock::duration window = std::chrono::milliseconds(20);
+    /// Pending keys that flush without waiting for the window; also the most items per call.
+    size_t maxBatchItems = 64;
+    /// Rebases of one write before its conflict is reported.
+    uint32_t maxRebases = 3;
+    /// Metadata write results kept while a call is being made, in case one is its own.
+    size_t unclaimedCapacity = 16;
+    agora::rtm::MetadataOptions metadataOptions;
+    /// Called before a conflicted key is written again, with the replica's current value (empty when absent).
+    /// May merge it into `value`; returns false to drop the write. Empty keeps the pending value.
+    std::function<bool(std::string_view key, std::string_view current, std::string& value)> rebase;
+    /// Called once per write with its keys and final result.
+    std::function<void(const std::vector<std::string>& keys, agora::rtm::RTM_ERROR_CODE errorCode)> onComplete;
+  };
+
+  struct Stats {
+    uint64_t writes = 0;
+    uint64_t coalesced = 0;
+    uint64_t flushes = 0;
+    uint64_t flushedItems = 0;
+    uint64_t conflicts = 0;
+    uint64_t rebases = 0;
+    uint64_t failed = 0;
+    size_t pending = 0;
+  };
+
+  MetadataWriteCoalescer(agora::rtm::IRtmStorage& storage, ChannelMetadataReplica& replica);
+  MetadataWriteCoalescer(agora::rtm::IRtmStorage& storage, ChannelMetadataReplica& replica, Options options);
+
+  MetadataWriteCoalescer(const MetadataWriteCoalescer&) = delete;
+  MetadataWriteCoalescer& operator=(const MetadataWriteCoalescer&) = delete;
+
+  /// Queues `key = value`, replacing a pending value of the same key. Issues a write when the batch is full.
+  agora::rtm::RTM_ERROR_CODE set(std::string_view key, std::string_view value, RtmClock::time_point now);
+
+  /// Issues the pending keys if the window has passed, the batch is full or a rebase is ready. Returns the
+  /// number of storage calls made, 0 or 1.
+  size_t poll(RtmClock::time_point now);
+  /// Issues the pending keys now, unless a write is in flight.
+  size_t flush();
+  /// When `poll` has work, or `time_point::max()` when it waits on nothing or on a write in flight.
+  RtmClock::time_point nextDeadline() const;
+  /// Whether a write is in flight.
+  bool busy() const;
+
+  Stats stats() const;
+
+  void onSetChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                  agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override;
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char* channelName,
+                                     agora::rtm::RTM_CHANNEL_TYPE channelType,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override;
+
+ private:
+  struct Write {
+    std::vector<std::pair<std::string, std::string>> items;
+    uint32_t rebases = 0;
+    int64_t basedOn = -1;
+  };
+
+  size_t issue(RtmClock::time_point now, bool force);
+  void result(uint64_t requestId, std::string_view channelName, agora::rtm::RTM_CHANNEL_TYPE channelType,
+              agora::rtm::RTM_ERROR_CODE errorCode);
+  /// Settles the write in flight. Fills `keys` when it is over; true when the replica needs a refresh.
+  bool settleLocked(agora::rtm::RTM_ERROR_CODE errorCode, std::vector<std::string>& keys);
+  void finish(bool refresh, const std::vector<std::string>& keys, agora::rtm::RTM_ERROR_CODE errorCode);
+
+  agora::rtm::IRtmStorage& storage_;
+  ChannelMetadataReplica& replica_;
+  Options options_;
+  mutable std::mutex mutex_;
+  /// Pending keys in first-write order, and their positions in it.
+  std::vector<std::pair<std::string, std::string>> pending_;
+  StringMap<size_t> pendingIndex_;
+  RtmClock::time_point firstPending_;
+  bool inFlight_ = false;
+  /// 0 while the call is being made.
+  uint64_t inFlightRequestId_ = 0;
+  UnclaimedResults<agora::rtm::RTM_ERROR_CODE> unclaimed_;
+  Write write_;
+  /// A conflicted write waiting for `poll`.
+  bool rebaseReady_ = false;
+  Stats stats_;
+};
+
+}  // namespace rtm
+}  // namespace flat
@@ -0,0 +1,182 @@
+//
+//  BatchingPublisherTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+
+#include "Events/DebatchingEventHandler.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Publishing/BatchingPublisher.h"
+#include "Publishing/MessageBatch.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/// A teacher publishing into "room" and a student receiving through a de-batcher.
+struct Classroom {
+  Classroom() : debatcher(received) {
+    student = loggedInClient(broker, "student", debatcher);
+    teacher = loggedInClient(broker, "teacher", teacherEvents);
+    uint64_t requestId = 0;
+    student->subscribe("room", SubscribeOptions(), requestId);
+    teacher->subscribe("room", SubscribeOptions(), requestId);
+  }
+
+  ~Classroom() {
+    teacher->release();
+    student->release();
+  }
+
+  LoopbackBroker broker;
+  RecordingEventHandler received;
+  RecordingEventHandler teacherEvents;
+  DebatchingEventHandler debatcher;
+  LoopbackRtmClient* student;
+  LoopbackRtmClient* teacher;
+};
+
+PublishOptions command(const char* customType, RTM_MESSAGE_TYPE messageType = RTM_MESSAGE_TYPE_STRING) {
+  PublishOptions options;
+  options.customType = customType;
+  options.messageType = messageType;
+  return options;
+}
+
+void testWindowCoalescesIntoOneEnvelope() {
+  Classroom room;
+  BatchingPublisher publisher(*room.teacher);
+  RtmClock::time_point start = RtmClock::now();
+  publisher.publish("room", "{\"raiseHand\":true}", 18, command("RaiseHand"), start);
+  publisher.publish("room", "{\"camera\":false}", 16, command("DeviceState"), start + milliseconds(1));
+  publisher.publish("room", "\x01\x00\x02", 3, command(nullptr, RTM_MESSAGE_TYPE_BINARY), start + milliseconds(2));
+  RTM_CHECK_EQ(publisher.pendingMessages(), 3u);
+  RTM_CHECK(publisher.nextDeadline() == start + milliseconds(5));
+  RTM_CHECK_EQ(publisher.poll(start + milliseconds(4)), 0u);
+  RTM_CHECK(room.received.messages.empty());
+
+  RTM_CHECK_EQ(publisher.poll(start + milliseconds(5)), 1u);
+  RTM_CHECK_EQ(room.received.messages.size(), 3u);
+  RTM_CHECK_EQ(room.received.messages[0].payload, "{\"raiseHand\":true}");
+  RTM_CHECK_EQ(room.received.messages[0].customType, "RaiseHand");
+  RTM_CHECK_EQ(room.received.messages[1].customType, "DeviceState");
+  RTM_CHECK_EQ(room.received.messages[2].payload, std::string("\x01\x00\x02", 3));
+  RTM_CHECK_EQ(room.received.messages[2].customType, "");
+  RTM_CHECK_EQ(room.received.messages[2].publisher, "teacher");
+
+  BatchingPublisher::Stats stats = publisher.stats();
+  RTM_CHECK_EQ(stats.messages, 3u);
+  RTM_CHECK_EQ(stats.publishes, 1u);
+  RTM_CHECK_EQ(stats.envelopes, 1u);
+  RTM_CHECK_EQ(room.debatcher.stats().messages, 3u);
+  RTM_CHECK(publisher.nextDeadline() == RtmClock::time_point::max());
+}
+
+void testSingleMessageGoesOutPlain() {
+  Classroom room;
+  RecordingEventHandler raw;
+  uint64_t requestId = 0;
+  LoopbackRtmClient* observer = loggedInClient(room.broker, "observer", raw);
+  observer->subscribe("room", SubscribeOptions(), requestId);
+  BatchingPublisher publisher(*room.teacher);
+  RtmClock::time_point start = RtmClock::now();
+  publisher.publish("room", "hello", 5, command("Chat"), start);
+  publisher.flush();
+  RTM_CHECK_EQ(raw.messages.size(), 1u);
+  RTM_CHECK_EQ(raw.messages[0].customType, "Chat");
+  RTM_CHECK_EQ(raw.messages[0].payload, "hello");
+  RTM_CHECK_EQ(publisher.stats().envelopes, 0u);
+  observer->release();
+}
+
+void testSizeLimitKeepsOrder() {
+  Classroom room;
+  BatchingPublisher::Options options;
+  options.maxBatchBytes = 64;
+  BatchingPublisher publisher(*room.teacher, options);
+  RtmClock::time_point start = RtmClock::now();
+  std::string small(20, 's');
+  std::string large(100, 'L');
+  publisher.publish("room", small.data(), small.size(), command("A"), start);
+  publisher.publish("room", small.data(), small.size(), command("B"), start);
+  publisher.publish("room", small.data(), small.size(), command("C"), start);
+  RTM_CHECK_EQ(publisher.stats().fullFlushes, 1u);
+  publisher.publish("room", large.data(), large.size(), command("D"), start);
+  RTM_CHECK_EQ(publisher.pendingMessages(), 0u);
+
+  RTM_CHECK_EQ(room.received.messages.size(), 4u);
+  RTM_CHECK_EQ(room.received.messages[0].customType, "A");
+  RTM_CHECK_EQ(room.received.messages[1].customType, "B");
+  RTM_CHECK_EQ(room.received.messages[2].customType, "C");
+  RTM_CHECK_EQ(room.received.messages[3].payload, large);
+  BatchingPublisher::Stats stats = publisher.stats();
+  RTM_CHECK_EQ(stats.oversized, 1u);
+  RTM_CHECK_EQ(stats.publishes, 3u);
+}
+
+void testPublishedBatchesGiveUpTheirEntries() {
+  Classroom room;
+  BatchingPublisher publisher(*room.teacher);
+  RtmClock::time_point start = RtmClock::now();
+  // A long session passing through many rooms: each round sends to rooms the publisher has not seen.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      std::string channelName = "room-" + std::to_string(round) + "-" + std::to_string(i);
+      publisher.publish(channelName.c_str(), "hi", 2, command("Chat"), start);
+    }
+    RTM_CHECK_EQ(publisher.openBatches(), 100u);
+    start += milliseconds(5);
+    RTM_CHECK_EQ(publisher.poll(start), 100u);
+    RTM_CHECK_EQ(publisher.openBatches(), 0u);
+  }
+  publisher.publish("room", "a", 1, command("A"), start);
+  publisher.publish("room", "b", 1, command("B"), start);
+  RTM_CHECK_EQ(publisher.openBatches(), 1u);
+  RTM_CHECK_EQ(publisher.flush(), 1u);
+  RTM_CHECK_EQ(publisher.openBatches(), 0u);
+  RTM_CHECK(publisher.nextDeadline() == RtmClock::time_point::max());
+  RTM_CHECK_EQ(room.received.messages.size(), 2u);
+  RTM_CHECK_EQ(room.received.messages[1].customType, "B");
+}
+
+void testMalformedEnvelopeIsDropped() {
+  RecordingEventHandler received;
+  DebatchingEventHandler debatcher(received);
+  std::string envelope;
+  MessageBatch::beginEnvelope(envelope);
+  MessageBatch::appendFrame(envelope, RTM_MESSAGE_TYPE_STRING, "A", "ok", 2);
+  MessageBatch::appendFrame(envelope, RTM_MESSAGE_TYPE_STRING, "B", "cut", 3);
+  envelope.resize(envelope.size() - 1);
+
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.messageType = RTM_MESSAGE_TYPE_BINARY;
+  event.channelName = "room";
+  event.customType = MessageBatch::kCustomType;
+  event.message = envelope.data();
+  event.messageLength = envelope.size();
+  debatcher.onMessageEvent(event);
+  RTM_CHECK(received.messages.empty());
+  RTM_CHECK_EQ(debatcher.stats().malformed, 1u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testWindowCoalescesIntoOneEnvelope);
+  RTM_RUN(testSingleMessageGoesOutPlain);
+  RTM_RUN(testSizeLimitKeepsOrder);
+  RTM_RUN(testPublishedBatchesGiveUpTheirEntries);
+  RTM_RUN(testMalformedEnvelopeIsDropped);
+  return 0;
+}
@@ -0,0 +1,260 @@
+//
+//  ChannelMetadataReplicaTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Storage/ChannelMetadataReplica.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+/// A teacher whose replica of "room" is fed through `LossyStorageEvents`, and a student who writes.
+struct Room {
+  explicit Room(ChannelMetadataReplica::Options options = {}) {
+    teacher = loggedInClient(broker, "teacher", mux);
+    student = loggedInClient(broker, "student", studentEvents);
+    replica = std::make_unique<ChannelMetadataReplica>(*teacher->getStorage(), "room", RTM_CHANNEL_TYPE_MESSAGE,
+                                                       options);
+    lossy = std::make_unique<LossyStorageEvents>(*replica);
+    mux.add(*lossy);
+    SubscribeOptions subscribeOptions;
+    subscribeOptions.withMetadata = true;
+    uint64_t requestId = 0;
+    teacher->subscribe("room", subscribeOptions, requestId);
+    teacher->pump();
+  }
+
+  ~Room() {
+    teacher->release();
+    student->release();
+  }
+
+  RTM_ERROR_CODE write(void (IRtmStorage::*operation)(const char*, RTM_CHANNEL_TYPE, const Metadata&,
+                                                      const MetadataOptions&, const char*, uint64_t&),
+                       std::vector<MetadataItem> items) {
+    Metadata data;
+    data.items = items.data();
+    data.itemCount = items.size();
+    MetadataOptions options;
+    options.recordUserId = true;
+    uint64_t requestId = 0;
+    (student->getStorage()->*operation)("room", RTM_CHANNEL_TYPE_MESSAGE, data, options, nullptr, requestId);
+    settle();
+    return studentEvents.resultOf(requestId);
+  }
+
+  RTM_ERROR_CODE set(const char* key, const char* value) {
+    return write(&IRtmStorage::setChannelMetadata, {MetadataItem(key, value)});
+  }
+
+  /// Delivers the results both clients are owed, including those of refetches they trigger.
+  void settle() {
+    while (student->pump() + teacher->pump() > 0) {
+    }
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler studentEvents;
+  LoopbackRtmClient* teacher = nullptr;
+  LoopbackRtmClient* student = nullptr;
+  std::unique_ptr<ChannelMetadataReplica> replica;
+  std::unique_ptr<LossyStorageEvents> lossy;
+};
+
+std::string valueOf(const ChannelMetadataReplica& replica, const char* key) {
+  std::string value;
+  return replica.value(key, value) ? value : "<absent>";
+}
+
+void testEventsApplyIncrementally() {
+  Room room;
+  RTM_CHECK(room.replica->synced());
+  RTM_CHECK_EQ(room.replica->majorRevision(), 0);
+
+  RTM_CHECK_EQ(room.set("raiseHand", "alice"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.write(&IRtmStorage::setChannelMetadata, {MetadataItem("device", "on"), MetadataItem("page", "1")}),
+               RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.write(&IRtmStorage::updateChannelMetadata, {MetadataItem("page", "2")}), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.write(&IRtmStorage::removeChannelMetadata, {MetadataItem("device", nullptr)}), RTM_ERROR_OK);
+
+  RTM_CHECK_EQ(room.replica->majorRevision(), 4);
+  RTM_CHECK_EQ(room.replica->size(), 2u);
+  RTM_CHECK_EQ(valueOf(*room.replica, "raiseHand"), "alice");
+  RTM_CHECK_EQ(valueOf(*room.replica, "page"), "2");
+  RTM_CHECK_EQ(valueOf(*room.replica, "device"), "<absent>");
+  RTM_CHECK_EQ(room.replica->revision("page"), 3);
+  RTM_CHECK_EQ(room.replica->revision("device"), 0);
+  ChannelMetadataReplica::Item item;
+  RTM_CHECK(room.replica->get("raiseHand", item));
+  RTM_CHECK_EQ(item.authorUserId, "student");
+
+  ChannelMetadataReplica::Stats stats = room.replica->stats();
+  RTM_CHECK_EQ(stats.snapshots, 1u);
+  RTM_CHECK_EQ(stats.applied, 4u);
+  RTM_CHECK_EQ(stats.fetches, 0u);
+
+  // Replayed and foreign events change nothing.
+  IRtmEventHandler::StorageEvent stale;
+  stale.storageType = RTM_STORAGE_TYPE_CHANNEL;
+  stale.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  stale.eventType = RTM_STORAGE_EVENT_TYPE_REMOVE;
+  stale.target = "room";
+  stale.data.majorRevision = 2;
+  MetadataItem page("page", nullptr, 2);
+  stale.data.items = &page;
+  stale.data.itemCount = 1;
+  room.replica->onStorageEvent(stale);
+  stale.target = "lobby";
+  stale.data.majorRevision = 5;
+  room.replica->onStorageEvent(stale);
+  RTM_CHECK_EQ(valueOf(*room.replica, "page"), "2");
+  RTM_CHECK_EQ(room.replica->majorRevision(), 4);
+  RTM_CHECK_EQ(room.replica->stats().ignored, 1u);
+}
+
+void testRevisionGapRefetchesOnce() {
+  Room room;
+  RTM_CHECK_EQ(room.set("a", "1"), RTM_ERROR_OK);
+  room.lossy->drops = 2;
+  RTM_CHECK_EQ(room.set("b", "1"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.set("a", "2"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.replica->majorRevision(), 1);
+  RTM_CHECK_EQ(room.replica->stats().fetches, 0u);
+
+  // Revision 4 arrives after 1: it applies at once, and the skip makes the replica fetch what it missed.
+  RTM_CHECK_EQ(room.set("c", "1"), RTM_ERROR_OK);
+  RTM_CHECK(room.replica->synced());
+  RTM_CHECK_EQ(room.replica->majorRevision(), 4);
+  RTM_CHECK_EQ(valueOf(*room.replica, "a"), "2");
+  RTM_CHECK_EQ(valueOf(*room.replica, "b"), "1");
+  RTM_CHECK_EQ(valueOf(*room.replica, "c"), "1");
+  ChannelMetadataReplica::Stats stats = room.replica->stats();
+  RTM_CHECK_EQ(stats.gaps, 1u);
+  RTM_CHECK_EQ(stats.fetches, 1u);
+  RTM_CHECK_EQ(stats.fetchErrors, 0u);
+
+  // Back in step: later events apply without fetching.
+  RTM_CHECK_EQ(room.set("d", "1"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.replica->majorRevision(), 5);
+  RTM_CHECK_EQ(room.replica->stats().fetches, 1u);
+  RTM_CHECK_EQ(room.replica->items().size(), 4u);
+}
+
+void testSkippedRevisionsRefetchAtMostOncePerWindow() {
+  ChannelMetadataReplica::Options options;
+  options.minEventsBetweenFetches = 3;
+  Room room(options);
+  room.lossy->drops = 1;
+  RTM_CHECK_EQ(room.set("a", "1"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.set("b", "1"), RTM_ERROR_OK);
+  RTM_CHECK(room.replica->synced());
+  RTM_CHECK_EQ(room.replica->stats().fetches, 1u);
+
+  // The next skip comes one event after that fetch: it applies, but the copy stays stale for two more events.
+  room.lossy->drops = 1;
+  RTM_CHECK_EQ(room.set("c", "1"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.set("d", "1"), RTM_ERROR_OK);
+  RTM_CHECK(!room.replica->synced());
+  RTM_CHECK_EQ(room.replica->majorRevision(), 4);
+  RTM_CHECK_EQ(valueOf(*room.replica, "c"), "<absent>");
+  RTM_CHECK_EQ(valueOf(*room.replica, "d"), "1");
+  RTM_CHECK_EQ(room.set("e", "1"), RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.replica->stats().fetches, 1u);
+  RTM_CHECK_EQ(room.set("f", "1"), RTM_ERROR_OK);
+  RTM_CHECK(room.replica->synced());
+  RTM_CHECK_EQ(valueOf(*room.replica, "c"), "1");
+  ChannelMetadataReplica::Stats stats = room.replica->stats();
+  RTM_CHECK_EQ(stats.gaps, 2u);
+  RTM_CHECK_EQ(stats.fetches, 2u);
+  RTM_CHECK_EQ(room.replica->size(), 6u);
+}
+
+void testOtherFetchesAnsweredDuringTheFetch() {
+  Room room;
+  RTM_CHECK_EQ(room.set("page", "7"), RTM_ERROR_OK);
+
+  // The app's own fetch succeeds; then the teacher goes offline, so the replica's fetch fails. Both results
+  // arrive while the replica's fetch is being made, the app's first.
+  uint64_t requestId = 0;
+  room.teacher->getChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, requestId);
+  room.teacher->logout(requestId);
+  room.teacher->setResultsInCall(true);
+  RTM_CHECK(room.replica->refresh() != 0);
+  RTM_CHECK(room.replica->synced());
+  RTM_CHECK_EQ(valueOf(*room.replica, "page"), "7");
+  ChannelMetadataReplica::Stats stats = room.replica->stats();
+  RTM_CHECK_EQ(stats.fetches, 1u);
+  RTM_CHECK_EQ(stats.fetchErrors, 1u);
+}
+
+void testKeyIdsSurviveRemoval() {
+  Room room;
+  ChannelMetadataReplica::KeyId hand = room.replica->intern("raiseHand");
+  RTM_CHECK(hand != ChannelMetadataReplica::kInvalidKey);
+  RTM_CHECK_EQ(room.replica->find("raiseHand"), hand);
+  RTM_CHECK_EQ(room.replica->find("unknown"), ChannelMetadataReplica::kInvalidKey);
+  ChannelMetadataReplica::Item item;
+  RTM_CHECK(!room.replica->get(hand, item));
+
+  RTM_CHECK_EQ(room.set("raiseHand", "alice"), RTM_ERROR_OK);
+  RTM_CHECK(room.replica->get(hand, item));
+  RTM_CHECK_EQ(item.value, "alice");
+  RTM_CHECK_EQ(room.write(&IRtmStorage::removeChannelMetadata, {}), RTM_ERROR_OK);
+  RTM_CHECK(!room.replica->get(hand, item));
+  RTM_CHECK_EQ(room.set("raiseHand", "bob"), RTM_ERROR_OK);
+  RTM_CHECK(room.replica->get(hand, item));
+  RTM_CHECK_EQ(item.value, "bob");
+  RTM_CHECK_EQ(room.replica->find("raiseHand"), hand);
+}
+
+void testLateSubscriberCatchesUpWithRefresh() {
+  LoopbackBroker broker;
+  RecordingEventHandler studentEvents;
+  LoopbackRtmClient* student = loggedInClient(broker, "student", studentEvents);
+  MetadataItem item("page", "7");
+  Metadata data;
+  data.items = &item;
+  data.itemCount = 1;
+  uint64_t requestId = 0;
+  student->setChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, MetadataOptions(), nullptr, requestId);
+
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  ChannelMetadataReplica replica(*teacher->getStorage(), "room", RTM_CHANNEL_TYPE_MESSAGE);
+  mux.add(replica);
+  RTM_CHECK(!replica.synced());
+  RTM_CHECK(replica.refresh() != 0);
+  RTM_CHECK(!replica.synced());
+  teacher->pump();
+  RTM_CHECK(replica.synced());
+  RTM_CHECK_EQ(replica.majorRevision(), 1);
+  RTM_CHECK_EQ(valueOf(replica, "page"), "7");
+  teacher->release();
+  student->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testEventsApplyIncrementally);
+  RTM_RUN(testRevisionGapRefetchesOnce);
+  RTM_RUN(testSkippedRevisionsRefetchAtMostOncePerWindow);
+  RTM_RUN(testOtherFetchesAnsweredDuringTheFetch);
+  RTM_RUN(testKeyIdsSurviveRemoval);
+  RTM_RUN(testLateSubscriberCatchesUpWithRefresh);
+  return 0;
+}
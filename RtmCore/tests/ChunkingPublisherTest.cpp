@@ -0,0 +1,326 @@
+//
+//  ChunkingPublisherTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Events/ReassemblingEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Publishing/ChunkingPublisher.h"
+#include "Publishing/MessageChunk.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+std::string snapshot(size_t length) {
+  std::string payload(length, '\0');
+  for (size_t i = 0; i < length; ++i) payload[i] = static_cast<char>('a' + (i * 7 + i / 251) % 26);
+  return payload;
+}
+
+/// The teacher, sending through a rate governor with a chunking publisher on top.
+struct Sender {
+  Sender(LoopbackBroker& broker, RtmClock::time_point now, ChunkingPublisher::Options options = {},
+         RtmRateGovernor::Options limits = {}) {
+    client = loggedInClient(broker, "teacher", mux);
+    limits.onComplete = [this](RtmRateGovernor::Ticket ticket, RTM_ERROR_CODE code) {
+      publisher->onFragmentComplete(ticket, code);
+    };
+    governor = std::make_unique<RtmRateGovernor>(*client, now, limits);
+    mux.add(*governor);
+    options.onComplete = [this](ChunkingPublisher::TransferId transfer, RTM_ERROR_CODE code) {
+      transfers.emplace_back(transfer, code);
+    };
+    publisher = std::make_unique<ChunkingPublisher>(*client, *governor, options);
+  }
+
+  ~Sender() { client->release(); }
+
+  /// Delivers publish results until no fragment is left waiting for one.
+  void settle() {
+    while (client->pump() > 0) {
+    }
+  }
+
+  RtmEventMux mux;
+  LoopbackRtmClient* client = nullptr;
+  std::unique_ptr<RtmRateGovernor> governor;
+  std::unique_ptr<ChunkingPublisher> publisher;
+  std::vector<std::pair<ChunkingPublisher::TransferId, RTM_ERROR_CODE>> transfers;
+};
+
+/// The fragments a subscriber receives for one message, for tests to replay in any order.
+std::vector<std::string> fragmentsOf(const std::string& payload, const char* customType, size_t maxLength) {
+  LoopbackBroker broker;
+  RecordingEventHandler studentEvents;
+  LoopbackRtmClient* student = loggedInClient(broker, "student", studentEvents);
+  uint64_t requestId = 0;
+  student->subscribe("room", SubscribeOptions(), requestId);
+  ChunkingPublisher::Options options;
+  options.maxMessageLength = maxLength;
+  RtmClock::time_point now;
+  Sender teacher(broker, now, options);
+  PublishOptions publish;
+  publish.customType = customType;
+  teacher.publisher->publish("room", payload.data(), payload.size(), publish, requestId);
+  teacher.settle();
+  std::vector<std::string> fragments;
+  for (const auto& message : studentEvents.messages) fragments.push_back(message.payload);
+  student->release();
+  return fragments;
+}
+
+IRtmEventHandler::MessageEvent fragmentEvent(const std::string& payload, const char* publisher = "teacher") {
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.channelName = "room";
+  event.publisher = publisher;
+  event.messageType = RTM_MESSAGE_TYPE_BINARY;
+  event.customType = MessageChunk::kCustomType;
+  event.message = payload.data();
+  event.messageLength = payload.size();
+  return event;
+}
+
+void testSplitsAndReassemblesOverTheWire() {
+  LoopbackBroker broker;
+  RecordingEventHandler studentEvents, oldStudentEvents;
+  RtmClock::time_point now;
+  ReassemblingEventHandler reassembling(studentEvents, now);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", reassembling);
+  LoopbackRtmClient* oldStudent = loggedInClient(broker, "old-student", oldStudentEvents);
+  uint64_t requestId = 0;
+  student->subscribe("room", SubscribeOptions(), requestId);
+  oldStudent->subscribe("room", SubscribeOptions(), requestId);
+
+  RtmRateGovernor::Options limits;
+  limits.publish = {10, 2};
+  Sender teacher(broker, now, ChunkingPublisher::Options(), limits);
+  ChunkingPublisher& publisher = *teacher.publisher;
+  std::string roster = snapshot(100 * 1024);
+  PublishOptions publish;
+  publish.messageType = RTM_MESSAGE_TYPE_STRING;
+  publish.customType = "flat.roster";
+  uint64_t transfer = 0;
+  RTM_CHECK_EQ(publisher.publish("room", roster.data(), roster.size(), publish, transfer), RTM_ERROR_OK);
+  RTM_CHECK(transfer != 0);
+  // Small messages are not held behind the transfer, and carry the SDK's requestId.
+  RTM_CHECK_EQ(publisher.publish("room", "hand up", 7, PublishOptions(), requestId), RTM_ERROR_OK);
+  RTM_CHECK(requestId != 0 && requestId != transfer);
+  RTM_CHECK_EQ(publisher.stats().fragmentsSent, 4u);
+  RTM_CHECK_EQ(publisher.stats().queuedFragments, 4u);
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(studentEvents.messages[0].payload, "hand up");
+
+  // The governor paces the fragments at 10 a second.
+  RTM_CHECK_EQ(oldStudentEvents.messages.size(), 3u);
+  RTM_CHECK(teacher.governor->nextDeadline() == now + milliseconds(100));
+  RTM_CHECK_EQ(teacher.governor->poll(now + milliseconds(100)), 1u);
+  RTM_CHECK_EQ(teacher.governor->poll(now + milliseconds(200)), 1u);
+  RTM_CHECK(teacher.transfers.empty());
+  teacher.settle();
+  RTM_CHECK(teacher.transfers == (std::vector<std::pair<uint64_t, RTM_ERROR_CODE>>{{transfer, RTM_ERROR_OK}}));
+  RTM_CHECK_EQ(publisher.stats().queuedFragments, 0u);
+  RTM_CHECK_EQ(publisher.stats().queuedBytes, 0u);
+
+  RTM_CHECK_EQ(studentEvents.messages.size(), 2u);
+  const RecordingEventHandler::Message& restored = studentEvents.messages[1];
+  RTM_CHECK(restored.payload == roster);
+  RTM_CHECK_EQ(restored.customType, "flat.roster");
+  RTM_CHECK_EQ(restored.publisher, "teacher");
+  RTM_CHECK_EQ(restored.channelName, "room");
+  // Every fragment fits the service's limit.
+  RTM_CHECK_EQ(oldStudentEvents.messages.size(), 5u);
+  for (const auto& message : oldStudentEvents.messages) RTM_CHECK(message.payload.size() <= 32 * 1024);
+  ReassemblingEventHandler::Stats stats = reassembling.stats();
+  RTM_CHECK_EQ(stats.fragments, 4u);
+  RTM_CHECK_EQ(stats.messages, 1u);
+  RTM_CHECK_EQ(stats.bufferedBytes, 0u);
+  RTM_CHECK_EQ(stats.pendingTransfers, 0u);
+
+  // Queued bytes are bounded.
+  ChunkingPublisher::Options small;
+  small.maxQueuedBytes = 64 * 1024;
+  ChunkingPublisher bounded(*teacher.client, *teacher.governor, small);
+  RTM_CHECK_EQ(bounded.publish("room", roster.data(), roster.size(), publish, requestId),
+               RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION);
+  RTM_CHECK_EQ(requestId, 0u);
+  RTM_CHECK_EQ(bounded.stats().rejected, 1u);
+
+  oldStudent->release();
+  student->release();
+}
+
+void testReassemblesTopicMessages() {
+  LoopbackBroker broker;
+  RecordingEventHandler studentEvents;
+  RtmClock::time_point now;
+  ReassemblingEventHandler reassembling(studentEvents, now);
+  Sender teacher(broker, now);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", reassembling);
+  int errorCode = 0;
+  IStreamChannel* teacherChannel = teacher.client->createStreamChannel("class", errorCode);
+  IStreamChannel* studentChannel = student->createStreamChannel("class", errorCode);
+  uint64_t requestId = 0;
+  teacherChannel->join(JoinChannelOptions(), requestId);
+  studentChannel->join(JoinChannelOptions(), requestId);
+  const char* publishers[] = {"teacher"};
+  TopicOptions subscribe;
+  subscribe.users = publishers;
+  subscribe.userCount = 1;
+  teacherChannel->joinTopic("whiteboard", JoinTopicOptions(), requestId);
+  studentChannel->subscribeTopic("whiteboard", subscribe, requestId);
+
+  std::string scenes = snapshot(70 * 1024 + 3);
+  RTM_CHECK_EQ(teacher.publisher->publishTopicMessage(*teacherChannel, "whiteboard", scenes.data(), scenes.size(),
+                                                      TopicMessageOptions(), requestId),
+               RTM_ERROR_OK);
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK(studentEvents.messages[0].payload == scenes);
+  RTM_CHECK_EQ(studentEvents.messages[0].topic, "whiteboard");
+  RTM_CHECK(studentEvents.messages[0].customType.empty());
+  teacher.settle();
+  RTM_CHECK(teacher.transfers == (std::vector<std::pair<uint64_t, RTM_ERROR_CODE>>{{requestId, RTM_ERROR_OK}}));
+
+  studentChannel->release();
+  teacherChannel->release();
+  student->release();
+}
+
+void testRetriesThenAbortsFailedFragments() {
+  LoopbackBroker broker;
+  RecordingEventHandler studentEvents;
+  RtmClock::time_point now;
+  ReassemblingEventHandler reassembling(studentEvents, now);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", reassembling);
+  uint64_t requestId = 0;
+  student->subscribe("room", SubscribeOptions(), requestId);
+  ChunkingPublisher::Options options;
+  options.maxMessageLength = 1024;
+  options.maxFragmentsInFlight = 1;
+  options.maxFragmentRetries = 1;
+  Sender teacher(broker, now, options);
+  std::string payload = snapshot(3000);
+
+  // The teacher drops offline after the first fragment; the second fails, and goes again once it is back.
+  uint64_t first = 0;
+  RTM_CHECK_EQ(teacher.publisher->publish("room", payload.data(), payload.size(), PublishOptions(), first),
+               RTM_ERROR_OK);
+  teacher.client->logout(requestId);
+  teacher.client->pump();
+  RTM_CHECK_EQ(teacher.publisher->stats().fragmentsSent, 2u);
+  teacher.client->login("token", requestId);
+  teacher.settle();
+  ChunkingPublisher::Stats stats = teacher.publisher->stats();
+  RTM_CHECK_EQ(stats.retries, 1u);
+  RTM_CHECK_EQ(stats.fragmentsSent, 5u);
+  RTM_CHECK(teacher.transfers == (std::vector<std::pair<uint64_t, RTM_ERROR_CODE>>{{first, RTM_ERROR_OK}}));
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK(studentEvents.messages[0].payload == payload);
+
+  // Offline for good after the first fragment: the retry fails too, and the fragments still queued are dropped.
+  uint64_t second = 0;
+  RTM_CHECK_EQ(teacher.publisher->publish("room", payload.data(), payload.size(), PublishOptions(), second),
+               RTM_ERROR_OK);
+  teacher.client->logout(requestId);
+  teacher.settle();
+  RTM_CHECK_EQ(teacher.transfers.size(), 2u);
+  RTM_CHECK(teacher.transfers[1] == std::make_pair(second, RTM_ERROR_NOT_LOGIN));
+  stats = teacher.publisher->stats();
+  RTM_CHECK_EQ(stats.aborted, 1u);
+  RTM_CHECK_EQ(stats.retries, 2u);
+  RTM_CHECK_EQ(stats.fragmentsSent, 8u);
+  RTM_CHECK_EQ(stats.queuedFragments, 0u);
+  RTM_CHECK_EQ(stats.queuedBytes, 0u);
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(reassembling.stats().pendingTransfers, 1u);
+
+  student->release();
+}
+
+void testToleratesReorderingAndDuplicates() {
+  std::string payload = snapshot(10000);
+  std::vector<std::string> fragments = fragmentsOf(payload, "flat.snapshot", 1024);
+  RTM_CHECK_EQ(fragments.size(), 11u);
+
+  RecordingEventHandler events;
+  RtmClock::time_point now;
+  ReassemblingEventHandler reassembling(events, now);
+  for (size_t i = fragments.size(); i-- > 0;) {
+    reassembling.onMessageEvent(fragmentEvent(fragments[i]));
+    if (i == 5) reassembling.onMessageEvent(fragmentEvent(fragments[i]));
+    // The same transfer from another publisher is another transfer.
+    if (i == 3) reassembling.onMessageEvent(fragmentEvent(fragments[i], "other"));
+  }
+  RTM_CHECK_EQ(events.messages.size(), 1u);
+  RTM_CHECK(events.messages[0].payload == payload);
+  RTM_CHECK_EQ(events.messages[0].customType, "flat.snapshot");
+  ReassemblingEventHandler::Stats stats = reassembling.stats();
+  RTM_CHECK_EQ(stats.duplicates, 1u);
+  RTM_CHECK_EQ(stats.pendingTransfers, 1u);
+
+  // A truncated fragment is malformed.
+  std::string truncated = fragments[0].substr(0, fragments[0].size() - 1);
+  reassembling.onMessageEvent(fragmentEvent(truncated));
+  RTM_CHECK_EQ(reassembling.stats().malformed, 1u);
+}
+
+void testBoundsAndTimeouts() {
+  std::string payload = snapshot(10000);
+  std::vector<std::string> fragments = fragmentsOf(payload, nullptr, 1024);
+  RecordingEventHandler events;
+  RtmClock::time_point now;
+  ReassemblingEventHandler::Options options;
+  options.maxBufferedBytes = 15000;
+  options.timeout = milliseconds(1000);
+  ReassemblingEventHandler reassembling(events, now, options);
+
+  reassembling.onMessageEvent(fragmentEvent(fragments[0], "a"));
+  RTM_CHECK_EQ(reassembling.stats().bufferedBytes, 10000u);
+  // A second transfer would exceed the buffer.
+  reassembling.onMessageEvent(fragmentEvent(fragments[0], "b"));
+  RTM_CHECK_EQ(reassembling.stats().rejected, 1u);
+  RTM_CHECK(reassembling.nextDeadline() == now + milliseconds(1000));
+
+  // Fragments keep the transfer alive; silence expires it.
+  RTM_CHECK_EQ(reassembling.poll(now + milliseconds(900)), 0u);
+  reassembling.onMessageEvent(fragmentEvent(fragments[1], "a"));
+  RTM_CHECK_EQ(reassembling.poll(now + milliseconds(1500)), 0u);
+  RTM_CHECK_EQ(reassembling.poll(now + milliseconds(1900)), 1u);
+  ReassemblingEventHandler::Stats stats = reassembling.stats();
+  RTM_CHECK_EQ(stats.expired, 1u);
+  RTM_CHECK_EQ(stats.bufferedBytes, 0u);
+  RTM_CHECK(reassembling.nextDeadline() == RtmClock::time_point::max());
+
+  // With the buffer free again, another publisher's transfer goes through.
+  for (const std::string& fragment : fragments) reassembling.onMessageEvent(fragmentEvent(fragment, "b"));
+  RTM_CHECK_EQ(events.messages.size(), 1u);
+  RTM_CHECK(events.messages[0].payload == payload);
+  RTM_CHECK(events.messages[0].customType.empty());
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testSplitsAndReassemblesOverTheWire);
+  RTM_RUN(testReassemblesTopicMessages);
+  RTM_RUN(testRetriesThenAbortsFailedFragments);
+  RTM_RUN(testToleratesReorderingAndDuplicates);
+  RTM_RUN(testBoundsAndTimeouts);
+  return 0;
+}
@@ -0,0 +1,204 @@
+//
+//  CompressingPublisherTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <string>
+
+#include "Command/RtmCommandCodec.h"
+#include "Events/DecompressingEventHandler.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Publishing/CompressingPublisher.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+/// A notice with a paragraph of text, as JSON.
+std::string noticeJson() {
+  RtmCommand notice;
+  notice.type = RtmCommandType::notice;
+  notice.roomUUID = "5f1c8a3e-2b7d-4c9a-9e0f-61d2b3a4c5e6";
+  notice.text = "Please open the worksheet on page 12 and finish the first three exercises, then share your "
+                "answers in the chat. We will review the exercises together after the break.";
+  std::string json;
+  RtmCommandCodec::encode(notice, RtmCommandCodec::Format::json, json);
+  return json;
+}
+
+/// A scene list like the whiteboard's, which repeats itself a lot.
+std::string sceneListJson() {
+  std::string json = R"({"scenePath":"/","scenes":[)";
+  for (int page = 1; page <= 40; ++page) {
+    if (page > 1) json += ',';
+    json += R"({"name":")" + std::to_string(page) +
+            R"(","ppt":{"height":720,"width":1280,"src":"pptx://convertcdn.netless.link/dynamicConvert/)"
+            R"(6a212c90fa5311ea8b9c074232aaccd4/)" +
+            std::to_string(page) + R"(.slide"}})";
+  }
+  return json + "]}";
+}
+
+struct Room {
+  Room() : studentInflating(studentEvents) {
+    teacher = loggedInClient(broker, "teacher", teacherEvents);
+    student = loggedInClient(broker, "student", studentInflating);
+    oldStudent = loggedInClient(broker, "old-student", oldStudentEvents);
+    uint64_t requestId = 0;
+    student->subscribe("room", SubscribeOptions(), requestId);
+    oldStudent->subscribe("room", SubscribeOptions(), requestId);
+  }
+
+  ~Room() {
+    oldStudent->release();
+    student->release();
+    teacher->release();
+  }
+
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents, studentEvents, oldStudentEvents;
+  DecompressingEventHandler studentInflating;
+  LoopbackRtmClient* teacher;
+  LoopbackRtmClient* student;
+  LoopbackRtmClient* oldStudent;
+};
+
+void testCompressesOnlyNegotiatedChannels() {
+  Room room;
+  CompressingPublisher publisher(*room.teacher);
+  std::string notice = noticeJson();
+  PublishOptions options;
+  options.messageType = RTM_MESSAGE_TYPE_STRING;
+  uint64_t requestId = 0;
+
+  // Before negotiation every client, old or new, gets the message as published.
+  publisher.publish("room", notice.data(), notice.size(), options, requestId);
+  RTM_CHECK_EQ(room.oldStudentEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(room.oldStudentEvents.messages[0].payload, notice);
+  RTM_CHECK_EQ(room.studentEvents.messages[0].payload, notice);
+  RTM_CHECK_EQ(publisher.stats().compressed, 0u);
+
+  publisher.enable("room");
+  RTM_CHECK(publisher.enabled("room") && !publisher.enabled("other"));
+  options.customType = "flat.notice";
+  publisher.publish("room", notice.data(), notice.size(), options, requestId);
+  RTM_CHECK_EQ(room.studentEvents.messages.size(), 2u);
+  const RecordingEventHandler::Message& restored = room.studentEvents.messages[1];
+  RTM_CHECK_EQ(restored.payload, notice);
+  RTM_CHECK_EQ(restored.customType, "flat.notice");
+  RTM_CHECK_EQ(restored.publisher, "teacher");
+  RTM_CHECK_EQ(room.oldStudentEvents.messages[1].customType, PayloadCompression::kCustomType);
+
+  CompressingPublisher::Stats stats = publisher.stats();
+  RTM_CHECK_EQ(stats.messages, 2u);
+  RTM_CHECK_EQ(stats.compressed, 1u);
+  RTM_CHECK(stats.bytesSaved() > 0);
+  RTM_CHECK(room.oldStudentEvents.messages[1].payload.size() < notice.size());
+  DecompressingEventHandler::Stats inflated = room.studentInflating.stats();
+  RTM_CHECK_EQ(inflated.inflated, 1u);
+  RTM_CHECK_EQ(inflated.bytesOut, static_cast<uint64_t>(notice.size()));
+  RTM_CHECK_EQ(inflated.bytesIn + stats.bytesSaved(), static_cast<uint64_t>(notice.size()));
+
+  // Short and incompressible messages go out as they are.
+  publisher.publish("room", "hand up", 7, PublishOptions(), requestId);
+  std::string noise(512, '\0');
+  uint32_t state = 1;
+  for (char& c : noise) c = static_cast<char>((state = state * 1103515245u + 12345u) >> 24);
+  publisher.publish("room", noise.data(), noise.size(), PublishOptions(), requestId);
+  RTM_CHECK_EQ(room.oldStudentEvents.messages[2].payload, "hand up");
+  RTM_CHECK_EQ(room.oldStudentEvents.messages[3].payload, noise);
+  RTM_CHECK_EQ(publisher.stats().uncompressed, 2u);
+
+  publisher.disable("room");
+  publisher.publish("room", notice.data(), notice.size(), options, requestId);
+  RTM_CHECK_EQ(room.oldStudentEvents.messages[4].payload, notice);
+}
+
+void testCompressesTopicMessages() {
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents, studentEvents;
+  DecompressingEventHandler studentInflating(studentEvents);
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", teacherEvents);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", studentInflating);
+  int errorCode = 0;
+  IStreamChannel* teacherChannel = teacher->createStreamChannel("class", errorCode);
+  IStreamChannel* studentChannel = student->createStreamChannel("class", errorCode);
+  uint64_t requestId = 0;
+  teacherChannel->join(JoinChannelOptions(), requestId);
+  studentChannel->join(JoinChannelOptions(), requestId);
+  const char* publishers[] = {"teacher"};
+  TopicOptions subscribe;
+  subscribe.users = publishers;
+  subscribe.userCount = 1;
+  teacherChannel->joinTopic("whiteboard", JoinTopicOptions(), requestId);
+  studentChannel->subscribeTopic("whiteboard", subscribe, requestId);
+
+  CompressingPublisher publisher(*teacher);
+  publisher.enable("class");
+  std::string scenes = sceneListJson();
+  TopicMessageOptions options;
+  options.messageType = RTM_MESSAGE_TYPE_STRING;
+  publisher.publishTopicMessage(*teacherChannel, "whiteboard", scenes.data(), scenes.size(), options, requestId);
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(studentEvents.messages[0].payload, scenes);
+  RTM_CHECK_EQ(studentEvents.messages[0].topic, "whiteboard");
+  RTM_CHECK(studentEvents.messages[0].customType.empty());
+  // Repetitive JSON shrinks several times over.
+  RTM_CHECK(publisher.stats().bytesOut * 5 < scenes.size());
+
+  studentChannel->release();
+  teacherChannel->release();
+  student->release();
+  teacher->release();
+}
+
+void testDropsMalformedFrames() {
+  RecordingEventHandler events;
+  DecompressingEventHandler inflating(events);
+  PayloadDeflater deflater;
+  std::string notice = noticeJson();
+  std::string frame;
+  RTM_CHECK(deflater.deflate(RTM_MESSAGE_TYPE_STRING, "", notice.data(), notice.size(), frame));
+
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.channelName = "room";
+  event.messageType = RTM_MESSAGE_TYPE_BINARY;
+  event.customType = PayloadCompression::kCustomType;
+  for (size_t length = 0; length < frame.size(); ++length) {
+    event.message = frame.data();
+    event.messageLength = length;
+    inflating.onMessageEvent(event);
+  }
+  std::string corrupt = frame;
+  corrupt[corrupt.size() / 2] ^= 0x5A;
+  std::string trailing = frame + "x";
+  for (const std::string* bad : {&corrupt, &trailing}) {
+    event.message = bad->data();
+    event.messageLength = bad->size();
+    inflating.onMessageEvent(event);
+  }
+  RTM_CHECK(events.messages.empty());
+  RTM_CHECK_EQ(inflating.stats().malformed, static_cast<uint64_t>(frame.size() + 2));
+
+  event.message = frame.data();
+  event.messageLength = frame.size();
+  inflating.onMessageEvent(event);
+  RTM_CHECK_EQ(events.messages.size(), 1u);
+  RTM_CHECK_EQ(events.messages[0].payload, notice);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testCompressesOnlyNegotiatedChannels);
+  RTM_RUN(testCompressesTopicMessages);
+  RTM_RUN(testDropsMalformedFrames);
+  return 0;
+}
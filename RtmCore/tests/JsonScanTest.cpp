@@ -0,0 +1,99 @@
+//
+//  JsonScanTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Command/RtmCommandCodec.h"
+#include "Common/JsonScan.h"
+#include "TestSupport.h"
+
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+void testEveryKernelStopsAtTheSameByte() {
+  std::vector<const JsonScanKernels*> kernels = availableJsonScanKernels();
+  RTM_CHECK(!kernels.empty());
+  const JsonScanKernels& scalar = *kernels.front();
+
+  // Each byte value alone, at every position of a buffer longer than two AVX2 registers.
+  std::string buffer(80, 'a');
+  for (int byte = 0; byte < 256; ++byte) {
+    for (size_t at = 0; at < buffer.size(); ++at) {
+      std::string probe = buffer;
+      probe[at] = static_cast<char>(byte);
+      const char* begin = probe.data();
+      const char* end = begin + probe.size();
+      for (const JsonScanKernels* kernel : kernels) {
+        RTM_CHECK(kernel->stringStop(begin, end) == scalar.stringStop(begin, end));
+        RTM_CHECK(kernel->structural(begin, end) == scalar.structural(begin, end));
+      }
+    }
+  }
+  RTM_CHECK(scalar.stringStop(buffer.data(), buffer.data() + buffer.size()) == buffer.data() + buffer.size());
+
+  // Bytes of UTF-8 text are never control characters, however a signed compare would read them.
+  std::string text = "准备 😀 é";
+  for (const JsonScanKernels* kernel : kernels) {
+    RTM_CHECK(kernel->stringStop(text.data(), text.data() + text.size()) == text.data() + text.size());
+  }
+
+  // Random buffers at every start offset and length, so every tail length is covered.
+  std::mt19937 random(7);
+  const char alphabet[] = "ab{}[]\"\\ \x01\x1f\x7f\x80\xff:,";
+  for (int round = 0; round < 200; ++round) {
+    std::string input(100, ' ');
+    for (char& c : input) c = alphabet[random() % (sizeof(alphabet) - 1)];
+    for (size_t offset = 0; offset < 40; ++offset) {
+      for (size_t length = 0; offset + length <= input.size(); length += 7) {
+        const char* begin = input.data() + offset;
+        const char* end = begin + length;
+        for (const JsonScanKernels* kernel : kernels) {
+          RTM_CHECK(kernel->stringStop(begin, end) == scalar.stringStop(begin, end));
+          RTM_CHECK(kernel->structural(begin, end) == scalar.structural(begin, end));
+        }
+      }
+    }
+  }
+}
+
+void testCodecReadsTheSameWithEveryKernel() {
+  std::string longText(300, 'x');
+  longText.replace(100, 2, "\\n");
+  longText.replace(250, 6, "\\u00e9");
+  std::string json = R"({"extra":{"list":[1,"]}\"",{"deep":[[{}]]}],"s":")" + std::string(70, '{') +
+                     R"("},"t":"notice","v":{"roomUUID":"5f1c8a3e-2b7d-4c9a-9e0f-61d2b3a4c5e6","text":")" + longText +
+                     R"("}})";
+  std::string expected(300, 'x');
+  expected.replace(100, 2, "\n");
+  expected.replace(249, 6, "é");
+  for (const JsonScanKernels* kernel : availableJsonScanKernels()) {
+    RtmCommandCodec codec(*kernel);
+    RtmCommand command;
+    RTM_CHECK(codec.decode(json, RtmCommandCodec::Format::json, command));
+    RTM_CHECK(command.type == RtmCommandType::notice);
+    RTM_CHECK(command.roomUUID == "5f1c8a3e-2b7d-4c9a-9e0f-61d2b3a4c5e6");
+    RTM_CHECK(command.text == expected);
+
+    // Skipped values must still end: an unclosed container or string, or a raw control character, fails.
+    for (const char* bad : {R"({"x":[{"a":1},"t":"notice"})", R"({"x":"abc\"})", "{\"x\":[\"a\x01\"],\"t\":\"ban\"}"}) {
+      RTM_CHECK(!codec.decode(bad, RtmCommandCodec::Format::json, command));
+      RTM_CHECK(command.text == "decode command error");
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testEveryKernelStopsAtTheSameByte);
+  RTM_RUN(testCodecReadsTheSameWithEveryKernel);
+  return 0;
+}
@@ -0,0 +1,220 @@
+//
+//  LockStateMirrorTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Lock/LockStateMirror.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::seconds;
+
+std::string ownerOf(const LockStateMirror& mirror, const char* lockName) {
+  std::string owner;
+  if (!mirror.owner(lockName, owner)) return "<absent>";
+  return owner;
+}
+
+void subscribeWithLock(LoopbackRtmClient* client) {
+  SubscribeOptions options;
+  options.withLock = true;
+  uint64_t requestId = 0;
+  client->subscribe("class", options, requestId);
+}
+
+void testFollowsLockEvents() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  LoopbackRtmClient* assistant = loggedInClient(broker, "assistant", quiet);
+  LockStateMirror mirror(*teacher->getLock(), "class", RTM_CHANNEL_TYPE_MESSAGE, RtmClock::now());
+  mux.add(mirror);
+  subscribeWithLock(assistant);
+  uint64_t requestId = 0;
+  assistant->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", 10, requestId);
+  assistant->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+
+  // The snapshot that comes with the subscription fills the mirror.
+  RTM_CHECK(!mirror.synced());
+  subscribeWithLock(teacher);
+  RTM_CHECK(mirror.synced());
+  RTM_CHECK_EQ(ownerOf(mirror, "presenter"), "assistant");
+  LockStateMirror::LockId presenter = mirror.find("presenter");
+  RTM_CHECK(presenter != LockStateMirror::kInvalidLock);
+
+  assistant->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", 30, requestId);
+  RTM_CHECK_EQ(mirror.size(), 2u);
+  RTM_CHECK_EQ(ownerOf(mirror, "whiteboard"), "");
+  teacher->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", false, requestId);
+  RTM_CHECK_EQ(ownerOf(mirror, "whiteboard"), "teacher");
+  LockStateMirror::Lock lock;
+  RTM_CHECK(mirror.get("whiteboard", lock) && lock.ttl == 30u);
+
+  assistant->releaseLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  std::string owner = "?";
+  RTM_CHECK(mirror.owner(presenter, owner) && owner.empty());
+  assistant->removeLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  RTM_CHECK_EQ(ownerOf(mirror, "presenter"), "<absent>");
+  RTM_CHECK_EQ(mirror.find("presenter"), presenter);
+  RTM_CHECK_EQ(mirror.size(), 1u);
+
+  // A fetch gives the same answer as the events.
+  LockStateMirror fetched(*teacher->getLock(), "class", RTM_CHANNEL_TYPE_MESSAGE, RtmClock::now());
+  mux.add(fetched);
+  RTM_CHECK(fetched.refresh() != 0);
+  RTM_CHECK(!fetched.synced());
+  teacher->pump();
+  RTM_CHECK(fetched.synced());
+  RTM_CHECK_EQ(ownerOf(fetched, "whiteboard"), "teacher");
+  RTM_CHECK_EQ(fetched.stats().fetches, 1u);
+  RTM_CHECK_EQ(mirror.stats().fetches, 0u);
+
+  assistant->release();
+  teacher->release();
+}
+
+void testOtherFetchesAnsweredDuringTheFetch() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  LoopbackRtmClient* assistant = loggedInClient(broker, "assistant", quiet);
+  LockStateMirror mirror(*teacher->getLock(), "class", RTM_CHANNEL_TYPE_MESSAGE, RtmClock::now());
+  mux.add(mirror);
+  subscribeWithLock(assistant);
+  uint64_t requestId = 0;
+  assistant->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", 10, requestId);
+  assistant->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+
+  // The app's own fetch succeeds; then the teacher goes offline, so the mirror's fetch fails. Both results
+  // arrive while the mirror's fetch is being made, the app's first.
+  teacher->getLock()->getLocks("class", RTM_CHANNEL_TYPE_MESSAGE, requestId);
+  teacher->logout(requestId);
+  teacher->setResultsInCall(true);
+  RTM_CHECK(mirror.refresh() != 0);
+  RTM_CHECK(mirror.synced());
+  RTM_CHECK_EQ(ownerOf(mirror, "presenter"), "assistant");
+  LockStateMirror::Stats stats = mirror.stats();
+  RTM_CHECK_EQ(stats.snapshots, 1u);
+  RTM_CHECK_EQ(stats.fetchErrors, 1u);
+
+  assistant->release();
+  teacher->release();
+}
+
+void testPredictsExpiryWhenOwnerLeaves() {
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  LoopbackBroker::Options options;
+  options.clock = [&now] { return now; };
+  LoopbackBroker broker(options);
+  RtmEventMux mux;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  LockStateMirror mirror(*teacher->getLock(), "class", RTM_CHANNEL_TYPE_MESSAGE, start);
+  mux.add(mirror);
+  subscribeWithLock(teacher);
+  subscribeWithLock(alice);
+  subscribeWithLock(bob);
+  uint64_t requestId = 0;
+  alice->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", 10, requestId);
+  alice->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+  bob->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", 20, requestId);
+  bob->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", false, requestId);
+  RTM_CHECK_EQ(ownerOf(mirror, "presenter"), "alice");
+
+  // Alice leaves: her lock counts down from the last poll and is freed before the service says so.
+  mirror.poll(start + seconds(1));
+  now = start + seconds(1);
+  alice->unsubscribe("class", requestId);
+  LockStateMirror::Lock lock;
+  RTM_CHECK(mirror.get("presenter", lock) && lock.expiring);
+  RTM_CHECK(lock.expiresAt == start + seconds(11));
+  now = start + seconds(10);
+  broker.expireLocks();
+  RTM_CHECK_EQ(mirror.poll(start + seconds(10)), 0u);
+  RTM_CHECK_EQ(ownerOf(mirror, "presenter"), "alice");
+  RTM_CHECK_EQ(mirror.poll(start + seconds(11)), 1u);
+  RTM_CHECK(mirror.get("presenter", lock) && lock.owner.empty() && lock.predicted && !lock.expiring);
+  now = start + seconds(11);
+  broker.expireLocks();
+  RTM_CHECK(mirror.get("presenter", lock) && !lock.predicted);
+
+  // Bob leaves and comes back within the ttl: his lock stays his.
+  bob->unsubscribe("class", requestId);
+  RTM_CHECK(mirror.get("whiteboard", lock) && lock.expiring);
+  now = start + seconds(20);
+  subscribeWithLock(bob);
+  now = start + seconds(60);
+  broker.expireLocks();
+  RTM_CHECK_EQ(mirror.poll(start + seconds(60)), 0u);
+  RTM_CHECK_EQ(ownerOf(mirror, "whiteboard"), "bob");
+
+  LockStateMirror::Stats stats = mirror.stats();
+  RTM_CHECK_EQ(stats.countdowns, 2u);
+  RTM_CHECK_EQ(stats.predictedExpiries, 1u);
+  RTM_CHECK_EQ(stats.confirmedExpiries, 1u);
+  bob->release();
+  alice->release();
+  teacher->release();
+}
+
+void testLooksUpAcquireWithoutOwner() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler bobEvents;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  LockStateMirror mirror(*teacher->getLock(), "class", RTM_CHANNEL_TYPE_MESSAGE, RtmClock::now());
+  mux.add(mirror);
+  subscribeWithLock(teacher);
+  subscribeWithLock(bob);
+  uint64_t requestId = 0;
+  bob->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", 20, requestId);
+
+  // The loopback always names the new owner, so the ownerless acquire the service can send is built by hand.
+  LockDetail detail;
+  detail.lockName = "whiteboard";
+  detail.owner = "";
+  detail.ttl = 20;
+  IRtmEventHandler::LockEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.eventType = RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED;
+  event.channelName = "class";
+  event.lockDetailList = &detail;
+  event.count = 1;
+  bob->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", false, requestId);
+  mirror.onLockEvent(event);
+  teacher->pump();
+  RTM_CHECK_EQ(ownerOf(mirror, "whiteboard"), "bob");
+  RTM_CHECK_EQ(mirror.stats().fetches, 1u);
+  bob->release();
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testFollowsLockEvents);
+  RTM_RUN(testPredictsExpiryWhenOwnerLeaves);
+  RTM_RUN(testLooksUpAcquireWithoutOwner);
+  RTM_RUN(testOtherFetchesAnsweredDuringTheFetch);
+  return 0;
+}
@@ -0,0 +1,432 @@
+//
+//  LoopbackRtmClientTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "IAgoraRtmClient.h"
+#include "IAgoraStreamChannel.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+void subscribe(LoopbackRtmClient* client, const char* channelName, bool withMetadata = false, bool withLock = false) {
+  SubscribeOptions options;
+  options.withMetadata = withMetadata;
+  options.withLock = withLock;
+  uint64_t requestId = 0;
+  client->subscribe(channelName, options, requestId);
+}
+
+void publish(LoopbackRtmClient* client, const char* channelName, const std::string& payload, uint64_t& requestId,
+             RTM_CHANNEL_TYPE channelType = RTM_CHANNEL_TYPE_MESSAGE) {
+  PublishOptions options;
+  options.channelType = channelType;
+  client->publish(channelName, payload.data(), payload.size(), options, requestId);
+}
+
+void testLoginEmitsLinkStates() {
+  LoopbackBroker broker;
+  RecordingEventHandler handler;
+  LoopbackRtmClient* client = loggedInClient(broker, "alice", handler);
+  RTM_CHECK(client->isOnline());
+  RTM_CHECK(!handler.linkStates.empty());
+  RTM_CHECK_EQ(handler.linkStates.back(), RTM_LINK_STATE_CONNECTED);
+  client->release();
+}
+
+void testChannelPublishSkipsPublisher() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  subscribe(alice, "room");
+  subscribe(bob, "room");
+
+  uint64_t requestId = 0;
+  publish(alice, "room", "hello", requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  RTM_CHECK(aliceEvents.messages.empty());
+  RTM_CHECK_EQ(bobEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(bobEvents.messages[0].payload, "hello");
+  RTM_CHECK_EQ(bobEvents.messages[0].publisher, "alice");
+  RTM_CHECK_EQ(bobEvents.messages[0].channelName, "room");
+
+  publish(alice, "empty-room", "nobody", requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+
+  bob->release();
+  alice->release();
+}
+
+void testUserChannelPublish() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+
+  uint64_t requestId = 0;
+  publish(alice, "bob", "p2p", requestId, RTM_CHANNEL_TYPE_USER);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  RTM_CHECK_EQ(bobEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(bobEvents.messages[0].channelType, RTM_CHANNEL_TYPE_USER);
+  RTM_CHECK_EQ(bobEvents.messages[0].channelName, "alice");
+
+  publish(alice, "carol", "p2p", requestId, RTM_CHANNEL_TYPE_USER);
+  alice->pump();
+  RTM_CHECK_EQ(aliceEvents.resultOf(requestId), RTM_ERROR_CHANNEL_RECEIVER_OFFLINE);
+
+  bob->release();
+  alice->release();
+}
+
+void testPresenceJoinAndSnapshot() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  subscribe(alice, "room");
+  subscribe(bob, "room");
+
+  RTM_CHECK(!aliceEvents.presences.empty());
+  RTM_CHECK_EQ(aliceEvents.presences.back().type, RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL);
+  RTM_CHECK_EQ(aliceEvents.presences.back().publisher, "bob");
+  RTM_CHECK(!bobEvents.presences.empty());
+  RTM_CHECK_EQ(bobEvents.presences.back().type, RTM_PRESENCE_EVENT_TYPE_SNAPSHOT);
+  RTM_CHECK_EQ(bobEvents.presences.back().users.size(), 2u);
+
+  uint64_t requestId = 0;
+  StateItem item;
+  item.key = "camera";
+  item.value = "on";
+  bob->setState("room", RTM_CHANNEL_TYPE_MESSAGE, &item, 1, requestId);
+  bob->pump();
+  RTM_CHECK(bobEvents.succeeded(requestId));
+  RTM_CHECK_EQ(aliceEvents.presences.back().type, RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED);
+  RTM_CHECK_EQ(aliceEvents.presences.back().states["camera"], "on");
+
+  bob->unsubscribe("room", requestId);
+  RTM_CHECK_EQ(aliceEvents.presences.back().type, RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL);
+
+  bob->release();
+  alice->release();
+}
+
+void testWhoNowPaging() {
+  LoopbackBroker::Options options;
+  options.presencePageSize = 2;
+  LoopbackBroker broker(options);
+  RecordingEventHandler handlers[5];
+  LoopbackRtmClient* clients[5];
+  for (int i = 0; i < 5; ++i) {
+    std::string userId = "user" + std::to_string(i);
+    clients[i] = loggedInClient(broker, userId.c_str(), handlers[i]);
+    subscribe(clients[i], "room");
+  }
+
+  RecordingEventHandler& events = handlers[0];
+  PresenceOptions presenceOptions;
+  presenceOptions.includeUserId = true;
+  uint64_t requestId = 0;
+  size_t seen = 0;
+  int pages = 0;
+  std::string page;
+  do {
+    presenceOptions.page = page.empty() ? nullptr : page.c_str();
+    clients[0]->whoNow("room", RTM_CHANNEL_TYPE_MESSAGE, presenceOptions, requestId);
+    clients[0]->pump();
+    RTM_CHECK(events.succeeded(requestId));
+    seen += events.lastUsers.size();
+    page = events.lastNextPage;
+    ++pages;
+  } while (!page.empty());
+  RTM_CHECK_EQ(seen, 5u);
+  RTM_CHECK_EQ(pages, 3);
+
+  for (LoopbackRtmClient* client : clients) client->release();
+}
+
+void testChannelMetadataRevisions() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  subscribe(alice, "room", true);
+  subscribe(bob, "room", true);
+
+  MetadataItem item;
+  item.key = "status";
+  item.value = "started";
+  Metadata data;
+  data.items = &item;
+  data.itemCount = 1;
+  MetadataOptions options;
+  uint64_t requestId = 0;
+  alice->setChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, options, nullptr, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  RTM_CHECK(!bobEvents.storages.empty());
+  RTM_CHECK_EQ(bobEvents.storages.back().type, RTM_STORAGE_EVENT_TYPE_SET);
+  RTM_CHECK_EQ(bobEvents.storages.back().items["status"], "started");
+  int64_t revision = bobEvents.storages.back().majorRevision;
+  RTM_CHECK(revision > 0);
+
+  data.majorRevision = revision + 100;
+  item.value = "paused";
+  bob->updateChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, options, nullptr, requestId);
+  bob->pump();
+  RTM_CHECK_EQ(bobEvents.resultOf(requestId), RTM_ERROR_STORAGE_OUTDATED_REVISION);
+
+  data.majorRevision = revision;
+  bob->updateChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, options, nullptr, requestId);
+  bob->pump();
+  RTM_CHECK(bobEvents.succeeded(requestId));
+  RTM_CHECK_EQ(aliceEvents.storages.back().items["status"], "paused");
+
+  bob->release();
+  alice->release();
+}
+
+void testLockHandoff() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  subscribe(alice, "room", false, true);
+  subscribe(bob, "room", false, true);
+
+  uint64_t requestId = 0;
+  alice->setLock("room", RTM_CHANNEL_TYPE_MESSAGE, "board", 10, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  alice->acquireLock("room", RTM_CHANNEL_TYPE_MESSAGE, "board", false, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+
+  uint64_t bobRequest = 0;
+  bob->acquireLock("room", RTM_CHANNEL_TYPE_MESSAGE, "board", true, bobRequest);
+  RTM_CHECK(bobEvents.results.find(bobRequest) == bobEvents.results.end());
+
+  alice->releaseLock("room", RTM_CHANNEL_TYPE_MESSAGE, "board", requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  bob->pump();
+  RTM_CHECK(bobEvents.succeeded(bobRequest));
+
+  bob->release();
+  alice->release();
+}
+
+void testStreamChannelTopics() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  int errorCode = 0;
+  IStreamChannel* aliceChannel = alice->createStreamChannel("stream", errorCode);
+  IStreamChannel* bobChannel = bob->createStreamChannel("stream", errorCode);
+  RTM_CHECK(aliceChannel && bobChannel);
+
+  JoinChannelOptions joinOptions;
+  uint64_t requestId = 0;
+  aliceChannel->join(joinOptions, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  bobChannel->join(joinOptions, requestId);
+  bob->pump();
+  RTM_CHECK(bobEvents.succeeded(requestId));
+
+  JoinTopicOptions topicOptions;
+  aliceChannel->joinTopic("whiteboard", topicOptions, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+
+  const char* publishers[] = {"alice"};
+  TopicOptions subscribeOptions;
+  subscribeOptions.users = publishers;
+  subscribeOptions.userCount = 1;
+  bobChannel->subscribeTopic("whiteboard", subscribeOptions, requestId);
+  bob->pump();
+  RTM_CHECK(bobEvents.succeeded(requestId));
+
+  TopicMessageOptions messageOptions;
+  const char* payload = "stroke";
+  aliceChannel->publishTopicMessage("whiteboard", payload, std::strlen(payload), messageOptions, requestId);
+  alice->pump();
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  RTM_CHECK_EQ(bobEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(bobEvents.messages[0].topic, "whiteboard");
+  RTM_CHECK_EQ(bobEvents.messages[0].payload, "stroke");
+
+  bobChannel->release();
+  aliceChannel->release();
+  bob->release();
+  alice->release();
+}
+
+/// Issues a second publish from inside the first one's result.
+struct ChainingHandler : RecordingEventHandler {
+  void onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) override {
+    RecordingEventHandler::onPublishResult(requestId, errorCode);
+    if (client && !chained) publish(client, "room", "second", chained);
+  }
+
+  LoopbackRtmClient* client = nullptr;
+  uint64_t chained = 0;
+};
+
+void testResultsWaitForPump() {
+  LoopbackBroker broker;
+  ChainingHandler aliceEvents;
+  RecordingEventHandler bobEvents;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", bobEvents);
+  subscribe(bob, "room");
+  bob->pump();
+
+  // The call returns its id first; the message itself is out at once.
+  uint64_t requestId = 0;
+  publish(alice, "room", "first", requestId);
+  RTM_CHECK(requestId != 0);
+  RTM_CHECK(aliceEvents.results.find(requestId) == aliceEvents.results.end());
+  RTM_CHECK_EQ(bobEvents.messages.size(), 1u);
+
+  // A request made by a result callback is answered by the next pump.
+  aliceEvents.client = alice;
+  RTM_CHECK_EQ(alice->pump(), 1u);
+  RTM_CHECK(aliceEvents.succeeded(requestId));
+  RTM_CHECK(aliceEvents.chained != 0);
+  RTM_CHECK(aliceEvents.results.find(aliceEvents.chained) == aliceEvents.results.end());
+  RTM_CHECK_EQ(alice->pump(), 1u);
+  RTM_CHECK(aliceEvents.succeeded(aliceEvents.chained));
+  RTM_CHECK_EQ(alice->pump(), 0u);
+
+  // Results go to the client that made the request, in request order.
+  uint64_t first = 0, second = 0;
+  aliceEvents.client = nullptr;
+  publish(alice, "room", "a", first);
+  publish(bob, "room", "b", second);
+  RTM_CHECK(bobEvents.results.find(second) == bobEvents.results.end());
+  RTM_CHECK_EQ(bob->pump(), 1u);
+  RTM_CHECK(bobEvents.succeeded(second));
+  RTM_CHECK(aliceEvents.results.find(first) == aliceEvents.results.end());
+
+  // Released with a result still queued: it is dropped.
+  bob->release();
+  alice->release();
+}
+
+void testResultsInCall() {
+  LoopbackBroker broker;
+  RecordingEventHandler events;
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", events);
+  uint64_t queued = 0, answered = 0;
+  publish(alice, "room", "queued", queued);
+  alice->setResultsInCall(true);
+  publish(alice, "room", "answered", answered);
+  RTM_CHECK(events.succeeded(queued));
+  RTM_CHECK(events.succeeded(answered));
+  RTM_CHECK_EQ(alice->pump(), 0u);
+  alice->release();
+}
+
+/// Records results from the dispatcher thread and lets the test wait for them.
+class WaitingHandler : public IRtmEventHandler {
+ public:
+  void onLoginResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) override { record(requestId, errorCode); }
+  void onPublishResult(const uint64_t requestId, RTM_ERROR_CODE errorCode) override { record(requestId, errorCode); }
+
+  bool waitFor(uint64_t requestId) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return arrived.wait_for(lock, std::chrono::seconds(5), [&] { return results.count(requestId) != 0; }) &&
+           results[requestId] == RTM_ERROR_OK;
+  }
+
+  std::mutex mutex;
+  std::condition_variable arrived;
+  std::map<uint64_t, RTM_ERROR_CODE> results;
+
+ private:
+  void record(uint64_t requestId, RTM_ERROR_CODE errorCode) {
+    std::lock_guard<std::mutex> guard(mutex);
+    results[requestId] = errorCode;
+    arrived.notify_all();
+  }
+};
+
+void testDropInClientNeedsNoPump() {
+  WaitingHandler events;
+  RtmConfig config;
+  config.appId = "loopback";
+  config.userId = "dispatched";
+  config.eventHandler = &events;
+  int errorCode = 0;
+  IRtmClient* client = createAgoraRtmClient(config, errorCode);
+  RTM_CHECK(client != nullptr);
+  uint64_t login = 0, published = 0;
+  client->login("token", login);
+  RTM_CHECK(events.waitFor(login));
+  PublishOptions options;
+  client->publish("room", "hi", 2, options, published);
+  RTM_CHECK(events.waitFor(published));
+  client->release();
+}
+
+void testSameUserIdKicksOldSession() {
+  LoopbackBroker broker;
+  RecordingEventHandler firstEvents, secondEvents;
+  LoopbackRtmClient* first = loggedInClient(broker, "alice", firstEvents);
+  LoopbackRtmClient* second = loggedInClient(broker, "alice", secondEvents);
+  RTM_CHECK(!first->isOnline());
+  RTM_CHECK(second->isOnline());
+  RTM_CHECK_EQ(firstEvents.linkStates.back(), RTM_LINK_STATE_FAILED);
+  second->release();
+  first->release();
+}
+
+void testCreateRejectsInvalidConfig() {
+  RtmConfig config;
+  config.appId = "loopback";
+  config.userId = "alice";
+  int errorCode = 0;
+  IRtmClient* client = createAgoraRtmClient(config, errorCode);
+  RTM_CHECK(client == nullptr);
+  RTM_CHECK_EQ(errorCode, RTM_ERROR_INVALID_EVENT_HANDLER);
+  RTM_CHECK(std::strcmp(getErrorReason(RTM_ERROR_INVALID_EVENT_HANDLER), "RTM_ERROR_INVALID_EVENT_HANDLER") == 0);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testLoginEmitsLinkStates);
+  RTM_RUN(testChannelPublishSkipsPublisher);
+  RTM_RUN(testUserChannelPublish);
+  RTM_RUN(testPresenceJoinAndSnapshot);
+  RTM_RUN(testWhoNowPaging);
+  RTM_RUN(testChannelMetadataRevisions);
+  RTM_RUN(testLockHandoff);
+  RTM_RUN(testStreamChannelTopics);
+  RTM_RUN(testResultsWaitForPump);
+  RTM_RUN(testResultsInCall);
+  RTM_RUN(testDropInClientNeedsNoPump);
+  RTM_RUN(testSameUserIdKicksOldSession);
+  RTM_RUN(testCreateRejectsInvalidConfig);
+  return 0;
+}
@@ -0,0 +1,213 @@
+//
+//  MetadataWriteCoalescerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Storage/ChannelMetadataReplica.h"
+#include "Storage/MetadataWriteCoalescer.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/// A teacher writing "room" through a coalescer over its lossy replica, and a student watching the metadata.
+struct Room {
+  explicit Room(MetadataWriteCoalescer::Options options = {}) {
+    teacher = loggedInClient(broker, "teacher", mux);
+    student = loggedInClient(broker, "student", studentEvents);
+    replica = std::make_unique<ChannelMetadataReplica>(*teacher->getStorage(), "room", RTM_CHANNEL_TYPE_MESSAGE);
+    lossy = std::make_unique<LossyStorageEvents>(*replica);
+    options.onComplete = [this](const std::vector<std::string>& keys, RTM_ERROR_CODE errorCode) {
+      completions.emplace_back(keys, errorCode);
+    };
+    coalescer = std::make_unique<MetadataWriteCoalescer>(*teacher->getStorage(), *replica, options);
+    mux.add(*lossy);
+    mux.add(*coalescer);
+    SubscribeOptions subscribeOptions;
+    subscribeOptions.withMetadata = true;
+    uint64_t requestId = 0;
+    teacher->subscribe("room", subscribeOptions, requestId);
+    student->subscribe("room", subscribeOptions, requestId);
+    settle();
+  }
+
+  ~Room() {
+    teacher->release();
+    student->release();
+  }
+
+  /// Delivers the results both clients are owed, including those of the calls they trigger.
+  void settle() {
+    while (teacher->pump() + student->pump() > 0) {
+    }
+  }
+
+  std::string valueOf(const char* key) const {
+    std::string value;
+    return replica->value(key, value) ? value : "<absent>";
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler studentEvents;
+  LoopbackRtmClient* teacher = nullptr;
+  LoopbackRtmClient* student = nullptr;
+  std::unique_ptr<ChannelMetadataReplica> replica;
+  std::unique_ptr<LossyStorageEvents> lossy;
+  std::unique_ptr<MetadataWriteCoalescer> coalescer;
+  std::vector<std::pair<std::vector<std::string>, RTM_ERROR_CODE>> completions;
+};
+
+void testBurstBecomesOneWrite() {
+  Room room;
+  RtmClock::time_point start = RtmClock::now();
+  const char* keys[] = {"raiseHand", "device/alice", "device/bob", "page", "ban"};
+  for (int i = 0; i < 100; ++i) {
+    RTM_CHECK_EQ(room.coalescer->set(keys[i % 5], std::to_string(i), start + milliseconds(i / 10)), RTM_ERROR_OK);
+  }
+  RTM_CHECK_EQ(room.coalescer->nextDeadline(), start + milliseconds(20));
+  RTM_CHECK_EQ(room.coalescer->poll(start + milliseconds(19)), 0u);
+  RTM_CHECK_EQ(room.studentEvents.storages.size(), 1u);
+  RTM_CHECK_EQ(room.coalescer->poll(start + milliseconds(20)), 1u);
+  RTM_CHECK(room.coalescer->busy());
+  room.settle();
+  RTM_CHECK(!room.coalescer->busy());
+
+  // New keys go out with setChannelMetadata; once all are known, with updateChannelMetadata.
+  RTM_CHECK_EQ(room.studentEvents.storages.size(), 2u);
+  RTM_CHECK_EQ(room.studentEvents.storages[1].type, RTM_STORAGE_EVENT_TYPE_SET);
+  RTM_CHECK_EQ(room.studentEvents.storages[1].items.size(), 5u);
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "95");
+  RTM_CHECK_EQ(room.valueOf("ban"), "99");
+
+  room.coalescer->set("page", "next", start + milliseconds(30));
+  room.coalescer->set("ban", "none", start + milliseconds(31));
+  RTM_CHECK_EQ(room.coalescer->flush(), 1u);
+  room.settle();
+  RTM_CHECK_EQ(room.studentEvents.storages.back().type, RTM_STORAGE_EVENT_TYPE_UPDATE);
+  RTM_CHECK_EQ(room.valueOf("page"), "next");
+
+  MetadataWriteCoalescer::Stats stats = room.coalescer->stats();
+  RTM_CHECK_EQ(stats.writes, 102u);
+  RTM_CHECK_EQ(stats.coalesced, 95u);
+  RTM_CHECK_EQ(stats.flushes, 2u);
+  RTM_CHECK_EQ(stats.flushedItems, 7u);
+  RTM_CHECK_EQ(stats.pending, 0u);
+  RTM_CHECK_EQ(room.completions.size(), 2u);
+  RTM_CHECK_EQ(room.completions[0].first.size(), 5u);
+  RTM_CHECK_EQ(room.completions[0].second, RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.coalescer->nextDeadline(), RtmClock::time_point::max());
+}
+
+void testConflictRebasesAgainstReplica() {
+  MetadataWriteCoalescer::Options options;
+  options.rebase = [](std::string_view, std::string_view current, std::string& value) {
+    value = std::string(current) + "," + value;
+    return true;
+  };
+  Room room(options);
+  RtmClock::time_point start = RtmClock::now();
+  room.coalescer->set("raiseHand", "alice", start);
+  room.coalescer->poll(start + milliseconds(20));
+  room.settle();
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "alice");
+
+  // The student adds a hand the teacher's replica never hears about.
+  room.lossy->drops = 1;
+  MetadataItem item("raiseHand", "alice,bob");
+  Metadata data;
+  data.items = &item;
+  data.itemCount = 1;
+  uint64_t requestId = 0;
+  room.student->setChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, MetadataOptions(), nullptr, requestId);
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "alice");
+
+  room.coalescer->set("raiseHand", "carol", start + milliseconds(100));
+  RTM_CHECK_EQ(room.coalescer->poll(start + milliseconds(120)), 1u);
+  room.settle();
+  MetadataWriteCoalescer::Stats stats = room.coalescer->stats();
+  RTM_CHECK_EQ(stats.conflicts, 1u);
+  RTM_CHECK_EQ(stats.pending, 1u);
+  RTM_CHECK_EQ(room.replica->stats().fetches, 1u);
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "alice,bob");
+
+  RTM_CHECK_EQ(room.coalescer->nextDeadline(), RtmClock::time_point::min());
+  RTM_CHECK_EQ(room.coalescer->poll(start + milliseconds(121)), 1u);
+  room.settle();
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "alice,bob,carol");
+  stats = room.coalescer->stats();
+  RTM_CHECK_EQ(stats.rebases, 1u);
+  RTM_CHECK_EQ(stats.flushes, 2u);
+  RTM_CHECK_EQ(stats.failed, 0u);
+  RTM_CHECK_EQ(room.completions.back().second, RTM_ERROR_OK);
+}
+
+void testLargeBurstsSplitAtMaxBatchItems() {
+  MetadataWriteCoalescer::Options options;
+  options.maxBatchItems = 8;
+  Room room(options);
+  RtmClock::time_point start = RtmClock::now();
+  // Filling a batch writes at once; the next full batch goes once that write is answered, the rest waits for
+  // its window.
+  for (int i = 0; i < 20; ++i) room.coalescer->set("device/" + std::to_string(i), "on", start);
+  RTM_CHECK(room.coalescer->busy());
+  RTM_CHECK_EQ(room.coalescer->stats().pending, 12u);
+  RTM_CHECK_EQ(room.coalescer->nextDeadline(), RtmClock::time_point::max());
+  room.settle();
+  RTM_CHECK_EQ(room.coalescer->nextDeadline(), RtmClock::time_point::min());
+  RTM_CHECK_EQ(room.coalescer->poll(start), 1u);
+  room.settle();
+  RTM_CHECK_EQ(room.coalescer->stats().flushes, 2u);
+  RTM_CHECK_EQ(room.coalescer->stats().pending, 4u);
+  RTM_CHECK_EQ(room.coalescer->poll(start + milliseconds(20)), 1u);
+  room.settle();
+  RTM_CHECK_EQ(room.replica->size(), 20u);
+  RTM_CHECK_EQ(room.studentEvents.storages.size(), 4u);
+}
+
+void testOtherWritesAnsweredDuringTheCall() {
+  Room room;
+  // A write of the teacher's own, with a stale revision, is refused; its result is still on its way.
+  MetadataItem item("raiseHand", "bob", 42);
+  Metadata data;
+  data.items = &item;
+  data.itemCount = 1;
+  uint64_t requestId = 0;
+  room.teacher->setChannelMetadata("room", RTM_CHANNEL_TYPE_MESSAGE, data, MetadataOptions(), nullptr, requestId);
+
+  // Both results arrive while the coalescer's write is being made, the refusal first.
+  room.teacher->setResultsInCall(true);
+  room.coalescer->set("raiseHand", "alice", RtmClock::now());
+  RTM_CHECK_EQ(room.coalescer->flush(), 1u);
+  RTM_CHECK(!room.coalescer->busy());
+  RTM_CHECK_EQ(room.completions.size(), 1u);
+  RTM_CHECK_EQ(room.completions[0].second, RTM_ERROR_OK);
+  RTM_CHECK_EQ(room.coalescer->stats().conflicts, 0u);
+  RTM_CHECK_EQ(room.coalescer->stats().pending, 0u);
+  RTM_CHECK_EQ(room.valueOf("raiseHand"), "alice");
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testBurstBecomesOneWrite);
+  RTM_RUN(testConflictRebasesAgainstReplica);
+  RTM_RUN(testLargeBurstsSplitAtMaxBatchItems);
+  RTM_RUN(testOtherWritesAnsweredDuringTheCall);
+  return 0;
+}
@@ -0,0 +1,197 @@
+//
+//  OnlineUserStreamTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Events/QueuedRtmEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Presence/OnlineUserStream.h"
+#include "Requests/RtmTask.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+LoopbackBroker::Options smallPages() {
+  LoopbackBroker::Options options;
+  options.presencePageSize = 7;
+  return options;
+}
+
+/// A lecture of `count` students, the even ones with a raised hand, and a teacher paging through it.
+struct Lecture {
+  explicit Lecture(int count, IRtmEventHandler* teacherHandler = nullptr) : broker(smallPages()) {
+    teacher = loggedInClient(broker, "teacher", teacherHandler ? *teacherHandler : mux);
+    SubscribeOptions options;
+    options.withPresence = false;
+    for (int i = 0; i < count; ++i) {
+      LoopbackRtmClient* student = loggedInClient(broker, ("student" + std::to_string(i)).c_str(), quiet);
+      uint64_t requestId = 0;
+      student->subscribe("lecture", options, requestId);
+      if (i % 2 == 0) {
+        StateItem item;
+        item.key = "hand";
+        item.value = "up";
+        student->getPresence()->setState("lecture", RTM_CHANNEL_TYPE_MESSAGE, &item, 1, requestId);
+      }
+      students.push_back(student);
+    }
+  }
+
+  ~Lecture() {
+    for (LoopbackRtmClient* student : students) student->release();
+    teacher->release();
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = nullptr;
+  std::vector<LoopbackRtmClient*> students;
+};
+
+void testPagesThroughWithOnePagePrefetched() {
+  Lecture lecture(100);
+  OnlineUserStream stream(*lecture.teacher->getPresence(), "lecture", RTM_CHANNEL_TYPE_MESSAGE);
+  lecture.mux.add(stream);
+
+  std::set<std::string> seen;
+  const OnlineUserStream::User* user = nullptr;
+  stream.start();
+  RTM_CHECK_EQ(stream.stats().requests, 1u);
+  lecture.teacher->pump();
+  // The first page is in and the one after it already requested.
+  RTM_CHECK_EQ(stream.stats().requests, 2u);
+  // A reader slower than the round trip: results land between any two reads.
+  OnlineUserStream::Status status;
+  while ((status = stream.tryNext(user)) == OnlineUserStream::Status::ready) {
+    RTM_CHECK(user->states.empty());
+    seen.insert(user->userId);
+    lecture.teacher->pump();
+  }
+  RTM_CHECK(status == OnlineUserStream::Status::end);
+  RTM_CHECK(stream.tryNext(user) == OnlineUserStream::Status::end);
+  RTM_CHECK_EQ(seen.size(), 100u);
+  RTM_CHECK(seen.count("student99") == 1);
+
+  OnlineUserStream::Stats stats = stream.stats();
+  RTM_CHECK_EQ(stats.requests, 15u);
+  RTM_CHECK_EQ(stats.pages, 15u);
+  RTM_CHECK_EQ(stats.users, 100u);
+  RTM_CHECK_EQ(stats.stalls, 0u);
+  RTM_CHECK(stats.peakBufferedUsers <= 14u);
+  RTM_CHECK_EQ(stream.error(), RTM_ERROR_OK);
+}
+
+RtmTask collect(OnlineUserStream& stream, std::vector<std::string>& raised, int& total, bool& done) {
+  while (const OnlineUserStream::User* user = co_await stream.next()) {
+    ++total;
+    for (const auto& state : user->states) {
+      if (state.first == "hand" && state.second == "up") raised.push_back(user->userId);
+    }
+  }
+  done = true;
+}
+
+void testCoroutineAwaitsQueuedPages() {
+  RtmEventMux mux;
+  QueuedRtmEventHandler queue(mux);
+  Lecture lecture(30, &queue);
+  OnlineUserStream::Options options;
+  options.includeState = true;
+  options.legacyWhoNow = true;
+  OnlineUserStream stream(*lecture.teacher->getPresence(), "lecture", RTM_CHANNEL_TYPE_MESSAGE, options);
+  mux.add(stream);
+  queue.drain();
+
+  std::vector<std::string> raised;
+  int total = 0;
+  bool done = false;
+  collect(stream, raised, total, done);
+  RTM_CHECK_EQ(total, 0);
+  RTM_CHECK(!done);
+  // Each delivered page resumes the reader, which reads it while the next one is queued.
+  size_t rounds = 0;
+  while (!done) {
+    lecture.teacher->pump();
+    if (queue.drain(1) == 0) break;
+    ++rounds;
+    RTM_CHECK_EQ(total, static_cast<int>(std::min<size_t>(rounds * 7, 30)));
+  }
+  RTM_CHECK(done);
+  RTM_CHECK_EQ(rounds, 5u);
+  RTM_CHECK_EQ(total, 30);
+  RTM_CHECK_EQ(raised.size(), 15u);
+  OnlineUserStream::Stats stats = stream.stats();
+  RTM_CHECK_EQ(stats.pages, 5u);
+  RTM_CHECK(stats.stalls >= 1u);
+  RTM_CHECK(stats.peakBufferedUsers <= 14u);
+}
+
+void testFailureEndsStream() {
+  Lecture lecture(3);
+  OnlineUserStream stream(*lecture.teacher->getPresence(), "lecture", RTM_CHANNEL_TYPE_MESSAGE);
+  lecture.mux.add(stream);
+  uint64_t requestId = 0;
+  lecture.teacher->logout(requestId);
+  const OnlineUserStream::User* user = nullptr;
+  RTM_CHECK(stream.tryNext(user) == OnlineUserStream::Status::pending);
+  lecture.teacher->pump();
+  RTM_CHECK(stream.tryNext(user) == OnlineUserStream::Status::failed);
+  RTM_CHECK_EQ(stream.error(), RTM_ERROR_NOT_LOGIN);
+  RTM_CHECK(stream.tryNext(user) == OnlineUserStream::Status::failed);
+  RTM_CHECK_EQ(stream.stats().requests, 1u);
+}
+
+void testTwoStreamsOnOneClient() {
+  Lecture lecture(40);
+  OnlineUserStream::Options withStates;
+  withStates.includeState = true;
+  OnlineUserStream hands(*lecture.teacher->getPresence(), "lecture", RTM_CHANNEL_TYPE_MESSAGE, withStates);
+  OnlineUserStream roll(*lecture.teacher->getPresence(), "lecture", RTM_CHANNEL_TYPE_MESSAGE);
+  lecture.mux.add(hands);
+  lecture.mux.add(roll);
+
+  // The first stream's page is still on its way when the second one asks; both arrive during that call.
+  hands.start();
+  lecture.teacher->setResultsInCall(true);
+  roll.start();
+  const OnlineUserStream::User* user = nullptr;
+  std::set<std::string> raised, present;
+  while (hands.tryNext(user) == OnlineUserStream::Status::ready) {
+    if (!user->states.empty()) raised.insert(user->userId);
+  }
+  while (roll.tryNext(user) == OnlineUserStream::Status::ready) {
+    RTM_CHECK(user->states.empty());
+    present.insert(user->userId);
+  }
+  RTM_CHECK(hands.tryNext(user) == OnlineUserStream::Status::end);
+  RTM_CHECK(roll.tryNext(user) == OnlineUserStream::Status::end);
+  RTM_CHECK_EQ(raised.size(), 20u);
+  RTM_CHECK_EQ(present.size(), 40u);
+  RTM_CHECK_EQ(hands.stats().users, 40u);
+  RTM_CHECK_EQ(roll.stats().users, 40u);
+  RTM_CHECK_EQ(roll.stats().pages, 6u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testPagesThroughWithOnePagePrefetched);
+  RTM_RUN(testCoroutineAwaitsQueuedPages);
+  RTM_RUN(testFailureEndsStream);
+  RTM_RUN(testTwoStreamsOnOneClient);
+  return 0;
+}
@@ -0,0 +1,227 @@
+//
+//  PresenceQueryCacheTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/QueuedRtmEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Presence/PresenceQueryCache.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::seconds;
+using Cache = PresenceQueryCache;
+
+/// A teacher watching "room" with a cache, and students alice and bob in it.
+struct Room {
+  explicit Room(IRtmEventHandler* teacherHandler = nullptr) {
+    teacher = loggedInClient(broker, "teacher", teacherHandler ? *teacherHandler : mux);
+    cache = std::make_unique<Cache>(*teacher->getPresence());
+    mux.add(*cache);
+    alice = join("alice");
+    bob = join("bob");
+    SubscribeOptions options;
+    uint64_t requestId = 0;
+    teacher->subscribe("room", options, requestId);
+    teacher->pump();
+  }
+
+  ~Room() {
+    alice->release();
+    bob->release();
+    teacher->release();
+  }
+
+  LoopbackRtmClient* join(const char* userId) {
+    LoopbackRtmClient* student = loggedInClient(broker, userId, quiet);
+    SubscribeOptions options;
+    options.withPresence = false;
+    uint64_t requestId = 0;
+    student->subscribe("room", options, requestId);
+    student->pump();
+    return student;
+  }
+
+  static void raiseHand(LoopbackRtmClient* student) {
+    StateItem item;
+    item.key = "hand";
+    item.value = "up";
+    uint64_t requestId = 0;
+    student->getPresence()->setState("room", RTM_CHANNEL_TYPE_MESSAGE, &item, 1, requestId);
+  }
+
+  /// Asks for the room's users and returns how many the answer holds, or -1 on error.
+  int onlineUsers(bool includeState, RtmClock::time_point now) {
+    GetOnlineUsersOptions options;
+    options.includeState = includeState;
+    int users = -2;
+    cache->getOnlineUsers("room", RTM_CHANNEL_TYPE_MESSAGE, options, now,
+                          [&](RTM_ERROR_CODE code, std::shared_ptr<const Cache::OnlineUsers> value) {
+                            users = code == RTM_ERROR_OK ? static_cast<int>(value->users.size()) : -1;
+                          });
+    teacher->pump();
+    return users;
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = nullptr;
+  LoopbackRtmClient* alice = nullptr;
+  LoopbackRtmClient* bob = nullptr;
+  std::unique_ptr<Cache> cache;
+};
+
+void testHitsUntilTtl() {
+  Room room;
+  RtmClock::time_point start = RtmClock::now();
+  RTM_CHECK_EQ(room.onlineUsers(false, start), 3);
+  RTM_CHECK_EQ(room.onlineUsers(false, start + seconds(4)), 3);
+  RTM_CHECK_EQ(room.cache->stats().hits, 1u);
+  RTM_CHECK_EQ(room.cache->stats().misses, 1u);
+  RTM_CHECK_EQ(room.cache->size(), 1u);
+  // Different options are a different query.
+  RTM_CHECK_EQ(room.onlineUsers(true, start), 3);
+  RTM_CHECK_EQ(room.cache->stats().misses, 2u);
+
+  RTM_CHECK_EQ(room.cache->purge(start + seconds(4)), 0u);
+  RTM_CHECK_EQ(room.onlineUsers(false, start + seconds(5)), 3);
+  RTM_CHECK_EQ(room.cache->stats().misses, 3u);
+  RTM_CHECK_EQ(room.cache->purge(start + seconds(5)), 1u);
+  RTM_CHECK_EQ(room.cache->size(), 1u);
+
+  std::shared_ptr<const Cache::Channels> channels;
+  room.cache->getUserChannels("alice", start, [&](RTM_ERROR_CODE, std::shared_ptr<const Cache::Channels> value) {
+    channels = std::move(value);
+  });
+  room.teacher->pump();
+  RTM_CHECK(channels && channels->size() == 1);
+  RTM_CHECK_EQ((*channels)[0].channelName, "room");
+}
+
+void testEventsInvalidatePrecisely() {
+  Room room;
+  RtmClock::time_point now = RtmClock::now();
+  room.onlineUsers(false, now);
+  room.onlineUsers(true, now);
+  std::shared_ptr<const Cache::UserStates> aliceState;
+  auto getAlice = [&] {
+    room.cache->getState("room", RTM_CHANNEL_TYPE_MESSAGE, "alice", now,
+                         [&](RTM_ERROR_CODE, std::shared_ptr<const Cache::UserStates> value) {
+                           aliceState = std::move(value);
+                         });
+    room.teacher->pump();
+  };
+  getAlice();
+  RTM_CHECK(aliceState && aliceState->states.empty());
+  room.cache->getUserChannels("bob", now, [](RTM_ERROR_CODE, std::shared_ptr<const Cache::Channels>) {});
+  room.teacher->pump();
+  RTM_CHECK_EQ(room.cache->size(), 4u);
+
+  // A state change drops the lists with states and alice's state, nothing else.
+  Room::raiseHand(room.alice);
+  RTM_CHECK_EQ(room.cache->size(), 2u);
+  uint64_t misses = room.cache->stats().misses;
+  room.onlineUsers(false, now);
+  RTM_CHECK_EQ(room.cache->stats().misses, misses);
+  getAlice();
+  RTM_CHECK_EQ(room.cache->stats().misses, misses + 1);
+  RTM_CHECK(aliceState->states.size() == 1 && aliceState->states[0].second == "up");
+
+  // Bob leaving drops every list and what was known about bob, but not alice's state.
+  uint64_t requestId = 0;
+  room.bob->unsubscribe("room", requestId);
+  RTM_CHECK_EQ(room.cache->size(), 1u);
+  RTM_CHECK_EQ(room.onlineUsers(false, now), 2);
+  RTM_CHECK_EQ(room.cache->stats().invalidations, 4u);
+}
+
+void testConcurrentQueriesShareOneRequest() {
+  RtmEventMux mux;
+  QueuedRtmEventHandler queue(mux);
+  // The teacher's callbacks wait in the queue, so queries stay in flight until it is drained.
+  Room room(&queue);
+  mux.add(*room.cache);
+  room.teacher->pump();
+  queue.drain();
+  RtmClock::time_point now = RtmClock::now();
+
+  std::vector<std::shared_ptr<const Cache::OnlineUsers>> answers;
+  auto ask = [&] {
+    GetOnlineUsersOptions options;
+    room.cache->getOnlineUsers("room", RTM_CHANNEL_TYPE_MESSAGE, options, now,
+                               [&](RTM_ERROR_CODE code, std::shared_ptr<const Cache::OnlineUsers> value) {
+                                 RTM_CHECK_EQ(code, RTM_ERROR_OK);
+                                 answers.push_back(std::move(value));
+                               });
+  };
+  for (int i = 0; i < 3; ++i) ask();
+  room.teacher->pump();
+  RTM_CHECK(answers.empty());
+  RTM_CHECK_EQ(queue.drain(), 1u);
+  RTM_CHECK_EQ(answers.size(), 3u);
+  RTM_CHECK(answers[0] == answers[1] && answers[1] == answers[2]);
+  Cache::Stats stats = room.cache->stats();
+  RTM_CHECK_EQ(stats.misses, 3u);
+  RTM_CHECK_EQ(stats.coalesced, 2u);
+
+  // An answer to a query that went stale in flight reaches its waiters but is not kept.
+  room.cache->invalidate("room", RTM_CHANNEL_TYPE_MESSAGE);
+  ask();
+  room.cache->invalidate("room", RTM_CHANNEL_TYPE_MESSAGE);
+  room.teacher->pump();
+  queue.drain();
+  RTM_CHECK_EQ(answers.size(), 4u);
+  RTM_CHECK_EQ(room.cache->size(), 0u);
+  ask();
+  room.teacher->pump();
+  queue.drain();
+  RTM_CHECK_EQ(room.cache->size(), 1u);
+}
+
+void testTwoCachesOnOneClient() {
+  Room room;
+  Room::raiseHand(room.alice);
+  Cache other(*room.teacher->getPresence());
+  room.mux.add(other);
+  RtmClock::time_point now = RtmClock::now();
+  std::shared_ptr<const Cache::UserStates> mine, theirs;
+  room.cache->getState("room", RTM_CHANNEL_TYPE_MESSAGE, "alice", now,
+                       [&](RTM_ERROR_CODE, std::shared_ptr<const Cache::UserStates> value) {
+                         mine = std::move(value);
+                       });
+
+  // The first cache's answer is still on its way when the second asks about bob; both arrive during that call.
+  room.teacher->setResultsInCall(true);
+  other.getState("room", RTM_CHANNEL_TYPE_MESSAGE, "bob", now,
+                 [&](RTM_ERROR_CODE, std::shared_ptr<const Cache::UserStates> value) { theirs = std::move(value); });
+  RTM_CHECK(mine && mine->userId == "alice" && mine->states.size() == 1);
+  RTM_CHECK(theirs && theirs->userId == "bob" && theirs->states.empty());
+  RTM_CHECK_EQ(room.cache->size(), 1u);
+  RTM_CHECK_EQ(other.size(), 1u);
+  RTM_CHECK_EQ(other.stats().errors, 0u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testHitsUntilTtl);
+  RTM_RUN(testEventsInvalidatePrecisely);
+  RTM_RUN(testConcurrentQueriesShareOneRequest);
+  RTM_RUN(testTwoCachesOnOneClient);
+  return 0;
+}
@@ -0,0 +1,250 @@
+//
+//  PresenceRosterTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Presence/PresenceRoster.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+/// A lecture room: the teacher watches presence, students only join.
+struct Lecture {
+  explicit Lecture(const LoopbackBroker::Options& options = LoopbackBroker::Options()) : broker(options) {
+    teacher = loggedInClient(broker, "teacher", roster);
+    subscribe(teacher, true);
+  }
+
+  ~Lecture() {
+    for (LoopbackRtmClient* student : students) student->release();
+    teacher->release();
+  }
+
+  static void subscribe(LoopbackRtmClient* client, bool withPresence) {
+    SubscribeOptions options;
+    options.withPresence = withPresence;
+    uint64_t requestId = 0;
+    client->subscribe("lecture", options, requestId);
+  }
+
+  LoopbackRtmClient* addStudent(const std::string& userId) {
+    LoopbackRtmClient* student = loggedInClient(broker, userId.c_str(), quiet);
+    subscribe(student, false);
+    students.push_back(student);
+    return student;
+  }
+
+  void leave(size_t index) {
+    uint64_t requestId = 0;
+    students[index]->unsubscribe("lecture", requestId);
+  }
+
+  static void setState(LoopbackRtmClient* client, const char* key, const char* value) {
+    StateItem item;
+    item.key = key;
+    item.value = value;
+    uint64_t requestId = 0;
+    client->setState("lecture", RTM_CHANNEL_TYPE_MESSAGE, &item, 1, requestId);
+  }
+
+  LoopbackBroker broker;
+  PresenceRoster roster{"lecture", RTM_CHANNEL_TYPE_MESSAGE};
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = nullptr;
+  std::vector<LoopbackRtmClient*> students;
+};
+
+std::string stateOf(const PresenceRoster& roster, const char* userId, const char* key) {
+  PresenceRoster::States states;
+  if (!roster.states(userId, states)) return "<absent>";
+  for (const auto& state : states) {
+    if (state.first == key) return state.second;
+  }
+  return "<unset>";
+}
+
+void testSnapshotThenRemoteEvents() {
+  LoopbackBroker broker;
+  RecordingEventHandler events;
+  LoopbackRtmClient* early = loggedInClient(broker, "early", events);
+  Lecture::subscribe(early, false);
+  Lecture::setState(early, "hand", "up");
+
+  PresenceRoster roster("lecture", RTM_CHANNEL_TYPE_MESSAGE);
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", roster);
+  RTM_CHECK(!roster.synced());
+  Lecture::subscribe(teacher, true);
+  RTM_CHECK(roster.synced());
+  RTM_CHECK_EQ(roster.size(), 2u);
+  RTM_CHECK_EQ(stateOf(roster, "early", "hand"), "up");
+
+  LoopbackRtmClient* late = loggedInClient(broker, "late", events);
+  Lecture::subscribe(late, false);
+  RTM_CHECK(roster.contains("late"));
+  Lecture::setState(late, "camera", "on");
+  RTM_CHECK_EQ(stateOf(roster, "late", "camera"), "on");
+  uint64_t version = roster.version();
+  uint64_t requestId = 0;
+  early->unsubscribe("lecture", requestId);
+  RTM_CHECK(!roster.contains("early"));
+  RTM_CHECK_EQ(roster.version(), version + 1);
+
+  std::vector<std::string> userIds = roster.userIds();
+  std::sort(userIds.begin(), userIds.end());
+  RTM_CHECK(userIds == std::vector<std::string>({"late", "teacher"}));
+  size_t visited = 0;
+  roster.forEach([&](std::string_view, const PresenceRoster::States&) { ++visited; });
+  RTM_CHECK_EQ(visited, 2u);
+  PresenceRoster::Stats stats = roster.stats();
+  RTM_CHECK_EQ(stats.snapshots, 1u);
+  RTM_CHECK_EQ(stats.joins, 1u);
+  RTM_CHECK_EQ(stats.leaves, 1u);
+  RTM_CHECK_EQ(stats.stateChanges, 1u);
+  early->release();
+  late->release();
+  teacher->release();
+}
+
+void testIntervalDeltasInLargeRoom() {
+  LoopbackBroker::Options options;
+  options.presenceIntervalThreshold = 50;
+  Lecture lecture(options);
+  const int studentCount = 5000;
+  for (int i = 0; i < studentCount; ++i) lecture.addStudent("student" + std::to_string(i));
+  // The first 49 joins arrive one by one, the rest wait for the interval.
+  RTM_CHECK_EQ(lecture.roster.size(), 50u);
+  lecture.broker.flushPresenceIntervals();
+  RTM_CHECK_EQ(lecture.roster.size(), static_cast<size_t>(studentCount) + 1);
+
+  for (size_t i = 0; i < 1000; ++i) lecture.leave(i);
+  for (size_t i = 1000; i < 1100; ++i) Lecture::setState(lecture.students[i], "hand", "up");
+  RTM_CHECK_EQ(lecture.roster.size(), static_cast<size_t>(studentCount) + 1);
+  lecture.broker.flushPresenceIntervals();
+  RTM_CHECK_EQ(lecture.roster.size(), static_cast<size_t>(studentCount) - 1000 + 1);
+  RTM_CHECK(!lecture.roster.contains("student0"));
+  RTM_CHECK(lecture.roster.contains("student1000"));
+  RTM_CHECK_EQ(stateOf(lecture.roster, "student1050", "hand"), "up");
+  RTM_CHECK_EQ(stateOf(lecture.roster, "student2000", "hand"), "<unset>");
+
+  // Leaving and coming back within one interval keeps the user, with fresh states.
+  lecture.leave(1050);
+  Lecture::subscribe(lecture.students[1050], false);
+  lecture.broker.flushPresenceIntervals();
+  RTM_CHECK(lecture.roster.contains("student1050"));
+  RTM_CHECK_EQ(stateOf(lecture.roster, "student1050", "hand"), "<unset>");
+
+  PresenceRoster::Stats stats = lecture.roster.stats();
+  RTM_CHECK_EQ(stats.snapshots, 1u);
+  RTM_CHECK_EQ(stats.intervals, 3u);
+  RTM_CHECK_EQ(stats.joins, static_cast<uint64_t>(studentCount));
+  RTM_CHECK_EQ(stats.leaves, 1000u);
+}
+
+void testTimeoutsAndOutOfService() {
+  PresenceRoster roster("lecture", RTM_CHANNEL_TYPE_MESSAGE);
+  const char* users[] = {"a", "b", "c"};
+  UserState snapshotUsers[3];
+  for (int i = 0; i < 3; ++i) snapshotUsers[i].userId = users[i];
+  IRtmEventHandler::PresenceEvent event;
+  event.type = RTM_PRESENCE_EVENT_TYPE_SNAPSHOT;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.channelName = "lecture";
+  event.snapshot.userStateList = snapshotUsers;
+  event.snapshot.userCount = 3;
+  roster.onPresenceEvent(event);
+  RTM_CHECK_EQ(roster.size(), 3u);
+
+  IRtmEventHandler::PresenceEvent timeout;
+  timeout.type = RTM_PRESENCE_EVENT_TYPE_REMOTE_TIMEOUT;
+  timeout.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  timeout.channelName = "lecture";
+  timeout.publisher = "a";
+  roster.onPresenceEvent(timeout);
+  IRtmEventHandler::PresenceEvent interval;
+  interval.type = RTM_PRESENCE_EVENT_TYPE_INTERVAL;
+  interval.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  interval.channelName = "lecture";
+  interval.interval.timeoutUserList.users = users + 1;
+  interval.interval.timeoutUserList.userCount = 1;
+  roster.onPresenceEvent(interval);
+  RTM_CHECK_EQ(roster.size(), 1u);
+  RTM_CHECK(roster.contains("c"));
+  RTM_CHECK_EQ(roster.stats().timeouts, 2u);
+
+  // Other channels are not ours.
+  timeout.channelName = "lobby";
+  timeout.publisher = "c";
+  roster.onPresenceEvent(timeout);
+  RTM_CHECK(roster.contains("c"));
+
+  IRtmEventHandler::PresenceEvent outage;
+  outage.type = RTM_PRESENCE_EVENT_TYPE_ERROR_OUT_OF_SERVICE;
+  outage.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  outage.channelName = "lecture";
+  roster.onPresenceEvent(outage);
+  RTM_CHECK(!roster.synced());
+  roster.onPresenceEvent(event);
+  RTM_CHECK(roster.synced());
+  RTM_CHECK_EQ(roster.size(), 3u);
+}
+
+void testRostersOnOneTableKeepTheirOwnRows() {
+  UserIdTable users;
+  PresenceRoster lecture("lecture", RTM_CHANNEL_TYPE_MESSAGE, users);
+  PresenceRoster lobby("lobby", RTM_CHANNEL_TYPE_MESSAGE, users);
+  auto remote = [](const char* channelName, RTM_PRESENCE_EVENT_TYPE type, const char* userId) {
+    IRtmEventHandler::PresenceEvent event;
+    event.type = type;
+    event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+    event.channelName = channelName;
+    event.publisher = userId;
+    return event;
+  };
+  // Handle 0 goes to the lecture's first member; thousands of lobby users follow it in the table.
+  lecture.onPresenceEvent(remote("lecture", RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL, "teacher"));
+  RTM_CHECK_EQ(users.find("teacher"), 0u);
+  for (int i = 0; i < 5000; ++i) {
+    std::string userId = "visitor-" + std::to_string(i);
+    lobby.onPresenceEvent(remote("lobby", RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL, userId.c_str()));
+  }
+  lecture.onPresenceEvent(remote("lecture", RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL, "visitor-4999"));
+  lecture.onPresenceEvent(remote("lecture", RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL, "student"));
+
+  RTM_CHECK_EQ(lecture.size(), 3u);
+  RTM_CHECK_EQ(lobby.size(), 5000u);
+  RTM_CHECK(lecture.contains("teacher") && !lobby.contains("teacher"));
+  RTM_CHECK(lecture.contains("visitor-4999") && !lecture.contains("visitor-0"));
+
+  // Leaving swaps the last member into the hole; the moved member is still found by its handle.
+  lecture.onPresenceEvent(remote("lecture", RTM_PRESENCE_EVENT_TYPE_REMOTE_LEAVE_CHANNEL, "teacher"));
+  lecture.onPresenceEvent(remote("lecture", RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED, "student"));
+  RTM_CHECK(!lecture.contains("teacher"));
+  RTM_CHECK(lecture.contains(users.find("student")));
+  RTM_CHECK_EQ(stateOf(lecture, "student", "camera"), "<unset>");
+  std::vector<std::string> members = lecture.userIds();
+  std::sort(members.begin(), members.end());
+  RTM_CHECK(members == (std::vector<std::string>{"student", "visitor-4999"}));
+  RTM_CHECK(lobby.contains("visitor-4999"));
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testSnapshotThenRemoteEvents);
+  RTM_RUN(testIntervalDeltasInLargeRoom);
+  RTM_RUN(testTimeoutsAndOutOfService);
+  RTM_RUN(testRostersOnOneTableKeepTheirOwnRows);
+  return 0;
+}
@@ -0,0 +1,286 @@
+//
+//  PresenceStateWriterTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/QueuedRtmEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Presence/PresenceRoster.h"
+#include "Presence/PresenceStateWriter.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+using Writer = PresenceStateWriter;
+
+/// A teacher watching "room" through a roster, and alice writing her state into it.
+struct Room {
+  explicit Room(const LoopbackBroker::Options& brokerOptions = LoopbackBroker::Options(),
+                IRtmEventHandler* aliceHandler = nullptr)
+      : broker(brokerOptions) {
+    teacher = loggedInClient(broker, "teacher", roster);
+    alice = loggedInClient(broker, "alice", aliceHandler ? *aliceHandler : mux);
+    SubscribeOptions options;
+    uint64_t requestId = 0;
+    teacher->subscribe("room", options, requestId);
+    options.withPresence = false;
+    alice->subscribe("room", options, requestId);
+    teacher->pump();
+    alice->pump();
+  }
+
+  ~Room() {
+    alice->release();
+    teacher->release();
+  }
+
+  Writer& writer(Writer::Options options = Writer::Options()) {
+    options.onComplete = [this](const std::vector<std::string>& keys, RTM_ERROR_CODE code) {
+      completed.push_back({keys, code});
+    };
+    writerStorage = std::make_unique<Writer>(*alice->getPresence(), "room", RTM_CHANNEL_TYPE_MESSAGE, options);
+    mux.add(*writerStorage);
+    return *writerStorage;
+  }
+
+  std::string stateOf(const char* key) const {
+    PresenceRoster::States states;
+    if (!roster.states("alice", states)) return "<absent>";
+    for (const auto& state : states) {
+      if (state.first == key) return state.second;
+    }
+    return "<unset>";
+  }
+
+  struct Completion {
+    std::vector<std::string> keys;
+    RTM_ERROR_CODE code;
+  };
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  PresenceRoster roster{"room", RTM_CHANNEL_TYPE_MESSAGE};
+  LoopbackRtmClient* teacher = nullptr;
+  LoopbackRtmClient* alice = nullptr;
+  std::unique_ptr<Writer> writerStorage;
+  std::vector<Completion> completed;
+};
+
+/// Pumps `client` when a state change is heard: its results arriving on the SDK thread while its next call is
+/// still being made.
+class PumpOnStateChange : public IRtmEventHandler {
+ public:
+  void onPresenceEvent(const PresenceEvent& event) override {
+    if (client && event.type == RTM_PRESENCE_EVENT_TYPE_REMOTE_STATE_CHANGED) client->pump();
+  }
+
+  LoopbackRtmClient* client = nullptr;
+};
+
+void testDebouncesToChangedKeysOnly() {
+  Room room;
+  Writer& writer = room.writer();
+  RtmClock::time_point start = RtmClock::now();
+
+  // Camera toggled off, on and off again, microphone on: one call with both keys once the burst settles.
+  RTM_CHECK_EQ(writer.set("camera", "off", start), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.set("camera", "on", start + milliseconds(10)), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.set("mic", "on", start + milliseconds(20)), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.set("camera", "off", start + milliseconds(30)), RTM_ERROR_OK);
+  RTM_CHECK(writer.nextDeadline() == start + milliseconds(80));
+  RTM_CHECK_EQ(writer.poll(start + milliseconds(79)), 0u);
+  RTM_CHECK_EQ(room.stateOf("camera"), "<unset>");
+  RTM_CHECK_EQ(writer.poll(start + milliseconds(80)), 1u);
+  room.alice->pump();
+  RTM_CHECK_EQ(room.stateOf("camera"), "off");
+  RTM_CHECK_EQ(room.stateOf("mic"), "on");
+  RTM_CHECK_EQ(room.completed.size(), 1u);
+  RTM_CHECK_EQ(room.completed[0].keys.size(), 2u);
+  std::string value;
+  RTM_CHECK(writer.acknowledged("mic", value) && value == "on");
+  RTM_CHECK(writer.nextDeadline() == RtmClock::time_point::max());
+
+  // Writing what the service holds sends nothing, and so does a toggle that ends where it started.
+  RtmClock::time_point later = start + milliseconds(500);
+  RTM_CHECK_EQ(writer.set("mic", "on", later), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.set("camera", "on", later), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.set("camera", "off", later), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.stats().pending, 0u);
+  RTM_CHECK_EQ(writer.flush(), 0u);
+
+  // Only the key that changed goes out.
+  RTM_CHECK_EQ(writer.set("mic", "off", later), RTM_ERROR_OK);
+  RTM_CHECK_EQ(writer.flush(), 1u);
+  room.alice->pump();
+  RTM_CHECK_EQ(room.stateOf("mic"), "off");
+
+  Writer::Stats stats = writer.stats();
+  RTM_CHECK_EQ(stats.changes, 8u);
+  RTM_CHECK_EQ(stats.unchanged, 1u);
+  RTM_CHECK_EQ(stats.coalesced, 3u);
+  RTM_CHECK_EQ(stats.calls, 2u);
+  RTM_CHECK_EQ(stats.sentItems, 3u);
+  RTM_CHECK(stats.amplification() < 0.4);
+
+  RTM_CHECK_EQ(writer.set("", "x", later), RTM_ERROR_PRESENCE_INVALID_STATE_KEY);
+}
+
+void testMaxDelayCapsAStreamOfChanges() {
+  Room room;
+  Writer& writer = room.writer();
+  RtmClock::time_point start = RtmClock::now();
+  // A slider dragged every 40ms never lets the 50ms debounce pass, but goes out once 250ms have passed.
+  size_t calls = 0;
+  for (int i = 0; i <= 12; ++i) {
+    RtmClock::time_point now = start + milliseconds(40 * i);
+    writer.set("volume", std::to_string(i), now);
+    calls += writer.poll(now);
+    room.alice->pump();
+    if (i < 7) RTM_CHECK_EQ(calls, 0u);
+  }
+  RTM_CHECK_EQ(calls, 1u);
+  RTM_CHECK_EQ(room.stateOf("volume"), "7");
+  RTM_CHECK_EQ(writer.stats().pending, 1u);
+  RTM_CHECK(writer.nextDeadline() == start + milliseconds(480 + 50));
+}
+
+void testOneCallInFlightAndFailures() {
+  RtmEventMux mux;
+  QueuedRtmEventHandler queue(mux);
+  LoopbackBroker::Options brokerOptions;
+  brokerOptions.maxStateCount = 3;
+  Room room(brokerOptions, &queue);
+  queue.drain();
+  Writer::Options options;
+  options.maxKeys = 4;
+  Writer& writer = room.writer(options);
+  mux.add(*room.writerStorage);
+  RtmClock::time_point now = RtmClock::now();
+
+  writer.set("camera", "on", now);
+  RTM_CHECK_EQ(writer.flush(), 1u);
+  RTM_CHECK(writer.busy());
+  // The value in flight counts as held; other changes wait for the result.
+  writer.set("camera", "on", now);
+  writer.set("mic", "on", now);
+  RTM_CHECK_EQ(writer.flush(), 0u);
+  RTM_CHECK(writer.nextDeadline() == RtmClock::time_point::max());
+  room.alice->pump();
+  RTM_CHECK_EQ(queue.drain(), 1u);
+  RTM_CHECK(!writer.busy());
+  RTM_CHECK_EQ(writer.flush(), 1u);
+  room.alice->pump();
+  queue.drain();
+  RTM_CHECK_EQ(writer.stats().unchanged, 1u);
+
+  // The writer caps its keys; the loopback holds fewer, so the third and fourth key fail together.
+  writer.set("hand", "up", now);
+  writer.set("screen", "on", now);
+  RTM_CHECK_EQ(writer.set("pen", "red", now), RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW);
+  writer.flush();
+  room.alice->pump();
+  queue.drain();
+  RTM_CHECK_EQ(room.completed.size(), 3u);
+  RTM_CHECK_EQ(room.completed[2].code, RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW);
+  RTM_CHECK_EQ(room.completed[2].keys.size(), 2u);
+  std::string value;
+  RTM_CHECK(!writer.acknowledged("hand", value));
+  RTM_CHECK(writer.acknowledged("camera", value));
+  RTM_CHECK_EQ(writer.stats().failed, 1u);
+
+  // Resubscribing forgets what the service held, so the same value is sent again.
+  SubscribeOptions subscribeOptions;
+  subscribeOptions.withPresence = false;
+  uint64_t requestId = 0;
+  room.alice->unsubscribe("room", requestId);
+  room.alice->subscribe("room", subscribeOptions, requestId);
+  room.alice->pump();
+  queue.drain();
+  RTM_CHECK(!writer.acknowledged("camera", value));
+  writer.set("camera", "on", now);
+  RTM_CHECK_EQ(writer.flush(), 1u);
+  room.alice->pump();
+  queue.drain();
+  RTM_CHECK_EQ(room.stateOf("camera"), "on");
+}
+
+void testResultsOfOtherWritersDuringTheCall() {
+  LoopbackBroker::Options brokerOptions;
+  brokerOptions.maxStateCount = 2;
+  LoopbackBroker broker(brokerOptions);
+  PumpOnStateChange teacherEvents;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", teacherEvents);
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", mux);
+  SubscribeOptions options;
+  uint64_t requestId = 0;
+  teacher->subscribe("room", options, requestId);
+  alice->subscribe("room", options, requestId);
+  teacher->pump();
+  alice->pump();
+
+  std::vector<RTM_ERROR_CODE> deviceResults, handResults;
+  Writer::Options deviceOptions;
+  deviceOptions.onComplete = [&](const std::vector<std::string>&, RTM_ERROR_CODE code) {
+    deviceResults.push_back(code);
+  };
+  Writer::Options handOptions;
+  handOptions.onComplete = [&](const std::vector<std::string>&, RTM_ERROR_CODE code) { handResults.push_back(code); };
+  Writer devices(*alice->getPresence(), "room", RTM_CHANNEL_TYPE_MESSAGE, deviceOptions);
+  Writer hand(*alice->getPresence(), "room", RTM_CHANNEL_TYPE_MESSAGE, handOptions);
+  mux.add(devices);
+  mux.add(hand);
+  RtmClock::time_point now = RtmClock::now();
+
+  // The devices writer asks for more states than the service holds; its result is still on its way.
+  devices.set("camera", "on", now);
+  devices.set("mic", "on", now);
+  devices.set("screen", "on", now);
+  RTM_CHECK_EQ(devices.flush(), 1u);
+
+  // It arrives while the hand writer's call is being made, followed by the hand writer's own.
+  teacherEvents.client = alice;
+  hand.set("hand", "up", now);
+  RTM_CHECK_EQ(hand.flush(), 1u);
+  RTM_CHECK(deviceResults == std::vector<RTM_ERROR_CODE>{RTM_ERROR_PRESENCE_STATE_COUNT_OVERFLOW});
+  RTM_CHECK(handResults == std::vector<RTM_ERROR_CODE>{RTM_ERROR_OK});
+  RTM_CHECK(!devices.busy() && !hand.busy());
+  std::string value;
+  RTM_CHECK(hand.acknowledged("hand", value) && value == "up");
+  RTM_CHECK(!devices.acknowledged("camera", value));
+
+  // Answered inside its own call, a writer still takes only its own result.
+  alice->setResultsInCall(true);
+  hand.set("hand", "down", now);
+  RTM_CHECK_EQ(hand.flush(), 1u);
+  RTM_CHECK_EQ(handResults.size(), 2u);
+  RTM_CHECK_EQ(deviceResults.size(), 1u);
+  RTM_CHECK(hand.acknowledged("hand", value) && value == "down");
+
+  alice->release();
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testDebouncesToChangedKeysOnly);
+  RTM_RUN(testMaxDelayCapsAStreamOfChanges);
+  RTM_RUN(testOneCallInFlightAndFailures);
+  RTM_RUN(testResultsOfOtherWritersDuringTheCall);
+  return 0;
+}
@@ -0,0 +1,171 @@
+//
+//  QueuedRtmEventHandlerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Events/QueuedRtmEventHandler.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+void testDrainDeliversDeepCopies() {
+  LoopbackBroker broker;
+  RecordingEventHandler aliceEvents, bobEvents;
+  QueuedRtmEventHandler queued(bobEvents);
+  LoopbackRtmClient* alice = loggedInClient(broker, "alice", aliceEvents);
+  LoopbackRtmClient* bob = loggedInClient(broker, "bob", queued);
+
+  SubscribeOptions options;
+  uint64_t requestId = 0;
+  alice->subscribe("room", options, requestId);
+  bob->subscribe("room", options, requestId);
+  std::string payload = "raise-hand";
+  PublishOptions publishOptions;
+  alice->publish("room", payload.data(), payload.size(), publishOptions, requestId);
+  payload.assign(payload.size(), '?');
+
+  RTM_CHECK(bobEvents.messages.empty());
+  RTM_CHECK(queued.depth() > 0);
+  size_t delivered = queued.drain();
+  RTM_CHECK_EQ(delivered, queued.stats().delivered);
+  RTM_CHECK_EQ(queued.depth(), 0u);
+
+  RTM_CHECK_EQ(bobEvents.linkStates.back(), RTM_LINK_STATE_CONNECTED);
+  RTM_CHECK(!bobEvents.presences.empty());
+  RTM_CHECK_EQ(bobEvents.presences[0].type, RTM_PRESENCE_EVENT_TYPE_SNAPSHOT);
+  RTM_CHECK_EQ(bobEvents.presences[0].users.size(), 2u);
+  RTM_CHECK_EQ(bobEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(bobEvents.messages[0].payload, "raise-hand");
+  RTM_CHECK_EQ(bobEvents.messages[0].publisher, "alice");
+
+  bob->release();
+  alice->release();
+}
+
+void testOverflowDropsNewest() {
+  RecordingEventHandler events;
+  QueuedRtmEventHandler::Options options;
+  options.capacity = 4;
+  QueuedRtmEventHandler queued(events, options);
+  for (uint64_t requestId = 1; requestId <= 10; ++requestId) queued.onPublishResult(requestId, RTM_ERROR_OK);
+
+  QueuedRtmEventHandler::Stats stats = queued.stats();
+  RTM_CHECK_EQ(stats.enqueued, 4u);
+  RTM_CHECK_EQ(stats.dropped, 6u);
+  RTM_CHECK_EQ(stats.depth, 4u);
+  RTM_CHECK_EQ(queued.drain(), 4u);
+  RTM_CHECK(events.succeeded(1) && events.succeeded(4));
+  RTM_CHECK(!events.succeeded(5));
+  RTM_CHECK_EQ(queued.stats().highWatermark, 4u);
+}
+
+void testWarmPoolQueuesWithoutAllocating() {
+  RecordingEventHandler events;
+  RtmEventBlockPool pool;
+  QueuedRtmEventHandler::Options options;
+  options.pool = &pool;
+  QueuedRtmEventHandler queued(events, options);
+  IRtmEventHandler::MessageEvent message;
+  message.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  message.channelName = "room";
+  message.publisher = "teacher";
+  message.message = "hand up";
+  message.messageLength = 7;
+  auto queueRound = [&] {
+    for (uint64_t requestId = 1; requestId <= 8; ++requestId) {
+      queued.onPublishResult(requestId, RTM_ERROR_OK);
+      queued.onMessageEvent(message);
+    }
+    RTM_CHECK_EQ(queued.drain(), 16u);
+  };
+  queueRound();
+  uint64_t allocations = pool.stats().allocations;
+  RTM_CHECK(allocations > 0);
+
+  // Each callback and its copies share one pooled block, which goes back to the pool once delivered.
+  queueRound();
+  RtmEventBlockPool::Stats stats = pool.stats();
+  RTM_CHECK_EQ(stats.allocations, allocations);
+  RTM_CHECK(stats.reuses >= 16u);
+  RTM_CHECK_EQ(stats.cachedBlocks, allocations);
+  RTM_CHECK_EQ(events.messages.size(), 16u);
+  RTM_CHECK_EQ(events.messages[15].payload, "hand up");
+  RTM_CHECK(events.succeeded(8));
+}
+
+/// Checks per-publisher ordering on the consumer thread.
+class OrderCheckingHandler : public IRtmEventHandler {
+ public:
+  explicit OrderCheckingHandler(size_t producers) : next(producers, 0) {}
+
+  void onMessageEvent(const MessageEvent& event) override {
+    size_t producer = std::stoul(event.publisher);
+    size_t sequence = std::stoul(std::string(event.message, event.messageLength));
+    if (sequence != next[producer]) outOfOrder = true;
+    next[producer] = sequence + 1;
+    ++received;
+  }
+
+  std::vector<size_t> next;
+  size_t received = 0;
+  bool outOfOrder = false;
+};
+
+void testConsumerThreadKeepsProducerOrder() {
+  constexpr size_t kProducers = 4;
+  constexpr size_t kMessages = 20000;
+  OrderCheckingHandler handler(kProducers);
+  QueuedRtmEventHandler::Options options;
+  options.capacity = 1024;
+  options.overflow = QueuedRtmEventHandler::OverflowPolicy::block;
+  QueuedRtmEventHandler queued(handler, options);
+  queued.start();
+
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < kProducers; ++producer) {
+    producers.emplace_back([&queued, producer] {
+      std::string publisher = std::to_string(producer);
+      for (size_t sequence = 0; sequence < kMessages; ++sequence) {
+        std::string payload = std::to_string(sequence);
+        IRtmEventHandler::MessageEvent event;
+        event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+        event.channelName = "room";
+        event.publisher = publisher.c_str();
+        event.message = payload.data();
+        event.messageLength = payload.size();
+        queued.onMessageEvent(event);
+      }
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  queued.stop();
+
+  RTM_CHECK_EQ(handler.received, kProducers * kMessages);
+  RTM_CHECK(!handler.outOfOrder);
+  QueuedRtmEventHandler::Stats stats = queued.stats();
+  RTM_CHECK_EQ(stats.dropped, 0u);
+  RTM_CHECK_EQ(stats.delivered, kProducers * kMessages);
+  RTM_CHECK(stats.batches > 0);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testDrainDeliversDeepCopies);
+  RTM_RUN(testOverflowDropsNewest);
+  RTM_RUN(testWarmPoolQueuesWithoutAllocating);
+  RTM_RUN(testConsumerThreadKeepsProducerOrder);
+  return 0;
+}
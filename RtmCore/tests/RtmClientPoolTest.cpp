@@ -0,0 +1,213 @@
+//
+//  RtmClientPoolTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/UserIdTable.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Session/RtmClientPool.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+/// A bot that notes which threads its callbacks ran on.
+class BotHandler : public IRtmEventHandler {
+ public:
+  void onLoginResult(const uint64_t, RTM_ERROR_CODE errorCode) override {
+    record();
+    logins.push_back(errorCode);
+  }
+  void onSubscribeResult(const uint64_t, const char*, RTM_ERROR_CODE) override { record(); }
+  void onMessageEvent(const MessageEvent&) override {
+    record();
+    ++messages;
+  }
+
+  std::set<std::thread::id> threads;
+  std::vector<RTM_ERROR_CODE> logins;
+  size_t messages = 0;
+
+ private:
+  void record() { threads.insert(std::this_thread::get_id()); }
+};
+
+RtmClientPool::ClientFactory loopbackFactory(LoopbackBroker& broker) {
+  return [&broker](const RtmConfig& config, int& errorCode) -> IRtmClient* {
+    return createLoopbackRtmClient(broker, config, errorCode);
+  };
+}
+
+std::vector<RtmClientPool::SessionId> addBots(RtmClientPool& pool, std::vector<BotHandler>& bots) {
+  std::vector<RtmClientPool::SessionId> ids;
+  for (size_t i = 0; i < bots.size(); ++i) {
+    std::string userId = "bot-" + std::to_string(i);
+    RtmConfig config;
+    config.appId = "bots";
+    config.userId = userId.c_str();
+    int errorCode = 0;
+    ids.push_back(pool.add(config, "token", bots[i], errorCode));
+    RTM_CHECK(ids.back() != RtmClientPool::kInvalidSession);
+    RTM_CHECK_EQ(errorCode, RTM_ERROR_OK);
+  }
+  return ids;
+}
+
+/// Hands the results the loopback clients hold to their sessions' queues.
+void pumpAll(RtmClientPool& pool, const std::vector<RtmClientPool::SessionId>& ids) {
+  for (RtmClientPool::SessionId id : ids) {
+    if (IRtmClient* client = pool.client(id)) static_cast<LoopbackRtmClient*>(client)->pump();
+  }
+}
+
+void drainAll(RtmClientPool& pool, const std::vector<RtmClientPool::SessionId>& ids) {
+  pumpAll(pool, ids);
+  for (size_t shard = 0; shard < pool.shards(); ++shard) pool.drain(shard);
+}
+
+void testStaggersLoginsAndRetriesShedOnes() {
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  LoopbackBroker::Options brokerOptions;
+  brokerOptions.loginsPerSecond = 5;
+  brokerOptions.clock = [&now] { return now; };
+  LoopbackBroker broker(brokerOptions);
+  UserIdTable userIds;
+  RtmClientPool::Options options;
+  options.loginsPerSecond = 8;
+  options.loginBurst = 8;
+  options.retryBackoff = milliseconds(500);
+  options.maxRetryBackoff = seconds(4);
+  options.seed = 9;
+  options.userIds = &userIds;
+  options.create = loopbackFactory(broker);
+  RtmClientPool pool(start, options);
+
+  std::vector<BotHandler> bots(20);
+  std::vector<RtmClientPool::SessionId> ids = addBots(pool, bots);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    RTM_CHECK_EQ(ids[i], i);
+    RTM_CHECK_EQ(pool.shardOf(ids[i]), i % 4);
+  }
+  RtmConfig config;
+  config.userId = "bot-3";
+  int errorCode = 0;
+  RTM_CHECK(pool.add(config, "token", bots[3], errorCode) == RtmClientPool::kInvalidSession);
+  RTM_CHECK_EQ(errorCode, RTM_ERROR_DUPLICATE_OPERATION);
+  RTM_CHECK_EQ(pool.stats().waiting, 20u);
+
+  // The burst goes out at once; the service admits five and sheds the rest, which the bots never hear about.
+  RTM_CHECK_EQ(pool.poll(start), 8u);
+  drainAll(pool, ids);
+  RtmClientPool::Stats stats = pool.stats();
+  RTM_CHECK_EQ(stats.online, 5u);
+  RTM_CHECK_EQ(stats.loginRetries, 3u);
+  RTM_CHECK_EQ(stats.waiting, 15u);
+  RTM_CHECK(pool.nextDeadline() == start + milliseconds(125));
+  RTM_CHECK_EQ(pool.poll(start + milliseconds(124)), 0u);
+
+  for (int i = 0; i < 1000 && pool.stats().online < bots.size(); ++i) {
+    now = pool.nextDeadline();
+    pool.poll(now);
+    drainAll(pool, ids);
+  }
+  stats = pool.stats();
+  RTM_CHECK_EQ(stats.online, 20u);
+  RTM_CHECK_EQ(stats.waiting, 0u);
+  RTM_CHECK_EQ(stats.loginFailures, 0u);
+  RTM_CHECK_EQ(stats.logins, 20u + stats.loginRetries);
+  // Five logins a second: the last of twenty cannot get in before the fourth window.
+  RTM_CHECK(now >= start + seconds(3));
+  for (size_t i = 0; i < bots.size(); ++i) {
+    RTM_CHECK(pool.online(ids[i]));
+    RTM_CHECK_EQ(bots[i].logins.size(), 1u);
+    RTM_CHECK_EQ(bots[i].logins[0], RTM_ERROR_OK);
+  }
+  RTM_CHECK(pool.nextDeadline() == RtmClock::time_point::max());
+}
+
+void testPinsCallbacksToShardThreads() {
+  LoopbackBroker broker;
+  UserIdTable userIds;
+  RtmClientPool::Options options;
+  options.shards = 3;
+  options.loginsPerSecond = 0;
+  options.maxBatch = 4;
+  options.userIds = &userIds;
+  options.create = loopbackFactory(broker);
+  RtmClientPool pool(RtmClock::now(), options);
+  std::vector<BotHandler> bots(12);
+  std::vector<RtmClientPool::SessionId> ids = addBots(pool, bots);
+  pool.start();
+  RTM_CHECK_EQ(pool.poll(RtmClock::now()), 12u);
+  RtmClock::time_point giveUp = RtmClock::now() + seconds(10);
+  while (pool.stats().online < bots.size() && RtmClock::now() < giveUp) {
+    pumpAll(pool, ids);
+    std::this_thread::yield();
+  }
+  RTM_CHECK_EQ(pool.stats().online, 12u);
+
+  for (RtmClientPool::SessionId id : ids) {
+    uint64_t requestId = 0;
+    pool.client(id)->subscribe("room", SubscribeOptions(), requestId);
+  }
+  pumpAll(pool, ids);
+  RecordingEventHandler recording;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", recording);
+  PublishOptions publishOptions;
+  for (int i = 0; i < 50; ++i) {
+    uint64_t requestId = 0;
+    teacher->publish("room", "hi", 2, publishOptions, requestId);
+  }
+
+  // Nothing reaches a removed bot once `remove` returns.
+  RTM_CHECK(pool.remove(ids[5]));
+  RTM_CHECK(!pool.remove(ids[5]));
+  RTM_CHECK(pool.client(ids[5]) == nullptr);
+  size_t removedMessages = bots[5].messages;
+  for (int i = 0; i < 10; ++i) {
+    uint64_t requestId = 0;
+    teacher->publish("room", "hi", 2, publishOptions, requestId);
+  }
+  pool.stop();
+
+  RTM_CHECK_EQ(bots[5].messages, removedMessages);
+  std::vector<std::thread::id> shardThreads(pool.shards());
+  for (size_t i = 0; i < bots.size(); ++i) {
+    if (i != 5) RTM_CHECK_EQ(bots[i].messages, 60u);
+    RTM_CHECK_EQ(bots[i].threads.size(), 1u);
+    std::thread::id thread = *bots[i].threads.begin();
+    RTM_CHECK(thread != std::this_thread::get_id());
+    std::thread::id& shardThread = shardThreads[pool.shardOf(ids[i])];
+    if (shardThread == std::thread::id()) shardThread = thread;
+    RTM_CHECK(thread == shardThread);
+  }
+  RTM_CHECK(std::set<std::thread::id>(shardThreads.begin(), shardThreads.end()).size() == 3u);
+  RtmClientPool::Stats stats = pool.stats();
+  RTM_CHECK_EQ(stats.sessions, 11u);
+  RTM_CHECK_EQ(stats.dropped, 0u);
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testStaggersLoginsAndRetriesShedOnes);
+  RTM_RUN(testPinsCallbacksToShardThreads);
+  return 0;
+}
@@ -0,0 +1,176 @@
+//
+//  RtmCommandCodecTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+
+#include "Command/RtmCommandCodec.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using Format = RtmCommandCodec::Format;
+
+std::vector<RtmCommand> sampleCommands() {
+  std::vector<RtmCommand> commands(kRtmCommandTypeCount);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    commands[i].type = static_cast<RtmCommandType>(i);
+    if (i != 0) commands[i].roomUUID = "7a1f-room";
+  }
+  commands[0].text = "decode command error";
+  commands[1].on = true;
+  commands[2].on = true;
+  commands[3].text = "Class \"starts\"\nin 5 minutes — 准备";
+  commands[4].status = "Paused";
+  commands[5].device = RtmDeviceType::mic;
+  commands[6].device = RtmDeviceType::camera;
+  commands[6].on = true;
+  commands[7].device = RtmDeviceType::mic;
+  commands[8].userUUID = "student-1";
+  commands[9].userUUID = "student-2";
+  commands[9].userName = "Ada";
+  commands[9].rtcUID = 3000000001u;
+  commands[9].avatarURL = "";
+  commands[10].roomLevel = 1;
+  commands[10].expireAt = 1767225600000;
+  return commands;
+}
+
+void checkSame(const RtmCommand& decoded, const RtmCommand& expected) {
+  RTM_CHECK(decoded.type == expected.type);
+  RTM_CHECK(decoded.roomUUID == expected.roomUUID);
+  RTM_CHECK_EQ(decoded.on, expected.on);
+  RTM_CHECK(decoded.text == expected.text);
+  RTM_CHECK(decoded.status == expected.status);
+  RTM_CHECK(decoded.device == expected.device);
+  RTM_CHECK(decoded.userUUID == expected.userUUID);
+  RTM_CHECK(decoded.userName == expected.userName);
+  RTM_CHECK_EQ(decoded.rtcUID, expected.rtcUID);
+  RTM_CHECK(decoded.avatarURL == expected.avatarURL);
+  RTM_CHECK_EQ(decoded.roomLevel, expected.roomLevel);
+  RTM_CHECK_EQ(decoded.expireAt, expected.expireAt);
+}
+
+bool within(std::string_view view, const std::string& buffer) {
+  return view.data() >= buffer.data() && view.data() + view.size() <= buffer.data() + buffer.size();
+}
+
+void testRoundTripsEveryCommandOverTheWire() {
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents;
+  RecordingEventHandler studentEvents;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", teacherEvents);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", studentEvents);
+  uint64_t requestId = 0;
+  student->subscribe("room", SubscribeOptions(), requestId);
+
+  std::vector<RtmCommand> commands = sampleCommands();
+  for (Format format : {Format::binary, Format::json}) {
+    for (const RtmCommand& command : commands) {
+      std::string payload;
+      RtmCommandCodec::encode(command, format, payload);
+      PublishOptions options;
+      options.messageType = RtmCommandCodec::messageTypeOf(format);
+      options.customType = RtmCommandCodec::customTypeOf(format);
+      teacher->publish("room", payload.data(), payload.size(), options, requestId);
+    }
+  }
+  RTM_CHECK_EQ(studentEvents.messages.size(), 2 * commands.size());
+
+  RtmCommandCodec codec;
+  for (size_t i = 0; i < studentEvents.messages.size(); ++i) {
+    const RecordingEventHandler::Message& message = studentEvents.messages[i];
+    IRtmEventHandler::MessageEvent event;
+    event.channelType = message.channelType;
+    event.message = message.payload.data();
+    event.messageLength = message.payload.size();
+    event.customType = message.customType.empty() ? nullptr : message.customType.c_str();
+    RtmCommand decoded;
+    RTM_CHECK(codec.decode(event, decoded));
+    checkSame(decoded, commands[i % commands.size()]);
+    // The binary form is smaller, and its strings are read in place.
+    if (i < commands.size()) {
+      RTM_CHECK(message.payload.size() < studentEvents.messages[i + commands.size()].payload.size());
+      if (!decoded.roomUUID.empty()) RTM_CHECK(within(decoded.roomUUID, message.payload));
+    }
+  }
+  student->release();
+  teacher->release();
+}
+
+void testReadsJsonOfOtherClients() {
+  RtmCommandCodec codec;
+  RtmCommand command;
+  // The web client orders keys its own way, and escapes what it likes.
+  std::string json = R"( { "v" : { "userInfo" : { "avatarURL" : "https:\/\/a.io\/x.png", "rtcUID" : 42,
+      "name" : "你好 😀", "extra" : [1, {"a": null}, "b"] }, "roomUUID" : "r-1",
+      "userUUID" : "u\"1" }, "t" : "enter", "version" : 2 } )";
+  RTM_CHECK(codec.decode(json, Format::json, command));
+  RTM_CHECK(command.type == RtmCommandType::newUserEnter);
+  RTM_CHECK(command.roomUUID == "r-1");
+  RTM_CHECK(command.userUUID == "u\"1");
+  RTM_CHECK(command.userName == "你好 😀");
+  RTM_CHECK(command.avatarURL == "https://a.io/x.png");
+  RTM_CHECK_EQ(command.rtcUID, 42u);
+  RTM_CHECK(within(command.roomUUID, json));
+
+  // JSONEncoder writes dates as milliseconds, possibly with a fraction.
+  RTM_CHECK(codec.decode(R"({"t":"room-expire","v":{"roomUUID":"r","expireInfo":{"roomLevel":0,
+      "expireAt":1767225600000.0}}})",
+                         Format::json, command));
+  RTM_CHECK_EQ(command.expireAt, 1767225600000);
+  RTM_CHECK(codec.decode(R"({"t":"request-device","v":{"roomUUID":"r","mic":true}})", Format::json, command));
+  RTM_CHECK(command.type == RtmCommandType::requestDevice && command.device == RtmDeviceType::mic);
+  RTM_CHECK(codec.decode(R"({"t":"ban","v":{"roomUUID":"r","status":false}})", Format::json, command));
+  RTM_CHECK(command.type == RtmCommandType::ban && !command.on);
+}
+
+void testRejectsMalformedCommands() {
+  RtmCommandCodec codec;
+  RtmCommand command;
+  RTM_CHECK(!codec.decode(R"({"t":"raise-hand","v":{"roomUUID":"r"}})", Format::json, command));
+  RTM_CHECK(command.type == RtmCommandType::undefined);
+  RTM_CHECK(command.text == "decode command field error");
+  RTM_CHECK(!codec.decode(R"({"t":"wave","v":{"roomUUID":"r"}})", Format::json, command));
+  RTM_CHECK(command.text == "decode command title error");
+  RTM_CHECK(!codec.decode(R"({"t":"notice"})", Format::json, command));
+  RTM_CHECK(command.text == "decode command info error");
+  for (const char* json : {R"({"t":"notice","v":{"roomUUID":"r","text":"a})", R"({"t":"ban"} x)",
+                           R"({"t":"notice","v":{"roomUUID":"r","text":"\ud800"}})", "[]", ""}) {
+    RTM_CHECK(!codec.decode(json, Format::json, command));
+    RTM_CHECK(command.text == "decode command error");
+  }
+
+  RtmCommand notice = sampleCommands()[3];
+  std::string binary;
+  RtmCommandCodec::encode(notice, Format::binary, binary);
+  for (size_t length = 0; length < binary.size(); ++length) {
+    RTM_CHECK(!codec.decode(std::string_view(binary.data(), length), Format::binary, command));
+  }
+  // Fields from a newer client are skipped.
+  binary.append("\xa0\x01\x05", 3);
+  binary.append("\xaa\x01\x03xyz", 6);
+  RTM_CHECK(codec.decode(binary, Format::binary, command));
+  checkSame(command, notice);
+  binary.push_back('\x07');
+  RTM_CHECK(!codec.decode(binary, Format::binary, command));
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testRoundTripsEveryCommandOverTheWire);
+  RTM_RUN(testReadsJsonOfOtherClients);
+  RTM_RUN(testRejectsMalformedCommands);
+  return 0;
+}
@@ -0,0 +1,182 @@
+//
+//  RtmEventArenaTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Events/RtmEventArena.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+
+namespace {
+
+using PresenceEvent = IRtmEventHandler::PresenceEvent;
+
+/// Owned source data for a presence snapshot, destroyed before the copy is checked.
+struct SnapshotSource {
+  explicit SnapshotSource(size_t users) {
+    userIds.reserve(users);
+    for (size_t i = 0; i < users; ++i) userIds.push_back("user-" + std::to_string(i));
+    items.resize(users);
+    states.resize(users);
+    for (size_t i = 0; i < users; ++i) {
+      items[i].key = "mic";
+      items[i].value = i % 2 ? "on" : "off";
+      states[i].userId = userIds[i].c_str();
+      states[i].states = &items[i];
+      states[i].statesCount = 1;
+    }
+    event.type = RTM_PRESENCE_EVENT_TYPE_SNAPSHOT;
+    event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+    event.channelName = "lecture";
+    event.snapshot.userStateList = states.data();
+    event.snapshot.userCount = states.size();
+  }
+
+  std::vector<std::string> userIds;
+  std::vector<StateItem> items;
+  std::vector<UserState> states;
+  PresenceEvent event;
+};
+
+void testSnapshotCopiesIntoOneBlock() {
+  RtmEventBlockPool pool;
+  RtmEventArena arena(pool);
+  PresenceEvent copy;
+  {
+    SnapshotSource source(500);
+    copy = arena.copy(source.event);
+    RTM_CHECK(copy.snapshot.userStateList != source.event.snapshot.userStateList);
+  }
+  RTM_CHECK_EQ(arena.blockCount(), 1u);
+  RTM_CHECK_EQ(pool.stats().allocations, 1u);
+  RTM_CHECK_EQ(copy.snapshot.userCount, 500u);
+  RTM_CHECK(std::strcmp(copy.channelName, "lecture") == 0);
+  RTM_CHECK(std::strcmp(copy.snapshot.userStateList[499].userId, "user-499") == 0);
+  RTM_CHECK_EQ(copy.snapshot.userStateList[499].statesCount, 1u);
+  RTM_CHECK(std::strcmp(copy.snapshot.userStateList[499].states[0].value, "on") == 0);
+  RTM_CHECK(arena.bytesUsed() <= RtmEventArena::footprint(copy));
+}
+
+void testBlocksAreReusedAfterReset() {
+  RtmEventBlockPool pool;
+  SnapshotSource source(64);
+  {
+    RtmEventArena arena(pool);
+    arena.copy(source.event);
+    arena.reset();
+    RTM_CHECK_EQ(arena.blockCount(), 0u);
+    arena.copy(source.event);
+  }
+  RtmEventArena other(pool);
+  other.copy(source.event);
+  RtmEventBlockPool::Stats stats = pool.stats();
+  RTM_CHECK_EQ(stats.allocations, 1u);
+  RTM_CHECK_EQ(stats.reuses, 2u);
+}
+
+void testPoolIsSharedAcrossThreads() {
+  RtmEventBlockPool::Options options;
+  options.maxCachedPerClass = 8;
+  RtmEventBlockPool pool(options);
+  constexpr size_t kThreads = 4;
+  constexpr size_t kRounds = 20000;
+  std::vector<std::thread> threads;
+  std::atomic<size_t> corrupted{0};
+  for (size_t thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&pool, &corrupted, thread] {
+      for (size_t round = 0; round < kRounds; ++round) {
+        size_t capacity = 0;
+        unsigned char* block = static_cast<unsigned char*>(pool.acquire(100 + (round % 3) * 400, capacity));
+        std::memset(block, static_cast<int>(thread), capacity);
+        std::this_thread::yield();
+        // No other thread was handed the block while this one held it.
+        if (block[0] != thread || block[capacity - 1] != thread) corrupted.fetch_add(1);
+        pool.release(block, capacity);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  RtmEventBlockPool::Stats stats = pool.stats();
+  RTM_CHECK_EQ(corrupted.load(), 0u);
+  RTM_CHECK_EQ(stats.allocations + stats.reuses, kThreads * kRounds);
+  // New blocks are only needed while the cached ones are all held.
+  RTM_CHECK(stats.allocations <= 64);
+  RTM_CHECK(stats.cachedBlocks <= 2 * 8);
+}
+
+void testMessageCopyKeepsBinaryPayload() {
+  RtmEventBlockPool pool;
+  RtmEventArena arena(pool);
+  const char payload[] = {'a', '\0', 'b'};
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.messageType = RTM_MESSAGE_TYPE_BINARY;
+  event.channelName = "room";
+  event.message = payload;
+  event.messageLength = sizeof(payload);
+  event.publisher = "alice";
+  IRtmEventHandler::MessageEvent copy = arena.copy(event);
+  RTM_CHECK_EQ(copy.messageLength, 3u);
+  RTM_CHECK(std::memcmp(copy.message, payload, sizeof(payload)) == 0);
+  RTM_CHECK(copy.channelTopic == nullptr);
+  RTM_CHECK(copy.customType == nullptr);
+
+  RtmEventArena moved(std::move(arena));
+  RTM_CHECK_EQ(arena.blockCount(), 0u);
+  RTM_CHECK_EQ(moved.blockCount(), 1u);
+  RTM_CHECK(std::strcmp(copy.publisher, "alice") == 0);
+}
+
+void testStorageAndLockCopies() {
+  RtmEventBlockPool pool;
+  RtmEventArena arena(pool);
+  MetadataItem items[2] = {MetadataItem("status", "started", 3), MetadataItem("notice", "hello", 4)};
+  items[1].authorUserId = "teacher";
+  IRtmEventHandler::StorageEvent storage;
+  storage.eventType = RTM_STORAGE_EVENT_TYPE_UPDATE;
+  storage.target = "room";
+  storage.data.majorRevision = 4;
+  storage.data.items = items;
+  storage.data.itemCount = 2;
+  IRtmEventHandler::StorageEvent storageCopy = arena.copy(storage);
+  RTM_CHECK_EQ(storageCopy.data.majorRevision, 4);
+  RTM_CHECK_EQ(storageCopy.data.items[1].revision, 4);
+  RTM_CHECK(std::strcmp(storageCopy.data.items[1].authorUserId, "teacher") == 0);
+  RTM_CHECK(storageCopy.data.items[0].authorUserId == nullptr);
+
+  LockDetail detail;
+  detail.lockName = "board";
+  detail.owner = "teacher";
+  detail.ttl = 10;
+  IRtmEventHandler::LockEvent lock;
+  lock.eventType = RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED;
+  lock.channelName = "room";
+  lock.lockDetailList = &detail;
+  lock.count = 1;
+  IRtmEventHandler::LockEvent lockCopy = arena.copy(lock);
+  RTM_CHECK(lockCopy.lockDetailList != &detail);
+  RTM_CHECK_EQ(lockCopy.lockDetailList[0].ttl, 10u);
+  RTM_CHECK(std::strcmp(lockCopy.lockDetailList[0].owner, "teacher") == 0);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testSnapshotCopiesIntoOneBlock);
+  RTM_RUN(testBlocksAreReusedAfterReset);
+  RTM_RUN(testPoolIsSharedAcrossThreads);
+  RTM_RUN(testMessageCopyKeepsBinaryPayload);
+  RTM_RUN(testStorageAndLockCopies);
+  return 0;
+}
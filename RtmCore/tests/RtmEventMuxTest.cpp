@@ -0,0 +1,135 @@
+//
+//  RtmEventMuxTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <string>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+IRtmEventHandler::MessageEvent message(RTM_CHANNEL_TYPE channelType, const char* channelName, const char* topic,
+                                       const char* payload) {
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = channelType;
+  event.channelName = channelName;
+  event.channelTopic = topic;
+  event.message = payload;
+  event.messageLength = std::char_traits<char>::length(payload);
+  event.publisher = "teacher";
+  return event;
+}
+
+void testChannelAndTopicFilters() {
+  RtmEventMux mux;
+  RecordingEventHandler roomA, controlOnly, everything;
+  RtmEventMux::Filter roomAFilter;
+  roomAFilter.channels = {"roomA"};
+  mux.add(roomA, roomAFilter);
+  RtmEventMux::Filter controlFilter;
+  controlFilter.channels = {"roomB"};
+  controlFilter.topics = {"control"};
+  mux.add(controlOnly, controlFilter);
+  mux.add(everything);
+
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, "roomA", nullptr, "a"));
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_STREAM, "roomB", "control", "b-control"));
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_STREAM, "roomB", "whiteboard", "b-bulk"));
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, "roomC", nullptr, "c"));
+
+  RTM_CHECK_EQ(roomA.messages.size(), 1u);
+  RTM_CHECK_EQ(roomA.messages[0].payload, "a");
+  RTM_CHECK_EQ(controlOnly.messages.size(), 1u);
+  RTM_CHECK_EQ(controlOnly.messages[0].payload, "b-control");
+  RTM_CHECK_EQ(everything.messages.size(), 4u);
+
+  IRtmEventHandler::PresenceEvent presence;
+  presence.type = RTM_PRESENCE_EVENT_TYPE_REMOTE_JOIN_CHANNEL;
+  presence.channelName = "roomB";
+  presence.publisher = "student";
+  mux.onPresenceEvent(presence);
+  RTM_CHECK(roomA.presences.empty());
+  RTM_CHECK_EQ(controlOnly.presences.size(), 1u);
+  RTM_CHECK_EQ(everything.presences.size(), 1u);
+}
+
+void testUserEventsAndResults() {
+  RtmEventMux mux;
+  RecordingEventHandler quiet, loud;
+  RtmEventMux::Filter quietFilter;
+  quietFilter.channels = {"roomA"};
+  quietFilter.userEvents = false;
+  quietFilter.results = false;
+  mux.add(quiet, quietFilter);
+  mux.add(loud);
+
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_USER, "teacher", nullptr, "p2p"));
+  mux.onPublishResult(7, RTM_ERROR_OK);
+  RTM_CHECK(quiet.messages.empty());
+  RTM_CHECK(quiet.results.empty());
+  RTM_CHECK_EQ(loud.messages.size(), 1u);
+  RTM_CHECK(loud.succeeded(7));
+}
+
+void testRemoveStopsDelivery() {
+  RtmEventMux mux;
+  RecordingEventHandler first, second;
+  RtmEventMux::HandlerId firstId = mux.add(first);
+  mux.add(second);
+  RTM_CHECK_EQ(mux.size(), 2u);
+  RTM_CHECK(mux.remove(firstId));
+  RTM_CHECK(!mux.remove(firstId));
+  mux.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, "roomA", nullptr, "a"));
+  RTM_CHECK(first.messages.empty());
+  RTM_CHECK_EQ(second.messages.size(), 1u);
+}
+
+void testLoopbackClientThroughMux() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler roomA, roomB, publisherEvents;
+  RtmEventMux::Filter roomAFilter;
+  roomAFilter.channels = {"roomA"};
+  mux.add(roomA, roomAFilter);
+  RtmEventMux::Filter roomBFilter;
+  roomBFilter.channels = {"roomB"};
+  mux.add(roomB, roomBFilter);
+
+  LoopbackRtmClient* listener = loggedInClient(broker, "student", mux);
+  LoopbackRtmClient* publisher = loggedInClient(broker, "teacher", publisherEvents);
+  SubscribeOptions options;
+  uint64_t requestId = 0;
+  for (const char* channel : {"roomA", "roomB"}) {
+    listener->subscribe(channel, options, requestId);
+    publisher->subscribe(channel, options, requestId);
+  }
+  PublishOptions publishOptions;
+  publisher->publish("roomB", "hi", 2, publishOptions, requestId);
+  RTM_CHECK(roomA.messages.empty());
+  RTM_CHECK_EQ(roomB.messages.size(), 1u);
+  RTM_CHECK_EQ(roomB.presences.back().channelName, "roomB");
+  RTM_CHECK(roomA.linkStates == roomB.linkStates);
+
+  publisher->release();
+  listener->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testChannelAndTopicFilters);
+  RTM_RUN(testUserEventsAndResults);
+  RTM_RUN(testRemoveStopsDelivery);
+  RTM_RUN(testLoopbackClientThroughMux);
+  return 0;
+}
@@ -0,0 +1,291 @@
+//
+//  RtmLeaseManagerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Events/ForwardingRtmEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Lock/RtmLeaseManager.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using Ticket = RtmLeaseManager::Ticket;
+
+/// A classroom with a "presenter" lock of `ttl` seconds; the teacher's tasks share it through a lease manager.
+struct Classroom {
+  explicit Classroom(uint32_t ttl = 10) {
+    teacher = loggedInClient(broker, "teacher", mux);
+    assistant = loggedInClient(broker, "assistant", watcher);
+    leases = std::make_unique<RtmLeaseManager>(*teacher->getLock(), "teacher");
+    mux.add(*leases);
+    SubscribeOptions options;
+    options.withLock = true;
+    uint64_t requestId = 0;
+    teacher->subscribe("class", options, requestId);
+    assistant->subscribe("class", options, requestId);
+    assistant->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", ttl, requestId);
+    pump();
+  }
+
+  ~Classroom() {
+    assistant->release();
+    teacher->release();
+  }
+
+  /// Delivers the results both clients hold.
+  void pump() {
+    teacher->pump();
+    assistant->pump();
+  }
+
+  Ticket acquire() {
+    return leases->acquire("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", [this](Ticket ticket, RTM_ERROR_CODE code) {
+      results.emplace_back(ticket, code);
+    });
+  }
+
+  std::string owner() const {
+    std::vector<LoopbackLock> locks;
+    broker.getLocks("class", RTM_CHANNEL_TYPE_MESSAGE, locks);
+    return locks.empty() ? "<none>" : locks[0].owner;
+  }
+
+  size_t lockEvents(RTM_LOCK_EVENT_TYPE type) const {
+    size_t count = 0;
+    for (const auto& lock : watcher.locks) count += lock.type == type ? 1 : 0;
+    return count;
+  }
+
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler watcher;
+  LoopbackRtmClient* teacher = nullptr;
+  LoopbackRtmClient* assistant = nullptr;
+  std::unique_ptr<RtmLeaseManager> leases;
+  std::vector<std::pair<Ticket, RTM_ERROR_CODE>> results;
+};
+
+void testLocalTasksShareOneRemoteAcquire() {
+  Classroom room;
+  std::vector<Ticket> tickets;
+  for (int i = 0; i < 5; ++i) tickets.push_back(room.acquire());
+  room.pump();
+  RTM_CHECK_EQ(room.results.size(), 1u);
+  RTM_CHECK_EQ(room.results[0].first, tickets[0]);
+  RTM_CHECK_EQ(room.owner(), "teacher");
+  RTM_CHECK(room.leases->held("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter"));
+  RTM_CHECK_EQ(room.leases->stats().waiting, 4u);
+
+  // A waiting task gives up; the others get the lock in turn without the service noticing.
+  RTM_CHECK(room.leases->release(tickets[2]));
+  RTM_CHECK(!room.leases->release(tickets[2]));
+  for (size_t i : {0, 1, 3}) RTM_CHECK(room.leases->release(tickets[i]));
+  room.pump();
+  RTM_CHECK_EQ(room.results.size(), 4u);
+  RTM_CHECK_EQ(room.results[3].first, tickets[4]);
+  RTM_CHECK_EQ(room.owner(), "teacher");
+  RTM_CHECK(room.leases->release(tickets[4]));
+  room.pump();
+  RTM_CHECK_EQ(room.owner(), "");
+
+  RtmLeaseManager::Stats stats = room.leases->stats();
+  RTM_CHECK_EQ(stats.remoteAcquires, 1u);
+  RTM_CHECK_EQ(stats.remoteReleases, 1u);
+  RTM_CHECK_EQ(stats.grants, 4u);
+  RTM_CHECK_EQ(stats.handoffs, 3u);
+  RTM_CHECK_EQ(stats.held, 0u);
+  RTM_CHECK_EQ(room.lockEvents(RTM_LOCK_EVENT_TYPE_LOCK_ACQUIRED), 1u);
+  RTM_CHECK_EQ(room.lockEvents(RTM_LOCK_EVENT_TYPE_LOCK_RELEASED), 1u);
+}
+
+void testReportsLoss() {
+  Classroom room(10);
+  Ticket first = room.acquire();
+  Ticket second = room.acquire();
+  room.pump();
+  RTM_CHECK(room.results[0] == std::make_pair(first, RTM_ERROR_OK));
+
+  // The assistant revokes the lock: the holder hears it is gone, the next task is granted on a new acquire.
+  uint64_t requestId = 0;
+  room.assistant->revokeLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", "teacher", requestId);
+  room.pump();
+  RTM_CHECK_EQ(room.results.size(), 3u);
+  RTM_CHECK(room.results[1] == std::make_pair(first, RTM_ERROR_LOCK_NOT_ACQUIRED));
+  RTM_CHECK(room.results[2] == std::make_pair(second, RTM_ERROR_OK));
+  RTM_CHECK(!room.leases->release(first));
+  RTM_CHECK_EQ(room.owner(), "teacher");
+
+  // Removing the lock ends the holder's lease and fails the tasks still waiting.
+  Ticket third = room.acquire();
+  room.assistant->removeLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  room.pump();
+  RTM_CHECK_EQ(room.results.size(), 5u);
+  RTM_CHECK(room.results[3] == std::make_pair(third, RTM_ERROR_LOCK_NOT_EXIST));
+  RTM_CHECK(room.results[4] == std::make_pair(second, RTM_ERROR_LOCK_NOT_EXIST));
+  RtmLeaseManager::Stats stats = room.leases->stats();
+  RTM_CHECK_EQ(stats.remoteAcquires, 2u);
+  RTM_CHECK_EQ(stats.lost, 2u);
+  RTM_CHECK_EQ(stats.failed, 1u);
+  RTM_CHECK_EQ(stats.held, 0u);
+}
+
+void testContendedAcquireWaitsRemotely() {
+  Classroom room;
+  uint64_t requestId = 0;
+  room.assistant->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+  Ticket first = room.acquire();
+  Ticket second = room.acquire();
+  room.pump();
+  RTM_CHECK(room.results.empty());
+  RTM_CHECK(!room.leases->held("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter"));
+  RTM_CHECK(room.leases->release(first));
+
+  // The service hands the lock over when the assistant lets go; the task still waiting gets it.
+  room.assistant->releaseLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  room.pump();
+  RTM_CHECK_EQ(room.results.size(), 1u);
+  RTM_CHECK(room.results[0] == std::make_pair(second, RTM_ERROR_OK));
+  RTM_CHECK_EQ(room.owner(), "teacher");
+  RTM_CHECK_EQ(room.leases->stats().remoteAcquires, 1u);
+
+  // A lock that does not exist fails every task queued for it.
+  room.leases->acquire("class", RTM_CHANNEL_TYPE_MESSAGE, "whiteboard", [&](Ticket, RTM_ERROR_CODE code) {
+    RTM_CHECK_EQ(code, RTM_ERROR_LOCK_NOT_EXIST);
+  });
+  room.pump();
+  RTM_CHECK_EQ(room.leases->stats().failed, 1u);
+}
+
+void testIgnoresOtherLockResults() {
+  Classroom room;
+  uint64_t requestId = 0;
+  room.assistant->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+  room.pump();
+
+  // The app's own attempt on the same lock fails, and its result arrives while the manager's acquire is being
+  // made: the manager keeps waiting for its own.
+  room.teacher->getLock()->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+  room.teacher->setResultsInCall(true);
+  Ticket ticket = room.acquire();
+  RTM_CHECK(room.results.empty());
+  RTM_CHECK_EQ(room.leases->stats().waiting, 1u);
+
+  room.assistant->releaseLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  RTM_CHECK_EQ(room.results.size(), 1u);
+  RTM_CHECK(room.results[0] == std::make_pair(ticket, RTM_ERROR_OK));
+  RTM_CHECK_EQ(room.owner(), "teacher");
+  RTM_CHECK_EQ(room.leases->stats().failed, 0u);
+}
+
+/// Holds back RELEASED lock events until `replay`, so they arrive after what followed them.
+class LateReleases : public ForwardingRtmEventHandler {
+ public:
+  using ForwardingRtmEventHandler::ForwardingRtmEventHandler;
+
+  void onLockEvent(const LockEvent& event) override {
+    if (!holding || event.eventType != RTM_LOCK_EVENT_TYPE_LOCK_RELEASED) {
+      ForwardingRtmEventHandler::onLockEvent(event);
+      return;
+    }
+    for (size_t i = 0; i < event.count; ++i) {
+      held.push_back({str(event.channelName), str(event.lockDetailList[i].lockName),
+                      str(event.lockDetailList[i].owner), event.lockDetailList[i].ttl});
+    }
+  }
+
+  void replay() {
+    holding = false;
+    for (const Release& release : held) {
+      LockDetail detail;
+      detail.lockName = release.lockName.c_str();
+      detail.owner = release.owner.c_str();
+      detail.ttl = release.ttl;
+      LockEvent event;
+      event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+      event.eventType = RTM_LOCK_EVENT_TYPE_LOCK_RELEASED;
+      event.channelName = release.channelName.c_str();
+      event.lockDetailList = &detail;
+      event.count = 1;
+      ForwardingRtmEventHandler::onLockEvent(event);
+    }
+    held.clear();
+  }
+
+  struct Release {
+    std::string channelName;
+    std::string lockName;
+    std::string owner;
+    uint32_t ttl;
+  };
+
+  bool holding = false;
+  std::vector<Release> held;
+};
+
+void testOnlyOurReleaseIsALoss() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LateReleases late(mux);
+  RecordingEventHandler quiet;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", late);
+  LoopbackRtmClient* assistant = loggedInClient(broker, "assistant", quiet);
+  RtmLeaseManager leases(*teacher->getLock(), "teacher");
+  mux.add(leases);
+  SubscribeOptions options;
+  options.withLock = true;
+  uint64_t requestId = 0;
+  teacher->subscribe("class", options, requestId);
+  assistant->subscribe("class", options, requestId);
+  assistant->setLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", 10, requestId);
+  assistant->acquireLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", false, requestId);
+  std::vector<std::pair<Ticket, RTM_ERROR_CODE>> results;
+  Ticket ticket = leases.acquire("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter",
+                                 [&](Ticket granted, RTM_ERROR_CODE code) { results.emplace_back(granted, code); });
+  teacher->pump();
+  RTM_CHECK(results.empty());
+
+  // The assistant lets go; our acquire result comes before their RELEASED event, which must not take it back.
+  late.holding = true;
+  assistant->releaseLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", requestId);
+  RTM_CHECK_EQ(results.size(), 1u);
+  RTM_CHECK(results[0] == std::make_pair(ticket, RTM_ERROR_OK));
+  RTM_CHECK_EQ(late.held.size(), 1u);
+  late.replay();
+  RTM_CHECK_EQ(results.size(), 1u);
+  RTM_CHECK(leases.held("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter"));
+  RTM_CHECK_EQ(leases.stats().lost, 0u);
+
+  // Our own release, reported by the service, still is.
+  assistant->revokeLock("class", RTM_CHANNEL_TYPE_MESSAGE, "presenter", "teacher", requestId);
+  RTM_CHECK_EQ(results.size(), 2u);
+  RTM_CHECK(results[1] == std::make_pair(ticket, RTM_ERROR_LOCK_NOT_ACQUIRED));
+  RTM_CHECK_EQ(leases.stats().lost, 1u);
+
+  assistant->release();
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testLocalTasksShareOneRemoteAcquire);
+  RTM_RUN(testReportsLoss);
+  RTM_RUN(testContendedAcquireWaitsRemotely);
+  RTM_RUN(testIgnoresOtherLockResults);
+  RTM_RUN(testOnlyOurReleaseIsALoss);
+  return 0;
+}
@@ -0,0 +1,175 @@
+//
+//  RtmMessageRouterTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+
+#include "Command/RtmCommandCodec.h"
+#include "Events/RtmMessageRouter.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+constexpr auto kRoomRoutes = rtmRoutes({
+    {RTM_CHANNEL_TYPE_MESSAGE, RtmCommandCodec::kCustomType},
+    {RTM_CHANNEL_TYPE_USER, RtmCommandCodec::kCustomType},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.chat"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.chat"},
+    {RTM_CHANNEL_TYPE_MESSAGE, ""},
+});
+
+// The table is usable in constant expressions, and tells channel types apart.
+static_assert(kRoomRoutes.find("flat.chat", RTM_CHANNEL_TYPE_STREAM) == 3);
+static_assert(kRoomRoutes.find("flat.chat", RTM_CHANNEL_TYPE_USER) == kRoomRoutes.size());
+static_assert(kRoomRoutes.find("flat.cha", RTM_CHANNEL_TYPE_MESSAGE) == kRoomRoutes.size());
+
+// Big route sets build too: every route is found, at the position it was listed.
+constexpr auto kManyRoutes = rtmRoutes({
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.raiseHand"}, {RTM_CHANNEL_TYPE_USER, "flat.raiseHand"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.raiseHand"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.raiseHand.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.banText"}, {RTM_CHANNEL_TYPE_USER, "flat.banText"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.banText"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.banText.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.banVideo"}, {RTM_CHANNEL_TYPE_USER, "flat.banVideo"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.banVideo"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.banVideo.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.notice"}, {RTM_CHANNEL_TYPE_USER, "flat.notice"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.notice"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.notice.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.chat"}, {RTM_CHANNEL_TYPE_USER, "flat.chat"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.chat"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.chat.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.device"}, {RTM_CHANNEL_TYPE_USER, "flat.device"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.device"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.device.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.speak"}, {RTM_CHANNEL_TYPE_USER, "flat.speak"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.speak"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.speak.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.reward"}, {RTM_CHANNEL_TYPE_USER, "flat.reward"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.reward"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.reward.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.whiteboard"}, {RTM_CHANNEL_TYPE_USER, "flat.whiteboard"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.whiteboard"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.whiteboard.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.recording"}, {RTM_CHANNEL_TYPE_USER, "flat.recording"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.recording"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.recording.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.pageTurn"}, {RTM_CHANNEL_TYPE_USER, "flat.pageTurn"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.pageTurn"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.pageTurn.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.cursor"}, {RTM_CHANNEL_TYPE_USER, "flat.cursor"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.cursor"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.cursor.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.vote"}, {RTM_CHANNEL_TYPE_USER, "flat.vote"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.vote"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.vote.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.quiz"}, {RTM_CHANNEL_TYPE_USER, "flat.quiz"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.quiz"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.quiz.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.timer"}, {RTM_CHANNEL_TYPE_USER, "flat.timer"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.timer"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.timer.ack"},
+    {RTM_CHANNEL_TYPE_MESSAGE, "flat.onStage"}, {RTM_CHANNEL_TYPE_USER, "flat.onStage"},
+    {RTM_CHANNEL_TYPE_STREAM, "flat.onStage"}, {RTM_CHANNEL_TYPE_MESSAGE, "flat.onStage.ack"},
+});
+
+consteval bool findsEveryRoute() {
+  for (size_t i = 0; i < kManyRoutes.size(); ++i) {
+    if (kManyRoutes.find(kManyRoutes.key(i).name, kManyRoutes.key(i).tag) != i) return false;
+  }
+  return true;
+}
+
+static_assert(kManyRoutes.size() == 64);
+static_assert(findsEveryRoute());
+static_assert(kManyRoutes.find("flat.chat.ack", RTM_CHANNEL_TYPE_USER) == kManyRoutes.size());
+
+IRtmEventHandler::MessageEvent message(RTM_CHANNEL_TYPE channelType, const char* customType, const char* payload) {
+  IRtmEventHandler::MessageEvent event;
+  event.channelType = channelType;
+  event.channelName = "room";
+  event.customType = customType;
+  event.message = payload;
+  event.messageLength = std::char_traits<char>::length(payload);
+  event.publisher = "teacher";
+  return event;
+}
+
+void testDispatchesByChannelTypeAndCustomType() {
+  RecordingEventHandler fallback;
+  RtmMessageRouter router(kRoomRoutes, fallback);
+  std::vector<std::string> commands, chat, streamChat, plain;
+  auto into = [](std::vector<std::string>& out) {
+    return [&out](const IRtmEventHandler::MessageEvent& event) {
+      out.emplace_back(event.message, event.messageLength);
+    };
+  };
+  RTM_CHECK(router.on({RTM_CHANNEL_TYPE_MESSAGE, RtmCommandCodec::kCustomType}, into(commands)));
+  RTM_CHECK(router.on({RTM_CHANNEL_TYPE_MESSAGE, "flat.chat"}, into(chat)));
+  RTM_CHECK(router.on({RTM_CHANNEL_TYPE_STREAM, "flat.chat"}, into(streamChat)));
+  RTM_CHECK(router.on({RTM_CHANNEL_TYPE_MESSAGE, ""}, into(plain)));
+  RTM_CHECK(!router.on({RTM_CHANNEL_TYPE_STREAM, "flat.whiteboard"}, into(plain)));
+
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, "flat.cmd.1", "cmd"));
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, "flat.chat", "hi"));
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_STREAM, "flat.chat", "hi on stream"));
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_MESSAGE, nullptr, "no custom type"));
+  // Unknown types, and known routes nobody handles, fall through to `next`.
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_STREAM, "flat.whiteboard", "scene"));
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_USER, "flat.cmd.1", "direct cmd"));
+  router.onMessageEvent(message(RTM_CHANNEL_TYPE_USER, "flat.chat", "direct chat"));
+
+  RTM_CHECK(commands == std::vector<std::string>{"cmd"});
+  RTM_CHECK(chat == std::vector<std::string>{"hi"});
+  RTM_CHECK(streamChat == std::vector<std::string>{"hi on stream"});
+  RTM_CHECK(plain == std::vector<std::string>{"no custom type"});
+  RTM_CHECK_EQ(fallback.messages.size(), 3u);
+  RTM_CHECK_EQ(fallback.messages[0].payload, "scene");
+  RTM_CHECK_EQ(fallback.messages[1].customType, "flat.cmd.1");
+  RTM_CHECK_EQ(router.stats().routed, 4u);
+  RTM_CHECK_EQ(router.stats().unrouted, 3u);
+
+  // Other callbacks pass through.
+  router.onPublishResult(7, RTM_ERROR_OK);
+  RTM_CHECK(fallback.results.count(7) == 1);
+}
+
+void testRoutesCommandsPublishedOverTheWire() {
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents;
+  RecordingEventHandler studentEvents;
+  RtmMessageRouter router(kRoomRoutes, studentEvents);
+  RtmCommandCodec codec;
+  std::vector<RtmCommandType> received;
+  router.on({RTM_CHANNEL_TYPE_MESSAGE, RtmCommandCodec::kCustomType}, [&](const IRtmEventHandler::MessageEvent& event) {
+    RtmCommand command;
+    RTM_CHECK(codec.decode(event, command));
+    received.push_back(command.type);
+  });
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", teacherEvents);
+  LoopbackRtmClient* student = loggedInClient(broker, "student", router);
+  uint64_t requestId = 0;
+  student->subscribe("room", SubscribeOptions(), requestId);
+
+  RtmCommand command;
+  command.type = RtmCommandType::raiseHand;
+  command.roomUUID = "room";
+  command.on = true;
+  std::string payload;
+  RtmCommandCodec::encode(command, RtmCommandCodec::Format::binary, payload);
+  PublishOptions options;
+  options.messageType = RtmCommandCodec::messageTypeOf(RtmCommandCodec::Format::binary);
+  options.customType = RtmCommandCodec::kCustomType;
+  teacher->publish("room", payload.data(), payload.size(), options, requestId);
+  teacher->publish("room", "hello", 5, PublishOptions(), requestId);
+
+  RTM_CHECK(received == std::vector<RtmCommandType>{RtmCommandType::raiseHand});
+  RTM_CHECK_EQ(studentEvents.messages.size(), 1u);
+  RTM_CHECK_EQ(studentEvents.messages[0].payload, "hello");
+  student->release();
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testDispatchesByChannelTypeAndCustomType);
+  RTM_RUN(testRoutesCommandsPublishedOverTheWire);
+  return 0;
+}
@@ -0,0 +1,189 @@
+//
+//  RtmRateGovernorTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Publishing/RtmRateGovernor.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+/// A broker limiting publishes to 10 per second on a clock the test moves.
+struct Throttled {
+  explicit Throttled(RtmRateGovernor::Options options = RtmRateGovernor::Options())
+      : broker(brokerOptions(now)), governor(nullptr) {
+    student = loggedInClient(broker, "student", received);
+    teacher = loggedInClient(broker, "teacher", mux);
+    uint64_t requestId = 0;
+    student->subscribe("room", SubscribeOptions(), requestId);
+    options.onComplete = [this](RtmRateGovernor::Ticket ticket, RTM_ERROR_CODE code) { completed[ticket] = code; };
+    governor = std::make_unique<RtmRateGovernor>(*teacher, now, options);
+    mux.add(*governor);
+  }
+
+  ~Throttled() {
+    teacher->release();
+    student->release();
+  }
+
+  static LoopbackBroker::Options brokerOptions(RtmClock::time_point& now) {
+    LoopbackBroker::Options options;
+    options.publishesPerSecond = 10;
+    options.clock = [&now] { return now; };
+    return options;
+  }
+
+  /// Delivers the teacher's publish results to the governor.
+  void pump() { teacher->pump(); }
+
+  RtmRateGovernor::Ticket publish(const std::string& payload, RTM_MESSAGE_PRIORITY priority) {
+    return governor->publish("room", payload.data(), payload.size(), PublishOptions(), priority, now);
+  }
+
+  RtmClock::time_point now = RtmClock::now();
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  RecordingEventHandler received;
+  std::unique_ptr<RtmRateGovernor> governor;
+  LoopbackRtmClient* student;
+  LoopbackRtmClient* teacher;
+  std::map<RtmRateGovernor::Ticket, RTM_ERROR_CODE> completed;
+};
+
+void testBurstQueuesInsteadOfFailing() {
+  RtmRateGovernor::Options options;
+  options.publish = {30, 20};
+  Throttled room(options);
+  for (int i = 0; i < 40; ++i) RTM_CHECK(room.publish("cmd-" + std::to_string(i), RTM_MESSAGE_PRIORITY_NORMAL) != 0);
+  room.pump();
+  RTM_CHECK_EQ(room.received.messages.size(), 10u);
+  RTM_CHECK(room.governor->ratePerSecond(RtmOperationClass::publish) < 30);
+  RTM_CHECK(room.governor->nextDeadline() > room.now);
+
+  for (int second = 0; second < 10 && room.received.messages.size() < 40; ++second) {
+    room.now += seconds(1);
+    room.governor->poll(room.now);
+    room.pump();
+  }
+  RTM_CHECK_EQ(room.received.messages.size(), 40u);
+  for (int i = 0; i < 40; ++i) RTM_CHECK_EQ(room.received.messages[i].payload, "cmd-" + std::to_string(i));
+  RTM_CHECK_EQ(room.completed.size(), 40u);
+  for (const auto& [ticket, code] : room.completed) RTM_CHECK_EQ(code, RTM_ERROR_OK);
+  RtmRateGovernor::Stats stats = room.governor->stats();
+  RTM_CHECK(stats.rateLimited > 0);
+  RTM_CHECK_EQ(stats.retried, stats.rateLimited);
+  RTM_CHECK_EQ(stats.queued, 0u);
+  RTM_CHECK(room.governor->nextDeadline() == RtmClock::time_point::max());
+}
+
+void testHigherPriorityOvertakesQueue() {
+  RtmRateGovernor::Options options;
+  options.publish = {2, 2};
+  Throttled room(options);
+  room.publish("low-0", RTM_MESSAGE_PRIORITY_LOW);
+  room.publish("low-1", RTM_MESSAGE_PRIORITY_LOW);
+  room.publish("low-2", RTM_MESSAGE_PRIORITY_LOW);
+  room.publish("normal", RTM_MESSAGE_PRIORITY_NORMAL);
+  room.publish("control", RTM_MESSAGE_PRIORITY_HIGHEST);
+  room.pump();
+  RTM_CHECK_EQ(room.received.messages.size(), 2u);
+  RTM_CHECK_EQ(room.governor->stats().queued, 3u);
+
+  room.now += milliseconds(500);
+  RTM_CHECK_EQ(room.governor->poll(room.now), 1u);
+  room.pump();
+  RTM_CHECK_EQ(room.received.messages[2].payload, "control");
+  room.now += seconds(1);
+  room.governor->poll(room.now);
+  room.pump();
+  RTM_CHECK_EQ(room.received.messages[3].payload, "normal");
+  RTM_CHECK_EQ(room.received.messages[4].payload, "low-2");
+}
+
+void testRetriesAreBounded() {
+  RtmRateGovernor::Options options;
+  options.publish = {100, 100};
+  options.maxRetries = 1;
+  Throttled room(options);
+  for (int i = 0; i < 11; ++i) room.publish("m", RTM_MESSAGE_PRIORITY_NORMAL);
+  room.pump();
+  // The 11th is refused and re-queued; refused again within the broker's window, it fails.
+  room.now += milliseconds(10);
+  room.governor->poll(room.now);
+  room.pump();
+  RTM_CHECK_EQ(room.completed.size(), 10u);
+  room.now += milliseconds(500);
+  room.governor->poll(room.now);
+  room.pump();
+  RTM_CHECK_EQ(room.completed.size(), 11u);
+  RTM_CHECK_EQ(room.completed.rbegin()->second, RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT);
+}
+
+void testRetriesRespectMaxQueued() {
+  // Results are fed by hand, so one can arrive while the queue is full.
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", teacherEvents);
+  RtmClock::time_point now;
+  std::map<RtmRateGovernor::Ticket, RTM_ERROR_CODE> completed;
+  RtmRateGovernor::Options options;
+  options.publish = {1, 2};
+  options.maxQueued = 1;
+  options.unclaimedCapacity = 1;
+  options.onComplete = [&completed](RtmRateGovernor::Ticket ticket, RTM_ERROR_CODE code) { completed[ticket] = code; };
+  RtmRateGovernor governor(*teacher, now, options);
+  PublishOptions publish;
+  RtmRateGovernor::Ticket first = governor.publish("room", "a", 1, publish, RTM_MESSAGE_PRIORITY_NORMAL, now);
+  RtmRateGovernor::Ticket second = governor.publish("room", "b", 1, publish, RTM_MESSAGE_PRIORITY_NORMAL, now);
+  RTM_CHECK(governor.publish("room", "c", 1, publish, RTM_MESSAGE_PRIORITY_NORMAL, now) != 0);
+  RTM_CHECK_EQ(governor.publish("room", "d", 1, publish, RTM_MESSAGE_PRIORITY_NORMAL, now), 0u);
+  RTM_CHECK_EQ(governor.stats().inFlight, 2u);
+
+  teacher->pump();
+  std::vector<uint64_t> requestIds;
+  for (const auto& [requestId, code] : teacherEvents.results) requestIds.push_back(requestId);
+  RTM_CHECK_EQ(requestIds.size(), 3u);
+  governor.onPublishResult(requestIds[1], RTM_ERROR_OK);
+  // The retry would overflow the queue, so the rate-limit error is reported instead.
+  governor.onPublishResult(requestIds[2], RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT);
+  RTM_CHECK_EQ(completed[first], RTM_ERROR_OK);
+  RTM_CHECK_EQ(completed[second], RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TOO_FREQUENT);
+  RtmRateGovernor::Stats stats = governor.stats();
+  RTM_CHECK_EQ(stats.queued, 1u);
+  RTM_CHECK_EQ(stats.retried, 0u);
+  RTM_CHECK_EQ(stats.rateLimited, 1u);
+
+  // Results no call claims are kept within `unclaimedCapacity`; evicted ones are counted.
+  governor.onPublishResult(1000, RTM_ERROR_OK);
+  governor.onPublishResult(1001, RTM_ERROR_OK);
+  RTM_CHECK_EQ(governor.stats().unclaimedDropped, 1u);
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testBurstQueuesInsteadOfFailing);
+  RTM_RUN(testHigherPriorityOvertakesQueue);
+  RTM_RUN(testRetriesAreBounded);
+  RTM_RUN(testRetriesRespectMaxQueued);
+  return 0;
+}
@@ -0,0 +1,148 @@
+//
+//  RtmRequestTrackerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Requests/RtmRequestTracker.h"
+#include "Requests/RtmTask.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/// Issues nothing: hands out the next id and leaves the result to the test.
+struct ManualIssue {
+  uint64_t* nextId;
+  void operator()(uint64_t& requestId) const { requestId = ++*nextId; }
+};
+
+RtmTask loginSubscribePublish(RtmRequestTracker& tracker, IRtmClient& client, std::vector<RTM_ERROR_CODE>& codes) {
+  codes.push_back(co_await tracker.login(client, "token"));
+  codes.push_back(co_await tracker.subscribe(client, "room", SubscribeOptions()));
+  codes.push_back(co_await tracker.publish(client, "room", "hello", 5, PublishOptions()));
+  PublishOptions direct;
+  direct.channelType = RTM_CHANNEL_TYPE_USER;
+  codes.push_back(co_await tracker.publish(client, "nobody", "hello", 5, direct));
+}
+
+RtmTask awaitManual(RtmRequestTracker& tracker, uint64_t& nextId, RTM_ERROR_CODE& code, bool& done) {
+  code = co_await tracker.track(ManualIssue{&nextId}, RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT);
+  done = true;
+}
+
+void testLoopbackResultsResumeEachStep() {
+  LoopbackBroker broker;
+  RtmRequestTracker tracker(RtmClock::now());
+  RtmEventMux mux;
+  RecordingEventHandler events;
+  mux.add(tracker);
+  mux.add(events);
+  RtmConfig config;
+  config.appId = "loopback";
+  config.userId = "teacher";
+  config.eventHandler = &mux;
+  int errorCode = 0;
+  LoopbackRtmClient* client = createLoopbackRtmClient(broker, config, errorCode);
+
+  std::vector<RTM_ERROR_CODE> codes;
+  loginSubscribePublish(tracker, *client, codes);
+  RTM_CHECK(codes.empty());
+  // Each result resumes the task, whose next call is answered on the next pump.
+  while (client->pump() > 0) {
+  }
+  RTM_CHECK_EQ(codes.size(), 4u);
+  RTM_CHECK_EQ(codes[0], RTM_ERROR_OK);
+  RTM_CHECK_EQ(codes[1], RTM_ERROR_OK);
+  RTM_CHECK_EQ(codes[2], RTM_ERROR_OK);
+  RTM_CHECK_EQ(codes[3], RTM_ERROR_CHANNEL_RECEIVER_OFFLINE);
+  RTM_CHECK_EQ(events.results.size(), 4u);
+  RtmRequestTracker::Stats stats = tracker.stats();
+  RTM_CHECK_EQ(stats.inFlight, 0u);
+  RTM_CHECK_EQ(stats.completed, 4u);
+  client->release();
+}
+
+void testManyRequestsCompleteOutOfOrder() {
+  RtmRequestTracker tracker(RtmClock::now());
+  const int count = 5000;
+  uint64_t nextId = 0;
+  std::vector<RTM_ERROR_CODE> codes(count, RTM_ERROR_OK);
+  std::unique_ptr<bool[]> done(new bool[count]());
+  for (int i = 0; i < count; ++i) awaitManual(tracker, nextId, codes[i], done[i]);
+  RTM_CHECK_EQ(tracker.size(), static_cast<size_t>(count));
+  for (int i = count; i > 0; --i) {
+    tracker.onPublishResult(i, i % 2 ? RTM_ERROR_OK : RTM_ERROR_CHANNEL_RECEIVER_OFFLINE);
+  }
+  RTM_CHECK_EQ(tracker.size(), 0u);
+  for (int i = 0; i < count; ++i) {
+    RTM_CHECK(done[i]);
+    RTM_CHECK_EQ(codes[i], (i + 1) % 2 ? RTM_ERROR_OK : RTM_ERROR_CHANNEL_RECEIVER_OFFLINE);
+  }
+}
+
+void testDeadlinesResumeWithTimeoutCode() {
+  RtmClock::time_point start = RtmClock::now();
+  RtmRequestTracker::Options options;
+  options.timeout = milliseconds(200);
+  RtmRequestTracker tracker(start, options);
+  uint64_t nextId = 0;
+  RTM_ERROR_CODE first = RTM_ERROR_OK, second = RTM_ERROR_OK;
+  bool firstDone = false, secondDone = false;
+  awaitManual(tracker, nextId, first, firstDone);
+  tracker.poll(start + milliseconds(150));
+  awaitManual(tracker, nextId, second, secondDone);
+
+  RTM_CHECK_EQ(tracker.poll(start + milliseconds(199)), 0u);
+  RTM_CHECK_EQ(tracker.poll(start + milliseconds(200)), 1u);
+  RTM_CHECK(firstDone && !secondDone);
+  RTM_CHECK_EQ(first, RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT);
+
+  // Late results are ignored; the second request completes normally.
+  tracker.onPublishResult(1, RTM_ERROR_OK);
+  RTM_CHECK_EQ(first, RTM_ERROR_CHANNEL_PUBLISH_MESSAGE_TIMEOUT);
+  tracker.onPublishResult(2, RTM_ERROR_OK);
+  RTM_CHECK(secondDone);
+  RTM_CHECK_EQ(tracker.poll(start + milliseconds(1000)), 0u);
+  RTM_CHECK_EQ(tracker.stats().timedOut, 1u);
+}
+
+void testUnclaimedResultsAreBounded() {
+  RtmRequestTracker::Options options;
+  options.unclaimedCapacity = 4;
+  RtmRequestTracker tracker(RtmClock::now(), options);
+  for (uint64_t id = 1; id <= 6; ++id) tracker.onLoginResult(id, RTM_ERROR_OK);
+  RTM_CHECK_EQ(tracker.stats().unclaimedDropped, 2u);
+
+  // Id 6 is still kept, so awaiting it resumes without suspending.
+  uint64_t nextId = 5;
+  RTM_ERROR_CODE code = RTM_ERROR_NOT_LOGIN;
+  bool done = false;
+  awaitManual(tracker, nextId, code, done);
+  RTM_CHECK(done);
+  RTM_CHECK_EQ(code, RTM_ERROR_OK);
+  RTM_CHECK_EQ(tracker.size(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testLoopbackResultsResumeEachStep);
+  RTM_RUN(testManyRequestsCompleteOutOfOrder);
+  RTM_RUN(testDeadlinesResumeWithTimeoutCode);
+  RTM_RUN(testUnclaimedResultsAreBounded);
+  return 0;
+}
@@ -0,0 +1,241 @@
+//
+//  RtmSessionManagerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Events/QueuedRtmEventHandler.h"
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Session/RtmSessionManager.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+size_t channelsOf(const LoopbackBroker& broker, const char* userId) {
+  std::vector<LoopbackChannelRef> channels;
+  broker.whereNow(userId, channels);
+  return channels.size();
+}
+
+void subscribeRooms(RtmSessionManager& sessions, int first, int count) {
+  for (int i = first; i < first + count; ++i) {
+    uint64_t requestId = 0;
+    sessions.subscribe(("room-" + std::to_string(i)).c_str(), SubscribeOptions(), requestId);
+  }
+}
+
+void testRestoresInParallelAfterSessionLoss() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  // The teacher's callbacks wait in the queue, so restore calls stay in flight until it is drained.
+  QueuedRtmEventHandler queue(mux);
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", queue);
+  RtmClock::time_point start = RtmClock::now();
+  std::vector<RtmClock::duration> restored;
+  RtmSessionManager::Options options;
+  options.maxInFlight = 4;
+  options.seed = 7;
+  options.onRestored = [&](RtmClock::duration timeToRestore, size_t failed) {
+    RTM_CHECK_EQ(failed, 0u);
+    restored.push_back(timeToRestore);
+  };
+  RtmSessionManager sessions(*teacher, start, options);
+  mux.add(sessions);
+
+  subscribeRooms(sessions, 0, 10);
+  int errorCode = 0;
+  IStreamChannel* board = teacher->createStreamChannel("board", errorCode);
+  uint64_t requestId = 0;
+  sessions.join(*board, JoinChannelOptions(), requestId);
+  JoinTopicOptions topicOptions;
+  topicOptions.meta = "pen";
+  sessions.joinTopic(*board, "strokes", topicOptions, requestId);
+  sessions.joinTopic(*board, "cursor", topicOptions, requestId);
+  teacher->pump();
+  queue.drain();
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 11u);
+  RTM_CHECK_EQ(sessions.stats().topics, 2u);
+
+  // The service drops the session; the link comes back half a second later without it.
+  sessions.poll(start + seconds(1));
+  teacher->reconnect(false);
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 0u);
+  while (!sessions.restoring() && queue.drain(1) > 0) {
+  }
+  RtmSessionManager::Stats stats = sessions.stats();
+  RTM_CHECK_EQ(stats.calls, 4u);
+  RTM_CHECK_EQ(stats.pending, 11u);
+  sessions.poll(start + milliseconds(1500));
+
+  // Each result frees a slot for the next call; the topics follow the board's join.
+  while (queue.drain(1) > 0 || teacher->pump() > 0) {
+  }
+  RTM_CHECK(!sessions.restoring());
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 11u);
+  TopicMessageOptions messageOptions;
+  RTM_CHECK_EQ(broker.publishTopicMessage(*teacher->session(), "board", "strokes", "x", 1, messageOptions),
+               RTM_ERROR_OK);
+  stats = sessions.stats();
+  RTM_CHECK_EQ(stats.reconnects, 1u);
+  RTM_CHECK_EQ(stats.restores, 1u);
+  RTM_CHECK_EQ(stats.calls, 13u);
+  RTM_CHECK_EQ(stats.peakInFlight, 4u);
+  RTM_CHECK_EQ(stats.pending, 0u);
+  RTM_CHECK(stats.lastTimeToRestore == milliseconds(500));
+  RTM_CHECK_EQ(restored.size(), 1u);
+
+  board->release();
+  teacher->release();
+}
+
+void testRetriesWithJitteredBackoff() {
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  LoopbackBroker::Options brokerOptions;
+  brokerOptions.subscribesPerSecond = 5;
+  brokerOptions.clock = [&now] { return now; };
+  LoopbackBroker broker(brokerOptions);
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmSessionManager::Options options;
+  options.seed = 3;
+  RtmSessionManager sessions(*teacher, start, options);
+  mux.add(sessions);
+  subscribeRooms(sessions, 0, 4);
+  now = start + seconds(1);
+  subscribeRooms(sessions, 4, 4);
+  teacher->pump();
+
+  // Eight resubscribes at once: the service admits five and turns the rest away.
+  now = start + seconds(2);
+  sessions.poll(now);
+  teacher->reconnect(false);
+  teacher->pump();
+  RtmSessionManager::Stats stats = sessions.stats();
+  RTM_CHECK_EQ(stats.calls, 8u);
+  RTM_CHECK_EQ(stats.retries, 3u);
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 5u);
+  RtmClock::time_point retryAt = sessions.nextDeadline();
+  RTM_CHECK(retryAt >= now + milliseconds(100) && retryAt <= now + milliseconds(200));
+  RTM_CHECK_EQ(sessions.poll(retryAt - milliseconds(1)), 0u);
+
+  // Still inside the service's window: the retries fail and back off further.
+  now += milliseconds(200);
+  RTM_CHECK_EQ(sessions.poll(now), 3u);
+  teacher->pump();
+  RTM_CHECK_EQ(sessions.stats().retries, 6u);
+  RTM_CHECK(sessions.nextDeadline() >= now + milliseconds(200) && sessions.nextDeadline() <= now + milliseconds(400));
+
+  now = start + milliseconds(3500);
+  RTM_CHECK_EQ(sessions.poll(now), 3u);
+  teacher->pump();
+  RTM_CHECK(!sessions.restoring());
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 8u);
+  stats = sessions.stats();
+  RTM_CHECK_EQ(stats.failed, 0u);
+  RTM_CHECK(stats.lastTimeToRestore == milliseconds(1500));
+  RTM_CHECK(sessions.nextDeadline() == RtmClock::time_point::max());
+  teacher->release();
+}
+
+void testResumedReconnectRestoresOnlyWhatWasLost() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmClock::time_point start = RtmClock::now();
+  RtmSessionManager sessions(*teacher, start);
+  mux.add(sessions);
+  subscribeRooms(sessions, 0, 3);
+  teacher->pump();
+
+  teacher->reconnect(true);
+  RtmSessionManager::Stats stats = sessions.stats();
+  RTM_CHECK_EQ(stats.reconnects, 1u);
+  RTM_CHECK_EQ(stats.resumed, 1u);
+  RTM_CHECK_EQ(stats.calls, 0u);
+  RTM_CHECK(!sessions.restoring());
+
+  // A resumed session that still lost one channel gets only that one back.
+  uint64_t requestId = 0;
+  teacher->unsubscribe("room-1", requestId);
+  teacher->pump();
+  IRtmEventHandler::LinkStateEvent event;
+  event.previousState = RTM_LINK_STATE_CONNECTED;
+  event.currentState = RTM_LINK_STATE_CONNECTING;
+  event.operation = RTM_LINK_OPERATION_AUTO_RECONNECT;
+  mux.onLinkStateEvent(event);
+  const char* unrestored[] = {"room-1"};
+  event.previousState = RTM_LINK_STATE_CONNECTING;
+  event.currentState = RTM_LINK_STATE_CONNECTED;
+  event.operation = RTM_LINK_OPERATION_RECONNECTED;
+  event.isResumed = true;
+  event.unrestoredChannels = unrestored;
+  event.unrestoredChannelCount = 1;
+  mux.onLinkStateEvent(event);
+  teacher->pump();
+  stats = sessions.stats();
+  RTM_CHECK_EQ(stats.resumed, 1u);
+  RTM_CHECK_EQ(stats.restores, 1u);
+  RTM_CHECK_EQ(stats.calls, 1u);
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 3u);
+
+  // Channels the app left are not restored.
+  sessions.unsubscribe("room-2", requestId);
+  teacher->pump();
+  teacher->reconnect(false);
+  teacher->pump();
+  RTM_CHECK_EQ(sessions.stats().calls, 3u);
+  RTM_CHECK_EQ(sessions.stats().subscriptions, 2u);
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 2u);
+  teacher->release();
+}
+
+void testIgnoresTheAppsOwnResults() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmClock::time_point start = RtmClock::now();
+  RtmSessionManager sessions(*teacher, start);
+  mux.add(sessions);
+  subscribeRooms(sessions, 0, 1);
+  teacher->pump();
+
+  // The app subscribes again on its own and fails; that result and the restore's own both come while the
+  // restore call is being made, the app's first. Only the restore's settles it.
+  uint64_t requestId = 0;
+  teacher->subscribe("room-0", SubscribeOptions(), requestId);
+  teacher->setResultsInCall(true);
+  sessions.poll(start + seconds(1));
+  teacher->reconnect(false);
+  RTM_CHECK(!sessions.restoring());
+  RtmSessionManager::Stats stats = sessions.stats();
+  RTM_CHECK_EQ(stats.calls, 1u);
+  RTM_CHECK_EQ(stats.retries, 0u);
+  RTM_CHECK_EQ(stats.pending, 0u);
+  RTM_CHECK_EQ(channelsOf(broker, "teacher"), 1u);
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testRestoresInParallelAfterSessionLoss);
+  RTM_RUN(testRetriesWithJitteredBackoff);
+  RTM_RUN(testResumedReconnectRestoresOnlyWhatWasLost);
+  RTM_RUN(testIgnoresTheAppsOwnResults);
+  return 0;
+}
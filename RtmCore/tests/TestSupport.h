@@ -0,0 +1,230 @@
+//
+//  TestSupport.h
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Events/ForwardingRtmEventHandler.h"
+#include "IAgoraRtmClient.h"
+#include "Loopback/LoopbackRtmClient.h"
+
+#define RTM_CHECK(condition)                                                          \
+  do {                                                                                \
+    if (!(condition)) {                                                               \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      std::exit(1);                                                                   \
+    }                                                                                 \
+  } while (0)
+
+#define RTM_CHECK_EQ(lhs, rhs) RTM_CHECK((lhs) == (rhs))
+
+#define RTM_RUN(test)                     \
+  do {                                    \
+    std::printf("[ RUN  ] %s\n", #test);  \
+    test();                               \
+    std::printf("[  OK  ] %s\n", #test);  \
+  } while (0)
+
+namespace flat {
+namespace rtm {
+namespace test {
+
+inline std::string str(const char* value) { return value ? value : ""; }
+
+/// Owning copy of every callback a test cares about.
+class RecordingEventHandler : public agora::rtm::IRtmEventHandler {
+ public:
+  struct Message {
+    agora::rtm::RTM_CHANNEL_TYPE channelType;
+    std::string channelName;
+    std::string topic;
+    std::string publisher;
+    std::string payload;
+    std::string customType;
+  };
+
+  struct Presence {
+    agora::rtm::RTM_PRESENCE_EVENT_TYPE type;
+    std::string channelName;
+    std::string publisher;
+    std::vector<std::string> users;
+    std::map<std::string, std::string> states;
+  };
+
+  struct Storage {
+    agora::rtm::RTM_STORAGE_EVENT_TYPE type;
+    std::string target;
+    int64_t majorRevision;
+    std::map<std::string, std::string> items;
+  };
+
+  struct Lock {
+    agora::rtm::RTM_LOCK_EVENT_TYPE type;
+    std::string channelName;
+    std::vector<std::pair<std::string, std::string>> locks;
+  };
+
+  void onLinkStateEvent(const LinkStateEvent& event) override { linkStates.push_back(event.currentState); }
+
+  void onMessageEvent(const MessageEvent& event) override {
+    messages.push_back({event.channelType, str(event.channelName), str(event.channelTopic), str(event.publisher),
+                        std::string(event.message, event.messageLength), str(event.customType)});
+  }
+
+  void onPresenceEvent(const PresenceEvent& event) override {
+    Presence presence{event.type, str(event.channelName), str(event.publisher), {}, {}};
+    for (size_t i = 0; i < event.snapshot.userCount; ++i) {
+      presence.users.push_back(str(event.snapshot.userStateList[i].userId));
+    }
+    for (size_t i = 0; i < event.stateItemCount; ++i) {
+      presence.states[str(event.stateItems[i].key)] = str(event.stateItems[i].value);
+    }
+    presences.push_back(presence);
+  }
+
+  void onStorageEvent(const StorageEvent& event) override {
+    Storage storage{event.eventType, str(event.target), event.data.majorRevision, {}};
+    for (size_t i = 0; i < event.data.itemCount; ++i) {
+      storage.items[str(event.data.items[i].key)] = str(event.data.items[i].value);
+    }
+    storages.push_back(storage);
+  }
+
+  void onLockEvent(const LockEvent& event) override {
+    Lock lock{event.eventType, str(event.channelName), {}};
+    for (size_t i = 0; i < event.count; ++i) {
+      lock.locks.emplace_back(str(event.lockDetailList[i].lockName), str(event.lockDetailList[i].owner));
+    }
+    locks.push_back(lock);
+  }
+
+  void onTopicEvent(const TopicEvent& event) override { topicEvents.push_back(event.type); }
+
+  void onLoginResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onPublishResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onSubscribeResult(const uint64_t requestId, const char*, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onUnsubscribeResult(const uint64_t requestId, const char*, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onJoinResult(const uint64_t requestId, const char*, const char*,
+                    agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onJoinTopicResult(const uint64_t requestId, const char*, const char*, const char*, const char*,
+                         agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onPublishTopicMessageResult(const uint64_t requestId, const char*, const char*,
+                                   agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onSubscribeTopicResult(const uint64_t requestId, const char*, const char*, const char*, agora::rtm::UserList,
+                              agora::rtm::UserList, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onSetChannelMetadataResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE,
+                                  agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onUpdateChannelMetadataResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onRemoveChannelMetadataResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE,
+                                     agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onSetLockResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE, const char*,
+                       agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onAcquireLockResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE, const char*,
+                           agora::rtm::RTM_ERROR_CODE errorCode, const char*) override {
+    results[requestId] = errorCode;
+  }
+  void onReleaseLockResult(const uint64_t requestId, const char*, agora::rtm::RTM_CHANNEL_TYPE, const char*,
+                           agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onPresenceSetStateResult(const uint64_t requestId, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+  }
+  void onWhoNowResult(const uint64_t requestId, const agora::rtm::UserState* userStateList, const size_t count,
+                      const char* nextPage, agora::rtm::RTM_ERROR_CODE errorCode) override {
+    results[requestId] = errorCode;
+    lastUsers.clear();
+    for (size_t i = 0; i < count; ++i) lastUsers.push_back(str(userStateList[i].userId));
+    lastNextPage = str(nextPage);
+  }
+
+  bool succeeded(uint64_t requestId) const {
+    auto found = results.find(requestId);
+    return found != results.end() && found->second == agora::rtm::RTM_ERROR_OK;
+  }
+
+  agora::rtm::RTM_ERROR_CODE resultOf(uint64_t requestId) const {
+    auto found = results.find(requestId);
+    return found == results.end() ? static_cast<agora::rtm::RTM_ERROR_CODE>(1) : found->second;
+  }
+
+  std::vector<agora::rtm::RTM_LINK_STATE> linkStates;
+  std::vector<Message> messages;
+  std::vector<Presence> presences;
+  std::vector<Storage> storages;
+  std::vector<Lock> locks;
+  std::vector<agora::rtm::RTM_TOPIC_EVENT_TYPE> topicEvents;
+  std::map<uint64_t, agora::rtm::RTM_ERROR_CODE> results;
+  std::vector<std::string> lastUsers;
+  std::string lastNextPage;
+};
+
+/// Loses the next `drops` storage events, the way a flaky link would.
+class LossyStorageEvents : public ForwardingRtmEventHandler {
+ public:
+  using ForwardingRtmEventHandler::ForwardingRtmEventHandler;
+
+  void onStorageEvent(const StorageEvent& event) override {
+    if (drops > 0) {
+      --drops;
+      return;
+    }
+    ForwardingRtmEventHandler::onStorageEvent(event);
+  }
+
+  int drops = 0;
+};
+
+/// A logged-in loopback client on `broker`.
+inline LoopbackRtmClient* loggedInClient(LoopbackBroker& broker, const char* userId,
+                                         agora::rtm::IRtmEventHandler& handler) {
+  agora::rtm::RtmConfig config;
+  config.appId = "loopback";
+  config.userId = userId;
+  config.eventHandler = &handler;
+  int errorCode = 0;
+  LoopbackRtmClient* client = createLoopbackRtmClient(broker, config, errorCode);
+  RTM_CHECK(client != nullptr);
+  uint64_t requestId = 0;
+  client->login("token", requestId);
+  client->pump();
+  return client;
+}
+
+}  // namespace test
+}  // namespace rtm
+}  // namespace flat
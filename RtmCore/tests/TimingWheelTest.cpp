@@ -0,0 +1,92 @@
+//
+//  TimingWheelTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Common/TimingWheel.h"
+#include "TestSupport.h"
+
+using namespace flat::rtm;
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::milliseconds;
+
+void testTimersFireOnTheirTick() {
+  RtmClock::time_point start = RtmClock::now();
+  TimingWheel wheel(start);
+  wheel.schedule(start + milliseconds(5), 5);
+  wheel.schedule(start + milliseconds(70), 70);
+  wheel.schedule(start + milliseconds(5000), 5000);
+  std::vector<uint64_t> expired;
+  RTM_CHECK_EQ(wheel.advance(start + milliseconds(4), expired), 0u);
+  RTM_CHECK_EQ(wheel.advance(start + milliseconds(5), expired), 1u);
+  RTM_CHECK_EQ(wheel.advance(start + milliseconds(69), expired), 0u);
+  RTM_CHECK_EQ(wheel.advance(start + milliseconds(4999), expired), 1u);
+  RTM_CHECK_EQ(wheel.size(), 1u);
+  RTM_CHECK_EQ(wheel.advance(start + milliseconds(5000), expired), 1u);
+  RTM_CHECK(expired == std::vector<uint64_t>({5, 70, 5000}));
+}
+
+void testCancelAndStaleIds() {
+  RtmClock::time_point start = RtmClock::now();
+  TimingWheel wheel(start);
+  TimingWheel::TimerId first = wheel.schedule(start + milliseconds(10), 1);
+  TimingWheel::TimerId second = wheel.schedule(start + milliseconds(10), 2);
+  RTM_CHECK(wheel.cancel(first));
+  RTM_CHECK(!wheel.cancel(first));
+  // The freed node is reused; the old id must not cancel the new timer.
+  TimingWheel::TimerId third = wheel.schedule(start + milliseconds(20), 3);
+  RTM_CHECK(!wheel.cancel(first));
+  std::vector<uint64_t> expired;
+  wheel.advance(start + milliseconds(30), expired);
+  RTM_CHECK(expired == std::vector<uint64_t>({2, 3}));
+  RTM_CHECK(!wheel.cancel(second));
+  RTM_CHECK(!wheel.cancel(third));
+  RTM_CHECK_EQ(wheel.size(), 0u);
+}
+
+void testCascadesMatchDeadlines() {
+  RtmClock::time_point start = RtmClock::now();
+  TimingWheel wheel(start);
+  std::vector<uint64_t> deadlines;
+  for (uint64_t ms = 1; ms < 300000; ms = ms * 3 + 7) deadlines.push_back(ms);
+  for (uint64_t ms : {63u, 64u, 65u, 4095u, 4096u, 4097u, 262144u}) deadlines.push_back(ms);
+  for (uint64_t ms : deadlines) wheel.schedule(start + milliseconds(ms), ms);
+  // Past the top level's span.
+  wheel.schedule(start + hours(6), 0);
+
+  std::vector<uint64_t> expired;
+  for (uint64_t now = 0; now <= 300000; now += 37) {
+    size_t before = expired.size();
+    wheel.advance(start + milliseconds(now), expired);
+    for (size_t i = before; i < expired.size(); ++i) {
+      RTM_CHECK(expired[i] <= now);
+      RTM_CHECK(expired[i] + 37 > now);
+    }
+  }
+  std::sort(deadlines.begin(), deadlines.end());
+  std::sort(expired.begin(), expired.end());
+  RTM_CHECK(expired == deadlines);
+  RTM_CHECK_EQ(wheel.size(), 1u);
+  wheel.advance(start + hours(6), expired);
+  RTM_CHECK_EQ(expired.back(), 0u);
+  RTM_CHECK_EQ(wheel.size(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testTimersFireOnTheirTick);
+  RTM_RUN(testCancelAndStaleIds);
+  RTM_RUN(testCascadesMatchDeadlines);
+  return 0;
+}
@@ -0,0 +1,228 @@
+//
+//  TokenRenewalSchedulerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Events/RtmEventMux.h"
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Session/TokenRenewalScheduler.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+using std::chrono::seconds;
+using Token = TokenRenewalScheduler::Token;
+
+/// Stands in for the app server: hands out tokens valid for `validity` from the time of the request.
+struct TokenServer {
+  void operator()(const std::vector<std::string>& targets, TokenRenewalScheduler::Done done) {
+    batches.push_back(targets);
+    std::vector<Token> tokens;
+    for (const std::string& target : targets) {
+      if (target == withheld) continue;
+      tokens.push_back({target, "token-" + std::to_string(++issued), *now + validity});
+    }
+    if (defer) {
+      pending.push_back([done, tokens] { done(tokens); });
+      return;
+    }
+    done(std::move(tokens));
+  }
+
+  const RtmClock::time_point* now = nullptr;
+  RtmClock::duration validity = hours(1);
+  std::string withheld = "<none>";
+  bool defer = false;
+  int issued = 0;
+  std::vector<std::vector<std::string>> batches;
+  std::vector<std::function<void()>> pending;
+};
+
+void testRenewsRoomsOfOneEpochInSpreadBatches() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  TokenServer server;
+  server.now = &now;
+  TokenRenewalScheduler::Options options;
+  options.seed = 11;
+  std::vector<std::string> routed;
+  options.renewChannel = [&](IStreamChannel& channel, const char* token, uint64_t& requestId) {
+    routed.emplace_back(channel.getChannelName());
+    channel.renewToken(token, requestId);
+  };
+  TokenRenewalScheduler scheduler(
+      *teacher, [&server](const std::vector<std::string>& targets, TokenRenewalScheduler::Done done) {
+        server(targets, std::move(done));
+      },
+      start, options);
+  mux.add(scheduler);
+
+  // Forty rooms whose tokens were all issued with the login token.
+  RtmClock::time_point epoch = start + hours(1);
+  scheduler.trackClient(epoch);
+  std::vector<IStreamChannel*> rooms;
+  for (int i = 0; i < 40; ++i) {
+    int errorCode = 0;
+    IStreamChannel* room = teacher->createStreamChannel(("room-" + std::to_string(i)).c_str(), errorCode);
+    uint64_t requestId = 0;
+    room->join(JoinChannelOptions(), requestId);
+    scheduler.trackChannel(*room, epoch);
+    rooms.push_back(room);
+  }
+  teacher->pump();
+  RTM_CHECK(scheduler.nextDeadline() >= epoch - seconds(90));
+  RTM_CHECK_EQ(scheduler.poll(epoch - seconds(91)), 0u);
+
+  for (now = epoch - seconds(90); now <= epoch - seconds(60); now += milliseconds(500)) {
+    scheduler.poll(now);
+    teacher->pump();
+  }
+  TokenRenewalScheduler::Stats stats = scheduler.stats();
+  RTM_CHECK_EQ(stats.renewals, 41u);
+  RTM_CHECK_EQ(stats.renewFailures, 0u);
+  RTM_CHECK_EQ(stats.late, 0u);
+  RTM_CHECK_EQ(routed.size(), 40u);
+  // Fewer fetches than tokens, but more than one: the renewals are spread over the 30 seconds.
+  RTM_CHECK(stats.fetches > 1 && stats.fetches < 41);
+  size_t fetched = 0;
+  for (const auto& batch : server.batches) {
+    RTM_CHECK(batch.size() <= options.maxBatch);
+    fetched += batch.size();
+  }
+  RTM_CHECK_EQ(fetched, 41u);
+  RTM_CHECK(scheduler.expiresAt("") > epoch);
+  RTM_CHECK(scheduler.expiresAt("room-7") > epoch);
+  RTM_CHECK(scheduler.nextDeadline() > epoch);
+
+  for (IStreamChannel* room : rooms) room->release();
+  teacher->release();
+}
+
+void testRetriesAndUrgentRenewals() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  TokenServer server;
+  server.now = &now;
+  server.defer = true;
+  server.validity = hours(3);
+  TokenRenewalScheduler::Options options;
+  options.seed = 5;
+  TokenRenewalScheduler scheduler(
+      *teacher, [&server](const std::vector<std::string>& targets, TokenRenewalScheduler::Done done) {
+        server(targets, std::move(done));
+      },
+      start, options);
+  mux.add(scheduler);
+  int errorCode = 0;
+  IStreamChannel* board = teacher->createStreamChannel("board", errorCode);
+  scheduler.trackClient(start + minutes(10));
+  scheduler.trackChannel(*board, start + hours(2));
+
+  // The SDK warns before the deadline: the client token is fetched at once, and only once.
+  scheduler.onTokenPrivilegeWillExpire("");
+  scheduler.onTokenPrivilegeWillExpire(nullptr);
+  RTM_CHECK_EQ(server.batches.size(), 1u);
+  RTM_CHECK_EQ(scheduler.stats().urgent, 1u);
+  server.pending[0]();
+  teacher->pump();
+  RTM_CHECK(scheduler.expiresAt("") == start + hours(3));
+  RTM_CHECK_EQ(scheduler.stats().renewals, 1u);
+
+  // The board was never joined, so its renewal fails and is tried again after the retry delay.
+  now = start + hours(2) - seconds(60);
+  RTM_CHECK_EQ(scheduler.poll(now), 1u);
+  server.pending[1]();
+  teacher->pump();
+  RTM_CHECK_EQ(scheduler.stats().renewFailures, 1u);
+  RTM_CHECK(scheduler.nextDeadline() == now + seconds(5));
+  uint64_t requestId = 0;
+  board->join(JoinChannelOptions(), requestId);
+  teacher->pump();
+
+  // The server has no token for the board this time; the next attempt gets one.
+  server.withheld = "board";
+  now += seconds(5);
+  RTM_CHECK_EQ(scheduler.poll(now), 1u);
+  server.pending[2]();
+  teacher->pump();
+  RTM_CHECK_EQ(scheduler.stats().missingTokens, 1u);
+  server.withheld = "<none>";
+  now += seconds(5);
+  RTM_CHECK_EQ(scheduler.poll(now), 1u);
+  server.pending[3]();
+  teacher->pump();
+  RTM_CHECK(scheduler.expiresAt("board") == now + hours(3));
+
+  // A target dropped while its fetch is out is not renewed.
+  scheduler.onTokenPrivilegeWillExpire("board");
+  RTM_CHECK(scheduler.untrack("board"));
+  RTM_CHECK(!scheduler.untrack("board"));
+  server.pending[4]();
+  teacher->pump();
+  TokenRenewalScheduler::Stats stats = scheduler.stats();
+  RTM_CHECK_EQ(stats.renewals, 3u);
+  RTM_CHECK_EQ(stats.fetches, 5u);
+  RTM_CHECK_EQ(stats.tracked, 1u);
+  RTM_CHECK_EQ(stats.late, 0u);
+
+  board->release();
+  teacher->release();
+}
+
+void testIgnoresTheAppsOwnRenewals() {
+  LoopbackBroker broker;
+  RtmEventMux mux;
+  LoopbackRtmClient* teacher = loggedInClient(broker, "teacher", mux);
+  RtmClock::time_point start = RtmClock::now();
+  RtmClock::time_point now = start;
+  TokenServer server;
+  server.now = &now;
+  TokenRenewalScheduler scheduler(
+      *teacher, [&server](const std::vector<std::string>& targets, TokenRenewalScheduler::Done done) {
+        server(targets, std::move(done));
+      },
+      start);
+  mux.add(scheduler);
+  scheduler.trackClient(start + minutes(10));
+
+  // The app renews with an empty token and fails; that result and the scheduler's own both come while the
+  // scheduler's renewal is being made, the app's first. Only the scheduler's settles it.
+  uint64_t requestId = 0;
+  teacher->renewToken("", requestId);
+  teacher->setResultsInCall(true);
+  scheduler.onTokenPrivilegeWillExpire("");
+  TokenRenewalScheduler::Stats stats = scheduler.stats();
+  RTM_CHECK_EQ(stats.renewals, 1u);
+  RTM_CHECK_EQ(stats.renewFailures, 0u);
+  RTM_CHECK(scheduler.expiresAt("") == start + hours(1));
+  teacher->release();
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testRenewsRoomsOfOneEpochInSpreadBatches);
+  RTM_RUN(testRetriesAndUrgentRenewals);
+  RTM_RUN(testIgnoresTheAppsOwnRenewals);
+  return 0;
+}
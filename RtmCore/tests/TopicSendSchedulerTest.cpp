@@ -0,0 +1,151 @@
+//
+//  TopicSendSchedulerTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+
+#include "Loopback/LoopbackBroker.h"
+#include "Loopback/LoopbackRtmClient.h"
+#include "Publishing/TopicSendScheduler.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/// A teacher publishing on three topics of one stream channel, a student subscribed to all of them.
+struct StreamRoom {
+  StreamRoom() {
+    teacher = loggedInClient(broker, "teacher", teacherEvents);
+    student = loggedInClient(broker, "student", studentEvents);
+    int errorCode = 0;
+    teacherChannel = teacher->createStreamChannel("class", errorCode);
+    studentChannel = student->createStreamChannel("class", errorCode);
+    uint64_t requestId = 0;
+    teacherChannel->join(JoinChannelOptions(), requestId);
+    studentChannel->join(JoinChannelOptions(), requestId);
+    const char* publishers[] = {"teacher"};
+    TopicOptions subscribe;
+    subscribe.users = publishers;
+    subscribe.userCount = 1;
+    for (const char* topic : {"control", "chat", "whiteboard"}) {
+      teacherChannel->joinTopic(topic, JoinTopicOptions(), requestId);
+      studentChannel->subscribeTopic(topic, subscribe, requestId);
+    }
+  }
+
+  ~StreamRoom() {
+    studentChannel->release();
+    teacherChannel->release();
+    student->release();
+    teacher->release();
+  }
+
+  size_t received(const std::string& topic) const {
+    size_t count = 0;
+    for (const auto& message : studentEvents.messages) count += message.topic == topic;
+    return count;
+  }
+
+  LoopbackBroker broker;
+  RecordingEventHandler teacherEvents, studentEvents;
+  LoopbackRtmClient* teacher;
+  LoopbackRtmClient* student;
+  IStreamChannel* teacherChannel;
+  IStreamChannel* studentChannel;
+};
+
+void testControlOvertakesBulkBacklog() {
+  StreamRoom room;
+  TopicSendScheduler::Options options;
+  options.bytesPerSecond = 10 * 1024;
+  options.burstBytes = 2 * 1024;
+  RtmClock::time_point now = RtmClock::now();
+  TopicSendScheduler scheduler(*room.teacherChannel, now, options);
+  scheduler.setTopicPriority("control", RTM_MESSAGE_PRIORITY_HIGHEST);
+  scheduler.setTopicPriority("whiteboard", RTM_MESSAGE_PRIORITY_LOW);
+
+  std::string delta(1000, 'w');
+  for (int i = 0; i < 100; ++i) {
+    RTM_CHECK_EQ(scheduler.enqueue("whiteboard", delta.data(), delta.size(), TopicMessageOptions(), now),
+                 RTM_ERROR_OK);
+  }
+  size_t backlogSent = room.received("whiteboard");
+  RTM_CHECK(backlogSent < 5);
+  RTM_CHECK(scheduler.nextDeadline() > now);
+
+  scheduler.enqueue("control", "{\"mute\":true}", 13, TopicMessageOptions(), now);
+  for (int i = 0; i < 3 && room.received("control") == 0; ++i) {
+    now += milliseconds(100);
+    scheduler.poll(now);
+  }
+  RTM_CHECK_EQ(room.received("control"), 1u);
+  RTM_CHECK(room.received("whiteboard") <= backlogSent + 2);
+  RTM_CHECK_EQ(scheduler.queued("control"), 0u);
+  RTM_CHECK(scheduler.queued("whiteboard") > 90);
+}
+
+void testSaturatedTopicsShareByWeight() {
+  StreamRoom room;
+  TopicSendScheduler::Options options;
+  options.bytesPerSecond = 20 * 1024;
+  options.burstBytes = 1024;
+  options.quantumBytes = 200;
+  RtmClock::time_point now = RtmClock::now();
+  TopicSendScheduler scheduler(*room.teacherChannel, now, options);
+  scheduler.setTopicPriority("chat", RTM_MESSAGE_PRIORITY_HIGH);
+  scheduler.setTopicPriority("whiteboard", RTM_MESSAGE_PRIORITY_LOW);
+
+  std::string payload(200, 'x');
+  for (int i = 0; i < 500; ++i) {
+    scheduler.enqueue("chat", payload.data(), payload.size(), TopicMessageOptions(), now);
+    scheduler.enqueue("whiteboard", payload.data(), payload.size(), TopicMessageOptions(), now);
+  }
+  for (int i = 0; i < 20; ++i) {
+    now += milliseconds(50);
+    scheduler.poll(now);
+  }
+  size_t chat = room.received("chat");
+  size_t whiteboard = room.received("whiteboard");
+  RTM_CHECK(whiteboard > 0 && chat < 500);
+  RTM_CHECK(chat >= whiteboard * 3 && chat <= whiteboard * 5);
+
+  TopicSendScheduler::Stats stats = scheduler.stats();
+  RTM_CHECK_EQ(stats.sent, chat + whiteboard);
+  RTM_CHECK_EQ(stats.queuedMessages, 1000 - stats.sent);
+  RTM_CHECK(room.teacherEvents.succeeded(room.teacherEvents.results.rbegin()->first));
+}
+
+void testQueueLimitRejects() {
+  StreamRoom room;
+  TopicSendScheduler::Options options;
+  options.bytesPerSecond = 1;
+  options.burstBytes = 1;
+  options.maxQueuedPerTopic = 2;
+  RtmClock::time_point now = RtmClock::now();
+  TopicSendScheduler scheduler(*room.teacherChannel, now, options);
+  RTM_CHECK_EQ(scheduler.enqueue("chat", "a", 1, TopicMessageOptions(), now), RTM_ERROR_OK);
+  RTM_CHECK_EQ(scheduler.enqueue("chat", "b", 1, TopicMessageOptions(), now), RTM_ERROR_OK);
+  RTM_CHECK_EQ(scheduler.enqueue("chat", "c", 1, TopicMessageOptions(), now), RTM_ERROR_OK);
+  RTM_CHECK_EQ(scheduler.enqueue("chat", "d", 1, TopicMessageOptions(), now),
+               RTM_ERROR_OPERATION_RATE_EXCEED_LIMITATION);
+  RTM_CHECK_EQ(scheduler.enqueue("", "e", 1, TopicMessageOptions(), now), RTM_ERROR_CHANNEL_INVALID_TOPIC_NAME);
+  RTM_CHECK_EQ(scheduler.stats().rejected, 1u);
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testControlOvertakesBulkBacklog);
+  RTM_RUN(testSaturatedTopicsShareByWeight);
+  RTM_RUN(testQueueLimitRejects);
+  return 0;
+}
@@ -0,0 +1,118 @@
+//
+//  UserIdTableTest.cpp
+//  RtmCore
+//
+//  Copyright © 2026 agora.io. All rights reserved.
+//
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/UserIdTable.h"
+#include "Presence/PresenceRoster.h"
+#include "TestSupport.h"
+
+using namespace agora::rtm;
+using namespace flat::rtm;
+using namespace flat::rtm::test;
+
+namespace {
+
+void testHandlesAreDenseAndStable() {
+  UserIdTable users;
+  RTM_CHECK_EQ(users.intern(""), UserIdTable::kNoUser);
+  RTM_CHECK_EQ(users.intern(static_cast<const char*>(nullptr)), UserIdTable::kNoUser);
+  RTM_CHECK_EQ(users.find("alice"), UserIdTable::kNoUser);
+  RTM_CHECK_EQ(users.intern("alice"), 0u);
+  RTM_CHECK_EQ(users.intern(std::string("bob")), 1u);
+  RTM_CHECK_EQ(users.intern("alice"), 0u);
+  RTM_CHECK_EQ(users.find("bob"), 1u);
+  std::string_view alice = users.name(0);
+  RTM_CHECK_EQ(alice, "alice");
+  RTM_CHECK(users.name(2).empty());
+
+  // Crosses several index growths and entry segments; earlier names never move.
+  const uint32_t count = 200000;
+  for (uint32_t i = 2; i < count; ++i) RTM_CHECK_EQ(users.intern("user" + std::to_string(i)), i);
+  RTM_CHECK_EQ(users.size(), static_cast<size_t>(count));
+  for (uint32_t i = 2; i < count; i += 997) {
+    std::string userId = "user" + std::to_string(i);
+    RTM_CHECK_EQ(users.find(userId), i);
+    RTM_CHECK_EQ(users.name(i), userId);
+  }
+  RTM_CHECK_EQ(alice.data(), users.name(0).data());
+  std::string longId(40000, 'x');
+  UserIdTable::UserHandle longHandle = users.intern(longId);
+  RTM_CHECK_EQ(users.name(longHandle), longId);
+  RTM_CHECK(users.bytes() > longId.size() + count * 8);
+}
+
+void testConcurrentInternAgreesOnHandles() {
+  UserIdTable users;
+  const int threadCount = 4;
+  const int idCount = 50000;
+  std::vector<std::vector<UserIdTable::UserHandle>> seen(threadCount,
+                                                          std::vector<UserIdTable::UserHandle>(idCount));
+  std::atomic<bool> mismatch{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t] {
+      // Each thread walks the ids from a different starting point, so every id races between threads.
+      for (int n = 0; n < idCount; ++n) {
+        int i = (n + t * idCount / threadCount) % idCount;
+        std::string userId = "student" + std::to_string(i);
+        UserIdTable::UserHandle handle = users.intern(userId);
+        seen[t][i] = handle;
+        if (users.find(userId) != handle || users.name(handle) != userId) mismatch = true;
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  RTM_CHECK(!mismatch);
+  RTM_CHECK_EQ(users.size(), static_cast<size_t>(idCount));
+  std::vector<bool> used(idCount);
+  for (int i = 0; i < idCount; ++i) {
+    for (int t = 1; t < threadCount; ++t) RTM_CHECK_EQ(seen[t][i], seen[0][i]);
+    RTM_CHECK(seen[0][i] < static_cast<UserIdTable::UserHandle>(idCount));
+    RTM_CHECK(!used[seen[0][i]]);
+    used[seen[0][i]] = true;
+  }
+}
+
+void testRostersShareHandles() {
+  UserIdTable users;
+  PresenceRoster lecture("lecture", RTM_CHANNEL_TYPE_MESSAGE, users);
+  PresenceRoster breakout("breakout", RTM_CHANNEL_TYPE_MESSAGE, users);
+  const char* ids[] = {"teacher", "alice"};
+  UserState states[2];
+  for (int i = 0; i < 2; ++i) states[i].userId = ids[i];
+  IRtmEventHandler::PresenceEvent event;
+  event.type = RTM_PRESENCE_EVENT_TYPE_SNAPSHOT;
+  event.channelType = RTM_CHANNEL_TYPE_MESSAGE;
+  event.channelName = "lecture";
+  event.snapshot.userStateList = states;
+  event.snapshot.userCount = 2;
+  lecture.onPresenceEvent(event);
+  event.channelName = "breakout";
+  event.snapshot.userStateList = states + 1;
+  event.snapshot.userCount = 1;
+  breakout.onPresenceEvent(event);
+
+  UserIdTable::UserHandle alice = users.find("alice");
+  RTM_CHECK_EQ(users.size(), 2u);
+  RTM_CHECK(lecture.contains(alice));
+  RTM_CHECK(breakout.contains(alice));
+  RTM_CHECK(!breakout.contains(users.find("teacher")));
+  RTM_CHECK(breakout.members() == std::vector<UserIdTable::UserHandle>({alice}));
+}
+
+}  // namespace
+
+int main() {
+  RTM_RUN(testHandlesAreDenseAndStable);
+  RTM_RUN(testConcurrentInternAgreesOnHandles);
+  RTM_RUN(testRostersShareHandles);
+  return 0;
+}